@@ -57,6 +57,18 @@ AppDescriptor& AppDescriptor::with_frames_in_flight(uint frames_in_flight)
     rhi.frames = frames_in_flight;
     return *this;
 }
+
+AppDescriptor& AppDescriptor::with_present_mode(GPUPresentMode present_mode)
+{
+    rhi.present_mode = present_mode;
+    return *this;
+}
+
+AppDescriptor& AppDescriptor::with_low_latency(bool enable)
+{
+    rhi.low_latency = enable;
+    return *this;
+}
 #pragma endregion AppDescriptor
 
 #pragma region Application
@@ -129,10 +141,18 @@ void Application::init_graphics()
         auto desc         = GPUSurfaceDescriptor{};
         desc.label        = "main_surface";
         desc.window       = *wsi;
-        desc.present_mode = GPUPresentMode::Fifo;
+        desc.present_mode = descriptor.rhi.present_mode;
         desc.frames       = descriptor.rhi.frames;
         return rhi->request_surface(desc);
     });
+
+    // frame pacing (can be changed at runtime with RHI::set_frame_pacing)
+    RHI::set_frame_pacing(lyra::execute([&]() {
+        auto pacing        = GPUFramePacing{};
+        pacing.frames      = descriptor.rhi.frames;
+        pacing.low_latency = descriptor.rhi.low_latency;
+        return pacing;
+    }));
 }
 
 void Application::init_compiler()
@@ -18,9 +18,11 @@ namespace lyra
 
     struct AppGraphicsDescriptor
     {
-        RHIBackend backend;
-        RHIFlags   flags;
-        uint       frames = 3;
+        RHIBackend     backend;
+        RHIFlags       flags;
+        uint           frames       = 3;
+        GPUPresentMode present_mode = GPUPresentMode::Fifo;
+        bool           low_latency  = false;
     };
 
     struct AppCompilerDescriptor
@@ -41,6 +43,8 @@ namespace lyra
         AppDescriptor& with_graphics_backend(RHIBackend backend);
         AppDescriptor& with_graphics_validation(bool debug = true, bool validation = true);
         AppDescriptor& with_frames_in_flight(uint frames_in_flight);
+        AppDescriptor& with_present_mode(GPUPresentMode present_mode);
+        AppDescriptor& with_low_latency(bool enable = true);
 
     private:
         AppWindowDescriptor   wsi;
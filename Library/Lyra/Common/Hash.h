@@ -3,6 +3,7 @@
 #ifndef LYRA_LIBRARY_COMMON_HASH_H
 #define LYRA_LIBRARY_COMMON_HASH_H
 
+#include <cstdint>
 #include <functional>
 
 namespace lyra
@@ -14,6 +15,18 @@ namespace lyra
         seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
 
+    // 64-bit FNV-1a, stable across runs and platforms (usable as a persistent key)
+    inline uint64_t hash_bytes(const void* data, std::size_t size)
+    {
+        auto     bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash  = 14695981039346656037ull;
+        for (std::size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
 } // namespace lyra
 
 #endif // LYRA_LIBRARY_COMMON_HASH_H
@@ -3,8 +3,12 @@
 #ifndef LYRA_LIBRARY_COMMON_SLOTMAP_H
 #define LYRA_LIBRARY_COMMON_SLOTMAP_H
 
+#include <deque>
+#include <memory>
 #include <vector>
+#include <cassert>
 #include <cstdint>
+#include <type_traits>
 
 namespace lyra
 {
@@ -20,12 +24,53 @@ namespace lyra
     {
     };
 
+    // Slotmap hands out handles packing [generation | index] into a single integer.
+    // Items live in fixed-size chunks, so references stay valid while the map grows.
+    // A slot is live when its generation is odd, both add and remove bump it, hence
+    // stale handles never match a recycled slot until the generation wraps around:
+    // with 12 generation bits, a handle aliases again once its slot is reused 2048 times.
+    // Free slots are recycled oldest first, so that takes 2048 reuses of every free slot.
+    // Handles stay 32-bit (see TypedEnumHandle), more generation bits would cost index bits.
     template <typename T, typename Deleter, typename I = uint32_t, typename = std::enable_if<has_valid<T>::value, bool>>
     struct Slotmap
     {
-        std::vector<T> data = {};
-        std::vector<I> free = {};
-        I              rear = 0;
+        static constexpr I      GENERATION_BITS = 12;
+        static constexpr I      INDEX_BITS      = sizeof(I) * 8 - GENERATION_BITS;
+        static constexpr I      INDEX_MASK      = (I(1) << INDEX_BITS) - 1;
+        static constexpr I      GENERATION_MASK = (I(1) << GENERATION_BITS) - 1;
+        static constexpr size_t CHUNK_SIZE      = 256;
+
+        // all bits set is reserved for invalid handles, hence the last index is never used
+        static constexpr size_t MAX_SLOTS = INDEX_MASK;
+
+        template <typename S, typename V>
+        struct Iterator
+        {
+            S*     slotmap = nullptr;
+            size_t index   = 0;
+
+            auto operator*() const -> V& { return slotmap->slot(index); }
+
+            // handle of the item the iterator points to
+            auto handle() const -> I { return encode(static_cast<I>(index), slotmap->generations[index]); }
+
+            auto operator++() -> Iterator&
+            {
+                index = slotmap->next_live(index + 1);
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const { return index == other.index; }
+            bool operator!=(const Iterator& other) const { return index != other.index; }
+        };
+
+        using iterator       = Iterator<Slotmap, T>;
+        using const_iterator = Iterator<const Slotmap, const T>;
+
+        Slotmap() = default;
+
+        Slotmap(const Slotmap&)            = delete;
+        Slotmap& operator=(const Slotmap&) = delete;
 
         virtual ~Slotmap()
         {
@@ -34,55 +79,132 @@ namespace lyra
 
         void clear()
         {
-            for (auto& item : data)
+            for (auto& item : *this)
                 if (item.valid())
                     Deleter()(item);
+
+            chunks.clear();
+            generations.clear();
+            free.clear();
+            count = 0;
         }
 
         auto add(const T& value) -> I
         {
             I index = get_next_index();
 
-            data.at(index) = value;
-            return index;
+            // odd generation marks the slot as live
+            I& generation = generations.at(index);
+            generation    = (generation + 1) & GENERATION_MASK;
+            slot(index)   = value;
+            count++;
+            return encode(index, generation);
         }
 
-        void remove(I index)
+        void remove(I handle)
         {
-            assert(index < data.size());
-            Deleter()(data.at(index));
+            assert(contains(handle) && "Slotmap::remove() called with a stale or invalid handle!");
+            if (!contains(handle))
+                return;
+
+            I  index      = handle & INDEX_MASK;
+            I& generation = generations.at(index);
+            generation    = (generation + 1) & GENERATION_MASK;
+
+            T& item = slot(index);
+            Deleter()(item);
+            item = T{};
+
             free.push_back(index);
+            count--;
         }
 
-        auto at(I index) -> T& { return data.at(index); }
+        // invalidates the handle and hands the item back without calling Deleter,
+        // stale handles are rejected with a default constructed (invalid) item.
+        auto release(I handle) -> T
+        {
+            assert(contains(handle) && "Slotmap::release() called with a stale or invalid handle!");
+            if (!contains(handle))
+                return T{};
 
-        auto at(I index) const -> const T& { return data.at(index); }
+            I  index      = handle & INDEX_MASK;
+            I& generation = generations.at(index);
+            generation    = (generation + 1) & GENERATION_MASK;
+
+            T item      = std::move(slot(index));
+            slot(index) = T{};
+
+            free.push_back(index);
+            count--;
+            return item;
+        }
+
+        bool contains(I handle) const
+        {
+            size_t index = handle & INDEX_MASK;
+            return index < generations.size() && generations[index] == (handle >> INDEX_BITS);
+        }
+
+        auto at(I handle) -> T&
+        {
+            assert(contains(handle) && "Slotmap::at() called with a stale or invalid handle!");
+            return slot(handle & INDEX_MASK);
+        }
+
+        auto at(I handle) const -> const T&
+        {
+            assert(contains(handle) && "Slotmap::at() called with a stale or invalid handle!");
+            return slot(handle & INDEX_MASK);
+        }
+
+        auto size() const -> size_t { return count; }
+
+        bool empty() const { return count == 0; }
+
+        auto begin() -> iterator { return iterator{this, next_live(0)}; }
+        auto end() -> iterator { return iterator{this, generations.size()}; }
+        auto begin() const -> const_iterator { return const_iterator{this, next_live(0)}; }
+        auto end() const -> const_iterator { return const_iterator{this, generations.size()}; }
 
     private:
-        auto get_next_index() -> I
+        std::vector<std::unique_ptr<T[]>> chunks      = {};
+        std::vector<I>                    generations = {};
+        std::deque<I>                     free        = {};
+        size_t                            count       = 0;
+
+        static auto encode(I index, I generation) -> I
         {
-            // fallback: increase the data array
-            if (free.empty()) {
-                if (rear < data.size())
-                    return rear++;
+            return (generation << INDEX_BITS) | index;
+        }
 
-                resize_data();
-                return rear++;
-            }
+        auto slot(size_t index) -> T& { return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE]; }
+
+        auto slot(size_t index) const -> const T& { return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE]; }
 
-            // find from free list
-            I index = free.back();
-            free.pop_back();
+        auto next_live(size_t index) const -> size_t
+        {
+            while (index < generations.size() && (generations[index] & 1) == 0)
+                index++;
             return index;
         }
 
-        void resize_data()
+        auto get_next_index() -> I
         {
-            size_t old_size = data.size();
-            size_t tgt_size = old_size * 2 + 1;
-            size_t new_size = tgt_size > 2048 ? 2048 : tgt_size;
-            data.resize(new_size);
-            rear = static_cast<I>(old_size);
+            // recycle the oldest free slot first, this spreads generation bumps across slots
+            if (!free.empty()) {
+                I index = free.front();
+                free.pop_front();
+                return index;
+            }
+
+            // fallback: grow by one chunk, existing items never move
+            size_t index = generations.size();
+            assert(index < MAX_SLOTS && "Slotmap ran out of handle indices!");
+            if (index % CHUNK_SIZE == 0)
+                chunks.push_back(std::make_unique<T[]>(CHUNK_SIZE));
+
+            generations.push_back(0);
+            return static_cast<I>(index);
         }
     };
 
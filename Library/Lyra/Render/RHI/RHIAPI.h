@@ -49,6 +49,7 @@ namespace lyra
 
         bool (*create_query_set)(GPUQuerySetHandle& query, const GPUQuerySetDescriptor& descriptor);
         void (*delete_query_set)(GPUQuerySetHandle query);
+        void (*reset_query_set)(GPUQuerySetHandle query, GPUSize32 first_query, GPUSize32 query_count);
 
         bool (*create_blas)(GPUBlasHandle& blas, const GPUBlasDescriptor& descriptor, GPUBlasGeometrySizeDescriptors sizes);
         void (*delete_blas)(GPUBlasHandle blas);
@@ -74,6 +75,9 @@ namespace lyra
 
         void (*new_frame)();
         void (*end_frame)();
+        void (*set_frame_pacing)(const GPUFramePacing& pacing);
+        bool (*get_frame_timing)(GPUFrameTiming& timing);
+        bool (*get_frame_slot)(GPUFrameSlot& slot);
 
         bool (*acquire_next_frame)(GPUSurfaceHandle surface, GPUTextureHandle& texture, GPUTextureViewHandle& view, GPUFenceHandle& image_available, GPUFenceHandle& render_complete, bool& suboptimal);
         bool (*present_curr_frame)(GPUSurfaceHandle surface);
@@ -81,25 +85,49 @@ namespace lyra
         void (*get_mapped_state)(GPUBufferHandle buffer, GPUMapState& state);
         void (*get_mapped_range)(GPUBufferHandle buffer, MappedBufferRange& range);
         void (*map_buffer)(GPUBufferHandle buffer, GPUMapMode mode, GPUSize64 offset, GPUSize64 size);
+        void (*map_buffer_async)(GPUBufferHandle buffer, GPUMapMode mode, GPUSize64 offset, GPUSize64 size, const GPUBufferMapCallback& callback);
         void (*unmap_buffer)(GPUBufferHandle buffer);
 
         void (*wait_idle)();
         void (*wait_fence)(GPUFenceHandle fence);
+        void (*flush_submissions)();
 
         bool (*get_blas_sizes)(GPUBlasHandle blas, GPUBVHSizes& sizes);
         bool (*get_tlas_sizes)(GPUTlasHandle tlas, GPUBVHSizes& sizes);
 
+        bool (*get_memory_pool_stats)(GPUMemoryPool pool, GPUMemoryPoolStats& stats);
+        bool (*get_memory_stats)(GPUMemoryStats& stats);
+        void (*set_memory_budget_callback)(float threshold, const GPUMemoryBudgetCallback& callback);
+        bool (*get_command_stats)(GPUCommandStats& stats);
+        bool (*get_shader_module_stats)(GPUShaderModuleStats& stats);
+        bool (*get_staging_stats)(GPUStagingStats& stats);
+        bool (*get_defragment_stats)(GPUDefragmentStats& stats);
+        bool (*get_shader_module_hash)(GPUShaderModuleHandle shader, GPUSize64& hash);
+        bool (*get_render_pipeline_status)(GPURenderPipelineHandle pipeline, GPUPipelineStatus& status);
+        bool (*get_compute_pipeline_status)(GPUComputePipelineHandle pipeline, GPUPipelineStatus& status);
+        void (*wait_pipelines)();
+        bool (*allocate_transient)(GPUSize64 size, GPUSize64 alignment, GPUTransientAllocation& allocation);
+
+        bool (*upload_buffer)(GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size, GPUUploadToken& token);
+        bool (*upload_texture)(const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size, GPUUploadToken& token);
+        void (*flush_uploads)();
+        bool (*query_upload)(GPUUploadToken token);
+        void (*wait_upload)(GPUUploadToken token);
+
         bool (*create_command_buffer)(GPUCommandEncoderHandle& cmdbuffer, const GPUCommandBufferDescriptor& descriptor);
         bool (*create_command_bundle)(GPUCommandEncoderHandle& cmdbuffer, const GPUCommandBundleDescriptor& descriptor);
         bool (*submit_command_buffer)(GPUCommandEncoderHandle cmdbuffer);
+        bool (*finish_command_bundle)(GPUCommandEncoderHandle cmdbuffer);
 
         void (*cmd_insert_debug_marker)(GPUCommandEncoderHandle cmdbuffer, CString marker_label);
         void (*cmd_push_debug_group)(GPUCommandEncoderHandle cmdbuffer, CString group_label);
         void (*cmd_pop_debug_group)(GPUCommandEncoderHandle cmdbuffer);
         void (*cmd_wait_fence)(GPUCommandEncoderHandle cmdbuffer, GPUFenceHandle fence, GPUBarrierSyncFlags sync);
         void (*cmd_signal_fence)(GPUCommandEncoderHandle cmdbuffer, GPUFenceHandle fence, GPUBarrierSyncFlags sync);
+        void (*cmd_wait_upload)(GPUCommandEncoderHandle cmdbuffer, GPUUploadToken token, GPUBarrierSyncFlags sync);
         void (*cmd_begin_render_pass)(GPUCommandEncoderHandle cmdbuffer, const GPURenderPassDescriptor& descriptor);
         void (*cmd_end_render_pass)(GPUCommandEncoderHandle cmdbuffer);
+        void (*cmd_execute_bundles)(GPUCommandEncoderHandle cmdbuffer, GPUCommandEncoderHandles bundles);
         void (*cmd_set_render_pipeline)(GPUCommandEncoderHandle cmdbuffer, GPURenderPipelineHandle pipeline);
         void (*cmd_set_compute_pipeline)(GPUCommandEncoderHandle cmdbuffer, GPUComputePipelineHandle pipeline);
         void (*cmd_set_raytracing_pipeline)(GPUCommandEncoderHandle cmdbuffer, GPURayTracingPipelineHandle pipeline);
@@ -111,9 +139,12 @@ namespace lyra
         void (*cmd_draw_indexed)(GPUCommandEncoderHandle cmdbuffer, GPUSize32 index_count, GPUSize32 instance_count, GPUSize32 first_index, GPUSignedOffset32 base_vertex, GPUSize32 first_instance);
         void (*cmd_draw_indirect)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUSize32 draw_count);
         void (*cmd_draw_indexed_indirect)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUSize32 draw_count);
+        void (*cmd_draw_indirect_count)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count);
+        void (*cmd_draw_indexed_indirect_count)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count);
         void (*cmd_dispatch_workgroups)(GPUCommandEncoderHandle cmdbuffer, GPUSize32 x, GPUSize32 y, GPUSize32 z);
         void (*cmd_dispatch_workgroups_indirect)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset);
         void (*cmd_copy_buffer_to_buffer)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle source, GPUSize64 source_offset, GPUBufferHandle destination, GPUSize64 destination_offset, GPUSize64 size);
+        void (*cmd_update_buffer)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size);
         void (*cmd_copy_buffer_to_texture)(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyBufferInfo& source, const GPUTexelCopyTextureInfo& destination, GPUExtent3D copy_size);
         void (*cmd_copy_texture_to_buffer)(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyTextureInfo& source, const GPUTexelCopyBufferInfo& destination, const GPUExtent3D& copy_size);
         void (*cmd_copy_texture_to_texture)(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyTextureInfo& source, const GPUTexelCopyTextureInfo& destination, const GPUExtent3D& copy_size);
@@ -126,14 +157,18 @@ namespace lyra
         void (*cmd_begin_occlusion_query)(GPUCommandEncoderHandle cmdbuffer, GPUSize32 query_index);
         void (*cmd_end_occlusion_query)(GPUCommandEncoderHandle cmdbuffer);
         void (*cmd_write_timestamp)(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
+        void (*cmd_begin_pipeline_statistics_query)(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
+        void (*cmd_end_pipeline_statistics_query)(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
         void (*cmd_write_blas_properties)(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index, GPUBlasHandle blas);
         void (*cmd_resolve_query_set)(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 first_query, GPUSize32 query_count, GPUBufferHandle destination, GPUSize64 destination_offset);
         void (*cmd_memory_barrier)(GPUCommandEncoderHandle cmdbuffer, GPUMemoryBarriers barriers);
         void (*cmd_buffer_barrier)(GPUCommandEncoderHandle cmdbuffer, GPUBufferBarriers barriers);
         void (*cmd_texture_barrier)(GPUCommandEncoderHandle cmdbuffer, GPUTextureBarriers barriers);
+        void (*cmd_update_tlas_instances)(GPUCommandEncoderHandle cmdbuffer, GPUTlasHandle tlas, GPUTlasInstanceUpdates updates);
         void (*cmd_build_tlases)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUTlasBuildEntries entries);
         void (*cmd_build_blases)(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUBlasBuildEntries entries);
         void (*cmd_copy_blas)(GPUCommandEncoderHandle cmdbuffer, GPUBlasHandle old_blas, GPUBlasHandle new_blas);
+        void (*cmd_defragment_memory)(GPUCommandEncoderHandle cmdbuffer, const GPUDefragmentDescriptor& descriptor);
     };
 
 } // namespace lyra
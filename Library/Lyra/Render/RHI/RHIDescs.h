@@ -26,9 +26,36 @@ namespace lyra
         // nothing here for now
     };
 
+    // NOTE: Non-WebGPU standard API
+    struct GPUMemoryPoolDescriptor
+    {
+        // block sizes of each sub-allocation pool
+        GPUSize64 device_block_size   = 64ull << 20;
+        GPUSize64 uniform_block_size  = 16ull << 20;
+        GPUSize64 upload_block_size   = 32ull << 20;
+        GPUSize64 readback_block_size = 16ull << 20;
+
+        // render targets larger than this receive their own dedicated allocation
+        GPUSize64 dedicated_threshold = 16ull << 20;
+
+        // initial size of the transient upload ring (per frame in flight)
+        GPUSize64 upload_ring_size = 8ull << 20;
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // limits of a single defragmentation pass, see GPUCommandEncoder::defragment_memory()
+    struct GPUDefragmentDescriptor
+    {
+        GPUSize64 max_bytes_per_pass = 32ull << 20; // bytes copied per pass
+        uint      max_moves_per_pass = 64;          // allocations moved per pass
+        float     max_time_ms        = 1.0f;        // host time creating and binding moved resources (not the GPU copies), later moves of the pass are abandoned until the pool is defragmented again (at least one move per pass)
+    };
+
     struct GPUDeviceDescriptor : public GPUObjectDescriptorBase
     {
-        GPUFeatureNames required_features = {};
+        GPUFeatureNames         required_features = {};
+        GPUMemoryPoolDescriptor memory_pools      = {};
+        uint                    frames            = 1; // NOTE: Non-WebGPU standard API (frame slots without a surface)
     };
 
     struct GPUSurfaceDescriptor : public GPUObjectDescriptorBase
@@ -120,15 +147,17 @@ namespace lyra
 
     struct GPUQuerySetDescriptor : public GPUObjectDescriptorBase
     {
-        GPUQueryType type;
-        GPUSize32    count;
+        GPUQueryType           type;
+        GPUSize32              count;
+        GPUQueryStatisticFlags statistics = 0; // only used by pipeline statistics queries
     };
 
     // NOTE: Non-WebGPU standard API
     struct GPUBlasDescriptor : public GPUObjectDescriptorBase
     {
-        GPUBVHFlags      flags       = 0;
-        GPUBVHUpdateMode update_mode = GPUBVHUpdateMode::BUILD;
+        GPUBVHFlags      flags          = 0;
+        GPUBVHUpdateMode update_mode    = GPUBVHUpdateMode::BUILD;
+        GPUSize64        compacted_size = 0; // non-zero creates the destination of a compacting copy, with this storage size
     };
 
     // NOTE: Non-WebGPU standard API
@@ -159,6 +188,11 @@ namespace lyra
     struct GPUPipelineDescriptorBase : public GPUObjectDescriptorBase
     {
         GPUPipelineLayoutHandle layout;
+
+        // NOTE: Non-WebGPU standard API
+        // asynchronous pipelines are compiled on worker threads, the handle is returned right away,
+        // draws and dispatches using the pipeline are skipped until it becomes ready.
+        bool async = false;
     };
 
     struct GPUComputePipelineDescriptor : public GPUPipelineDescriptorBase
@@ -193,14 +227,22 @@ namespace lyra
         GPURenderPassDepthStencilAttachment depth_stencil_attachment;
         GPUQuerySetHandle                   occlusion_query_set;
         GPUSize64                           max_draw_count = 50000000;
+        bool                                bundles_only   = false; // NOTE: Non-WebGPU, pass contents come from execute_bundles()
     };
 
     struct GPUCommandBufferDescriptor : public GPUObjectDescriptorBase
     {
         GPUQueueType queue = GPUQueueType::DEFAULT;
+
+        // NOTE: Non-WebGPU standard API
+        // tracked command buffers insert barriers automatically, based on the last known state of
+        // each buffer and texture subresource, explicit barriers only need the destination state.
+        // resources used by bundles and acceleration structure builds are not tracked.
+        bool tracked = false;
     };
 
-    struct GPUCommandBundleDescriptor : public GPUObjectDescriptorBase
+    // bundles are executed inside of a render pass with a compatible layout
+    struct GPUCommandBundleDescriptor : public GPURenderPassLayout
     {
         GPUQueueType queue = GPUQueueType::DEFAULT;
     };
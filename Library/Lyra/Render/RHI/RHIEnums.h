@@ -82,6 +82,15 @@ namespace lyra
         TRANSFER,
     };
 
+    // NOTE: Non-WebGPU standard API
+    enum struct GPUMemoryPool : uint
+    {
+        DEVICE,   // vertex/index/storage/indirect buffers
+        UNIFORM,  // uniform buffers
+        UPLOAD,   // MAP_WRITE (staging) buffers
+        READBACK, // MAP_READ buffers
+    };
+
     enum struct GPUPresentMode : uint
     {
         Fifo,
@@ -168,6 +177,13 @@ namespace lyra
         MAPPED,
     };
 
+    // NOTE: Non-WebGPU standard API
+    enum struct GPUPipelineStatus : uint
+    {
+        PENDING, // still compiling on a worker thread
+        READY,
+    };
+
     enum struct GPUBufferUsage : uint
     {
         MAP_READ      = 0x0001,
@@ -222,6 +238,19 @@ namespace lyra
         PIPELINE_STATISTICS, // additional pipeline support
     };
 
+    // NOTE: Non-WebGPU standard API
+    enum struct GPUQueryStatistic : uint
+    {
+        INPUT_VERTICES       = 0x0001,
+        INPUT_PRIMITIVES     = 0x0002,
+        VERTEX_INVOCATIONS   = 0x0004,
+        CLIPPING_INVOCATIONS = 0x0008,
+        CLIPPING_PRIMITIVES  = 0x0010,
+        FRAGMENT_INVOCATIONS = 0x0020,
+        COMPUTE_INVOCATIONS  = 0x0040,
+        ALL                  = 0x007F,
+    };
+
     enum struct GPUBufferBindingType : uint
     {
         UNIFORM,
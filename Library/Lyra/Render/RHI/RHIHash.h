@@ -37,4 +37,45 @@ struct std::hash<lyra::GPUTextureDescriptor>
     }
 };
 
+// NOTE: label is not part of the sampler state
+template <>
+struct std::hash<lyra::GPUSamplerDescriptor>
+{
+    std::size_t operator()(const lyra::GPUSamplerDescriptor& d) const
+    {
+        std::size_t res = 0;
+        lyra::hash_combine(res, d.address_mode_u);
+        lyra::hash_combine(res, d.address_mode_v);
+        lyra::hash_combine(res, d.address_mode_w);
+        lyra::hash_combine(res, d.mag_filter);
+        lyra::hash_combine(res, d.min_filter);
+        lyra::hash_combine(res, d.mipmap_filter);
+        lyra::hash_combine(res, d.lod_min_clamp);
+        lyra::hash_combine(res, d.lod_max_clamp);
+        lyra::hash_combine(res, d.compare);
+        lyra::hash_combine(res, d.max_anisotropy);
+        lyra::hash_combine(res, d.compare_enable);
+        return res;
+    }
+};
+
+template <>
+struct std::equal_to<lyra::GPUSamplerDescriptor>
+{
+    bool operator()(const lyra::GPUSamplerDescriptor& lhs, const lyra::GPUSamplerDescriptor& rhs) const
+    {
+        return lhs.address_mode_u == rhs.address_mode_u &&
+               lhs.address_mode_v == rhs.address_mode_v &&
+               lhs.address_mode_w == rhs.address_mode_w &&
+               lhs.mag_filter == rhs.mag_filter &&
+               lhs.min_filter == rhs.min_filter &&
+               lhs.mipmap_filter == rhs.mipmap_filter &&
+               lhs.lod_min_clamp == rhs.lod_min_clamp &&
+               lhs.lod_max_clamp == rhs.lod_max_clamp &&
+               lhs.compare == rhs.compare &&
+               lhs.max_anisotropy == rhs.max_anisotropy &&
+               lhs.compare_enable == rhs.compare_enable;
+    }
+};
+
 #endif // LYRA_LIBRARY_RENDER_RHI_HASH_H
@@ -64,6 +64,25 @@ void RHI::end_frame()
     RHI::api()->end_frame();
 }
 
+void RHI::set_frame_pacing(const GPUFramePacing& pacing)
+{
+    RHI::api()->set_frame_pacing(pacing);
+}
+
+GPUFrameTiming RHI::get_frame_timing()
+{
+    GPUFrameTiming timing;
+    RHI::api()->get_frame_timing(timing);
+    return timing;
+}
+
+GPUFrameSlot RHI::get_frame_slot()
+{
+    GPUFrameSlot slot;
+    RHI::api()->get_frame_slot(slot);
+    return slot;
+}
+
 GPUAdapter& RHI::get_current_adapter()
 {
     static GPUAdapter ADAPTER = {};
@@ -200,6 +219,9 @@ GPUQuerySet GPUDevice::create_query_set(const GPUQuerySetDescriptor& desc) const
 {
     GPUQuerySet query;
     RHI::api()->create_query_set(query.handle, desc);
+    query.type       = desc.type;
+    query.count      = desc.count;
+    query.statistics = desc.statistics;
     return query;
 }
 
@@ -285,6 +307,94 @@ GPUCommandBundle GPUDevice::create_command_bundle(const GPUCommandBundleDescript
     return command_bundle;
 }
 
+GPUMemoryPoolStats GPUDevice::get_memory_pool_stats(GPUMemoryPool pool) const
+{
+    GPUMemoryPoolStats stats;
+    RHI::api()->get_memory_pool_stats(pool, stats);
+    return stats;
+}
+
+GPUMemoryStats GPUDevice::get_memory_stats() const
+{
+    GPUMemoryStats stats;
+    RHI::api()->get_memory_stats(stats);
+    return stats;
+}
+
+void GPUDevice::set_memory_budget_callback(float threshold, const GPUMemoryBudgetCallback& callback) const
+{
+    RHI::api()->set_memory_budget_callback(threshold, callback);
+}
+
+GPUCommandStats GPUDevice::get_command_stats() const
+{
+    GPUCommandStats stats;
+    RHI::api()->get_command_stats(stats);
+    return stats;
+}
+
+GPUShaderModuleStats GPUDevice::get_shader_module_stats() const
+{
+    GPUShaderModuleStats stats;
+    RHI::api()->get_shader_module_stats(stats);
+    return stats;
+}
+
+GPUStagingStats GPUDevice::get_staging_stats() const
+{
+    GPUStagingStats stats;
+    RHI::api()->get_staging_stats(stats);
+    return stats;
+}
+
+GPUDefragmentStats GPUDevice::get_defragment_stats() const
+{
+    GPUDefragmentStats stats;
+    RHI::api()->get_defragment_stats(stats);
+    return stats;
+}
+
+void GPUDevice::wait_pipelines() const
+{
+    RHI::api()->wait_pipelines();
+}
+
+GPUTransientAllocation GPUDevice::allocate_transient(GPUSize64 size, GPUSize64 alignment) const
+{
+    GPUTransientAllocation allocation;
+    RHI::api()->allocate_transient(size, alignment, allocation);
+    return allocation;
+}
+
+GPUUploadToken GPUDevice::upload_buffer(const GPUBuffer& buffer, GPUSize64 offset, const void* data, GPUSize64 size) const
+{
+    GPUUploadToken token;
+    RHI::api()->upload_buffer(buffer.handle, offset, data, size, token);
+    return token;
+}
+
+GPUUploadToken GPUDevice::upload_texture(const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size) const
+{
+    GPUUploadToken token;
+    RHI::api()->upload_texture(destination, data, layout, size, token);
+    return token;
+}
+
+void GPUDevice::flush_uploads() const
+{
+    RHI::api()->flush_uploads();
+}
+
+void GPUDevice::flush_submissions() const
+{
+    RHI::api()->flush_submissions();
+}
+
+bool GPUDevice::is_upload_complete(GPUUploadToken token) const
+{
+    return RHI::api()->query_upload(token);
+}
+
 void GPUDevice::wait() const
 {
     RHI::api()->wait_idle();
@@ -295,6 +405,11 @@ void GPUDevice::wait(GPUFence fence) const
     RHI::api()->wait_fence(fence.handle);
 }
 
+void GPUDevice::wait(GPUUploadToken token) const
+{
+    RHI::api()->wait_upload(token);
+}
+
 void GPUDevice::destroy() const
 {
     RHI::api()->delete_device();
@@ -321,6 +436,11 @@ void GPUBuffer::map(GPUMapMode mode, GPUSize64 offset, GPUSize64 size)
     RHI::api()->map_buffer(handle, mode, offset, size);
 }
 
+void GPUBuffer::map_async(GPUMapMode mode, const GPUBufferMapCallback& callback, GPUSize64 offset, GPUSize64 size)
+{
+    RHI::api()->map_buffer_async(handle, mode, offset, size, callback);
+}
+
 void GPUBuffer::unmap()
 {
     RHI::api()->unmap_buffer(handle);
@@ -400,6 +520,49 @@ void GPUSampler::destroy()
 }
 #pragma endregion GPUSampler
 
+#pragma region GPUQuerySet
+void GPUQuerySet::reset(GPUSize32 first_query, GPUSize32 query_count) const
+{
+    RHI::api()->reset_query_set(handle, first_query, query_count);
+}
+
+void GPUQuerySet::destroy()
+{
+    RHI::api()->delete_query_set(handle);
+    handle.reset();
+}
+#pragma endregion GPUQuerySet
+
+#pragma region GPUTlas
+GPUBVHSizes GPUTlas::get_sizes() const
+{
+    GPUBVHSizes sizes = {};
+    RHI::api()->get_tlas_sizes(handle, sizes);
+    return sizes;
+}
+
+void GPUTlas::destroy()
+{
+    RHI::api()->delete_tlas(handle);
+    handle.reset();
+}
+#pragma endregion GPUTlas
+
+#pragma region GPUBlas
+GPUBVHSizes GPUBlas::get_sizes() const
+{
+    GPUBVHSizes sizes = {};
+    RHI::api()->get_blas_sizes(handle, sizes);
+    return sizes;
+}
+
+void GPUBlas::destroy()
+{
+    RHI::api()->delete_blas(handle);
+    handle.reset();
+}
+#pragma endregion GPUBlas
+
 #pragma region GPUFence
 void GPUFence::wait() const
 {
@@ -414,6 +577,13 @@ void GPUFence::destroy()
 #pragma endregion GPUFence
 
 #pragma region GPUShaderModule
+GPUSize64 GPUShaderModule::get_hash() const
+{
+    GPUSize64 hash = 0;
+    RHI::api()->get_shader_module_hash(handle, hash);
+    return hash;
+}
+
 void GPUShaderModule::destroy()
 {
     RHI::api()->delete_shader_module(handle);
@@ -438,6 +608,13 @@ void GPUPipelineLayout::destroy()
 #pragma endregion GPUPipelineLayout
 
 #pragma region GPURenderPipeline
+GPUPipelineStatus GPURenderPipeline::get_status() const
+{
+    GPUPipelineStatus status = GPUPipelineStatus::READY;
+    RHI::api()->get_render_pipeline_status(handle, status);
+    return status;
+}
+
 void GPURenderPipeline::destroy()
 {
     RHI::api()->delete_render_pipeline(handle);
@@ -446,6 +623,13 @@ void GPURenderPipeline::destroy()
 #pragma endregion GPURenderPipeline
 
 #pragma region GPUComputePipeline
+GPUPipelineStatus GPUComputePipeline::get_status() const
+{
+    GPUPipelineStatus status = GPUPipelineStatus::READY;
+    RHI::api()->get_compute_pipeline_status(handle, status);
+    return status;
+}
+
 void GPUComputePipeline::destroy()
 {
     RHI::api()->delete_compute_pipeline(handle);
@@ -487,6 +671,11 @@ void GPUCommandEncoder::signal(const GPUFence& fence, GPUBarrierSyncFlags sync)
     RHI::api()->cmd_signal_fence(handle, fence.handle, sync);
 }
 
+void GPUCommandEncoder::wait(GPUUploadToken token, GPUBarrierSyncFlags sync) const
+{
+    RHI::api()->cmd_wait_upload(handle, token, sync);
+}
+
 void GPUCommandEncoder::set_pipeline(const GPURenderPipeline& pipeline) const
 {
     RHI::api()->cmd_set_render_pipeline(handle, pipeline.handle);
@@ -552,6 +741,16 @@ void GPUCommandEncoder::draw_indexed_indirect(const GPUBuffer& indirect_buffer,
     RHI::api()->cmd_draw_indexed_indirect(handle, indirect_buffer.handle, indirect_offset, draw_count);
 }
 
+void GPUCommandEncoder::draw_indirect_count(const GPUBuffer& indirect_buffer, GPUSize64 indirect_offset, const GPUBuffer& count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count) const
+{
+    RHI::api()->cmd_draw_indirect_count(handle, indirect_buffer.handle, indirect_offset, count_buffer.handle, count_offset, max_draw_count);
+}
+
+void GPUCommandEncoder::draw_indexed_indirect_count(const GPUBuffer& indirect_buffer, GPUSize64 indirect_offset, const GPUBuffer& count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count) const
+{
+    RHI::api()->cmd_draw_indexed_indirect_count(handle, indirect_buffer.handle, indirect_offset, count_buffer.handle, count_offset, max_draw_count);
+}
+
 void GPUCommandEncoder::begin_render_pass(const GPURenderPassDescriptor& descriptor) const
 {
     RHI::api()->cmd_begin_render_pass(handle, descriptor);
@@ -572,6 +771,11 @@ void GPUCommandEncoder::copy_buffer_to_buffer(const GPUBuffer& source, GPUSize64
     RHI::api()->cmd_copy_buffer_to_buffer(handle, source, source_offset, destination, destination_offset, size);
 }
 
+void GPUCommandEncoder::update_buffer(const GPUBuffer& buffer, GPUSize64 offset, const void* data, GPUSize64 size) const
+{
+    RHI::api()->cmd_update_buffer(handle, buffer, offset, data, size);
+}
+
 void GPUCommandEncoder::copy_buffer_to_texture(const GPUTexelCopyBufferInfo& source, const GPUTexelCopyTextureInfo& destination, const GPUExtent3D& copy_size) const
 {
     RHI::api()->cmd_copy_buffer_to_texture(handle, source, destination, copy_size);
@@ -627,6 +831,16 @@ void GPUCommandEncoder::write_timestamp(const GPUQuerySet& query_set, GPUSize32
     RHI::api()->cmd_write_timestamp(handle, query_set, query_index);
 }
 
+void GPUCommandEncoder::begin_pipeline_statistics_query(const GPUQuerySet& query_set, GPUSize32 query_index) const
+{
+    RHI::api()->cmd_begin_pipeline_statistics_query(handle, query_set, query_index);
+}
+
+void GPUCommandEncoder::end_pipeline_statistics_query(const GPUQuerySet& query_set, GPUSize32 query_index) const
+{
+    RHI::api()->cmd_end_pipeline_statistics_query(handle, query_set, query_index);
+}
+
 void GPUCommandEncoder::write_blas_properties(const GPUQuerySet& query_set, GPUSize32 query_index, const GPUBlas& blas) const
 {
     RHI::api()->cmd_write_blas_properties(handle, query_set, query_index, blas);
@@ -656,11 +870,63 @@ void GPUCommandEncoder::resource_barrier(const Vector<GPUTextureBarrier>& barrie
 {
     RHI::api()->cmd_texture_barrier(handle, barriers);
 }
+
+void GPUCommandEncoder::resource_barrier(GPUMemoryBarrier barrier) const
+{
+    RHI::api()->cmd_memory_barrier(handle, barrier);
+}
+
+void GPUCommandEncoder::resource_barrier(const Vector<GPUMemoryBarrier>& barriers) const
+{
+    RHI::api()->cmd_memory_barrier(handle, barriers);
+}
+
+void GPUCommandEncoder::update_tlas_instances(const GPUTlas& tlas, const Vector<GPUTlasInstanceUpdate>& updates) const
+{
+    RHI::api()->cmd_update_tlas_instances(handle, tlas, updates);
+}
+
+void GPUCommandEncoder::build_tlases(const GPUBuffer& scratch_buffer, const Vector<GPUTlasBuildEntry>& entries) const
+{
+    RHI::api()->cmd_build_tlases(handle, scratch_buffer, entries);
+}
+
+void GPUCommandEncoder::build_blases(const GPUBuffer& scratch_buffer, const Vector<GPUBlasBuildEntry>& entries) const
+{
+    RHI::api()->cmd_build_blases(handle, scratch_buffer, entries);
+}
+
+void GPUCommandEncoder::copy_blas(const GPUBlas& source, const GPUBlas& destination) const
+{
+    RHI::api()->cmd_copy_blas(handle, source, destination);
+}
+
+void GPUCommandEncoder::defragment_memory(const GPUDefragmentDescriptor& descriptor) const
+{
+    RHI::api()->cmd_defragment_memory(handle, descriptor);
+}
 #pragma endregion GPUCommandEncoder
 
+#pragma region GPUCommandBundle
+void GPUCommandBundle::finish() const
+{
+    RHI::api()->finish_command_bundle(handle);
+}
+#pragma endregion GPUCommandBundle
+
 #pragma region GPUCommandBuffer
 void GPUCommandBuffer::submit() const
 {
     RHI::api()->submit_command_buffer(handle);
 }
+
+void GPUCommandBuffer::execute_bundles(const Vector<GPUCommandBundle>& bundles) const
+{
+    Vector<GPUCommandEncoderHandle> handles;
+    handles.reserve(bundles.size());
+    for (auto& bundle : bundles)
+        handles.push_back(bundle.handle);
+
+    RHI::api()->cmd_execute_bundles(handle, handles);
+}
 #pragma endregion GPUCommandBuffer
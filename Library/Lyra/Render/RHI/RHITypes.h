@@ -62,6 +62,10 @@ namespace lyra
 
         FORCE_INLINE bool valid() const { return handle.valid(); }
 
+        // NOTE: Non-WebGPU standard API
+        // content hash of the shader blob, identical blobs share the same module and hash
+        auto get_hash() const -> GPUSize64;
+
         void destroy();
     };
 
@@ -133,6 +137,9 @@ namespace lyra
 
         void map(GPUMapMode mode, GPUSize64 offset = 0, GPUSize64 size = 0);
 
+        // mapped after all GPU work submitted up to the current frame completes, the state is PENDING until then
+        void map_async(GPUMapMode mode, const GPUBufferMapCallback& callback, GPUSize64 offset = 0, GPUSize64 size = 0);
+
         void unmap();
 
         void destroy();
@@ -142,14 +149,19 @@ namespace lyra
     {
         GPUQuerySetHandle handle;
 
-        GPUQueryType type;
-        GPUSize32    count;
+        GPUQueryType           type;
+        GPUSize32              count;
+        GPUQueryStatisticFlags statistics;
 
         // implicit conversion
         FORCE_INLINE operator GPUQuerySetHandle() const { return handle; }
 
         FORCE_INLINE bool valid() const { return handle.valid(); }
 
+        // NOTE: Non-WebGPU standard API
+        // queries must be reset on host before they are written again (no-op for backends without this requirement)
+        auto reset(GPUSize32 first_query, GPUSize32 query_count) const -> void;
+
         auto destroy() -> void;
     };
 
@@ -164,6 +176,8 @@ namespace lyra
 
         FORCE_INLINE bool valid() const { return handle.valid(); }
 
+        auto get_sizes() const -> GPUBVHSizes;
+
         auto destroy() -> void;
     };
 
@@ -178,6 +192,8 @@ namespace lyra
 
         FORCE_INLINE bool valid() const { return handle.valid(); }
 
+        auto get_sizes() const -> GPUBVHSizes;
+
         auto destroy() -> void;
     };
 
@@ -235,6 +251,10 @@ namespace lyra
 
         FORCE_INLINE bool valid() const { return handle.valid(); }
 
+        // NOTE: Non-WebGPU standard API
+        // asynchronous pipelines become ready at the start of a frame after compilation finishes
+        auto get_status() const -> GPUPipelineStatus;
+
         void destroy();
     };
 
@@ -249,6 +269,10 @@ namespace lyra
 
         FORCE_INLINE bool valid() const { return handle.valid(); }
 
+        // NOTE: Non-WebGPU standard API
+        // asynchronous pipelines become ready at the start of a frame after compilation finishes
+        auto get_status() const -> GPUPipelineStatus;
+
         void destroy();
     };
 
@@ -287,6 +311,8 @@ namespace lyra
 
         void signal(const GPUFence& fence, GPUBarrierSyncFlags sync) const;
 
+        void wait(GPUUploadToken token, GPUBarrierSyncFlags sync) const;
+
         void set_pipeline(const GPURenderPipeline& pipeline) const;
 
         void set_pipeline(const GPUComputePipeline& pipeline) const;
@@ -319,6 +345,14 @@ namespace lyra
 
         void draw_indexed_indirect(const GPUBuffer& indirect_buffer, GPUSize64 indirect_offset, GPUSize32 draw_count) const;
 
+        // NOTE: Non-WebGPU standard API
+        // draw count is read from count_buffer on GPU (clamped to max_draw_count)
+        void draw_indirect_count(const GPUBuffer& indirect_buffer, GPUSize64 indirect_offset, const GPUBuffer& count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count) const;
+
+        // NOTE: Non-WebGPU standard API
+        // draw count is read from count_buffer on GPU (clamped to max_draw_count)
+        void draw_indexed_indirect_count(const GPUBuffer& indirect_buffer, GPUSize64 indirect_offset, const GPUBuffer& count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count) const;
+
         void begin_render_pass(const GPURenderPassDescriptor& descriptor) const;
 
         void end_render_pass() const;
@@ -327,6 +361,17 @@ namespace lyra
 
         void copy_buffer_to_buffer(const GPUBuffer& source, GPUSize64 source_offset, const GPUBuffer& destination, GPUSize64 destination_offset, GPUSize64 size) const;
 
+        // NOTE: Non-WebGPU standard API
+        // data is copied into recycled staging memory right away, the buffer is written when the command executes.
+        // must be recorded outside of render passes.
+        void update_buffer(const GPUBuffer& buffer, GPUSize64 offset, const void* data, GPUSize64 size) const;
+
+        template <typename T>
+        void update_buffer(const GPUBuffer& buffer, GPUSize64 offset, const T& value) const
+        {
+            update_buffer(buffer, offset, &value, sizeof(T));
+        }
+
         void copy_buffer_to_texture(const GPUTexelCopyBufferInfo& source, const GPUTexelCopyTextureInfo& destination, const GPUExtent3D& copy_size) const;
 
         void copy_texture_to_buffer(const GPUTexelCopyTextureInfo& source, const GPUTexelCopyBufferInfo& destination, const GPUExtent3D& copy_size) const;
@@ -349,6 +394,15 @@ namespace lyra
 
         void write_timestamp(const GPUQuerySet& query_set, GPUSize32 query_index) const;
 
+        // NOTE: Non-WebGPU standard API
+        // at most one pipeline statistics query may be active per command buffer, begun and ended outside of render passes.
+        // the query ends early before executing bundles, and before deferred render passes when secondary
+        // command buffers cannot inherit it (Vulkan without inheritedQueries), later commands are not counted.
+        void begin_pipeline_statistics_query(const GPUQuerySet& query_set, GPUSize32 query_index) const;
+
+        // NOTE: Non-WebGPU standard API
+        void end_pipeline_statistics_query(const GPUQuerySet& query_set, GPUSize32 query_index) const;
+
         void write_blas_properties(const GPUQuerySet& query_set, GPUSize32 query_index, const GPUBlas& blas) const;
 
         void resolve_query_set(GPUQuerySet query_set, GPUSize32 first_query, GPUSize32 query_count, const GPUBuffer& destination, GPUSize64 destination_offset) const;
@@ -360,6 +414,34 @@ namespace lyra
         void resource_barrier(const Vector<GPUBufferBarrier>& barriers) const;
 
         void resource_barrier(const Vector<GPUTextureBarrier>& barriers) const;
+
+        // NOTE: Non-WebGPU standard API
+        void resource_barrier(GPUMemoryBarrier barrier) const;
+
+        // NOTE: Non-WebGPU standard API
+        void resource_barrier(const Vector<GPUMemoryBarrier>& barriers) const;
+
+        // NOTE: Non-WebGPU standard API
+        // writes individual instance records of a tlas, later builds of the tlas pick them up
+        void update_tlas_instances(const GPUTlas& tlas, const Vector<GPUTlasInstanceUpdate>& updates) const;
+
+        // NOTE: Non-WebGPU standard API
+        // builds share the scratch buffer, which must hold the build (or update) scratch size of every entry
+        void build_tlases(const GPUBuffer& scratch_buffer, const Vector<GPUTlasBuildEntry>& entries) const;
+
+        // NOTE: Non-WebGPU standard API
+        // builds share the scratch buffer, which must hold the build (or update) scratch size of every entry
+        void build_blases(const GPUBuffer& scratch_buffer, const Vector<GPUBlasBuildEntry>& entries) const;
+
+        // NOTE: Non-WebGPU standard API
+        // compacts the source when it is built with ALLOW_COMPACTION, otherwise clones it
+        void copy_blas(const GPUBlas& source, const GPUBlas& destination) const;
+
+        // NOTE: Non-WebGPU standard API
+        // runs one incremental defragmentation pass, moved resources keep their handles.
+        // must be recorded while no other command buffer or bundle of the frame is open (created and not submitted),
+        // resources referenced by bind groups created earlier in the frame are not moved.
+        void defragment_memory(const GPUDefragmentDescriptor& descriptor) const;
     };
 
     struct GPUCommandBundle : public GPUCommandEncoder
@@ -370,6 +452,9 @@ namespace lyra
         FORCE_INLINE operator GPUCommandEncoderHandle() const { return handle; }
 
         FORCE_INLINE bool valid() const { return handle.valid(); }
+
+        // must be called on the recording thread, before the bundle is executed
+        void finish() const;
     };
 
     struct GPUCommandBuffer : public GPUCommandEncoder
@@ -438,10 +523,50 @@ namespace lyra
 
         auto create_command_bundle(const GPUCommandBundleDescriptor& descriptor) const -> GPUCommandBundle;
 
+        auto get_memory_pool_stats(GPUMemoryPool pool) const -> GPUMemoryPoolStats;
+
+        auto get_memory_stats() const -> GPUMemoryStats;
+
+        // budgets are checked at the end of every frame, callback fires once per heap crossing threshold * budget
+        auto set_memory_budget_callback(float threshold, const GPUMemoryBudgetCallback& callback) const -> void;
+
+        // cumulative over all command buffers finished so far
+        auto get_command_stats() const -> GPUCommandStats;
+
+        // identical shader blobs share one shader module
+        auto get_shader_module_stats() const -> GPUShaderModuleStats;
+
+        // staging allocations created and avoided by inline buffer updates during the last recorded frame
+        auto get_staging_stats() const -> GPUStagingStats;
+
+        // progress and fragmentation of the defragmentation passes recorded so far
+        auto get_defragment_stats() const -> GPUDefragmentStats;
+
+        // blocks until all asynchronous pipelines are compiled, must not overlap with command recording
+        auto wait_pipelines() const -> void;
+
+        // transient allocations are only valid until the current frame completes on GPU
+        auto allocate_transient(GPUSize64 size, GPUSize64 alignment = 256) const -> GPUTransientAllocation;
+
+        // uploads are recorded onto the transfer queue, and submitted on flush or at the end of frame
+        auto upload_buffer(const GPUBuffer& buffer, GPUSize64 offset, const void* data, GPUSize64 size) const -> GPUUploadToken;
+
+        auto upload_texture(const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size) const -> GPUUploadToken;
+
+        auto flush_uploads() const -> void;
+
+        // NOTE: Non-WebGPU standard API
+        // submitted command buffers are batched until the end of frame, flushing submits them right away
+        auto flush_submissions() const -> void;
+
+        auto is_upload_complete(GPUUploadToken token) const -> bool;
+
         auto wait() const -> void;
 
         auto wait(GPUFence fence) const -> void;
 
+        auto wait(GPUUploadToken token) const -> void;
+
         auto destroy() const -> void;
     };
 
@@ -495,6 +620,15 @@ namespace lyra
 
         static void end_frame();
 
+        // NOTE: Non-WebGPU standard API
+        static void set_frame_pacing(const GPUFramePacing& pacing);
+
+        // NOTE: Non-WebGPU standard API
+        static auto get_frame_timing() -> GPUFrameTiming;
+
+        // NOTE: Non-WebGPU standard API
+        static auto get_frame_slot() -> GPUFrameSlot;
+
         auto destroy() const -> void;
 
         auto request_adapter(const GPUAdapterDescriptor& descriptor = {}) const -> GPUAdapter;
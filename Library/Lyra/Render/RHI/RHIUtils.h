@@ -7,6 +7,7 @@
 #include <Lyra/Common/Assert.h>
 #include <Lyra/Common/String.h>
 #include <Lyra/Common/Handle.h>
+#include <Lyra/Common/Function.h>
 #include <Lyra/Common/BitFlags.h>
 #include <Lyra/Render/RHI/RHIEnums.h>
 
@@ -57,6 +58,7 @@ namespace lyra
     using GPUBVHFlags              = BitFlags<GPUBVHFlag>;
     using GPUBVHGeometryFlags      = BitFlags<GPUBVHGeometryFlag>;
     using GPUTextureAspectFlags    = BitFlags<GPUTextureAspect>;
+    using GPUQueryStatisticFlags   = BitFlags<GPUQueryStatistic>;
 
     template <GPUObjectType E>
     using GPUHandle = TypedEnumHandle<GPUObjectType, E>;
@@ -87,6 +89,9 @@ namespace lyra
     struct GPUTlasInstance;
     using GPUTlasInstances = TypedView<GPUTlasInstance>;
 
+    struct GPUTlasInstanceUpdate;
+    using GPUTlasInstanceUpdates = TypedView<GPUTlasInstanceUpdate>;
+
     struct GPUBlasTriangleGeometry;
     using GPUBlasTriangleGeometries = TypedView<GPUBlasTriangleGeometry>;
 
@@ -140,6 +145,8 @@ namespace lyra
 
     using GPUBufferDynamicOffsets = TypedView<GPUBufferDynamicOffset>;
 
+    using GPUCommandEncoderHandles = TypedView<GPUCommandEncoderHandle>;
+
     struct MappedBufferRange
     {
         BufferSource data;
@@ -250,9 +257,10 @@ namespace lyra
 
     struct GPUProperties
     {
-        uint subgroup_max_size           = 0;
-        uint subgroup_min_size           = 0;
-        uint texture_row_pitch_alignment = 0;
+        uint  subgroup_max_size           = 0;
+        uint  subgroup_min_size           = 0;
+        uint  texture_row_pitch_alignment = 0;
+        float timestamp_period            = 0.0f; // nanoseconds per timestamp tick
     };
 
     struct GPUAdapterInfo
@@ -271,6 +279,237 @@ namespace lyra
         GPUProperties        properties = {};
     };
 
+    // NOTE: Non-WebGPU standard API
+    struct GPUMemoryPoolStats
+    {
+        GPUSize64 block_count          = 0; // number of device memory blocks owned by the pool
+        GPUSize64 block_bytes          = 0; // total bytes of all blocks
+        GPUSize64 allocation_count     = 0; // number of live sub-allocations
+        GPUSize64 allocation_bytes     = 0; // total bytes of all sub-allocations
+        GPUSize64 unused_range_count   = 0; // number of free ranges between sub-allocations
+        GPUSize64 largest_unused_range = 0; // largest free range (in bytes)
+        float     utilization          = 0.0f; // allocation_bytes / block_bytes
+        float     fragmentation        = 0.0f; // 1 - largest_unused_range / unused bytes
+    };
+
+    // NOTE: Non-WebGPU standard API
+    struct GPUMemoryHeapStats
+    {
+        bool      device_local         = false;
+        GPUSize64 budget               = 0; // bytes this process can use before over-subscribing the heap
+        GPUSize64 usage                = 0; // bytes used by this process (including memory outside the engine)
+        GPUSize64 block_count          = 0; // number of device memory blocks allocated by the engine
+        GPUSize64 block_bytes          = 0; // total bytes of all blocks
+        GPUSize64 allocation_count     = 0; // number of live allocations
+        GPUSize64 allocation_bytes     = 0; // total bytes of all allocations
+        GPUSize64 largest_unused_range = 0; // largest free range inside the blocks (in bytes)
+    };
+
+    // NOTE: Non-WebGPU standard API
+    struct GPUMemoryStats
+    {
+        Vector<GPUMemoryHeapStats> heaps = {};
+
+        // live objects per resource type
+        uint buffer_count    = 0;
+        uint texture_count   = 0;
+        uint view_count      = 0;
+        uint sampler_count   = 0;
+        uint shader_count    = 0;
+        uint pipeline_count  = 0;
+        uint blas_count      = 0;
+        uint tlas_count      = 0;
+        uint query_set_count = 0;
+
+        GPUSize64 largest_unused_range = 0; // largest free range across all heaps
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // progress of incremental defragmentation, memory is measured over all blocks of the allocator
+    struct GPUDefragmentStats
+    {
+        uint               passes       = 0;  // completed passes
+        uint               moves        = 0;  // buffers and textures moved
+        uint               skipped      = 0;  // moves rejected, resources which cannot move
+        uint               abandoned    = 0;  // moves beyond the time budget, not retried until the pool is defragmented again
+        GPUSize64          bytes_moved  = 0;
+        GPUSize64          bytes_freed  = 0;
+        uint               blocks_freed = 0;
+        float              pass_ms      = 0.0f; // host time of the last pass
+        GPUMemoryPoolStats before       = {};   // memory before the last pass
+        GPUMemoryPoolStats after        = {};   // memory after the last pass
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // invoked with the heap index whenever heap usage rises above the budget threshold
+    using GPUMemoryBudgetCallback = Function<void(uint heap, const GPUMemoryHeapStats& stats)>;
+
+    // NOTE: Non-WebGPU standard API (WebGPU returns a promise instead)
+    // invoked once the buffer is mapped, or with success = false when the request is aborted by unmap/destroy
+    using GPUBufferMapCallback = Function<void(GPUBufferHandle buffer, bool success)>;
+
+    // NOTE: Non-WebGPU standard API
+    // state commands issued through command encoders, and how many were dropped as redundant
+    struct GPUCommandStats
+    {
+        GPUSize64 state_commands         = 0; // state setting commands issued by the user
+        GPUSize64 dropped_pipelines      = 0;
+        GPUSize64 dropped_bind_groups    = 0;
+        GPUSize64 dropped_vertex_buffers = 0;
+        GPUSize64 dropped_index_buffers  = 0;
+        GPUSize64 dropped_viewports      = 0;
+        GPUSize64 dropped_scissors       = 0;
+        GPUSize64 dropped_push_constants = 0;
+        GPUSize64 merged_vertex_buffers  = 0; // vertex buffer binds folded into a neighbouring slot's bind
+        GPUSize64 skipped_actions        = 0; // draws and dispatches skipped while the bound pipeline compiles
+        GPUSize64 submissions            = 0; // command buffers submitted
+        GPUSize64 queue_submits          = 0; // queue submit calls after coalescing submissions
+        GPUSize64 tracked_barriers       = 0; // barriers inserted by tracked command buffers while recording
+        GPUSize64 prologue_barriers      = 0; // barriers patched in at submission, against the states left by previous submissions
+
+        auto dropped() const -> GPUSize64
+        {
+            return dropped_pipelines + dropped_bind_groups + dropped_vertex_buffers + dropped_index_buffers +
+                   dropped_viewports + dropped_scissors + dropped_push_constants;
+        }
+
+        auto operator+=(const GPUCommandStats& other) -> GPUCommandStats&
+        {
+            state_commands += other.state_commands;
+            dropped_pipelines += other.dropped_pipelines;
+            dropped_bind_groups += other.dropped_bind_groups;
+            dropped_vertex_buffers += other.dropped_vertex_buffers;
+            dropped_index_buffers += other.dropped_index_buffers;
+            dropped_viewports += other.dropped_viewports;
+            dropped_scissors += other.dropped_scissors;
+            dropped_push_constants += other.dropped_push_constants;
+            merged_vertex_buffers += other.merged_vertex_buffers;
+            skipped_actions += other.skipped_actions;
+            submissions += other.submissions;
+            queue_submits += other.queue_submits;
+            tracked_barriers += other.tracked_barriers;
+            prologue_barriers += other.prologue_barriers;
+            return *this;
+        }
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // shader modules requested by the user versus unique shader blobs actually created
+    struct GPUShaderModuleStats
+    {
+        uint      module_count = 0; // live shader module references (a shared module counts once per reference)
+        uint      unique_count = 0; // unique shader blobs
+        GPUSize64 cache_hits   = 0; // create_shader_module() calls served by an existing blob
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // staging buffers behind inline buffer updates, counted over the last recorded frame
+    // (the one before the frame being recorded, its GPU work may still be in flight)
+    struct GPUStagingStats
+    {
+        uint      allocations    = 0; // staging buffers created
+        uint      reuses         = 0; // staging buffers recycled from previous frames (allocations avoided)
+        uint      pooled_buffers = 0; // staging buffers owned by the pool, in use or free
+        GPUSize64 pooled_bytes   = 0;
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // frame pacing, takes effect from the next new_frame()
+    struct GPUFramePacing
+    {
+        uint frames      = 0;     // frames in flight, 0 to use all frame slots (clamped to the available slots)
+        bool low_latency = false; // delay the CPU frame start until just before the GPU needs the frame
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // frame slot of the current frame, its previous use has completed on GPU once new_frame() returns.
+    // per-frame resources indexed by the slot are therefore safe to reuse, whatever the frame pacing.
+    struct GPUFrameSlot
+    {
+        uint frame = 0; // index of the current frame, increased by end_frame()
+        uint index = 0; // frame % count
+        uint count = 1; // number of frame slots
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // frame measurements (in milliseconds), GPU measurements lag behind by the frames in flight
+    struct GPUFrameTiming
+    {
+        uint  frame         = 0;    // frame index of the GPU measurements
+        uint  frames        = 0;    // frames in flight in effect
+        float cpu_wait      = 0.0f; // time the last new_frame() blocked, including the latency sleep
+        float latency_sleep = 0.0f; // part of cpu_wait added by the low latency mode
+        float cpu_time      = 0.0f; // time from new_frame() to end_frame()
+        float gpu_time      = 0.0f; // time from the first graphics command buffer starting to the frame completing
+        float gpu_idle      = 0.0f; // time the graphics queue was idle before the frame started
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // argument layout of draw_indirect and draw_indirect_count
+    struct GPUDrawIndirectArgs
+    {
+        GPUSize32 vertex_count   = 0;
+        GPUSize32 instance_count = 0;
+        GPUSize32 first_vertex   = 0;
+        GPUSize32 first_instance = 0;
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // argument layout of draw_indexed_indirect and draw_indexed_indirect_count
+    struct GPUDrawIndexedIndirectArgs
+    {
+        GPUSize32         index_count    = 0;
+        GPUSize32         instance_count = 0;
+        GPUSize32         first_index    = 0;
+        GPUSignedOffset32 base_vertex    = 0;
+        GPUSize32         first_instance = 0;
+    };
+
+    // NOTE: Non-WebGPU standard API
+    // resolved pipeline statistics query, counters not requested by the query set stay zero
+    struct GPUPipelineStatistics
+    {
+        GPUSize64 input_vertices       = 0; // vertices fetched by the input assembler
+        GPUSize64 input_primitives     = 0; // primitives assembled by the input assembler
+        GPUSize64 vertex_invocations   = 0; // vertex shader invocations
+        GPUSize64 clipping_invocations = 0; // primitives reaching the clipping stage
+        GPUSize64 clipping_primitives  = 0; // primitives surviving clipping
+        GPUSize64 fragment_invocations = 0; // fragment shader invocations
+        GPUSize64 compute_invocations  = 0; // compute shader invocations
+
+        auto operator+=(const GPUPipelineStatistics& other) -> GPUPipelineStatistics&
+        {
+            input_vertices += other.input_vertices;
+            input_primitives += other.input_primitives;
+            vertex_invocations += other.vertex_invocations;
+            clipping_invocations += other.clipping_invocations;
+            clipping_primitives += other.clipping_primitives;
+            fragment_invocations += other.fragment_invocations;
+            compute_invocations += other.compute_invocations;
+            return *this;
+        }
+    };
+
+    // NOTE: Non-WebGPU standard API
+    struct GPUTransientAllocation
+    {
+        GPUBufferHandle buffer;           // persistently mapped ring buffer of the current frame
+        GPUSize64       offset = 0;       // byte offset of this allocation within the buffer
+        GPUSize64       size   = 0;       // size of this allocation in bytes
+        BufferSource    data   = nullptr; // mapped pointer to the start of this allocation
+
+        template <typename T>
+        auto as() const -> T* { return reinterpret_cast<T*>(data); }
+    };
+
+    // NOTE: Non-WebGPU standard API
+    struct GPUUploadToken
+    {
+        uint64_t value = 0ull; // timeline value signaled once the upload lands on GPU
+
+        bool valid() const { return value != 0ull; }
+    };
+
     struct GPUColor
     {
         float r = 0.0f;
@@ -368,7 +607,7 @@ namespace lyra
         GPUVertexFormat     vertex_format;
         GPUIndexFormat      index_format;
         uint                vertex_count;
-        uint                index_count;
+        uint                index_count; // 0 for geometry without an index buffer
         GPUBVHGeometryFlags flags;
     };
 
@@ -425,10 +664,24 @@ namespace lyra
         GPUBlasHandle blas;
     };
 
+    // NOTE: Non-WebGPU standard API
+    // instance record written into the persistent instance buffer of a tlas
+    struct GPUTlasInstanceUpdate
+    {
+        uint            index;
+        GPUTlasInstance instance;
+    };
+
+    // NOTE: instances replace all instance records of the tlas, when empty the tlas is built
+    // from the first instance_count records written by update_tlas_instances instead.
+    // A built tlas is refitted when it prefers updates and its instance count is unchanged,
+    // unless rebuild is set (e.g. the instances were replaced).
     struct GPUTlasBuildEntry
     {
         GPUTlasHandle    tlas;
         GPUTlasInstances instances;
+        uint             instance_count = 0;
+        bool             rebuild        = false;
     };
 
     struct GPUBlendComponent
@@ -49,7 +49,9 @@ void FrameGraph::execute(FrameGraphContext* context, FrameGraphAllocator* alloca
         }
 
         // execute pass callback
+        if (context->statistics) context->statistics->begin_pass(context->cmdlist, pass.entry->name.c_str());
         std::invoke(pass.entry->callback, registry, context);
+        if (context->statistics) context->statistics->end_pass(context->cmdlist);
 
         // delete resources
         for (auto& rsid : pass.deletes) {
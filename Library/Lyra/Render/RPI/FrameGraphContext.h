@@ -4,14 +4,16 @@
 #define LYRA_LIBRARY_FRAME_GRAPH_CONTEXT_H
 
 #include <Lyra/Render/RHI/RHITypes.h>
+#include <Lyra/Render/RPI/GPUPassStatistics.h>
 
 namespace lyra
 {
     struct FrameGraphContext
     {
-        GPUDevice        device;
-        GPUSurface       surface;
-        GPUCommandBuffer cmdlist;
+        GPUDevice          device;
+        GPUSurface         surface;
+        GPUCommandBuffer   cmdlist;
+        GPUPassStatistics* statistics = nullptr; // optional, pipeline statistics per pass
     };
 
 } // namespace lyra
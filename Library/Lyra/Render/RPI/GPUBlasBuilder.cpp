@@ -0,0 +1,311 @@
+#include <cstring>
+#include <algorithm>
+#include <Lyra/Render/RPI/GPUBlasBuilder.h>
+
+using namespace lyra;
+
+GPUBlasBuilder::GPUBlasBuilder(const GPUBlasBuilderDescriptor& descriptor)
+    : descriptor(descriptor), readbacks(GPUReadbackPoolDescriptor{})
+{
+    auto& device = RHI::get_current_device();
+
+    queries = execute([&]() {
+        auto desc  = GPUQuerySetDescriptor{};
+        desc.label = "blas_compaction_queries";
+        desc.type  = GPUQueryType::BLAS_PROPERTIES;
+        desc.count = descriptor.max_queries;
+        return device.create_query_set(desc);
+    });
+
+    resolve = execute([&]() {
+        auto desc  = GPUBufferDescriptor{};
+        desc.label = "blas_compaction_sizes";
+        desc.size  = sizeof(uint64_t) * descriptor.max_queries;
+        desc.usage = GPUBufferUsage::QUERY_RESOLVE | GPUBufferUsage::COPY_DST | GPUBufferUsage::COPY_SRC;
+        return device.create_buffer(desc);
+    });
+
+    // queries are handed out from the back, lowest index first
+    for (uint i = descriptor.max_queries; i > 0; i--)
+        free_queries.push_back(i - 1);
+}
+
+GPUBlasBuilder::~GPUBlasBuilder()
+{
+    for (auto& entry : entries)
+        if (entry.blas.valid())
+            entry.blas.destroy();
+
+    if (scratch.valid()) scratch.destroy();
+    if (resolve.valid()) resolve.destroy();
+    if (queries.valid()) queries.destroy();
+}
+
+auto GPUBlasBuilder::add(const GPUBlasDescriptor& descriptor, const Vector<GPUBlasTriangleGeometry>& geometries) -> uint
+{
+    Vector<GPUBlasGeometrySizeDescriptor> sizes(geometries.size());
+    for (uint i = 0; i < geometries.size(); i++) {
+        sizes.at(i).type      = GPUBlasType::TRIANGLE;
+        sizes.at(i).triangles = geometries.at(i).size;
+    }
+
+    // storage is allocated up front, scratch memory only when the blas is built
+    auto entry       = Entry{};
+    entry.descriptor = descriptor;
+    entry.geometries = geometries;
+    entry.blas       = RHI::get_current_device().create_blas(descriptor, sizes);
+
+    auto bvh_sizes = entry.blas.get_sizes();
+    entry.size     = bvh_sizes.bvh_size;
+    entry.scratch  = bvh_sizes.build_size;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back(entry);
+    return static_cast<uint>(entries.size() - 1);
+}
+
+void GPUBlasBuilder::remove(uint index)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& entry = entries.at(index);
+    if (entry.state == EntryState::REMOVED)
+        return;
+
+    // built blas are counted as resident from their build on
+    if (entry.state != EntryState::QUEUED)
+        stats.resident_size -= entry.size;
+
+    // a pending query returns its slot once read back
+    entry.blas.destroy();
+    entry.geometries.clear();
+    entry.state = EntryState::REMOVED;
+}
+
+auto GPUBlasBuilder::get(uint index) const -> GPUBlas
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& entry = entries.at(index);
+    if (entry.state == EntryState::QUEUED || entry.state == EntryState::REMOVED)
+        return GPUBlas{};
+    return entry.blas;
+}
+
+void GPUBlasBuilder::update(const GPUCommandBuffer& command)
+{
+    auto requests = Vector<Query>{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        compact(command);
+        build(command);
+        requests = query(command);
+    }
+
+    if (requests.empty())
+        return;
+
+    // read back all sizes queried by this update with a single copy
+    uint first = requests.front().second;
+    uint last  = requests.front().second;
+    for (auto& request : requests) {
+        first = std::min(first, request.second);
+        last  = std::max(last, request.second);
+    }
+
+    // the readback copy reads the query results resolved by query()
+    auto barrier       = GPUMemoryBarrier{};
+    barrier.src_sync   = GPUBarrierSync::COPY;
+    barrier.dst_sync   = GPUBarrierSync::COPY;
+    barrier.src_access = GPUBarrierAccess::COPY_DEST;
+    barrier.dst_access = GPUBarrierAccess::COPY_SOURCE;
+    command.resource_barrier(barrier);
+
+    auto offset = GPUSize64(sizeof(uint64_t)) * first;
+    auto size   = GPUSize64(sizeof(uint64_t)) * (last - first + 1);
+    readbacks.read_buffer(command, resolve, offset, size, [this, requests, first](const uint8_t* data, GPUSize64) {
+        receive(requests, first, data);
+    });
+}
+
+auto GPUBlasBuilder::pending() const -> uint
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<uint>(std::count_if(entries.begin(), entries.end(), [](const Entry& entry) {
+        return entry.state != EntryState::DONE && entry.state != EntryState::REMOVED;
+    }));
+}
+
+auto GPUBlasBuilder::get_stats() const -> GPUBlasBuilderStats
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void GPUBlasBuilder::compact(const GPUCommandBuffer& command)
+{
+    auto& device = RHI::get_current_device();
+
+    bool copied = false;
+    for (auto& entry : entries) {
+        if (entry.state != EntryState::COMPACTING)
+            continue;
+
+        // nothing to gain, keep the original
+        entry.state = EntryState::DONE;
+        if (entry.compacted == 0 || entry.compacted >= entry.size)
+            continue;
+
+        Vector<GPUBlasGeometrySizeDescriptor> sizes(entry.geometries.size());
+        for (uint i = 0; i < entry.geometries.size(); i++) {
+            sizes.at(i).type      = GPUBlasType::TRIANGLE;
+            sizes.at(i).triangles = entry.geometries.at(i).size;
+        }
+
+        auto desc           = entry.descriptor;
+        desc.compacted_size = entry.compacted;
+        auto blas           = device.create_blas(desc, sizes);
+        command.copy_blas(entry.blas, blas);
+
+        // the original is released once the frame of the copy completes
+        entry.blas.destroy();
+        entry.blas = blas;
+
+        stats.resident_size -= entry.size;
+        entry.size = blas.get_sizes().bvh_size;
+        stats.resident_size += entry.size;
+        stats.compactions++;
+        copied = true;
+    }
+
+    // compacted blas are ready for tlas builds and ray tracing afterwards
+    if (copied) {
+        auto barrier       = GPUMemoryBarrier{};
+        barrier.src_sync   = GPUBarrierSync::ALL;
+        barrier.dst_sync   = GPUBarrierSync::ALL;
+        barrier.src_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_WRITE;
+        barrier.dst_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_READ;
+        command.resource_barrier(barrier);
+    }
+}
+
+void GPUBlasBuilder::build(const GPUCommandBuffer& command)
+{
+    // take queued entries in order while their scratch fits into the budget, at least one per batch
+    Vector<uint> batch;
+    GPUSize64    batch_scratch = 0;
+    for (uint i = 0; i < entries.size(); i++) {
+        auto& entry = entries.at(i);
+        if (entry.state != EntryState::QUEUED)
+            continue;
+        if (!batch.empty() && batch_scratch + entry.scratch > descriptor.scratch_budget)
+            break;
+
+        batch.push_back(i);
+        batch_scratch += entry.scratch;
+    }
+
+    if (batch.empty())
+        return;
+
+    reserve_scratch(batch_scratch);
+
+    Vector<GPUBlasBuildEntry> builds(batch.size());
+    for (uint i = 0; i < batch.size(); i++) {
+        auto& entry                = entries.at(batch.at(i));
+        auto& build                = builds.at(i);
+        build.blas                 = entry.blas;
+        build.geometries.type      = GPUBlasType::TRIANGLE;
+        build.geometries.triangles = entry.geometries;
+    }
+
+    // the scratch buffer is shared with the builds of previous batches
+    auto before       = GPUMemoryBarrier{};
+    before.src_sync   = GPUBarrierSync::ACCELERATION_STRUCTURE_BUILD;
+    before.dst_sync   = GPUBarrierSync::ACCELERATION_STRUCTURE_BUILD;
+    before.src_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_WRITE;
+    before.dst_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_WRITE;
+    command.resource_barrier(before);
+
+    command.build_blases(scratch, builds);
+
+    // queries, compacting copies and tlas builds read the results
+    auto after       = GPUMemoryBarrier{};
+    after.src_sync   = GPUBarrierSync::ACCELERATION_STRUCTURE_BUILD;
+    after.dst_sync   = GPUBarrierSync::ALL;
+    after.src_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_WRITE;
+    after.dst_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_READ;
+    command.resource_barrier(after);
+
+    for (auto index : batch) {
+        auto& entry = entries.at(index);
+        entry.state = entry.descriptor.flags.contains(GPUBVHFlag::ALLOW_COMPACTION)
+                          ? EntryState::BUILT
+                          : EntryState::DONE;
+
+        stats.builds++;
+        stats.built_size += entry.size;
+        stats.resident_size += entry.size;
+    }
+    stats.batches++;
+}
+
+auto GPUBlasBuilder::query(const GPUCommandBuffer& command) -> Vector<Query>
+{
+    Vector<Query> requests;
+    for (uint i = 0; i < entries.size() && !free_queries.empty(); i++) {
+        auto& entry = entries.at(i);
+        if (entry.state != EntryState::BUILT)
+            continue;
+
+        uint index = free_queries.back();
+        free_queries.pop_back();
+
+        // free queries are no longer in use by the device, hence they are reset on host
+        queries.reset(index, 1);
+        command.write_blas_properties(queries, index, entry.blas);
+        command.resolve_query_set(queries, index, 1, resolve, sizeof(uint64_t) * index);
+
+        entry.state = EntryState::QUERYING;
+        requests.push_back(Query{i, index});
+    }
+    return requests;
+}
+
+void GPUBlasBuilder::receive(const Vector<Query>& requests, uint first, const uint8_t* data)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& request : requests) {
+        uint64_t size = 0;
+        std::memcpy(&size, data + sizeof(uint64_t) * (request.second - first), sizeof(uint64_t));
+        free_queries.push_back(request.second);
+
+        auto& entry = entries.at(request.first);
+        if (entry.state != EntryState::QUERYING)
+            continue;
+
+        entry.compacted = size;
+        entry.state     = EntryState::COMPACTING;
+    }
+}
+
+void GPUBlasBuilder::reserve_scratch(GPUSize64 size)
+{
+    if (scratch.valid() && scratch.size >= size)
+        return;
+
+    // the previous scratch buffer is released once the frames using it complete
+    if (scratch.valid())
+        scratch.destroy();
+
+    scratch = execute([&]() {
+        auto desc            = GPUBufferDescriptor{};
+        desc.label           = "blas_build_scratch";
+        desc.size            = std::max(size, descriptor.scratch_budget);
+        desc.usage           = GPUBufferUsage::STORAGE;
+        desc.virtual_address = true;
+        return RHI::get_current_device().create_buffer(desc);
+    });
+    stats.scratch_size = scratch.size;
+}
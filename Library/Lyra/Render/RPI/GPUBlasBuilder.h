@@ -0,0 +1,110 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_BLAS_BUILDER_H
+#define LYRA_LIBRARY_GPU_BLAS_BUILDER_H
+
+#include <mutex>
+#include <Lyra/Common/Container.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+#include <Lyra/Render/RPI/GPUReadbackPool.h>
+
+namespace lyra
+{
+    struct GPUBlasBuilderDescriptor
+    {
+        GPUSize64 scratch_budget = 32u << 20; // scratch memory of the builds recorded per update, a larger blas is built alone
+        uint      max_queries    = 256;       // compacted size queries in flight
+    };
+
+    struct GPUBlasBuilderStats
+    {
+        uint      builds        = 0; // number of blas built
+        uint      batches       = 0; // number of build batches recorded
+        uint      compactions   = 0; // number of blas replaced by a compacted copy
+        GPUSize64 built_size    = 0; // storage of the blas as built
+        GPUSize64 resident_size = 0; // storage of the live blas, after compaction
+        GPUSize64 scratch_size  = 0; // size of the shared scratch buffer
+    };
+
+    // Service building bottom level acceleration structures in batches, and compacting them.
+    //
+    // Each update records the queued builds in FIFO order, as many as fit into the scratch budget,
+    // followed by a compacted size query for every blas built with ALLOW_COMPACTION.
+    // The sizes are read back asynchronously, once they arrive (a few frames later),
+    // the next update copies each blas into a compacted allocation and releases the original.
+    //
+    // The blas of an entry changes when it is compacted, tlas builds must fetch it through get().
+    // Geometry buffers must stay alive until the entry is built.
+    struct GPUBlasBuilder
+    {
+    public:
+        explicit GPUBlasBuilder(const GPUBlasBuilderDescriptor& descriptor);
+        explicit GPUBlasBuilder(GPUBlasBuilder&&)      = delete;
+        explicit GPUBlasBuilder(const GPUBlasBuilder&) = delete;
+        virtual ~GPUBlasBuilder();
+
+        // queues a blas build, returns the entry index
+        auto add(const GPUBlasDescriptor& descriptor, const Vector<GPUBlasTriangleGeometry>& geometries) -> uint;
+
+        // releases the blas of an entry, pending builds and compactions are dropped
+        void remove(uint index);
+
+        // current blas of an entry, invalid until it is built
+        auto get(uint index) const -> GPUBlas;
+
+        // records compacting copies, pending builds and compacted size queries,
+        // the command buffer must be submitted within the current frame.
+        void update(const GPUCommandBuffer& command);
+
+        // number of entries waiting to be built or compacted
+        auto pending() const -> uint;
+
+        auto get_stats() const -> GPUBlasBuilderStats;
+
+    private:
+        enum struct EntryState : uint
+        {
+            QUEUED,     // waiting for scratch memory
+            BUILT,      // waiting for a free query
+            QUERYING,   // waiting for the compacted size
+            COMPACTING, // waiting for the compacting copy
+            DONE,
+            REMOVED,
+        };
+
+        struct Entry
+        {
+            GPUBlasDescriptor               descriptor = {};
+            Vector<GPUBlasTriangleGeometry> geometries = {};
+            GPUBlas                         blas       = {};
+            GPUSize64                       size       = 0; // storage of the current blas
+            GPUSize64                       scratch    = 0; // build scratch size
+            GPUSize64                       compacted  = 0; // compacted size, once read back
+            EntryState                      state      = EntryState::QUEUED;
+        };
+
+        // entry and query index of a compacted size query
+        using Query = std::pair<uint, uint>;
+
+        void compact(const GPUCommandBuffer& command);
+        void build(const GPUCommandBuffer& command);
+        auto query(const GPUCommandBuffer& command) -> Vector<Query>;
+        void receive(const Vector<Query>& requests, uint first, const uint8_t* data);
+        void reserve_scratch(GPUSize64 size);
+
+    private:
+        GPUBlasBuilderDescriptor descriptor;
+        GPUBlasBuilderStats      stats;
+        GPUReadbackPool          readbacks;
+        GPUBuffer                scratch;
+        GPUBuffer                resolve;
+        GPUQuerySet              queries;
+        Vector<uint>             free_queries;
+        Vector<Entry>            entries;
+        mutable std::mutex       mutex;
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_BLAS_BUILDER_H
@@ -0,0 +1,156 @@
+#include <cmrc/cmrc.hpp>
+#include <Lyra/Render/RPI/GPUDrawCompactor.h>
+
+CMRC_DECLARE(engine);
+
+using namespace lyra;
+
+static constexpr uint COMPACTION_GROUP_SIZE = 64;
+
+struct CompactionParams
+{
+    uint draw_count;
+    uint stride;
+};
+
+GPUDrawCompactor::GPUDrawCompactor(const GPUDrawCompactorDescriptor& descriptor)
+{
+    auto& device   = RHI::get_current_device();
+    auto  compiler = Compiler(descriptor.compiler);
+
+    // shader source
+    auto fs     = cmrc::engine::get_filesystem();
+    auto file   = fs.open("Lyra/Render/RPI/Shaders/DrawCompaction.slang");
+    auto source = String(file.begin(), file.end());
+
+    // shader module
+    auto module = execute([&]() {
+        auto desc   = CompileDescriptor{};
+        desc.module = "draw_compaction";
+        desc.path   = "draw_compaction.slang";
+        desc.source = source.c_str();
+        return compiler.compile(desc);
+    });
+
+    // shader reflection
+    auto refl = compiler.reflect({
+        {*module, "csmain"},
+    });
+
+    // compute shader
+    shader = execute([&]() {
+        auto code  = module->get_shader_blob("csmain");
+        auto desc  = GPUShaderModuleDescriptor{};
+        desc.label = "draw_compaction_shader";
+        desc.data  = code->data;
+        desc.size  = code->size;
+        return device.create_shader_module(desc);
+    });
+
+    // bind group layout
+    blayout = device.create_bind_group_layout(refl->get_bind_group_layouts().at(0));
+
+    // pipeline layout
+    playout = execute([&]() {
+        auto desc                 = GPUPipelineLayoutDescriptor{};
+        desc.label                = "draw_compaction_pipeline_layout";
+        desc.bind_group_layouts   = blayout.handle;
+        desc.push_constant_ranges = refl->get_push_constant_ranges();
+        return device.create_pipeline_layout(desc);
+    });
+
+    // pipeline state
+    pipeline = execute([&]() {
+        auto desc           = GPUComputePipelineDescriptor{};
+        desc.label          = "draw_compaction_pipeline";
+        desc.layout         = playout;
+        desc.compute.module = shader;
+        return device.create_compute_pipeline(desc);
+    });
+}
+
+GPUDrawCompactor::~GPUDrawCompactor()
+{
+    if (pipeline.valid()) pipeline.destroy();
+    if (playout.valid()) playout.destroy();
+    if (blayout.valid()) blayout.destroy();
+    if (shader.valid()) shader.destroy();
+}
+
+void GPUDrawCompactor::compact(const GPUCommandEncoder& command, const GPUDrawCompaction& compaction)
+{
+    auto& device = RHI::get_current_device();
+
+    if (compaction.draw_count == 0)
+        return;
+
+    // bind group (bindings follow the declaration order in the shader)
+    auto bind_group = execute([&]() {
+        Array<GPUBindGroupEntry, 4> entries = {};
+
+        const GPUBufferBinding* buffers[] = {&compaction.draws, &compaction.visibility, &compaction.output, &compaction.count};
+        for (uint i = 0; i < entries.size(); i++) {
+            auto& entry   = entries.at(i);
+            entry.type    = GPUBindingResourceType::BUFFER;
+            entry.binding = i;
+            entry.buffer  = *buffers[i];
+        }
+
+        auto desc    = GPUBindGroupDescriptor{};
+        desc.layout  = blayout;
+        desc.entries = entries;
+        return device.create_bind_group(desc);
+    });
+
+    // reset draw count
+    command.clear_buffer(compaction.count.buffer, compaction.count.offset, sizeof(uint));
+    command.resource_barrier(execute([&]() {
+        auto barrier       = GPUBufferBarrier{};
+        barrier.src_sync   = GPUBarrierSync::CLEAR;
+        barrier.dst_sync   = GPUBarrierSync::COMPUTE;
+        barrier.src_access = GPUBarrierAccess::COPY_DEST;
+        barrier.dst_access = GPUBarrierAccess::UNORDERED_ACCESS;
+        barrier.buffer     = compaction.count.buffer;
+        barrier.offset     = compaction.count.offset;
+        barrier.size       = sizeof(uint);
+        return barrier;
+    }));
+
+    auto params       = CompactionParams{};
+    params.draw_count = compaction.draw_count;
+    params.stride     = compaction.indexed
+                            ? sizeof(GPUDrawIndexedIndirectArgs) / sizeof(uint)
+                            : sizeof(GPUDrawIndirectArgs) / sizeof(uint);
+
+    // compaction
+    command.set_pipeline(pipeline);
+    command.set_bind_group(0, bind_group);
+    command.set_push_constants(GPUShaderStage::COMPUTE, 0, params);
+    command.dispatch_workgroups((compaction.draw_count + COMPACTION_GROUP_SIZE - 1) / COMPACTION_GROUP_SIZE);
+
+    // compacted arguments and count are consumed by indirect draws
+    command.resource_barrier(Vector<GPUBufferBarrier>{
+        execute([&]() {
+            auto barrier       = GPUBufferBarrier{};
+            barrier.src_sync   = GPUBarrierSync::COMPUTE;
+            barrier.dst_sync   = GPUBarrierSync::EXECUTE_INDIRECT;
+            barrier.src_access = GPUBarrierAccess::UNORDERED_ACCESS;
+            barrier.dst_access = GPUBarrierAccess::INDIRECT_ARGUMENT;
+            barrier.buffer     = compaction.output.buffer;
+            barrier.offset     = compaction.output.offset;
+            barrier.size       = compaction.output.size;
+            return barrier;
+        }),
+        execute([&]() {
+            auto barrier       = GPUBufferBarrier{};
+            barrier.src_sync   = GPUBarrierSync::COMPUTE;
+            barrier.dst_sync   = GPUBarrierSync::EXECUTE_INDIRECT;
+            barrier.src_access = GPUBarrierAccess::UNORDERED_ACCESS;
+            barrier.dst_access = GPUBarrierAccess::INDIRECT_ARGUMENT;
+            barrier.buffer     = compaction.count.buffer;
+            barrier.offset     = compaction.count.offset;
+            barrier.size       = sizeof(uint);
+            return barrier;
+        }),
+    });
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_DRAW_COMPACTOR_H
+#define LYRA_LIBRARY_GPU_DRAW_COMPACTOR_H
+
+#include <Lyra/Shader/SLCTypes.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+
+namespace lyra
+{
+    struct GPUDrawCompactorDescriptor
+    {
+        CompilerHandle compiler;
+    };
+
+    struct GPUDrawCompaction
+    {
+        GPUBufferBinding draws;      // candidate draw arguments (STORAGE)
+        GPUBufferBinding visibility; // one uint per draw, non-zero when visible (STORAGE)
+        GPUBufferBinding output;     // compacted draw arguments (STORAGE | INDIRECT)
+        GPUBufferBinding count;      // compacted draw count, a single uint (STORAGE | INDIRECT | COPY_DST)
+        GPUSize32        draw_count = 0;
+        bool             indexed    = true; // GPUDrawIndexedIndirectArgs or GPUDrawIndirectArgs
+    };
+
+    // Compute stage that compacts the draw arguments of visible objects,
+    // so that a single draw_(indexed_)indirect_count call submits all of them.
+    // Draws of the same wave keep their relative order, but waves append in any order,
+    // hence per-object data should be looked up with first_instance, which is preserved by compaction.
+    struct GPUDrawCompactor
+    {
+    public:
+        explicit GPUDrawCompactor(const GPUDrawCompactorDescriptor& descriptor);
+        explicit GPUDrawCompactor(GPUDrawCompactor&&)      = delete;
+        explicit GPUDrawCompactor(const GPUDrawCompactor&) = delete;
+        virtual ~GPUDrawCompactor();
+
+        // must be recorded outside of render passes,
+        // output and count are ready for indirect draws once this returns
+        void compact(const GPUCommandEncoder& command, const GPUDrawCompaction& compaction);
+
+    private:
+        GPUShaderModule    shader;
+        GPUBindGroupLayout blayout;
+        GPUPipelineLayout  playout;
+        GPUComputePipeline pipeline;
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_DRAW_COMPACTOR_H
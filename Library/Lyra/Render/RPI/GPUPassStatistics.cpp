@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <Lyra/Render/RPI/GPUPassStatistics.h>
+
+using namespace lyra;
+
+// counters are written in bit order, skipping the ones not enabled on the query set
+static const std::pair<GPUQueryStatistic, GPUSize64 GPUPipelineStatistics::*> STATISTIC_FIELDS[] = {
+    {GPUQueryStatistic::INPUT_VERTICES, &GPUPipelineStatistics::input_vertices},
+    {GPUQueryStatistic::INPUT_PRIMITIVES, &GPUPipelineStatistics::input_primitives},
+    {GPUQueryStatistic::VERTEX_INVOCATIONS, &GPUPipelineStatistics::vertex_invocations},
+    {GPUQueryStatistic::CLIPPING_INVOCATIONS, &GPUPipelineStatistics::clipping_invocations},
+    {GPUQueryStatistic::CLIPPING_PRIMITIVES, &GPUPipelineStatistics::clipping_primitives},
+    {GPUQueryStatistic::FRAGMENT_INVOCATIONS, &GPUPipelineStatistics::fragment_invocations},
+    {GPUQueryStatistic::COMPUTE_INVOCATIONS, &GPUPipelineStatistics::compute_invocations},
+};
+
+static auto sanitize(GPUPassStatisticsDescriptor descriptor) -> GPUPassStatisticsDescriptor
+{
+    // pipeline statistics requires at least one counter
+    if (descriptor.statistics.value == 0)
+        descriptor.statistics = GPUQueryStatistic::ALL;
+    return descriptor;
+}
+
+static auto count_statistics(GPUQueryStatisticFlags statistics) -> uint
+{
+    uint counters = 0;
+    for (auto& field : STATISTIC_FIELDS)
+        if (statistics.contains(field.first))
+            counters++;
+    return counters;
+}
+
+static auto ring_descriptor(const GPUPassStatisticsDescriptor& descriptor, uint counters) -> GPUQueryRingDescriptor
+{
+    auto desc              = GPUQueryRingDescriptor{};
+    desc.label             = "gpu_pass_statistics_queries";
+    desc.type              = GPUQueryType::PIPELINE_STATISTICS;
+    desc.statistics        = descriptor.statistics;
+    desc.queries_per_frame = descriptor.max_passes;
+    desc.values_per_query  = counters;
+    return desc;
+}
+
+GPUPassStatistics::GPUPassStatistics(const GPUPassStatisticsDescriptor& descriptor)
+    : descriptor(sanitize(descriptor)),
+      counters(count_statistics(this->descriptor.statistics)),
+      ring(ring_descriptor(this->descriptor, counters))
+{
+    frames.resize(ring.get_slot_count());
+}
+
+GPUPassStatistics::~GPUPassStatistics()
+{
+    // do nothing
+}
+
+void GPUPassStatistics::new_frame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ring.new_frame([&](const uint64_t* values, uint first, uint queries) {
+        readback(frames.at(ring.get_slot()), values, first, queries);
+    });
+
+    if (frames.size() < ring.get_slot_count())
+        frames.resize(ring.get_slot_count());
+
+    frames.at(ring.get_slot()) = Frame{};
+}
+
+void GPUPassStatistics::begin_pass(const GPUCommandEncoder& command, CString name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& frame = frames.at(ring.get_slot());
+
+    // fold nested passes into the active one
+    auto it = frame.active.find(command.handle.value);
+    if (it != frame.active.end()) {
+        it->second.depth++;
+        return;
+    }
+
+    auto pass = ActivePass{};
+    if (!ring.allocate(1, pass.query))
+        return; // out of queries, the pass is silently dropped
+
+    frame.names.push_back(name);
+    frame.active.emplace(command.handle.value, pass);
+    command.begin_pipeline_statistics_query(ring.get_query_set(), pass.query);
+}
+
+void GPUPassStatistics::end_pass(const GPUCommandEncoder& command)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& frame = frames.at(ring.get_slot());
+    auto  it    = frame.active.find(command.handle.value);
+    if (it == frame.active.end())
+        return; // matching begin_pass was dropped
+
+    if (it->second.depth != 0) {
+        it->second.depth--;
+        return;
+    }
+
+    command.end_pipeline_statistics_query(ring.get_query_set(), it->second.query);
+    frame.active.erase(it);
+}
+
+void GPUPassStatistics::resolve(const GPUCommandEncoder& command)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // a query ends in the command buffer it began in, hence only the passes left open
+    // on this command buffer are closed, the others would never become available
+    auto&        frame = frames.at(ring.get_slot());
+    Vector<uint> skipped;
+    for (auto& kv : frame.active) {
+        if (kv.first == command.handle.value) {
+            command.end_pipeline_statistics_query(ring.get_query_set(), kv.second.query);
+        } else {
+            skipped.push_back(kv.second.query);
+            frame.dropped.insert(kv.second.query);
+        }
+    }
+    frame.active.clear();
+
+    ring.resolve(command, skipped);
+}
+
+void GPUPassStatistics::readback(const Frame& frame, const uint64_t* values, uint first, uint queries)
+{
+    report = GPUPassStatisticsReport{};
+    for (uint i = 0; i < queries; i++) {
+        if (frame.dropped.count(first + i))
+            continue;
+
+        // decode the enabled counters of this query
+        auto statistics = GPUPipelineStatistics{};
+        auto value      = values + i * counters;
+        for (auto& field : STATISTIC_FIELDS)
+            if (descriptor.statistics.contains(field.first))
+                statistics.*field.second = *value++;
+
+        // aggregate passes recorded multiple times by name
+        auto& name = frame.names.at(i);
+        auto  it   = std::find_if(report.passes.begin(), report.passes.end(), [&](const GPUPassStatisticsEntry& entry) {
+            return entry.name == name;
+        });
+        if (it == report.passes.end()) {
+            report.passes.push_back(GPUPassStatisticsEntry{name});
+            it = report.passes.end() - 1;
+        }
+        it->count++;
+        it->statistics += statistics;
+        report.total += statistics;
+    }
+}
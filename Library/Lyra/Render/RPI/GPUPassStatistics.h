@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_PASS_STATISTICS_H
+#define LYRA_LIBRARY_GPU_PASS_STATISTICS_H
+
+#include <mutex>
+#include <Lyra/Common/String.h>
+#include <Lyra/Common/Container.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+#include <Lyra/Render/RPI/GPUQueryRing.h>
+
+namespace lyra
+{
+    struct GPUPassStatisticsDescriptor
+    {
+        uint                   max_passes = 64; // maximum number of passes recorded per frame
+        GPUQueryStatisticFlags statistics = GPUQueryStatistic::ALL;
+    };
+
+    struct GPUPassStatisticsEntry
+    {
+        String                name       = "";
+        uint                  count      = 0; // number of times the pass was recorded in the frame
+        GPUPipelineStatistics statistics = {};
+    };
+
+    struct GPUPassStatisticsReport
+    {
+        Vector<GPUPassStatisticsEntry> passes = {}; // aggregated by pass name, in recording order
+        GPUPipelineStatistics          total  = {};
+    };
+
+    // Pipeline statistics counters (vertex/primitive/fragment/compute invocations) per named pass.
+    // One query per outermost pass, the report describes the frame last completed in the same frame slot.
+    struct GPUPassStatistics
+    {
+    public:
+        explicit GPUPassStatistics(const GPUPassStatisticsDescriptor& descriptor = {});
+        explicit GPUPassStatistics(GPUPassStatistics&&)      = delete;
+        explicit GPUPassStatistics(const GPUPassStatistics&) = delete;
+        virtual ~GPUPassStatistics();
+
+        // call once per frame, after RHI::new_frame()
+        void new_frame();
+
+        // passes nested within the same command buffer are folded into the outermost one,
+        // because only one pipeline statistics query can be active at a time.
+        // counting stops at the first bundle, see GPUCommandEncoder::begin_pipeline_statistics_query
+        void begin_pass(const GPUCommandEncoder& command, CString name);
+
+        void end_pass(const GPUCommandEncoder& command);
+
+        // copy this frame's queries to the readback buffer,
+        // must be recorded outside of render passes, in the last command buffer submitted in the frame.
+        // passes left open on other command buffers are dropped from the report.
+        void resolve(const GPUCommandEncoder& command);
+
+        // report of the most recent frame that has completed on GPU
+        auto get_report() const -> const GPUPassStatisticsReport& { return report; }
+
+    private:
+        struct ActivePass
+        {
+            uint query = 0;
+            uint depth = 0; // number of nested passes folded into this one
+        };
+
+        struct Frame
+        {
+            Vector<String>                names   = {}; // pass name per query
+            HashMap<uint32_t, ActivePass> active  = {}; // open pass per command buffer
+            HashSet<uint>                 dropped = {}; // queries of passes left open, never resolved
+        };
+
+        void readback(const Frame& frame, const uint64_t* values, uint first, uint queries);
+
+    private:
+        GPUPassStatisticsDescriptor descriptor;
+        uint                        counters = 0; // number of enabled counters per query
+        GPUQueryRing                ring;
+        Vector<Frame>               frames; // per frame slot
+        GPUPassStatisticsReport     report;
+        std::mutex                  mutex;
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_PASS_STATISTICS_H
@@ -0,0 +1,402 @@
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <Lyra/Common/Hash.h>
+#include <Lyra/Render/RPI/GPUPipelineManifest.h>
+
+using namespace lyra;
+
+// "LPSO" in little endian, followed by the format version
+constexpr uint32_t MANIFEST_MAGIC   = 0x4F53504C;
+constexpr uint32_t MANIFEST_VERSION = 1;
+
+template <typename T>
+static void put(Vector<uint8_t>& bytes, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "manifest values must be trivially copyable!");
+
+    auto data = reinterpret_cast<const uint8_t*>(&value);
+    bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+static void put(Vector<uint8_t>& bytes, CString value)
+{
+    auto size = static_cast<uint32_t>(value ? std::strlen(value) : 0);
+    put(bytes, size);
+    bytes.insert(bytes.end(), value, value + size);
+}
+
+// reads values back in the order they are put, any read past the end fails the whole entry
+struct ManifestReader
+{
+    const uint8_t* data   = nullptr;
+    size_t         size   = 0;
+    size_t         offset = 0;
+    bool           failed = false;
+
+    template <typename T>
+    auto get() -> T
+    {
+        T value = {};
+        if (failed || offset + sizeof(T) > size) {
+            failed = true;
+            return value;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    // element counts can not exceed the remaining bytes, which guards against corrupted files
+    auto count() -> uint32_t
+    {
+        auto value = get<uint32_t>();
+        if (value > size - offset)
+            failed = true;
+        return failed ? 0 : value;
+    }
+
+    auto string() -> String
+    {
+        auto length = count();
+        auto value  = String(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return value;
+    }
+};
+
+GPUPipelineManifest::GPUPipelineManifest(const GPUPipelineManifestDescriptor& descriptor) : descriptor(descriptor)
+{
+    // do nothing
+}
+
+GPUPipelineManifest::~GPUPipelineManifest()
+{
+    for (auto& [key, pipeline] : pipelines) {
+        if (pipeline.render.valid())
+            pipeline.render.destroy();
+        if (pipeline.compute.valid())
+            pipeline.compute.destroy();
+    }
+}
+
+auto GPUPipelineManifest::create_render_pipeline(const GPURenderPipelineDescriptor& descriptor) -> GPURenderPipeline
+{
+    auto bytes = encode(descriptor);
+    auto key   = hash_bytes(bytes.data(), bytes.size());
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // prewarmed pipelines might still be compiling, draws using them are skipped until ready
+    auto& pipeline = pipelines[pipeline_key(key, descriptor.layout)];
+    if (!pipeline.render.valid()) {
+        pipeline.render = RHI::get_current_device().create_render_pipeline(descriptor);
+        record(std::move(bytes), key);
+    }
+    return pipeline.render;
+}
+
+auto GPUPipelineManifest::create_compute_pipeline(const GPUComputePipelineDescriptor& descriptor) -> GPUComputePipeline
+{
+    auto bytes = encode(descriptor);
+    auto key   = hash_bytes(bytes.data(), bytes.size());
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // prewarmed pipelines might still be compiling, dispatches using them are skipped until ready
+    auto& pipeline = pipelines[pipeline_key(key, descriptor.layout)];
+    if (!pipeline.compute.valid()) {
+        pipeline.compute = RHI::get_current_device().create_compute_pipeline(descriptor);
+        record(std::move(bytes), key);
+    }
+    return pipeline.compute;
+}
+
+auto GPUPipelineManifest::prewarm() -> uint
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint count = 0;
+    for (auto& entry : entries)
+        if (replay(entry))
+            count++;
+    return count;
+}
+
+bool GPUPipelineManifest::save(const Path& path) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Vector<uint8_t> bytes;
+    put(bytes, MANIFEST_MAGIC);
+    put(bytes, MANIFEST_VERSION);
+    put(bytes, static_cast<uint32_t>(entries.size()));
+    for (auto& entry : entries) {
+        put(bytes, static_cast<uint32_t>(entry.bytes.size()));
+        bytes.insert(bytes.end(), entry.bytes.begin(), entry.bytes.end());
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return file.good();
+}
+
+bool GPUPipelineManifest::load(const Path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good())
+        return false;
+
+    Vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    auto reader = ManifestReader{bytes.data(), bytes.size()};
+    if (reader.get<uint32_t>() != MANIFEST_MAGIC || reader.get<uint32_t>() != MANIFEST_VERSION)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint count = reader.count();
+    for (uint i = 0; i < count && !reader.failed; i++) {
+        uint length = reader.count();
+        if (reader.failed)
+            break;
+
+        auto entry = Vector<uint8_t>(bytes.data() + reader.offset, bytes.data() + reader.offset + length);
+        auto key   = hash_bytes(entry.data(), entry.size());
+        reader.offset += length;
+        record(std::move(entry), key);
+    }
+    return !reader.failed;
+}
+
+auto GPUPipelineManifest::size() const -> uint
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<uint>(entries.size());
+}
+
+auto GPUPipelineManifest::encode(const GPURenderPipelineDescriptor& descriptor) const -> Vector<uint8_t>
+{
+    Vector<uint8_t> bytes;
+
+    // shaders, pipeline constants are not supported by the backends yet and are not recorded
+    put(bytes, EntryType::RENDER);
+    put(bytes, GPUShaderModule(descriptor.vertex.module).get_hash());
+    put(bytes, descriptor.vertex.entry_point);
+    put(bytes, GPUShaderModule(descriptor.fragment.module).get_hash());
+    put(bytes, descriptor.fragment.entry_point);
+
+    // vertex layout
+    put(bytes, static_cast<uint32_t>(descriptor.vertex.buffers.size()));
+    for (auto& buffer : descriptor.vertex.buffers) {
+        put(bytes, buffer.array_stride);
+        put(bytes, buffer.step_mode);
+        put(bytes, static_cast<uint32_t>(buffer.attributes.size()));
+        for (auto& attribute : buffer.attributes) {
+            put(bytes, attribute.format);
+            put(bytes, attribute.offset);
+            put(bytes, attribute.shader_location);
+            put(bytes, attribute.shader_semantic);
+        }
+    }
+
+    // primitive state
+    put(bytes, descriptor.primitive.topology);
+    put(bytes, descriptor.primitive.strip_index_format);
+    put(bytes, descriptor.primitive.front_face);
+    put(bytes, descriptor.primitive.cull_mode);
+    put(bytes, descriptor.primitive.unclipped_depth);
+
+    // depth stencil state
+    auto& depth_stencil = descriptor.depth_stencil;
+    put(bytes, depth_stencil.format);
+    put(bytes, depth_stencil.depth_write_enabled);
+    put(bytes, depth_stencil.depth_compare);
+    for (auto& face : {depth_stencil.stencil_front, depth_stencil.stencil_back}) {
+        put(bytes, face.compare);
+        put(bytes, face.fail_op);
+        put(bytes, face.depth_fail_op);
+        put(bytes, face.pass_op);
+    }
+    put(bytes, depth_stencil.stencil_read_mask);
+    put(bytes, depth_stencil.stencil_write_mask);
+    put(bytes, depth_stencil.depth_bias);
+    put(bytes, depth_stencil.depth_bias_constant);
+    put(bytes, depth_stencil.depth_bias_slope_scale);
+    put(bytes, depth_stencil.depth_bias_clamp);
+
+    // multisample state
+    put(bytes, descriptor.multisample.count);
+    put(bytes, descriptor.multisample.mask);
+    put(bytes, descriptor.multisample.alpha_to_one_enabled);
+    put(bytes, descriptor.multisample.alpha_to_coverage_enabled);
+
+    // color targets
+    put(bytes, static_cast<uint32_t>(descriptor.fragment.targets.size()));
+    for (auto& target : descriptor.fragment.targets) {
+        put(bytes, target.format);
+        for (auto& component : {target.blend.color, target.blend.alpha}) {
+            put(bytes, component.operation);
+            put(bytes, component.src_factor);
+            put(bytes, component.dst_factor);
+        }
+        put(bytes, target.write_mask.value);
+        put(bytes, target.blend_enable);
+    }
+    return bytes;
+}
+
+auto GPUPipelineManifest::encode(const GPUComputePipelineDescriptor& descriptor) const -> Vector<uint8_t>
+{
+    Vector<uint8_t> bytes;
+    put(bytes, EntryType::COMPUTE);
+    put(bytes, GPUShaderModule(descriptor.compute.module).get_hash());
+    put(bytes, descriptor.compute.entry_point);
+    return bytes;
+}
+
+auto GPUPipelineManifest::pipeline_key(GPUSize64 key, GPUPipelineLayoutHandle layout) const -> GPUSize64
+{
+    // layout handles are only valid within this run, hence they are not part of the recorded entry
+    GPUSize64 values[] = {key, static_cast<GPUSize64>(layout.value)};
+    return hash_bytes(values, sizeof(values));
+}
+
+bool GPUPipelineManifest::record(Vector<uint8_t>&& bytes, GPUSize64 key)
+{
+    if (indices.count(key))
+        return false;
+
+    auto entry  = Entry{};
+    entry.key   = key;
+    entry.bytes = std::move(bytes);
+
+    indices[key] = static_cast<uint>(entries.size());
+    entries.push_back(std::move(entry));
+    return true;
+}
+
+bool GPUPipelineManifest::replay(const Entry& entry)
+{
+    auto& device = RHI::get_current_device();
+    auto  reader = ManifestReader{entry.bytes.data(), entry.bytes.size()};
+
+    if (reader.get<EntryType>() == EntryType::COMPUTE) {
+        auto shader      = descriptor.shader(reader.get<GPUSize64>());
+        auto entry_point = reader.string();
+        if (reader.failed || !shader.valid())
+            return false;
+
+        auto desc                = GPUComputePipelineDescriptor{};
+        desc.label               = "prewarmed_compute_pipeline";
+        desc.async               = true;
+        desc.layout              = descriptor.layout({shader});
+        desc.compute.module      = shader;
+        desc.compute.entry_point = entry_point.c_str();
+        if (!desc.layout.valid())
+            return false;
+
+        // already created or prewarmed with this layout
+        auto& pipeline = pipelines[pipeline_key(entry.key, desc.layout)];
+        if (pipeline.compute.valid())
+            return false;
+
+        pipeline.compute = device.create_compute_pipeline(desc);
+        return true;
+    }
+
+    auto desc  = GPURenderPipelineDescriptor{};
+    desc.label = "prewarmed_render_pipeline";
+    desc.async = true;
+
+    // strings and arrays referenced by the descriptor
+    Deque<String>                      strings;
+    Vector<GPUVertexBufferLayout>      buffers;
+    Vector<Vector<GPUVertexAttribute>> attributes;
+    Vector<GPUColorTargetState>        targets;
+
+    // shaders
+    desc.vertex.module        = descriptor.shader(reader.get<GPUSize64>());
+    desc.vertex.entry_point   = strings.emplace_back(reader.string()).c_str();
+    desc.fragment.module      = descriptor.shader(reader.get<GPUSize64>());
+    desc.fragment.entry_point = strings.emplace_back(reader.string()).c_str();
+
+    // vertex layout
+    buffers.resize(reader.count());
+    attributes.resize(buffers.size());
+    for (uint i = 0; i < buffers.size(); i++) {
+        auto& buffer        = buffers.at(i);
+        buffer.array_stride = reader.get<GPUSize64>();
+        buffer.step_mode    = reader.get<GPUVertexStepMode>();
+
+        attributes.at(i).resize(reader.count());
+        for (auto& attribute : attributes.at(i)) {
+            attribute.format          = reader.get<GPUVertexFormat>();
+            attribute.offset          = reader.get<GPUSize64>();
+            attribute.shader_location = reader.get<GPUIndex32>();
+            attribute.shader_semantic = strings.emplace_back(reader.string()).c_str();
+        }
+        buffer.attributes = attributes.at(i);
+    }
+    desc.vertex.buffers = buffers;
+
+    // primitive state
+    desc.primitive.topology           = reader.get<GPUPrimitiveTopology>();
+    desc.primitive.strip_index_format = reader.get<GPUIndexFormat>();
+    desc.primitive.front_face         = reader.get<GPUFrontFace>();
+    desc.primitive.cull_mode          = reader.get<GPUCullMode>();
+    desc.primitive.unclipped_depth    = reader.get<bool>();
+
+    // depth stencil state
+    auto& depth_stencil               = desc.depth_stencil;
+    depth_stencil.format              = reader.get<GPUTextureFormat>();
+    depth_stencil.depth_write_enabled = reader.get<bool>();
+    depth_stencil.depth_compare       = reader.get<GPUCompareFunction>();
+    for (auto face : {&depth_stencil.stencil_front, &depth_stencil.stencil_back}) {
+        face->compare       = reader.get<GPUCompareFunction>();
+        face->fail_op       = reader.get<GPUStencilOperation>();
+        face->depth_fail_op = reader.get<GPUStencilOperation>();
+        face->pass_op       = reader.get<GPUStencilOperation>();
+    }
+    depth_stencil.stencil_read_mask      = reader.get<GPUStencilValue>();
+    depth_stencil.stencil_write_mask     = reader.get<GPUStencilValue>();
+    depth_stencil.depth_bias             = reader.get<GPUDepthBias>();
+    depth_stencil.depth_bias_constant    = reader.get<float>();
+    depth_stencil.depth_bias_slope_scale = reader.get<float>();
+    depth_stencil.depth_bias_clamp       = reader.get<float>();
+
+    // multisample state
+    desc.multisample.count                     = reader.get<GPUSize32>();
+    desc.multisample.mask                      = reader.get<GPUSampleMask>();
+    desc.multisample.alpha_to_one_enabled      = reader.get<bool>();
+    desc.multisample.alpha_to_coverage_enabled = reader.get<bool>();
+
+    // color targets
+    targets.resize(reader.count());
+    for (auto& target : targets) {
+        target.format = reader.get<GPUTextureFormat>();
+        for (auto component : {&target.blend.color, &target.blend.alpha}) {
+            component->operation  = reader.get<GPUBlendOperation>();
+            component->src_factor = reader.get<GPUBlendFactor>();
+            component->dst_factor = reader.get<GPUBlendFactor>();
+        }
+        target.write_mask   = reader.get<uint32_t>();
+        target.blend_enable = reader.get<bool>();
+    }
+    desc.fragment.targets = targets;
+
+    if (reader.failed || !desc.vertex.module.valid() || !desc.fragment.module.valid())
+        return false;
+
+    desc.layout = descriptor.layout({desc.vertex.module, desc.fragment.module});
+    if (!desc.layout.valid())
+        return false;
+
+    // already created or prewarmed with this layout
+    auto& pipeline = pipelines[pipeline_key(entry.key, desc.layout)];
+    if (pipeline.render.valid())
+        return false;
+
+    pipeline.render = device.create_render_pipeline(desc);
+    return true;
+}
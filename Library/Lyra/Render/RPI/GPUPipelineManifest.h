@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_PIPELINE_MANIFEST_H
+#define LYRA_LIBRARY_GPU_PIPELINE_MANIFEST_H
+
+#include <mutex>
+#include <Lyra/Common/Path.h>
+#include <Lyra/Common/Function.h>
+#include <Lyra/Common/Container.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+
+namespace lyra
+{
+    struct GPUPipelineManifestDescriptor
+    {
+        // finds a loaded shader module by its content hash, pipelines with a missing shader are not prewarmed
+        Function<GPUShaderModuleHandle(GPUSize64 hash)> shader;
+
+        // provides the layout of a pipeline from its shader modules (vertex and fragment, or compute)
+        Function<GPUPipelineLayoutHandle(const Vector<GPUShaderModuleHandle>& shaders)> layout;
+    };
+
+    // Records every unique pipeline created through it into a compact manifest,
+    // and replays a saved manifest on the pipeline compiler workers, hence pipelines
+    // already exist (or are compiling) by the time they are first requested.
+    //
+    // Entries refer to shaders by content hash, and carry the vertex layout and render states.
+    // Pipeline layouts are not recorded, they are assumed to follow from the shaders.
+    // Created pipelines are cached by entry and layout, hence descriptors only differing
+    // in their layout share one entry but get their own pipelines.
+    // Pipelines returned by the manifest are owned by the manifest.
+    struct GPUPipelineManifest
+    {
+    public:
+        explicit GPUPipelineManifest(const GPUPipelineManifestDescriptor& descriptor);
+        explicit GPUPipelineManifest(GPUPipelineManifest&&)      = delete;
+        explicit GPUPipelineManifest(const GPUPipelineManifest&) = delete;
+        virtual ~GPUPipelineManifest();
+
+        // returns the prewarmed pipeline when there is one, otherwise creates and records it
+        auto create_render_pipeline(const GPURenderPipelineDescriptor& descriptor) -> GPURenderPipeline;
+        auto create_compute_pipeline(const GPUComputePipelineDescriptor& descriptor) -> GPUComputePipeline;
+
+        // creates all recorded pipelines asynchronously, returns the number of pipelines queued
+        auto prewarm() -> uint;
+
+        // manifest file io, loading merges entries into the current manifest
+        bool save(const Path& path) const;
+        bool load(const Path& path);
+
+        auto size() const -> uint;
+
+    private:
+        enum struct EntryType : uint32_t
+        {
+            RENDER,
+            COMPUTE,
+        };
+
+        struct Entry
+        {
+            GPUSize64       key   = 0;
+            Vector<uint8_t> bytes = {};
+        };
+
+        struct Pipeline
+        {
+            GPURenderPipeline  render;
+            GPUComputePipeline compute;
+        };
+
+        auto encode(const GPURenderPipelineDescriptor& descriptor) const -> Vector<uint8_t>;
+        auto encode(const GPUComputePipelineDescriptor& descriptor) const -> Vector<uint8_t>;
+        auto pipeline_key(GPUSize64 key, GPUPipelineLayoutHandle layout) const -> GPUSize64;
+        bool record(Vector<uint8_t>&& bytes, GPUSize64 key);
+        bool replay(const Entry& entry);
+
+    private:
+        GPUPipelineManifestDescriptor descriptor;
+        Vector<Entry>                 entries;
+        HashMap<GPUSize64, uint>      indices;   // entry index of each key
+        HashMap<GPUSize64, Pipeline>  pipelines; // pipelines created or prewarmed, by key and layout
+        mutable std::mutex            mutex;
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_PIPELINE_MANIFEST_H
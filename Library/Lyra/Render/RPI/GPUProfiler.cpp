@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cstdint>
+#include <Lyra/Render/RPI/GPUProfiler.h>
+
+using namespace lyra;
+
+static auto ring_descriptor(const GPUProfilerDescriptor& descriptor) -> GPUQueryRingDescriptor
+{
+    auto desc              = GPUQueryRingDescriptor{};
+    desc.label             = "gpu_profiler_queries";
+    desc.type              = GPUQueryType::TIMESTAMP;
+    desc.queries_per_frame = descriptor.max_scopes * 2;
+    return desc;
+}
+
+GPUProfiler::GPUProfiler(const GPUProfilerDescriptor& descriptor) : descriptor(descriptor), ring(ring_descriptor(descriptor))
+{
+    auto& adapter = RHI::get_current_adapter();
+
+    frames.resize(ring.get_slot_count());
+    period = static_cast<double>(adapter.properties.timestamp_period) / 1e6;
+}
+
+GPUProfiler::~GPUProfiler()
+{
+    // do nothing
+}
+
+void GPUProfiler::new_frame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ring.new_frame([&](const uint64_t* timestamps, uint first, uint queries) {
+        readback(frames.at(ring.get_slot()), timestamps, first, queries);
+    });
+
+    if (frames.size() < ring.get_slot_count())
+        frames.resize(ring.get_slot_count());
+
+    frames.at(ring.get_slot()) = Frame{};
+}
+
+void GPUProfiler::begin_scope(const GPUCommandEncoder& command, CString name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint first = 0;
+    if (!ring.allocate(2, first))
+        return; // out of queries, the scope is silently dropped
+
+    auto& frame = frames.at(ring.get_slot());
+    auto& stack = frame.stacks[command.handle.value];
+
+    auto scope  = Scope{};
+    scope.name  = name;
+    scope.depth = static_cast<uint>(stack.size());
+    scope.begin = first;
+    scope.end   = first + 1;
+
+    stack.push_back(static_cast<uint>(frame.scopes.size()));
+    frame.scopes.push_back(scope);
+    command.write_timestamp(ring.get_query_set(), scope.begin);
+}
+
+void GPUProfiler::end_scope(const GPUCommandEncoder& command)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& frame = frames.at(ring.get_slot());
+    auto& stack = frame.stacks[command.handle.value];
+    if (stack.empty())
+        return; // matching begin_scope was dropped
+
+    auto& scope = frame.scopes.at(stack.back());
+    stack.pop_back();
+    command.write_timestamp(ring.get_query_set(), scope.end);
+}
+
+void GPUProfiler::resolve(const GPUCommandEncoder& command)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // scopes left open on this command buffer end here, the ones left open on other command buffers
+    // (maybe not even submitted yet) are dropped, their ending queries would never become available
+    auto&        frame = frames.at(ring.get_slot());
+    Vector<uint> skipped;
+    for (auto& kv : frame.stacks) {
+        for (auto index : kv.second) {
+            auto& scope = frame.scopes.at(index);
+            if (kv.first == command.handle.value) {
+                command.write_timestamp(ring.get_query_set(), scope.end);
+            } else {
+                scope.dropped = true;
+                skipped.push_back(scope.end);
+            }
+        }
+        kv.second.clear();
+    }
+
+    ring.resolve(command, skipped);
+}
+
+void GPUProfiler::readback(const Frame& frame, const uint64_t* timestamps, uint first, uint queries)
+{
+    // earliest timestamp of the frame is used as reference
+    uint64_t origin = UINT64_MAX;
+    for (auto& scope : frame.scopes)
+        if (!scope.dropped)
+            origin = std::min(origin, timestamps[scope.begin - first]);
+
+    results.clear();
+    for (auto& scope : frame.scopes) {
+        if (scope.dropped)
+            continue;
+
+        uint64_t begin = timestamps[scope.begin - first];
+        uint64_t end   = timestamps[scope.end - first];
+
+        auto result  = GPUProfilerScope{};
+        result.name  = scope.name;
+        result.depth = scope.depth;
+        result.start = static_cast<double>(begin - origin) * period;
+        result.time  = static_cast<double>(end >= begin ? end - begin : 0) * period;
+        results.push_back(result);
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_PROFILER_H
+#define LYRA_LIBRARY_GPU_PROFILER_H
+
+#include <mutex>
+#include <Lyra/Common/String.h>
+#include <Lyra/Common/Container.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+#include <Lyra/Render/RPI/GPUQueryRing.h>
+
+namespace lyra
+{
+    struct GPUProfilerDescriptor
+    {
+        uint max_scopes = 256; // maximum number of scopes recorded per frame
+    };
+
+    struct GPUProfilerScope
+    {
+        String name  = "";
+        uint   depth = 0;   // nesting depth within its command buffer
+        double start = 0.0; // milliseconds since the earliest scope of the frame
+        double time  = 0.0; // duration in milliseconds
+    };
+
+    // Named GPU scopes measured with timestamp queries.
+    // Queries come from a GPUQueryRing, hence results lag behind by the frames in flight.
+    struct GPUProfiler
+    {
+    public:
+        explicit GPUProfiler(const GPUProfilerDescriptor& descriptor = {});
+        explicit GPUProfiler(GPUProfiler&&)      = delete;
+        explicit GPUProfiler(const GPUProfiler&) = delete;
+        virtual ~GPUProfiler();
+
+        // call once per frame, after RHI::new_frame()
+        void new_frame();
+
+        void begin_scope(const GPUCommandEncoder& command, CString name);
+
+        void end_scope(const GPUCommandEncoder& command);
+
+        // copy this frame's queries to the readback buffer,
+        // must be recorded outside of render passes, in the last command buffer submitted in the frame.
+        // scopes left open on this command buffer end here, the ones left open elsewhere are dropped.
+        void resolve(const GPUCommandEncoder& command);
+
+        // scopes of the most recent frame that has completed on GPU
+        auto get_results() const -> const Vector<GPUProfilerScope>& { return results; }
+
+    private:
+        struct Scope
+        {
+            String name;
+            uint   depth = 0;
+            uint   begin   = 0;     // query index of the starting timestamp
+            uint   end     = 0;     // query index of the ending timestamp
+            bool   dropped = false; // left open on another command buffer, end is never written
+        };
+
+        struct Frame
+        {
+            Vector<Scope>                   scopes = {};
+            HashMap<uint32_t, Vector<uint>> stacks = {}; // open scopes per command buffer
+        };
+
+        void readback(const Frame& frame, const uint64_t* timestamps, uint first, uint queries);
+
+    private:
+        GPUProfilerDescriptor    descriptor;
+        GPUQueryRing             ring;
+        Vector<Frame>            frames; // per frame slot
+        Vector<GPUProfilerScope> results;
+        double                   period = 0.0; // milliseconds per timestamp tick
+        std::mutex               mutex;
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_PROFILER_H
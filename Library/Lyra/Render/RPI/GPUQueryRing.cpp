@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <Lyra/Render/RPI/GPUQueryRing.h>
+
+using namespace lyra;
+
+GPUQueryRing::GPUQueryRing(const GPUQueryRingDescriptor& descriptor) : descriptor(descriptor)
+{
+    auto slot = RHI::get_frame_slot();
+    create(slot.count);
+    current = slot.index;
+}
+
+GPUQueryRing::~GPUQueryRing()
+{
+    destroy();
+}
+
+void GPUQueryRing::new_frame(const Readback& readback)
+{
+    // frame slots are added when a surface with more frames is created,
+    // results pending in the old query set are dropped.
+    auto slot = RHI::get_frame_slot();
+    if (slots.size() < slot.count) {
+        destroy();
+        create(slot.count);
+    }
+    current = slot.index;
+
+    // the previous frame of this slot has completed, its results are available
+    auto& frame = slots.at(current);
+    uint  first = current * descriptor.queries_per_frame;
+    if (frame.resolved && readback) {
+        GPUSize64 stride = descriptor.values_per_query * sizeof(uint64_t);
+        buffer.map(GPUMapMode::READ, first * stride, frame.queries * stride);
+        readback(buffer.get_mapped_range<uint64_t>().data, first, frame.queries);
+        buffer.unmap();
+    }
+
+    // queries must be reset before they are written again
+    if (frame.queries != 0)
+        query_set.reset(first, frame.queries);
+
+    frame = Slot{};
+}
+
+bool GPUQueryRing::allocate(uint count, uint& first)
+{
+    auto& frame = slots.at(current);
+    if (frame.queries + count > descriptor.queries_per_frame)
+        return false;
+
+    first = current * descriptor.queries_per_frame + frame.queries;
+    frame.queries += count;
+    return true;
+}
+
+void GPUQueryRing::resolve(const GPUCommandEncoder& command, const Vector<uint>& skipped)
+{
+    auto& frame = slots.at(current);
+    if (frame.queries == 0)
+        return;
+
+    Vector<uint> gaps = skipped;
+    std::sort(gaps.begin(), gaps.end());
+
+    // resolve the runs of written queries between the skipped ones
+    uint first = current * descriptor.queries_per_frame;
+    uint last  = first + frame.queries;
+    uint begin = first;
+    for (uint end : gaps) {
+        if (end < begin || end >= last)
+            continue;
+        if (end > begin)
+            command.resolve_query_set(query_set, begin, end - begin, buffer, begin * descriptor.values_per_query * sizeof(uint64_t));
+        begin = end + 1;
+    }
+    if (last > begin)
+        command.resolve_query_set(query_set, begin, last - begin, buffer, begin * descriptor.values_per_query * sizeof(uint64_t));
+
+    frame.resolved = true;
+}
+
+void GPUQueryRing::create(uint count)
+{
+    auto& device = RHI::get_current_device();
+
+    uint total_queries = descriptor.queries_per_frame * count;
+
+    query_set = execute([&]() {
+        auto desc       = GPUQuerySetDescriptor{};
+        desc.label      = descriptor.label;
+        desc.type       = descriptor.type;
+        desc.count      = total_queries;
+        desc.statistics = descriptor.statistics;
+        return device.create_query_set(desc);
+    });
+    query_set.reset(0, total_queries);
+
+    buffer = execute([&]() {
+        auto desc  = GPUBufferDescriptor{};
+        desc.label = descriptor.label;
+        desc.size  = total_queries * descriptor.values_per_query * sizeof(uint64_t);
+        desc.usage = GPUBufferUsage::MAP_READ | GPUBufferUsage::COPY_DST;
+        return device.create_buffer(desc);
+    });
+
+    slots.clear();
+    slots.resize(count);
+}
+
+void GPUQueryRing::destroy()
+{
+    // released once the frames in flight complete
+    if (query_set.valid()) query_set.destroy();
+    if (buffer.valid()) buffer.destroy();
+}
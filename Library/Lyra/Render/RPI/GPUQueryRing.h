@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_QUERY_RING_H
+#define LYRA_LIBRARY_GPU_QUERY_RING_H
+
+#include <Lyra/Common/Function.h>
+#include <Lyra/Common/Container.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+
+namespace lyra
+{
+    struct GPUQueryRingDescriptor
+    {
+        CString                label             = "gpu_query_ring";
+        GPUQueryType           type              = GPUQueryType::TIMESTAMP;
+        GPUQueryStatisticFlags statistics        = 0;   // only used by pipeline statistics queries
+        uint                   queries_per_frame = 256; // maximum number of queries allocated per frame
+        uint                   values_per_query  = 1;   // 64-bit values written by each resolved query
+    };
+
+    // Query set and readback buffer partitioned per RHI frame slot (see RHI::get_frame_slot()).
+    // Each slot owns a range of queries and a slice of the readback buffer, results are read back
+    // when the slot is reused, hence the host never waits on GPU.
+    //
+    // The ring is not synchronized, owners serialize the calls.
+    struct GPUQueryRing
+    {
+    public:
+        // values of the queries [first, first + queries) resolved by the previous frame of the slot
+        using Readback = Function<void(const uint64_t* values, uint first, uint queries)>;
+
+        explicit GPUQueryRing(const GPUQueryRingDescriptor& descriptor);
+        explicit GPUQueryRing(GPUQueryRing&&)      = delete;
+        explicit GPUQueryRing(const GPUQueryRing&) = delete;
+        virtual ~GPUQueryRing();
+
+        // moves to the frame slot of the current frame, call once per frame after RHI::new_frame().
+        // readback is invoked when the previous frame of the slot resolved its queries.
+        void new_frame(const Readback& readback);
+
+        // allocates consecutive queries of the current frame, fails when the frame is out of queries
+        bool allocate(uint count, uint& first);
+
+        // copies this frame's queries to the readback buffer,
+        // must be recorded outside of render passes, in the last command buffer submitted in the frame.
+        // skipped queries were never written (resolving them would wait forever), their values are undefined.
+        void resolve(const GPUCommandEncoder& command, const Vector<uint>& skipped = {});
+
+        auto get_query_set() const -> const GPUQuerySet& { return query_set; }
+
+        // frame slot of the current frame, and the number of frame slots
+        auto get_slot() const -> uint { return current; }
+        auto get_slot_count() const -> uint { return static_cast<uint>(slots.size()); }
+
+        // queries allocated by the current frame
+        auto get_queries() const -> uint { return slots.at(current).queries; }
+
+    private:
+        struct Slot
+        {
+            uint queries  = 0;
+            bool resolved = false;
+        };
+
+        void create(uint count);
+        void destroy();
+
+    private:
+        GPUQueryRingDescriptor descriptor;
+        GPUQuerySet            query_set;
+        GPUBuffer              buffer;
+        Vector<Slot>           slots;
+        uint                   current = 0; // frame slot of the current frame
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_QUERY_RING_H
@@ -0,0 +1,112 @@
+#include <cassert>
+#include <algorithm>
+#include <Lyra/Render/RPI/GPUReadbackPool.h>
+
+using namespace lyra;
+
+GPUReadbackPool::GPUReadbackPool(const GPUReadbackPoolDescriptor& descriptor) : descriptor(descriptor)
+{
+    // do nothing
+}
+
+GPUReadbackPool::~GPUReadbackPool()
+{
+    // destroying a pending buffer aborts its mapping, the callback then only releases the slot
+    for (uint i = 0; i < slots.size(); i++) {
+        auto buffer = slots.at(i).buffer;
+        if (buffer.valid())
+            buffer.destroy();
+    }
+}
+
+void GPUReadbackPool::read_buffer(const GPUCommandBuffer& command, const GPUBuffer& source, GPUSize64 offset, GPUSize64 size, const GPUReadbackCallback& callback)
+{
+    uint index  = acquire(size);
+    auto buffer = GPUBuffer{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer = slots.at(index).buffer;
+    }
+
+    command.copy_buffer_to_buffer(source, offset, buffer, 0, size);
+    request(index, size, callback);
+}
+
+void GPUReadbackPool::read_texture(const GPUCommandBuffer& command, const GPUTexelCopyTextureInfo& source, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& extent, const GPUReadbackCallback& callback)
+{
+    assert(layout.bytes_per_row != 0 && "texture readback requires an explicit bytes_per_row!");
+
+    GPUSize64 rows = layout.rows_per_image != 0 ? layout.rows_per_image : extent.height;
+    GPUSize64 size = GPUSize64(layout.bytes_per_row) * rows * std::max(extent.depth, 1u);
+
+    uint index = acquire(size);
+
+    auto destination           = GPUTexelCopyBufferInfo{};
+    destination.offset         = 0;
+    destination.bytes_per_row  = layout.bytes_per_row;
+    destination.rows_per_image = static_cast<GPUSize32>(rows);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        destination.buffer = slots.at(index).buffer;
+    }
+
+    command.copy_texture_to_buffer(source, destination, extent);
+    request(index, size, callback);
+}
+
+auto GPUReadbackPool::pending() const -> uint
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<uint>(std::count_if(slots.begin(), slots.end(), [](const Slot& slot) { return slot.busy; }));
+}
+
+auto GPUReadbackPool::acquire(GPUSize64 size) -> uint
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // reuse the smallest free buffer which fits
+    uint best = static_cast<uint>(slots.size());
+    for (uint i = 0; i < slots.size(); i++) {
+        auto& slot = slots.at(i);
+        if (slot.busy || slot.buffer.size < size)
+            continue;
+        if (best == slots.size() || slot.buffer.size < slots.at(best).buffer.size)
+            best = i;
+    }
+
+    if (best == slots.size()) {
+        auto slot   = Slot{};
+        slot.buffer = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "readback_pool_buffer";
+            desc.size  = std::max(size, descriptor.min_size);
+            desc.usage = GPUBufferUsage::MAP_READ | GPUBufferUsage::COPY_DST;
+            return RHI::get_current_device().create_buffer(desc);
+        });
+        slots.push_back(slot);
+    }
+
+    slots.at(best).busy = true;
+    return best;
+}
+
+void GPUReadbackPool::request(uint index, GPUSize64 size, const GPUReadbackCallback& callback)
+{
+    auto buffer = GPUBuffer{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer = slots.at(index).buffer;
+    }
+
+    buffer.map_async(GPUMapMode::READ, [this, index, size, callback](GPUBufferHandle handle, bool success) {
+        if (success) {
+            auto mapped   = GPUBuffer{};
+            mapped.handle = handle;
+            callback(mapped.get_mapped_range<uint8_t>().data, size);
+            mapped.unmap();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        slots.at(index).busy = false;
+    });
+}
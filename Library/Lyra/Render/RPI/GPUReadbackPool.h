@@ -0,0 +1,62 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_READBACK_POOL_H
+#define LYRA_LIBRARY_GPU_READBACK_POOL_H
+
+#include <mutex>
+#include <Lyra/Common/Function.h>
+#include <Lyra/Common/Container.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+
+namespace lyra
+{
+    struct GPUReadbackPoolDescriptor
+    {
+        GPUSize64 min_size = 65536; // smallest readback buffer, larger requests get a buffer of their own size
+    };
+
+    // invoked with the copied bytes, the data is only valid during the callback
+    using GPUReadbackCallback = Function<void(const uint8_t* data, GPUSize64 size)>;
+
+    // Pool of readback buffers for reading GPU results without waiting on the device.
+    // Each readback copies into a free pooled buffer and maps it asynchronously,
+    // the buffer returns to the pool after the callback, once the frame of the copy has completed.
+    //
+    // The command buffer recording the copy must be submitted within the current frame.
+    // Pending readbacks are dropped when the pool is destroyed.
+    struct GPUReadbackPool
+    {
+    public:
+        explicit GPUReadbackPool(const GPUReadbackPoolDescriptor& descriptor);
+        explicit GPUReadbackPool(GPUReadbackPool&&)      = delete;
+        explicit GPUReadbackPool(const GPUReadbackPool&) = delete;
+        virtual ~GPUReadbackPool();
+
+        void read_buffer(const GPUCommandBuffer& command, const GPUBuffer& source, GPUSize64 offset, GPUSize64 size, const GPUReadbackCallback& callback);
+
+        // bytes_per_row must be set, the texture rows are copied with this pitch
+        void read_texture(const GPUCommandBuffer& command, const GPUTexelCopyTextureInfo& source, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& extent, const GPUReadbackCallback& callback);
+
+        // number of readbacks waiting for their frame to complete
+        auto pending() const -> uint;
+
+    private:
+        struct Slot
+        {
+            GPUBuffer buffer;
+            bool      busy = false;
+        };
+
+        auto acquire(GPUSize64 size) -> uint;
+        void request(uint index, GPUSize64 size, const GPUReadbackCallback& callback);
+
+    private:
+        GPUReadbackPoolDescriptor descriptor;
+        Vector<Slot>              slots;
+        mutable std::mutex        mutex;
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_READBACK_POOL_H
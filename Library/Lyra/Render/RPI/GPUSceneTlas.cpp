@@ -0,0 +1,160 @@
+#include <chrono>
+#include <algorithm>
+#include <Lyra/Render/RPI/GPUSceneTlas.h>
+
+using namespace lyra;
+
+GPUSceneTlas::GPUSceneTlas(const GPUSceneTlasDescriptor& descriptor) : descriptor(descriptor)
+{
+    // do nothing
+}
+
+GPUSceneTlas::~GPUSceneTlas()
+{
+    if (tlas.valid()) tlas.destroy();
+    if (scratch.valid()) scratch.destroy();
+}
+
+void GPUSceneTlas::update(const GPUCommandBuffer& command, Universe& universe)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // a new tlas starts without instance records
+    bool rebuild = detect_changes(universe);
+    if (slots.size() > capacity || !tlas.valid()) {
+        reserve(static_cast<uint>(slots.size()));
+        rebuild = true;
+    }
+
+    // rewrite the records of moved instances, or all of them on rebuild
+    Vector<GPUTlasInstanceUpdate> updates;
+    for (uint i = 0; i < slots.size(); i++) {
+        auto& world = universe.registry.get<WorldTransform>(slots.at(i).entity);
+        if (!rebuild && !world.dirty)
+            continue;
+
+        auto& instance = universe.registry.get<RayTracingInstance>(slots.at(i).entity);
+
+        auto update                 = GPUTlasInstanceUpdate{};
+        update.index                = i;
+        update.instance.custom_data = instance.custom_data;
+        update.instance.mask        = instance.mask;
+        update.instance.blas        = instance.blas;
+        for (uint col = 0; col < 4; col++)
+            for (uint row = 0; row < 3; row++)
+                update.instance.transform[col][row] = world.xform[col][row];
+        updates.push_back(update);
+    }
+
+    stats.instances = static_cast<uint>(slots.size());
+    stats.written   = static_cast<uint>(updates.size());
+
+    // nothing moved, the tlas stays as built
+    if (slots.empty() || (!rebuild && updates.empty()))
+        return;
+
+    if (descriptor.profiler)
+        descriptor.profiler->begin_scope(command, rebuild ? "tlas_rebuild" : "tlas_refit");
+
+    // ray tracing of previous frames may still read the tlas
+    auto before       = GPUMemoryBarrier{};
+    before.src_sync   = GPUBarrierSync::ALL;
+    before.dst_sync   = GPUBarrierSync::ACCELERATION_STRUCTURE_BUILD;
+    before.src_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_READ;
+    before.dst_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_WRITE;
+    command.resource_barrier(before);
+
+    command.update_tlas_instances(tlas, updates);
+
+    auto entry           = GPUTlasBuildEntry{};
+    entry.tlas           = tlas;
+    entry.instance_count = static_cast<uint>(slots.size());
+    entry.rebuild        = rebuild;
+    command.build_tlases(scratch, {entry});
+
+    // the tlas is ready for ray tracing afterwards
+    auto after       = GPUMemoryBarrier{};
+    after.src_sync   = GPUBarrierSync::ACCELERATION_STRUCTURE_BUILD;
+    after.dst_sync   = GPUBarrierSync::ALL;
+    after.src_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_WRITE;
+    after.dst_access = GPUBarrierAccess::ACCELERATION_STRUCTURE_READ;
+    command.resource_barrier(after);
+
+    if (descriptor.profiler)
+        descriptor.profiler->end_scope(command);
+
+    // recording time on the host, the GPU time of the build is reported by the profiler scope
+    auto time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    if (rebuild) {
+        stats.rebuilds++;
+        stats.rebuild_record_ms = time;
+    } else {
+        stats.refits++;
+        stats.refit_record_ms = time;
+    }
+}
+
+bool GPUSceneTlas::detect_changes(Universe& universe)
+{
+    auto view = universe.view<RayTracingInstance, WorldTransform>();
+
+    // instances are unchanged when every entity keeps its slot and blas, and none was removed
+    bool changed = false;
+    uint count   = 0;
+    view.each([&](Entity entity, RayTracingInstance& instance, WorldTransform&) {
+        count++;
+        auto it = indices.find(entity);
+        if (it == indices.end() || slots.at(it->second).blas.value != instance.blas.value)
+            changed = true;
+    });
+
+    if (!changed && count == slots.size())
+        return false;
+
+    slots.clear();
+    indices.clear();
+    view.each([&](Entity entity, RayTracingInstance& instance, WorldTransform&) {
+        indices[entity] = static_cast<uint>(slots.size());
+        slots.push_back(Slot{entity, instance.blas});
+    });
+    return true;
+}
+
+void GPUSceneTlas::reserve(uint count)
+{
+    uint size = std::max({capacity, descriptor.capacity, 1u});
+    while (size < count)
+        size *= 2;
+
+    // the previous tlas is released once the frames using it complete
+    if (tlas.valid())
+        tlas.destroy();
+
+    tlas = execute([&]() {
+        auto desc          = GPUTlasDescriptor{};
+        desc.label         = "scene_tlas";
+        desc.max_instances = size;
+        desc.flags         = GPUBVHFlag::PREFER_FAST_TRACE;
+        desc.update_mode   = GPUBVHUpdateMode::PREFER_UPDATE;
+        return RHI::get_current_device().create_tlas(desc);
+    });
+    capacity = size;
+
+    // scratch memory covers both rebuilds and refits
+    auto sizes = tlas.get_sizes();
+    auto bytes = GPUSize64(std::max(sizes.build_size, sizes.update_size));
+    if (scratch.valid() && scratch.size >= bytes)
+        return;
+
+    if (scratch.valid())
+        scratch.destroy();
+
+    scratch = execute([&]() {
+        auto desc            = GPUBufferDescriptor{};
+        desc.label           = "scene_tlas_scratch";
+        desc.size            = bytes;
+        desc.usage           = GPUBufferUsage::STORAGE;
+        desc.virtual_address = true;
+        return RHI::get_current_device().create_buffer(desc);
+    });
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_SCENE_TLAS_H
+#define LYRA_LIBRARY_GPU_SCENE_TLAS_H
+
+#include <Lyra/Common/Container.h>
+#include <Lyra/Scenes/Scene.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+#include <Lyra/Render/RPI/GPUProfiler.h>
+
+namespace lyra
+{
+    // places a blas in the scene tlas, the instance follows the world transform of its entity
+    struct RayTracingInstance
+    {
+        GPUBlasHandle blas;
+        uint32_t      custom_data = 0;
+        uint8_t       mask        = 0xFF;
+    };
+
+    struct GPUSceneTlasDescriptor
+    {
+        uint         capacity = 256;     // initial instance capacity, the tlas is recreated with twice the capacity when full
+        GPUProfiler* profiler = nullptr; // optional, GPU time of builds is measured as "tlas_refit" or "tlas_rebuild" scopes
+    };
+
+    struct GPUSceneTlasStats
+    {
+        uint   instances         = 0;   // instances in the tlas
+        uint   written           = 0;   // instance records written by the last update
+        uint   refits            = 0;   // number of in place refits
+        uint   rebuilds          = 0;   // number of full rebuilds
+        double refit_record_ms   = 0.0; // host time spent in the last refit update, change detection included
+        double rebuild_record_ms = 0.0; // host time spent in the last rebuild update, change detection included
+    };
+
+    // Scene tlas kept in sync with the entities carrying a RayTracingInstance.
+    //
+    // Instance records live in the persistent instance buffer of the tlas. Each update only rewrites
+    // the records of entities whose WorldTransform is dirty, and refits the tlas in place.
+    // When instances are added, removed or change their blas, all records are rewritten and the tlas is rebuilt.
+    //
+    // Dirty flags are read, not cleared, the owner of the transforms clears them once per frame.
+    struct GPUSceneTlas
+    {
+    public:
+        explicit GPUSceneTlas(const GPUSceneTlasDescriptor& descriptor);
+        explicit GPUSceneTlas(GPUSceneTlas&&)      = delete;
+        explicit GPUSceneTlas(const GPUSceneTlas&) = delete;
+        virtual ~GPUSceneTlas();
+
+        // records instance writes and the tlas build, must be recorded outside of render passes
+        void update(const GPUCommandBuffer& command, Universe& universe);
+
+        // the tlas changes when it outgrows its capacity
+        auto get_tlas() const -> GPUTlas { return tlas; }
+
+        auto get_stats() const -> GPUSceneTlasStats { return stats; }
+
+    private:
+        struct Slot
+        {
+            Entity        entity = entt::null;
+            GPUBlasHandle blas   = {};
+        };
+
+        bool detect_changes(Universe& universe);
+        void reserve(uint count);
+
+    private:
+        GPUSceneTlasDescriptor descriptor;
+        GPUSceneTlasStats      stats;
+        GPUTlas                tlas;
+        GPUBuffer              scratch;
+        Vector<Slot>           slots;   // entity of each instance index
+        HashMap<Entity, uint>  indices; // instance index of each entity
+        uint                   capacity = 0;
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_SCENE_TLAS_H
@@ -0,0 +1,118 @@
+#include <cassert>
+#include <algorithm>
+#include <Lyra/Render/RPI/GPUUniformAllocator.h>
+
+using namespace lyra;
+
+GPUUniformAllocator::GPUUniformAllocator(const GPUUniformAllocatorDescriptor& descriptor) : descriptor(descriptor)
+{
+    auto& adapter = RHI::get_current_adapter();
+
+    // dynamic offsets must be multiples of the device alignment
+    alignment = std::max(GPUSize64(adapter.limits.min_uniform_buffer_offset_alignment), GPUSize64(1));
+
+    // every page must hold at least one bound range
+    this->descriptor.range     = std::min(this->descriptor.range, GPUSize64(adapter.limits.max_uniform_buffer_binding_size));
+    this->descriptor.page_size = std::max(this->descriptor.page_size, this->descriptor.range);
+
+    auto slot = RHI::get_frame_slot();
+    frames.resize(slot.count);
+    current = slot.index;
+}
+
+GPUUniformAllocator::~GPUUniformAllocator()
+{
+    for (auto& frame : frames)
+        for (auto& page : frame.pages)
+            if (page.buffer.valid())
+                page.buffer.destroy();
+}
+
+void GPUUniformAllocator::new_frame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // frame slots are added when a surface with more frames is created
+    auto slot = RHI::get_frame_slot();
+    if (frames.size() < slot.count)
+        frames.resize(slot.count);
+    current = slot.index;
+
+    // the previous frame of this slot has completed, its pages are no longer read by GPU,
+    // bind groups are recycled by the RHI every frame, hence they are recreated on demand.
+    auto& frame   = frames.at(current);
+    frame.current = 0;
+    for (auto& page : frame.pages) {
+        page.bind_group = GPUBindGroup{};
+        page.head       = 0;
+    }
+}
+
+auto GPUUniformAllocator::allocate(GPUSize64 size) -> GPUUniformAllocation
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    assert(size <= descriptor.range && "uniform allocation exceeds the bound range!");
+
+    auto& frame = frames.at(current);
+
+    // the bound range starting at the offset must stay within the page
+    auto fits = [&](const Page& page) {
+        GPUSize64 offset = (page.head + alignment - 1) / alignment * alignment;
+        return offset + descriptor.range <= descriptor.page_size;
+    };
+
+    while (frame.current < frame.pages.size() && !fits(frame.pages.at(frame.current)))
+        frame.current++;
+
+    if (frame.current == frame.pages.size())
+        frame.pages.push_back(create_page());
+
+    auto& page = frame.pages.at(frame.current);
+
+    // one bind group per page, reused across all draws via dynamic offsets
+    if (!page.bind_group.valid()) {
+        page.bind_group = execute([&]() {
+            auto entry          = GPUBindGroupEntry{};
+            entry.type          = GPUBindingResourceType::BUFFER;
+            entry.binding       = descriptor.binding;
+            entry.buffer.buffer = page.buffer;
+            entry.buffer.offset = 0;
+            entry.buffer.size   = descriptor.range;
+
+            auto desc    = GPUBindGroupDescriptor{};
+            desc.label   = "uniform_allocator_bind_group";
+            desc.layout  = descriptor.layout;
+            desc.entries = entry;
+            return RHI::get_current_device().create_bind_group(desc);
+        });
+    }
+
+    GPUSize64 offset = (page.head + alignment - 1) / alignment * alignment;
+    page.head        = offset + size;
+
+    auto allocation       = GPUUniformAllocation{};
+    allocation.bind_group = page.bind_group;
+    allocation.offset     = static_cast<GPUBufferDynamicOffset>(offset);
+    allocation.data       = page.mapped + offset;
+    return allocation;
+}
+
+auto GPUUniformAllocator::create_page() -> Page
+{
+    auto& device = RHI::get_current_device();
+
+    auto page   = Page{};
+    page.buffer = execute([&]() {
+        auto desc               = GPUBufferDescriptor{};
+        desc.label              = "uniform_allocator_page";
+        desc.size               = descriptor.page_size;
+        desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+        desc.mapped_at_creation = true;
+        return device.create_buffer(desc);
+    });
+
+    // pages stay persistently mapped
+    page.mapped = page.buffer.get_mapped_range().data;
+    return page;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#ifndef LYRA_LIBRARY_GPU_UNIFORM_ALLOCATOR_H
+#define LYRA_LIBRARY_GPU_UNIFORM_ALLOCATOR_H
+
+#include <mutex>
+#include <cstring>
+#include <Lyra/Common/Container.h>
+#include <Lyra/Render/RHI/RHIDescs.h>
+#include <Lyra/Render/RHI/RHITypes.h>
+
+namespace lyra
+{
+    struct GPUUniformAllocatorDescriptor
+    {
+        GPUBindGroupLayoutHandle layout;             // layout with a single dynamic uniform buffer
+        GPUIndex32               binding   = 0;      // binding index of the dynamic uniform buffer
+        GPUSize64                range     = 256;    // bound size of the uniform buffer, the largest allocation
+        GPUSize64                page_size = 262144; // size of each uniform buffer
+    };
+
+    struct GPUUniformAllocation
+    {
+        GPUBindGroup           bind_group;       // shared by all allocations from the same page in a frame
+        GPUBufferDynamicOffset offset = 0;       // dynamic offset to bind the bind group with
+        BufferSource           data   = nullptr; // mapped pointer to the start of this allocation
+
+        template <typename T>
+        auto as() const -> T* { return reinterpret_cast<T*>(data); }
+    };
+
+    // Per-frame linear allocator for per-draw uniforms.
+    // Uniforms are packed into persistently mapped pages, each page owns a bind group per frame,
+    // hence per-draw data costs a memcpy and a dynamic offset instead of a new bind group.
+    // Pages are owned by the RHI frame slot (see RHI::get_frame_slot()), they are reused
+    // only once the previous frame of the slot has completed, whatever the frame pacing.
+    struct GPUUniformAllocator
+    {
+    public:
+        explicit GPUUniformAllocator(const GPUUniformAllocatorDescriptor& descriptor);
+        explicit GPUUniformAllocator(GPUUniformAllocator&&)      = delete;
+        explicit GPUUniformAllocator(const GPUUniformAllocator&) = delete;
+        virtual ~GPUUniformAllocator();
+
+        // call once per frame, after RHI::new_frame()
+        void new_frame();
+
+        // allocations are only valid until the current frame completes on GPU
+        auto allocate(GPUSize64 size) -> GPUUniformAllocation;
+
+        template <typename T>
+        auto allocate(const T& value) -> GPUUniformAllocation
+        {
+            auto allocation = allocate(sizeof(T));
+            std::memcpy(allocation.data, &value, sizeof(T));
+            return allocation;
+        }
+
+    private:
+        struct Page
+        {
+            GPUBuffer    buffer;
+            GPUBindGroup bind_group; // created on first use within a frame
+            BufferSource mapped = nullptr;
+            GPUSize64    head   = 0;
+        };
+
+        struct Frame
+        {
+            Vector<Page> pages   = {};
+            uint         current = 0; // page currently allocated from
+        };
+
+        auto create_page() -> Page;
+
+    private:
+        GPUUniformAllocatorDescriptor descriptor;
+        Vector<Frame>                 frames;    // per RHI frame slot
+        GPUSize64                     alignment = 256;
+        uint                          current   = 0; // frame slot of the current frame
+        std::mutex                    mutex;
+    };
+
+} // namespace lyra
+
+#endif // LYRA_LIBRARY_GPU_UNIFORM_ALLOCATOR_H
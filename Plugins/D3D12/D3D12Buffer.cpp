@@ -1,4 +1,5 @@
 // reference: https://alain.xyz/blog/raw-directx12
+#include <algorithm>
 #include "D3D12Utils.h"
 
 D3D12Buffer::D3D12Buffer()
@@ -81,3 +82,205 @@ void D3D12Buffer::unmap()
         mapped_size = 0ull;
     }
 }
+
+void D3D12UploadRing::reset()
+{
+    auto rhi = get_rhi();
+
+    // the frame has completed on GPU, outgrown buffers are no longer referenced
+    for (auto& handle : retired)
+        rhi->buffers.remove(handle.value);
+
+    retired.clear();
+    head = 0ull;
+}
+
+void D3D12UploadRing::destroy()
+{
+    auto rhi = get_rhi();
+
+    for (auto& handle : retired)
+        rhi->buffers.remove(handle.value);
+
+    if (buffer.valid())
+        rhi->buffers.remove(buffer.value);
+
+    retired.clear();
+    buffer.reset();
+    mapped   = nullptr;
+    capacity = 0ull;
+    head     = 0ull;
+}
+
+void D3D12UploadRing::grow(GPUSize64 size)
+{
+    auto rhi = get_rhi();
+
+    // keep the current buffer alive until the frame completes
+    if (buffer.valid())
+        retired.push_back(buffer);
+
+    // grow geometrically, so that the ring settles after a few frames
+    capacity = std::max(capacity * 2, rhi->upload_ring_size);
+    while (capacity < size)
+        capacity *= 2;
+
+    // upload heap memory can be consumed directly as uniforms and geometry
+    auto usages = GPUBufferUsage::MAP_WRITE | GPUBufferUsage::COPY_SRC | GPUBufferUsage::UNIFORM |
+                  GPUBufferUsage::VERTEX | GPUBufferUsage::INDEX;
+
+    auto desc               = GPUBufferDescriptor{};
+    desc.label              = "upload_ring";
+    desc.size               = capacity;
+    desc.usage              = usages;
+    desc.mapped_at_creation = true;
+
+    auto obj = D3D12Buffer(desc);
+    mapped   = obj.mapped_data;
+    buffer   = GPUBufferHandle(rhi->buffers.add(obj));
+    head     = 0ull;
+}
+
+GPUTransientAllocation D3D12UploadRing::allocate(GPUSize64 size, GPUSize64 alignment)
+{
+    alignment = std::max(alignment, GPUSize64(1));
+
+    GPUSize64 offset = (head + alignment - 1) / alignment * alignment;
+    if (!buffer.valid() || offset + size > capacity) {
+        grow(size);
+        offset = 0ull;
+    }
+
+    head = offset + size;
+
+    auto allocation   = GPUTransientAllocation{};
+    allocation.buffer = buffer;
+    allocation.offset = offset;
+    allocation.size   = size;
+    allocation.data   = mapped + offset;
+    return allocation;
+}
+
+bool api::allocate_transient(GPUSize64 size, GPUSize64 alignment, GPUTransientAllocation& allocation)
+{
+    auto rhi   = get_rhi();
+    allocation = rhi->current_frame().upload_ring.allocate(size, alignment);
+    return true;
+}
+
+Vector<GPUMemoryHeapStats> D3D12MemoryBudget::heaps(bool detailed) const
+{
+    auto rhi = get_rhi();
+
+    // D3D12 reports budgets per memory segment group (local, non-local)
+    D3D12MA::Budget budgets[2] = {};
+    rhi->allocator->GetBudget(&budgets[0], &budgets[1]);
+
+    // full statistics walk through all blocks, skipped for per-frame budget checks
+    auto total = D3D12MA::TotalStatistics{};
+    if (detailed)
+        rhi->allocator->CalculateStatistics(&total);
+
+    Vector<GPUMemoryHeapStats> heaps(2);
+    for (uint i = 0; i < 2; i++) {
+        auto& heap            = heaps.at(i);
+        heap.device_local     = i == 0;
+        heap.budget           = budgets[i].BudgetBytes;
+        heap.usage            = budgets[i].UsageBytes;
+        heap.block_count      = budgets[i].Stats.BlockCount;
+        heap.block_bytes      = budgets[i].Stats.BlockBytes;
+        heap.allocation_count = budgets[i].Stats.AllocationCount;
+        heap.allocation_bytes = budgets[i].Stats.AllocationBytes;
+
+        if (detailed && total.MemorySegmentGroup[i].UnusedRangeCount)
+            heap.largest_unused_range = total.MemorySegmentGroup[i].UnusedRangeSizeMax;
+    }
+    return heaps;
+}
+
+void D3D12MemoryBudget::check()
+{
+    if (!callback)
+        return;
+
+    auto stats = heaps(false);
+    exceeded.resize(stats.size(), false);
+
+    for (uint i = 0; i < stats.size(); i++) {
+        auto& heap = stats.at(i);
+        bool  over = heap.budget != 0 && static_cast<float>(heap.usage) > threshold * static_cast<float>(heap.budget);
+        if (over && !exceeded.at(i))
+            callback(i, heap);
+        exceeded.at(i) = over;
+    }
+}
+
+bool api::get_memory_stats(GPUMemoryStats& stats)
+{
+    auto rhi    = get_rhi();
+    stats.heaps = rhi->budget.heaps(true);
+
+    for (auto& heap : stats.heaps)
+        stats.largest_unused_range = std::max(stats.largest_unused_range, heap.largest_unused_range);
+
+    stats.buffer_count    = static_cast<uint>(rhi->buffers.size());
+    stats.texture_count   = static_cast<uint>(rhi->textures.size());
+    stats.view_count      = static_cast<uint>(rhi->views.size());
+    stats.sampler_count   = static_cast<uint>(rhi->samplers.size());
+    stats.shader_count    = static_cast<uint>(rhi->shaders.size());
+    stats.pipeline_count  = static_cast<uint>(rhi->pipelines.size());
+    stats.blas_count      = static_cast<uint>(rhi->blases.size());
+    stats.tlas_count      = static_cast<uint>(rhi->tlases.size());
+    stats.query_set_count = static_cast<uint>(rhi->query_sets.size());
+    return true;
+}
+
+bool api::get_memory_pool_stats(GPUMemoryPool pool, GPUMemoryPoolStats& stats)
+{
+    // NOTE: buffers are not sub-allocated from custom pools on this backend,
+    // each pool reports the D3D12MA statistics of the heap type its buffers are placed in.
+    // uniform buffers share the default heap with device buffers.
+    auto heap_type = D3D12_HEAP_TYPE_DEFAULT;
+    switch (pool) {
+        case GPUMemoryPool::UPLOAD:
+            heap_type = D3D12_HEAP_TYPE_UPLOAD;
+            break;
+        case GPUMemoryPool::READBACK:
+            heap_type = D3D12_HEAP_TYPE_READBACK;
+            break;
+        default:
+            break;
+    }
+
+    auto total = D3D12MA::TotalStatistics{};
+    get_rhi()->allocator->CalculateStatistics(&total);
+
+    // D3D12MA indexes heap types from D3D12_HEAP_TYPE_DEFAULT = 1
+    auto& detailed = total.HeapType[heap_type - D3D12_HEAP_TYPE_DEFAULT];
+
+    stats                      = GPUMemoryPoolStats{};
+    stats.block_count          = detailed.Stats.BlockCount;
+    stats.block_bytes          = detailed.Stats.BlockBytes;
+    stats.allocation_count     = detailed.Stats.AllocationCount;
+    stats.allocation_bytes     = detailed.Stats.AllocationBytes;
+    stats.unused_range_count   = detailed.UnusedRangeCount;
+    stats.largest_unused_range = detailed.UnusedRangeCount ? detailed.UnusedRangeSizeMax : 0;
+
+    if (stats.block_bytes != 0)
+        stats.utilization = static_cast<float>(stats.allocation_bytes) / static_cast<float>(stats.block_bytes);
+
+    // fragmentation is zero when all free space is a single contiguous range
+    GPUSize64 unused_bytes = stats.block_bytes - stats.allocation_bytes;
+    if (unused_bytes != 0)
+        stats.fragmentation = 1.0f - static_cast<float>(stats.largest_unused_range) / static_cast<float>(unused_bytes);
+
+    return true;
+}
+
+void api::set_memory_budget_callback(float threshold, const GPUMemoryBudgetCallback& callback)
+{
+    auto rhi              = get_rhi();
+    rhi->budget.threshold = threshold;
+    rhi->budget.callback  = callback;
+    rhi->budget.exceeded.clear();
+}
@@ -1,4 +1,5 @@
 // reference: https://alain.xyz/blog/raw-directx12
+#include <cstring>
 #include "D3D12Utils.h"
 
 void D3D12CommandBuffer::wait(const D3D12Fence& fence, GPUBarrierSyncFlags)
@@ -43,6 +44,7 @@ void D3D12CommandBuffer::reset()
     // clear fences
     wait_fences.clear();
     signal_fences.clear();
+    upload_value = 0ull;
 
     // clear bound pso
     pso.pipeline = nullptr;
@@ -215,6 +217,19 @@ void cmd::end_render_pass(GPUCommandEncoderHandle cmdbuffer)
     command_list->EndRenderPass();
 }
 
+void cmd::execute_bundles(GPUCommandEncoderHandle cmdbuffer, GPUCommandEncoderHandles bundles)
+{
+    auto  rhi = get_rhi();
+    auto& frm = rhi->current_frame();
+    auto& cmd = frm.command(cmdbuffer);
+
+    for (auto& bundle : bundles)
+        cmd.command_buffer->ExecuteBundle(frm.command(bundle).command_buffer);
+
+    // pipeline state set by bundles does not carry over
+    cmd.pso.pipeline = nullptr;
+}
+
 void cmd::set_render_pipeline(GPUCommandEncoderHandle cmdbuffer, GPURenderPipelineHandle pipeline)
 {
     auto  rhi = get_rhi();
@@ -410,6 +425,34 @@ void cmd::draw_indexed_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHand
     cmd.command_buffer->ExecuteIndirect(lay->signatures.draw_indexed_indirect.Get(), draw_count, buf.buffer, indirect_offset, nullptr, 0);
 }
 
+void cmd::draw_indirect_count(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count)
+{
+    auto  rhi = get_rhi();
+    auto& frm = rhi->current_frame();
+    auto& cmd = frm.command(cmdbuffer);
+    auto& buf = fetch_resource(rhi->buffers, indirect_buffer);
+    auto& cnt = fetch_resource(rhi->buffers, count_buffer);
+    auto* lay = cmd.pso.layout;
+
+    // indirect draw instanced, draw count is read from the count buffer
+    lay->create_draw_indirect_signature();
+    cmd.command_buffer->ExecuteIndirect(lay->signatures.draw_indirect.Get(), max_draw_count, buf.buffer, indirect_offset, cnt.buffer, count_offset);
+}
+
+void cmd::draw_indexed_indirect_count(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count)
+{
+    auto  rhi = get_rhi();
+    auto& frm = rhi->current_frame();
+    auto& cmd = frm.command(cmdbuffer);
+    auto& buf = fetch_resource(rhi->buffers, indirect_buffer);
+    auto& cnt = fetch_resource(rhi->buffers, count_buffer);
+    auto* lay = cmd.pso.layout;
+
+    // indirect draw indexed, draw count is read from the count buffer
+    lay->create_draw_indexed_indirect_signature();
+    cmd.command_buffer->ExecuteIndirect(lay->signatures.draw_indexed_indirect.Get(), max_draw_count, buf.buffer, indirect_offset, cnt.buffer, count_offset);
+}
+
 void cmd::dispatch_workgroups(GPUCommandEncoderHandle cmdbuffer, GPUSize32 x, GPUSize32 y, GPUSize32 z)
 {
     auto  rhi = get_rhi();
@@ -445,6 +488,15 @@ void cmd::copy_buffer_to_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHand
     cmd.command_buffer->CopyBufferRegion(dst.buffer, destination_offset, src.buffer, source_offset, size);
 }
 
+void cmd::update_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size)
+{
+    // NOTE: inline updates are staged in the transient upload ring of the frame
+    auto allocation = GPUTransientAllocation{};
+    api::allocate_transient(size, 16, allocation);
+    std::memcpy(allocation.data, data, size);
+    copy_buffer_to_buffer(cmdbuffer, allocation.buffer, allocation.offset, buffer, offset, size);
+}
+
 void cmd::copy_buffer_to_texture(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyBufferInfo& source, const GPUTexelCopyTextureInfo& destination, GPUExtent3D copy_size)
 {
     auto  rhi = get_rhi();
@@ -654,6 +706,18 @@ void cmd::write_timestamp(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle q
     assert(!!!"cmd::write_timestamp(...) is currently not implemented!");
 }
 
+void cmd::begin_pipeline_statistics_query(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index)
+{
+    // NOTE: No obvious way to support it now.
+    assert(!!!"cmd::begin_pipeline_statistics_query(...) is currently not implemented!");
+}
+
+void cmd::end_pipeline_statistics_query(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index)
+{
+    // NOTE: No obvious way to support it now.
+    assert(!!!"cmd::end_pipeline_statistics_query(...) is currently not implemented!");
+}
+
 void cmd::write_blas_properties(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index, GPUBlasHandle blas)
 {
     // NOTE: No obvious way to support it now.
@@ -764,6 +828,11 @@ void cmd::texture_barrier(GPUCommandEncoderHandle cmdbuffer, GPUTextureBarriers
     command_list->Barrier(1, &barrier_group);
 }
 
+void cmd::update_tlas_instances(GPUCommandEncoderHandle cmdbuffer, GPUTlasHandle tlas, GPUTlasInstanceUpdates updates)
+{
+    assert(!!!"cmd::update_tlas_instances(...) is currently not implemented!");
+}
+
 void cmd::build_tlases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUTlasBuildEntries entries)
 {
     assert(!!!"cmd::build_tlases(...) is currently not implemented!");
@@ -773,3 +842,13 @@ void cmd::build_blases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratc
 {
     assert(!!!"cmd::build_blases(...) is currently not implemented!");
 }
+
+void cmd::copy_blas(GPUCommandEncoderHandle cmdbuffer, GPUBlasHandle old_blas, GPUBlasHandle new_blas)
+{
+    assert(!!!"cmd::copy_blas(...) is currently not implemented!");
+}
+
+void cmd::defragment_memory(GPUCommandEncoderHandle cmdbuffer, const GPUDefragmentDescriptor& descriptor)
+{
+    // NOTE: defragmentation is opt-in, resources simply stay where they are on this backend
+}
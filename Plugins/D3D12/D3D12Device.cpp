@@ -1,4 +1,5 @@
 // reference: https://alain.xyz/blog/raw-directx12
+#include <algorithm>
 #include "D3D12Utils.h"
 
 bool api::create_device(const GPUDeviceDescriptor& desc)
@@ -45,9 +46,16 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
     rhi->sampler_heap.init(32, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, D3D12_DESCRIPTOR_HEAP_FLAG_NONE);
     rhi->cbv_srv_uav_heap.init(512, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, D3D12_DESCRIPTOR_HEAP_FLAG_NONE);
 
-    // create a default frame (for headless cases)
-    rhi->frames.emplace_back();
-    rhi->frames.back().init();
+    // transient upload rings are created lazily by each frame
+    rhi->upload_ring_size = desc.memory_pools.upload_ring_size;
+
+    // asynchronous uploads on the copy queue
+    rhi->uploads.init();
+
+    // create the default frames (for headless cases)
+    rhi->frames.resize(std::max(desc.frames, 1u));
+    for (auto& frame : rhi->frames)
+        frame.init();
 
     return true;
 }
@@ -62,63 +70,68 @@ void api::delete_device()
     for (auto& frame : rhi->frames)
         frame.destroy();
 
+    // clean up pending uploads and staging memory
+    rhi->uploads.destroy();
+
     // clean up remaining swapchains
-    for (auto& swapchain : rhi->swapchains.data)
+    for (auto& swapchain : rhi->swapchains)
         if (swapchain.valid())
             swapchain.destroy();
 
     // clean up remaining blases
-    for (auto& blas : rhi->blases.data)
+    for (auto& blas : rhi->blases)
         if (blas.valid())
             blas.destroy();
 
     // clean up remaining tlases
-    for (auto& tlas : rhi->tlases.data)
+    for (auto& tlas : rhi->tlases)
         if (tlas.valid())
             tlas.destroy();
 
     // clean up remaining fences
-    for (auto& fence : rhi->fences.data)
+    for (auto& fence : rhi->fences)
         if (fence.valid())
             fence.destroy();
 
     // clean up remaining buffers
-    for (auto& buffer : rhi->buffers.data)
+    for (auto& buffer : rhi->buffers)
         if (buffer.valid())
             buffer.destroy();
 
     // clean up remaining texture views
-    for (auto& view : rhi->views.data)
+    for (auto& view : rhi->views)
         if (view.valid())
             view.destroy();
 
     // clean up remaining textures
-    for (auto& texture : rhi->textures.data)
+    for (auto& texture : rhi->textures)
         if (texture.valid())
             texture.destroy();
 
     // clean up remaining samplers
-    for (auto& sampler : rhi->samplers.data)
+    rhi->sampler_cache.clear();
+    for (auto& sampler : rhi->samplers)
         if (sampler.valid())
             sampler.destroy();
 
     // clean up remaining shaders
-    for (auto& shader : rhi->shaders.data)
+    rhi->shader_cache.clear();
+    for (auto& shader : rhi->shaders)
         if (shader.valid())
             shader.destroy();
 
     // clean up remaining bind group layouts
-    for (auto& layout : rhi->bind_group_layouts.data)
+    for (auto& layout : rhi->bind_group_layouts)
         if (layout.valid())
             layout.destroy();
 
     // clean up remaining pipeline layouts
-    for (auto& layout : rhi->pipeline_layouts.data)
+    for (auto& layout : rhi->pipeline_layouts)
         if (layout.valid())
             layout.destroy();
 
     // clean up remaining pipelines
-    for (auto& pipeline : rhi->pipelines.data)
+    for (auto& pipeline : rhi->pipelines)
         if (pipeline.valid())
             pipeline.destroy();
 
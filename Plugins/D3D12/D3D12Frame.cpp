@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "D3D12Utils.h"
 
 constexpr uint MAX_SAMPLERS_HEAP_SIZE    = 2048u;
@@ -44,6 +45,9 @@ void D3D12Frame::reset()
     sampler_heap.reset();
     dynamic_heap.reset();
     allocated_descriptors.clear();
+
+    // recycle transient upload memory
+    upload_ring.reset();
 }
 
 void D3D12Frame::free()
@@ -87,6 +91,9 @@ void D3D12Frame::destroy()
     // destroy descriptor heap
     default_heap.destroy();
     sampler_heap.destroy();
+
+    // destroy transient upload memory
+    upload_ring.destroy();
 }
 
 GPUCommandEncoderHandle D3D12Frame::allocate(GPUQueueType type, bool primary)
@@ -165,3 +172,90 @@ GPUBindGroupHandle D3D12Frame::create(const GPUBindGroupDescriptor& desc)
     allocated_descriptors.push_back(descriptor);
     return GPUBindGroupHandle(handle);
 }
+
+void D3D12DeleteQueue::push(uint frame, Function<void()>&& release)
+{
+    entries.push_back(Entry{frame, std::move(release)});
+}
+
+void D3D12DeleteQueue::retire(uint completed_frame)
+{
+    // entries are pushed in frame order
+    while (!entries.empty() && entries.front().frame <= completed_frame) {
+        entries.front().release();
+        entries.pop_front();
+    }
+}
+
+void D3D12DeleteQueue::flush()
+{
+    for (auto& entry : entries)
+        entry.release();
+
+    entries.clear();
+}
+
+void D3D12MapQueue::push(Request&& request)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(std::move(request));
+}
+
+void D3D12MapQueue::retire(uint completed_frame)
+{
+    Vector<Request> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // requests are pushed in frame order
+        while (!requests.empty() && requests.front().frame <= completed_frame) {
+            ready.push_back(std::move(requests.front()));
+            requests.pop_front();
+        }
+    }
+    fulfill(ready, true);
+}
+
+void D3D12MapQueue::cancel(GPUBufferHandle buffer)
+{
+    Vector<Request> aborted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = std::remove_if(requests.begin(), requests.end(), [&](Request& request) {
+            if (request.buffer.value != buffer.value)
+                return false;
+            aborted.push_back(std::move(request));
+            return true;
+        });
+        requests.erase(it, requests.end());
+    }
+    fulfill(aborted, false);
+}
+
+void D3D12MapQueue::flush()
+{
+    Vector<Request> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& request : requests)
+            ready.push_back(std::move(request));
+        requests.clear();
+    }
+    fulfill(ready, true);
+}
+
+void D3D12MapQueue::fulfill(Vector<Request>& ready, bool success)
+{
+    auto rhi = get_rhi();
+
+    // callbacks run without the lock held, they are free to request another mapping
+    for (auto& request : ready) {
+        auto& buf       = fetch_resource(rhi->buffers, request.buffer);
+        buf.map_pending = false;
+        if (success)
+            buf.map(request.offset, request.size);
+        if (request.callback)
+            request.callback(request.buffer, success);
+    }
+}
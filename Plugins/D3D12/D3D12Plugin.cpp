@@ -63,7 +63,9 @@ bool api::create_buffer(GPUBufferHandle& buffer, const GPUBufferDescriptor& desc
 
 void api::delete_buffer(GPUBufferHandle buffer)
 {
-    get_rhi()->buffers.remove(buffer.value);
+    auto rhi = get_rhi();
+    rhi->maps.cancel(buffer);
+    defer_delete(rhi->buffers, buffer);
 }
 
 void api::map_buffer(GPUBufferHandle buffer, GPUMapMode, GPUSize64 offset, GPUSize64 size)
@@ -73,10 +75,34 @@ void api::map_buffer(GPUBufferHandle buffer, GPUMapMode, GPUSize64 offset, GPUSi
     buf.map(offset, size);
 }
 
+void api::map_buffer_async(GPUBufferHandle buffer, GPUMapMode, GPUSize64 offset, GPUSize64 size, const GPUBufferMapCallback& callback)
+{
+    auto  rhi = get_rhi();
+    auto& buf = fetch_resource(rhi->buffers, buffer);
+    assert(!buf.mapped() && !buf.map_pending && "buffer is already mapped or pending!");
+    buf.map_pending = true;
+
+    // GPU writes submitted up to this frame are complete once this frame retires
+    auto request     = D3D12MapQueue::Request{};
+    request.frame    = rhi->current_frame_index;
+    request.buffer   = buffer;
+    request.offset   = offset;
+    request.size     = size;
+    request.callback = callback;
+    rhi->maps.push(std::move(request));
+}
+
 void api::unmap_buffer(GPUBufferHandle buffer)
 {
     auto  rhi = get_rhi();
     auto& buf = fetch_resource(rhi->buffers, buffer);
+
+    // unmapping a pending buffer aborts the request
+    if (buf.map_pending) {
+        rhi->maps.cancel(buffer);
+        return;
+    }
+
     buf.unmap();
     buf.mapped_size = 0;
 }
@@ -85,7 +111,7 @@ void api::get_mapped_state(GPUBufferHandle buffer, GPUMapState& state)
 {
     auto  rhi = get_rhi();
     auto& buf = fetch_resource(rhi->buffers, buffer);
-    state     = buf.mapped() ? GPUMapState::MAPPED : GPUMapState::UNMAPPED;
+    state     = buf.map_pending ? GPUMapState::PENDING : buf.mapped() ? GPUMapState::MAPPED : GPUMapState::UNMAPPED;
 }
 
 void api::get_mapped_range(GPUBufferHandle buffer, MappedBufferRange& range)
@@ -98,17 +124,16 @@ void api::get_mapped_range(GPUBufferHandle buffer, MappedBufferRange& range)
 
 bool api::create_sampler(GPUSamplerHandle& sampler, const GPUSamplerDescriptor& desc)
 {
-    auto obj = D3D12Sampler(desc);
-    auto rhi = get_rhi();
-    auto ind = rhi->samplers.add(obj);
-
-    sampler = GPUSamplerHandle(ind);
+    // identical samplers share the same handle
+    sampler = get_rhi()->sampler_cache.acquire(desc);
     return true;
 }
 
 void api::delete_sampler(GPUSamplerHandle sampler)
 {
-    get_rhi()->samplers.remove(sampler.value);
+    auto rhi = get_rhi();
+    if (rhi->sampler_cache.release(sampler))
+        defer_delete(rhi->samplers, sampler);
 }
 
 bool api::create_texture(GPUTextureHandle& texture, const GPUTextureDescriptor& desc)
@@ -123,7 +148,7 @@ bool api::create_texture(GPUTextureHandle& texture, const GPUTextureDescriptor&
 
 void api::delete_texture(GPUTextureHandle handle)
 {
-    get_rhi()->textures.remove(handle.value);
+    defer_delete(get_rhi()->textures, handle);
 }
 
 bool api::create_texture_view(GPUTextureViewHandle& handle, GPUTextureHandle texture, const GPUTextureViewDescriptor& desc)
@@ -139,22 +164,27 @@ bool api::create_texture_view(GPUTextureViewHandle& handle, GPUTextureHandle tex
 
 void api::delete_texture_view(GPUTextureViewHandle handle)
 {
-    get_rhi()->views.remove(handle.value);
+    defer_delete(get_rhi()->views, handle);
 }
 
 bool api::create_shader_module(GPUShaderModuleHandle& shader, const GPUShaderModuleDescriptor& desc)
 {
-    auto obj = D3D12Shader(desc);
-    auto rhi = get_rhi();
-    auto ind = rhi->shaders.add(obj);
-
-    shader = GPUShaderModuleHandle(ind);
+    // identical binaries share the same handle
+    shader = get_rhi()->shader_cache.acquire(desc);
     return true;
 }
 
 void api::delete_shader_module(GPUShaderModuleHandle shader)
 {
-    get_rhi()->shaders.remove(shader.value);
+    auto rhi = get_rhi();
+    if (rhi->shader_cache.release(shader))
+        defer_delete(rhi->shaders, shader);
+}
+
+bool api::get_shader_module_hash(GPUShaderModuleHandle shader, GPUSize64& hash)
+{
+    hash = fetch_resource(get_rhi()->shaders, shader).hash;
+    return true;
 }
 
 bool api::create_fence(GPUFenceHandle& fence)
@@ -169,7 +199,7 @@ bool api::create_fence(GPUFenceHandle& fence)
 
 void api::delete_fence(GPUFenceHandle fence)
 {
-    get_rhi()->fences.remove(fence.value);
+    defer_delete(get_rhi()->fences, fence);
 }
 
 bool api::create_blas(GPUBlasHandle& blas, const GPUBlasDescriptor& desc, GPUBlasGeometrySizeDescriptors sizes)
@@ -249,6 +279,11 @@ bool api::create_query_set(GPUQuerySetHandle& query_set, const GPUQuerySetDescri
     // return true;
 }
 
+void api::reset_query_set(GPUQuerySetHandle query_set, GPUSize32 first_query, GPUSize32 query_count)
+{
+    // NOTE: D3D12 queries do not need to be reset before reuse.
+}
+
 void api::delete_query_set(GPUQuerySetHandle query_set)
 {
     assert(!!!"api::delete_query_set(...) is not implemented!");
@@ -268,7 +303,7 @@ bool api::create_bind_group_layout(GPUBindGroupLayoutHandle& layout, const GPUBi
 
 void api::delete_bind_group_layout(GPUBindGroupLayoutHandle layout)
 {
-    get_rhi()->bind_group_layouts.remove(layout.value);
+    defer_delete(get_rhi()->bind_group_layouts, layout);
 }
 
 bool api::create_pipeline_layout(GPUPipelineLayoutHandle& layout, const GPUPipelineLayoutDescriptor& desc)
@@ -283,7 +318,7 @@ bool api::create_pipeline_layout(GPUPipelineLayoutHandle& layout, const GPUPipel
 
 void api::delete_pipeline_layout(GPUPipelineLayoutHandle layout)
 {
-    get_rhi()->pipeline_layouts.remove(layout.value);
+    defer_delete(get_rhi()->pipeline_layouts, layout);
 }
 
 bool api::create_render_pipeline(GPURenderPipelineHandle& pipeline, const GPURenderPipelineDescriptor& desc)
@@ -298,7 +333,7 @@ bool api::create_render_pipeline(GPURenderPipelineHandle& pipeline, const GPURen
 
 void api::delete_render_pipeline(GPURenderPipelineHandle pipeline)
 {
-    get_rhi()->pipelines.remove(pipeline.value);
+    defer_delete(get_rhi()->pipelines, pipeline);
 }
 
 bool api::create_compute_pipeline(GPUComputePipelineHandle& pipeline, const GPUComputePipelineDescriptor& desc)
@@ -313,7 +348,7 @@ bool api::create_compute_pipeline(GPUComputePipelineHandle& pipeline, const GPUC
 
 void api::delete_compute_pipeline(GPUComputePipelineHandle pipeline)
 {
-    get_rhi()->pipelines.remove(pipeline.value);
+    defer_delete(get_rhi()->pipelines, pipeline);
 }
 
 bool api::create_raytracing_pipeline(GPURayTracingPipelineHandle& handle, const GPURayTracingPipelineDescriptor& desc)
@@ -328,7 +363,26 @@ bool api::create_raytracing_pipeline(GPURayTracingPipelineHandle& handle, const
 
 void api::delete_raytracing_pipeline(GPURayTracingPipelineHandle pipeline)
 {
-    get_rhi()->pipelines.remove(pipeline.value);
+    defer_delete(get_rhi()->pipelines, pipeline);
+}
+
+bool api::get_render_pipeline_status(GPURenderPipelineHandle pipeline, GPUPipelineStatus& status)
+{
+    // NOTE: asynchronous compilation is not implemented, pipelines are always created synchronously.
+    status = GPUPipelineStatus::READY;
+    return true;
+}
+
+bool api::get_compute_pipeline_status(GPUComputePipelineHandle pipeline, GPUPipelineStatus& status)
+{
+    // NOTE: asynchronous compilation is not implemented, pipelines are always created synchronously.
+    status = GPUPipelineStatus::READY;
+    return true;
+}
+
+void api::wait_pipelines()
+{
+    // do nothing
 }
 
 bool api::create_bind_group(GPUBindGroupHandle& bind_group, const GPUBindGroupDescriptor& desc)
@@ -345,6 +399,16 @@ bool api::create_command_buffer(GPUCommandEncoderHandle& cmdbuffer, const GPUCom
     auto& frm = rhi->current_frame();
     cmdbuffer = frm.allocate(descriptor.queue, true);
     frm.command(cmdbuffer).begin();
+
+    // NOTE: No obvious way to support tracked command buffers now, barriers must be explicit.
+    assert(!descriptor.tracked && "tracked command buffers are not supported by D3D12!");
+
+    // make completed uploads visible to graphics work without blocking
+    if (descriptor.queue == GPUQueueType::DEFAULT) {
+        rhi->uploads.retire();
+        if (rhi->uploads.completed_value > frm.command(cmdbuffer).upload_value)
+            rhi->uploads.acquire(frm.command(cmdbuffer), rhi->uploads.completed_value);
+    }
     return true;
 }
 
@@ -367,11 +431,49 @@ bool api::submit_command_buffer(GPUCommandEncoderHandle cmdbuffer)
     return true;
 }
 
+bool api::finish_command_bundle(GPUCommandEncoderHandle cmdbuffer)
+{
+    auto rhi = get_rhi();
+    rhi->current_frame().command(cmdbuffer).end();
+    return true;
+}
+
+bool api::get_command_stats(GPUCommandStats& stats)
+{
+    // NOTE: No redundant state tracking on D3D12 yet, nothing is dropped.
+    stats = GPUCommandStats{};
+    return true;
+}
+
+bool api::get_shader_module_stats(GPUShaderModuleStats& stats)
+{
+    get_rhi()->shader_cache.stats(stats);
+    return true;
+}
+
+bool api::get_staging_stats(GPUStagingStats& stats)
+{
+    // NOTE: inline updates use the transient upload ring, there is no staging pool to report
+    stats = GPUStagingStats{};
+    return true;
+}
+
+bool api::get_defragment_stats(GPUDefragmentStats& stats)
+{
+    // NOTE: defragmentation passes do not move resources on this backend
+    stats = GPUDefragmentStats{};
+    return true;
+}
+
 void api::wait_idle()
 {
     auto rhi = get_rhi();
     rhi->wait_idle();
 
+    // nothing is in flight, release all deferred deletions and pending mappings
+    rhi->deletes.flush();
+    rhi->maps.flush();
+
     // clean up all pools from all frames
     for (auto& frame : rhi->frames) {
         frame.wait();
@@ -392,6 +494,11 @@ void api::wait_fence(GPUFenceHandle handle)
     fetch_resource(rhi->fences, handle).wait();
 }
 
+void api::flush_submissions()
+{
+    // NOTE: command lists are executed as soon as they are submitted, there is nothing to flush
+}
+
 LYRA_EXPORT auto prepare() -> void
 {
     // do nothing
@@ -405,96 +512,134 @@ LYRA_EXPORT auto cleanup() -> void
 LYRA_EXPORT auto create() -> RenderAPI
 {
     auto api                             = RenderAPI{};
-    api.get_api_name                     = get_api_name;
-    api.create_instance                  = api::create_instance;
-    api.delete_instance                  = api::delete_instance;
-    api.create_adapter                   = api::create_adapter;
-    api.delete_adapter                   = api::delete_adapter;
-    api.create_device                    = api::create_device;
-    api.delete_device                    = api::delete_device;
-    api.create_surface                   = api::create_surface;
-    api.delete_surface                   = api::delete_surface;
-    api.get_surface_extent               = api::get_surface_extent;
-    api.get_surface_format               = api::get_surface_format;
-    api.get_surface_frames               = api::get_surface_frames;
-    api.create_buffer                    = api::create_buffer;
-    api.delete_buffer                    = api::delete_buffer;
-    api.create_texture                   = api::create_texture;
-    api.delete_texture                   = api::delete_texture;
-    api.create_texture_view              = api::create_texture_view;
-    api.delete_texture_view              = api::delete_texture_view;
-    api.create_sampler                   = api::create_sampler;
-    api.delete_sampler                   = api::delete_sampler;
-    api.create_fence                     = api::create_fence;
-    api.delete_fence                     = api::delete_fence;
-    api.create_shader_module             = api::create_shader_module;
-    api.delete_shader_module             = api::delete_shader_module;
-    api.create_blas                      = api::create_blas;
-    api.delete_blas                      = api::delete_blas;
-    api.create_tlas                      = api::create_tlas;
-    api.delete_tlas                      = api::delete_tlas;
-    api.create_pipeline_layout           = api::create_pipeline_layout;
-    api.delete_pipeline_layout           = api::delete_pipeline_layout;
-    api.create_render_pipeline           = api::create_render_pipeline;
-    api.delete_render_pipeline           = api::delete_render_pipeline;
-    api.create_compute_pipeline          = api::create_compute_pipeline;
-    api.delete_compute_pipeline          = api::delete_compute_pipeline;
-    api.create_raytracing_pipeline       = api::create_raytracing_pipeline;
-    api.delete_raytracing_pipeline       = api::delete_raytracing_pipeline;
-    api.create_bind_group                = api::create_bind_group;
-    api.create_bind_group_layout         = api::create_bind_group_layout;
-    api.delete_bind_group_layout         = api::delete_bind_group_layout;
-    api.wait_idle                        = api::wait_idle;
-    api.wait_fence                       = api::wait_fence;
-    api.map_buffer                       = api::map_buffer;
-    api.unmap_buffer                     = api::unmap_buffer;
-    api.get_mapped_state                 = api::get_mapped_state;
-    api.get_mapped_range                 = api::get_mapped_range;
-    api.create_command_buffer            = api::create_command_buffer;
-    api.create_command_bundle            = api::create_command_bundle;
-    api.submit_command_buffer            = api::submit_command_buffer;
-    api.get_blas_sizes                   = api::get_blas_sizes;
-    api.get_tlas_sizes                   = api::get_tlas_sizes;
-    api.new_frame                        = api::new_frame;
-    api.end_frame                        = api::end_frame;
-    api.acquire_next_frame               = api::acquire_next_frame;
-    api.present_curr_frame               = api::present_curr_frame;
-    api.cmd_insert_debug_marker          = cmd::insert_debug_marker;
-    api.cmd_push_debug_group             = cmd::push_debug_group;
-    api.cmd_pop_debug_group              = cmd::pop_debug_group;
-    api.cmd_wait_fence                   = cmd::wait_fence;
-    api.cmd_signal_fence                 = cmd::signal_fence;
-    api.cmd_begin_render_pass            = cmd::begin_render_pass;
-    api.cmd_end_render_pass              = cmd::end_render_pass;
-    api.cmd_set_render_pipeline          = cmd::set_render_pipeline;
-    api.cmd_set_compute_pipeline         = cmd::set_compute_pipeline;
-    api.cmd_set_raytracing_pipeline      = cmd::set_raytracing_pipeline;
-    api.cmd_set_bind_group               = cmd::set_bind_group;
-    api.cmd_set_push_constants           = cmd::set_push_constants;
-    api.cmd_set_index_buffer             = cmd::set_index_buffer;
-    api.cmd_set_vertex_buffer            = cmd::set_vertex_buffer;
-    api.cmd_draw                         = cmd::draw;
-    api.cmd_draw_indexed                 = cmd::draw_indexed;
-    api.cmd_draw_indirect                = cmd::draw_indirect;
-    api.cmd_draw_indexed_indirect        = cmd::draw_indexed_indirect;
-    api.cmd_dispatch_workgroups          = cmd::dispatch_workgroups;
-    api.cmd_dispatch_workgroups_indirect = cmd::dispatch_workgroups_indirect;
-    api.cmd_copy_buffer_to_buffer        = cmd::copy_buffer_to_buffer;
-    api.cmd_copy_buffer_to_texture       = cmd::copy_buffer_to_texture;
-    api.cmd_copy_texture_to_buffer       = cmd::copy_texture_to_buffer;
-    api.cmd_copy_texture_to_texture      = cmd::copy_texture_to_texture;
-    api.cmd_clear_buffer                 = cmd::clear_buffer;
-    api.cmd_set_viewport                 = cmd::set_viewport;
-    api.cmd_set_scissor_rect             = cmd::set_scissor_rect;
-    api.cmd_set_blend_constant           = cmd::set_blend_constant;
-    api.cmd_set_stencil_reference        = cmd::set_stencil_reference;
-    api.cmd_begin_occlusion_query        = cmd::begin_occlusion_query;
-    api.cmd_end_occlusion_query          = cmd::end_occlusion_query;
-    api.cmd_write_timestamp              = cmd::write_timestamp;
-    api.cmd_write_blas_properties        = cmd::write_blas_properties;
-    api.cmd_resolve_query_set            = cmd::resolve_query_set;
-    api.cmd_memory_barrier               = cmd::memory_barrier;
-    api.cmd_buffer_barrier               = cmd::buffer_barrier;
-    api.cmd_texture_barrier              = cmd::texture_barrier;
+    api.get_api_name                        = get_api_name;
+    api.create_instance                     = api::create_instance;
+    api.delete_instance                     = api::delete_instance;
+    api.create_adapter                      = api::create_adapter;
+    api.delete_adapter                      = api::delete_adapter;
+    api.create_device                       = api::create_device;
+    api.delete_device                       = api::delete_device;
+    api.create_surface                      = api::create_surface;
+    api.delete_surface                      = api::delete_surface;
+    api.get_surface_extent                  = api::get_surface_extent;
+    api.get_surface_format                  = api::get_surface_format;
+    api.get_surface_frames                  = api::get_surface_frames;
+    api.create_buffer                       = api::create_buffer;
+    api.delete_buffer                       = api::delete_buffer;
+    api.create_texture                      = api::create_texture;
+    api.delete_texture                      = api::delete_texture;
+    api.create_texture_view                 = api::create_texture_view;
+    api.delete_texture_view                 = api::delete_texture_view;
+    api.create_sampler                      = api::create_sampler;
+    api.delete_sampler                      = api::delete_sampler;
+    api.create_fence                        = api::create_fence;
+    api.delete_fence                        = api::delete_fence;
+    api.create_shader_module                = api::create_shader_module;
+    api.delete_shader_module                = api::delete_shader_module;
+    api.create_blas                         = api::create_blas;
+    api.delete_blas                         = api::delete_blas;
+    api.create_tlas                         = api::create_tlas;
+    api.delete_tlas                         = api::delete_tlas;
+    api.create_pipeline_layout              = api::create_pipeline_layout;
+    api.delete_pipeline_layout              = api::delete_pipeline_layout;
+    api.create_render_pipeline              = api::create_render_pipeline;
+    api.delete_render_pipeline              = api::delete_render_pipeline;
+    api.create_compute_pipeline             = api::create_compute_pipeline;
+    api.delete_compute_pipeline             = api::delete_compute_pipeline;
+    api.create_raytracing_pipeline          = api::create_raytracing_pipeline;
+    api.delete_raytracing_pipeline          = api::delete_raytracing_pipeline;
+    api.create_bind_group                   = api::create_bind_group;
+    api.create_query_set                    = api::create_query_set;
+    api.delete_query_set                    = api::delete_query_set;
+    api.reset_query_set                     = api::reset_query_set;
+    api.create_bind_group_layout            = api::create_bind_group_layout;
+    api.delete_bind_group_layout            = api::delete_bind_group_layout;
+    api.wait_idle                           = api::wait_idle;
+    api.wait_fence                          = api::wait_fence;
+    api.flush_submissions                   = api::flush_submissions;
+    api.map_buffer                          = api::map_buffer;
+    api.map_buffer_async                    = api::map_buffer_async;
+    api.allocate_transient                  = api::allocate_transient;
+    api.get_memory_pool_stats               = api::get_memory_pool_stats;
+    api.get_memory_stats                    = api::get_memory_stats;
+    api.set_memory_budget_callback          = api::set_memory_budget_callback;
+    api.get_command_stats                   = api::get_command_stats;
+    api.get_shader_module_stats             = api::get_shader_module_stats;
+    api.get_staging_stats                   = api::get_staging_stats;
+    api.get_defragment_stats                = api::get_defragment_stats;
+    api.get_shader_module_hash              = api::get_shader_module_hash;
+    api.get_render_pipeline_status          = api::get_render_pipeline_status;
+    api.get_compute_pipeline_status         = api::get_compute_pipeline_status;
+    api.wait_pipelines                      = api::wait_pipelines;
+    api.upload_buffer                       = api::upload_buffer;
+    api.upload_texture                      = api::upload_texture;
+    api.flush_uploads                       = api::flush_uploads;
+    api.query_upload                        = api::query_upload;
+    api.wait_upload                         = api::wait_upload;
+    api.unmap_buffer                        = api::unmap_buffer;
+    api.get_mapped_state                    = api::get_mapped_state;
+    api.get_mapped_range                    = api::get_mapped_range;
+    api.create_command_buffer               = api::create_command_buffer;
+    api.create_command_bundle               = api::create_command_bundle;
+    api.submit_command_buffer               = api::submit_command_buffer;
+    api.finish_command_bundle               = api::finish_command_bundle;
+    api.get_blas_sizes                      = api::get_blas_sizes;
+    api.get_tlas_sizes                      = api::get_tlas_sizes;
+    api.new_frame                           = api::new_frame;
+    api.end_frame                           = api::end_frame;
+    api.set_frame_pacing                    = api::set_frame_pacing;
+    api.get_frame_timing                    = api::get_frame_timing;
+    api.get_frame_slot                      = api::get_frame_slot;
+    api.acquire_next_frame                  = api::acquire_next_frame;
+    api.present_curr_frame                  = api::present_curr_frame;
+    api.cmd_insert_debug_marker             = cmd::insert_debug_marker;
+    api.cmd_push_debug_group                = cmd::push_debug_group;
+    api.cmd_pop_debug_group                 = cmd::pop_debug_group;
+    api.cmd_wait_fence                      = cmd::wait_fence;
+    api.cmd_signal_fence                    = cmd::signal_fence;
+    api.cmd_wait_upload                     = cmd::wait_upload;
+    api.cmd_begin_render_pass               = cmd::begin_render_pass;
+    api.cmd_end_render_pass                 = cmd::end_render_pass;
+    api.cmd_execute_bundles                 = cmd::execute_bundles;
+    api.cmd_set_render_pipeline             = cmd::set_render_pipeline;
+    api.cmd_set_compute_pipeline            = cmd::set_compute_pipeline;
+    api.cmd_set_raytracing_pipeline         = cmd::set_raytracing_pipeline;
+    api.cmd_set_bind_group                  = cmd::set_bind_group;
+    api.cmd_set_push_constants              = cmd::set_push_constants;
+    api.cmd_set_index_buffer                = cmd::set_index_buffer;
+    api.cmd_set_vertex_buffer               = cmd::set_vertex_buffer;
+    api.cmd_draw                            = cmd::draw;
+    api.cmd_draw_indexed                    = cmd::draw_indexed;
+    api.cmd_draw_indirect                   = cmd::draw_indirect;
+    api.cmd_draw_indexed_indirect           = cmd::draw_indexed_indirect;
+    api.cmd_draw_indirect_count             = cmd::draw_indirect_count;
+    api.cmd_draw_indexed_indirect_count     = cmd::draw_indexed_indirect_count;
+    api.cmd_dispatch_workgroups             = cmd::dispatch_workgroups;
+    api.cmd_dispatch_workgroups_indirect    = cmd::dispatch_workgroups_indirect;
+    api.cmd_copy_buffer_to_buffer           = cmd::copy_buffer_to_buffer;
+    api.cmd_update_buffer                   = cmd::update_buffer;
+    api.cmd_copy_buffer_to_texture          = cmd::copy_buffer_to_texture;
+    api.cmd_copy_texture_to_buffer          = cmd::copy_texture_to_buffer;
+    api.cmd_copy_texture_to_texture         = cmd::copy_texture_to_texture;
+    api.cmd_clear_buffer                    = cmd::clear_buffer;
+    api.cmd_set_viewport                    = cmd::set_viewport;
+    api.cmd_set_scissor_rect                = cmd::set_scissor_rect;
+    api.cmd_set_blend_constant              = cmd::set_blend_constant;
+    api.cmd_set_stencil_reference           = cmd::set_stencil_reference;
+    api.cmd_begin_occlusion_query           = cmd::begin_occlusion_query;
+    api.cmd_end_occlusion_query             = cmd::end_occlusion_query;
+    api.cmd_write_timestamp                 = cmd::write_timestamp;
+    api.cmd_begin_pipeline_statistics_query = cmd::begin_pipeline_statistics_query;
+    api.cmd_end_pipeline_statistics_query   = cmd::end_pipeline_statistics_query;
+    api.cmd_write_blas_properties           = cmd::write_blas_properties;
+    api.cmd_resolve_query_set               = cmd::resolve_query_set;
+    api.cmd_memory_barrier                  = cmd::memory_barrier;
+    api.cmd_buffer_barrier                  = cmd::buffer_barrier;
+    api.cmd_texture_barrier                 = cmd::texture_barrier;
+    api.cmd_update_tlas_instances           = cmd::update_tlas_instances;
+    api.cmd_build_tlases                    = cmd::build_tlases;
+    api.cmd_build_blases                    = cmd::build_blases;
+    api.cmd_copy_blas                       = cmd::copy_blas;
+    api.cmd_defragment_memory               = cmd::defragment_memory;
     return api;
 }
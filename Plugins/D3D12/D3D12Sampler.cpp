@@ -1,4 +1,5 @@
 // reference: https://alain.xyz/blog/raw-directx12
+#include <Lyra/Render/RHI/RHIHash.h>
 #include "D3D12Utils.h"
 
 D3D12Sampler::D3D12Sampler()
@@ -36,3 +37,56 @@ void D3D12Sampler::destroy()
         sampler.handle.ptr = 0;
     }
 }
+
+GPUSamplerHandle D3D12SamplerCache::acquire(const GPUSamplerDescriptor& desc)
+{
+    auto rhi = get_rhi();
+    auto key = std::hash<GPUSamplerDescriptor>{}(desc);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = entries.find(key);
+    if (it != entries.end() && std::equal_to<GPUSamplerDescriptor>{}(it->second.desc, desc)) {
+        it->second.refs++;
+        return it->second.handle;
+    }
+
+    auto handle = GPUSamplerHandle(rhi->samplers.add(D3D12Sampler(desc)));
+
+    // hash collisions are rare, colliding samplers are simply not shared
+    if (it == entries.end()) {
+        auto& entry        = entries[key];
+        entry.desc         = desc;
+        entry.desc.label   = nullptr;
+        entry.handle       = handle;
+        entry.refs         = 1;
+        keys[handle.value] = key;
+    }
+    return handle;
+}
+
+bool D3D12SamplerCache::release(GPUSamplerHandle handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // samplers that are not shared are deleted right away
+    auto it = keys.find(handle.value);
+    if (it == keys.end())
+        return true;
+
+    auto& entry = entries.at(it->second);
+    if (--entry.refs > 0)
+        return false;
+
+    entries.erase(it->second);
+    keys.erase(it);
+    return true;
+}
+
+void D3D12SamplerCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    keys.clear();
+}
@@ -1,4 +1,6 @@
 // reference: https://alain.xyz/blog/raw-directx12
+#include <cstring>
+#include <Lyra/Common/Hash.h>
 #include "D3D12Utils.h"
 
 D3D12Shader::D3D12Shader()
@@ -17,3 +19,75 @@ void D3D12Shader::destroy()
 {
     binary.clear();
 }
+
+GPUShaderModuleHandle D3D12ShaderCache::acquire(const GPUShaderModuleDescriptor& desc)
+{
+    auto rhi  = get_rhi();
+    auto hash = hash_bytes(desc.data, desc.size);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // binaries are kept around, hence hits are verified byte by byte
+    auto it = entries.find(hash);
+    if (it != entries.end()) {
+        auto& binary = fetch_resource(rhi->shaders, it->second.handle).binary;
+        if (binary.size() == desc.size && std::memcmp(binary.data(), desc.data, desc.size) == 0) {
+            it->second.refs++;
+            hits++;
+            return it->second.handle;
+        }
+    }
+
+    auto obj    = D3D12Shader(desc);
+    obj.hash    = hash;
+    auto handle = GPUShaderModuleHandle(rhi->shaders.add(obj));
+
+    // hash collisions are rare, colliding binaries are simply not shared
+    if (it == entries.end()) {
+        auto& entry        = entries[hash];
+        entry.handle       = handle;
+        entry.refs         = 1;
+        keys[handle.value] = hash;
+    }
+    return handle;
+}
+
+bool D3D12ShaderCache::release(GPUShaderModuleHandle handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // shaders that are not shared are deleted right away
+    auto it = keys.find(handle.value);
+    if (it == keys.end())
+        return true;
+
+    auto& entry = entries.at(it->second);
+    if (--entry.refs > 0)
+        return false;
+
+    entries.erase(it->second);
+    keys.erase(it);
+    return true;
+}
+
+void D3D12ShaderCache::stats(GPUShaderModuleStats& stats)
+{
+    auto rhi = get_rhi();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    stats              = GPUShaderModuleStats{};
+    stats.unique_count = static_cast<uint>(rhi->shaders.size());
+    stats.module_count = stats.unique_count;
+    stats.cache_hits   = hits;
+    for (auto& kv : entries)
+        stats.module_count += kv.second.refs - 1;
+}
+
+void D3D12ShaderCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    keys.clear();
+}
@@ -220,6 +220,13 @@ void api::new_frame()
     frame.wait();
     frame.reset();
 
+    // objects deleted during frames that are no longer in flight can be released, and their pending mappings fulfilled
+    uint frames_in_flight = static_cast<uint>(rhi->frames.size());
+    if (rhi->current_frame_index >= frames_in_flight) {
+        rhi->deletes.retire(rhi->current_frame_index - frames_in_flight);
+        rhi->maps.retire(rhi->current_frame_index - frames_in_flight);
+    }
+
     // clear all existing fences
     frame.existing_fences.clear();
 }
@@ -228,10 +235,43 @@ void api::end_frame()
 {
     auto rhi = get_rhi();
 
+    // submit uploads recorded during this frame
+    rhi->uploads.flush();
+    rhi->uploads.retire();
+
+    // notify when memory usage crosses the budget threshold
+    rhi->budget.check();
+
     // increment the current frame index
     rhi->current_frame_index++;
 }
 
+void api::set_frame_pacing(const GPUFramePacing& pacing)
+{
+    // NOTE: D3D12 frames are still paced by per-frame fences, all frame slots stay in flight.
+    (void)pacing;
+}
+
+bool api::get_frame_timing(GPUFrameTiming& timing)
+{
+    auto rhi = get_rhi();
+
+    // NOTE: No frame measurements on D3D12 yet.
+    timing        = GPUFrameTiming{};
+    timing.frames = static_cast<uint>(rhi->frames.size());
+    return true;
+}
+
+bool api::get_frame_slot(GPUFrameSlot& slot)
+{
+    auto rhi = get_rhi();
+
+    slot.frame = rhi->current_frame_index;
+    slot.count = static_cast<uint>(rhi->frames.size());
+    slot.index = slot.frame % slot.count;
+    return true;
+}
+
 bool api::acquire_next_frame(GPUSurfaceHandle surface, GPUTextureHandle& texture, GPUTextureViewHandle& view, GPUFenceHandle& image_available_fence, GPUFenceHandle& render_complete_fence, bool& suboptimal)
 {
     auto rhi = get_rhi();
@@ -0,0 +1,265 @@
+// reference: https://alain.xyz/blog/raw-directx12
+#include <algorithm>
+#include <cstring>
+#include "D3D12Utils.h"
+
+// staging memory is sub-allocated from chunks of at least this size
+constexpr GPUSize64 STAGING_CHUNK_SIZE = 4ull << 20;
+
+// completed staging chunks kept around for reuse
+constexpr size_t MAX_RECYCLED_CHUNKS = 8;
+
+void D3D12UploadService::init()
+{
+    auto rhi = get_rhi();
+
+    // NOTE: resources decay to COMMON after the copy queue is done with them,
+    // and are implicitly promoted on the graphics queue, no ownership transfer is needed.
+    command_queue = rhi->transfer_queue;
+
+    timeline.init(false);
+    timeline.fence->SetName(L"upload fence");
+}
+
+void D3D12UploadService::destroy()
+{
+    // idle fence only covers the graphics queue, drain the copy queue as well
+    if (recording.command != nullptr)
+        recording.command->Close();
+
+    if (submitted_value != 0ull) {
+        timeline.target = submitted_value;
+        timeline.wait();
+    }
+
+    if (recording.command != nullptr)
+        inflight.push_back(recording);
+
+    for (auto& batch : inflight) {
+        for (auto& buffer : batch.staging)
+            buffer.destroy();
+        batch.command->Release();
+        batch.pool.destroy();
+    }
+
+    for (auto& buffer : recycled)
+        buffer.destroy();
+
+    timeline.destroy();
+    recording = {};
+    inflight.clear();
+    recycled.clear();
+}
+
+D3D12UploadService::Batch& D3D12UploadService::begin()
+{
+    if (recording.command != nullptr)
+        return recording;
+
+    recording.pool.init(D3D12_COMMAND_LIST_TYPE_COPY);
+    recording.command = recording.pool.allocate();
+    recording.value   = submitted_value + 1;
+    recording.head    = 0ull;
+    return recording;
+}
+
+GPUSize64 D3D12UploadService::stage(GPUSize64 size, GPUSize64 alignment, D3D12Buffer*& buffer)
+{
+    auto& batch = begin();
+
+    GPUSize64 offset = (batch.head + alignment - 1) / alignment * alignment;
+
+    if (batch.staging.empty() || offset + size > batch.staging.back().mapped_size) {
+        // reuse a completed chunk if possible
+        auto it = std::find_if(recycled.begin(), recycled.end(), [&](const D3D12Buffer& chunk) {
+            return chunk.mapped_size >= size;
+        });
+
+        if (it != recycled.end()) {
+            batch.staging.push_back(*it);
+            recycled.erase(it);
+        } else {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "upload_staging";
+            desc.size               = std::max(size, STAGING_CHUNK_SIZE);
+            desc.usage              = GPUBufferUsage::MAP_WRITE | GPUBufferUsage::COPY_SRC;
+            desc.mapped_at_creation = true;
+            batch.staging.push_back(D3D12Buffer(desc));
+        }
+        offset = 0ull;
+    }
+
+    batch.head = offset + size;
+    buffer     = &batch.staging.back();
+    return offset;
+}
+
+uint64_t D3D12UploadService::upload(D3D12Buffer& buffer, GPUSize64 offset, const void* data, GPUSize64 size)
+{
+    D3D12Buffer* staging        = nullptr;
+    GPUSize64    staging_offset = stage(size, 16, staging);
+    std::memcpy(staging->mapped_data + staging_offset, data, size);
+
+    recording.command->CopyBufferRegion(buffer.buffer, offset, staging->buffer, staging_offset, size);
+    return recording.value;
+}
+
+uint64_t D3D12UploadService::upload(D3D12Texture& texture, const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size)
+{
+    // source rows are repacked to the pitch required by placed footprints
+    uint      texel_size     = size_of(texture.format);
+    GPUSize64 src_row_pitch  = layout.bytes_per_row ? layout.bytes_per_row : size.width * texel_size;
+    GPUSize64 rows_per_image = layout.rows_per_image ? layout.rows_per_image : size.height;
+    GPUSize64 dst_row_pitch  = infer_row_pitch(texture.format, size.width, 0);
+    GPUSize64 data_size      = dst_row_pitch * size.height * size.depth;
+
+    D3D12Buffer* staging        = nullptr;
+    GPUSize64    staging_offset = stage(data_size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, staging);
+
+    auto src = reinterpret_cast<const uint8_t*>(data) + layout.offset;
+    auto dst = staging->mapped_data + staging_offset;
+    for (uint z = 0; z < size.depth; z++)
+        for (uint y = 0; y < size.height; y++)
+            std::memcpy(dst + (z * size.height + y) * dst_row_pitch,
+                src + (z * rows_per_image + y) * src_row_pitch,
+                size.width * texel_size);
+
+    // setup texture copy location for source (buffer)
+    D3D12_TEXTURE_COPY_LOCATION src_location        = {};
+    src_location.pResource                          = staging->buffer;
+    src_location.Type                               = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    src_location.PlacedFootprint.Offset             = staging_offset;
+    src_location.PlacedFootprint.Footprint.Format   = texture.format;
+    src_location.PlacedFootprint.Footprint.Width    = size.width;
+    src_location.PlacedFootprint.Footprint.Height   = size.height;
+    src_location.PlacedFootprint.Footprint.Depth    = size.depth;
+    src_location.PlacedFootprint.Footprint.RowPitch = static_cast<uint>(dst_row_pitch);
+
+    // setup texture copy location for destination (texture)
+    D3D12_TEXTURE_COPY_LOCATION dst_location = {};
+    dst_location.pResource                   = texture.texture;
+    dst_location.Type                        = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dst_location.SubresourceIndex            = destination.mip_level;
+
+    recording.command->CopyTextureRegion(&dst_location, destination.origin.x, destination.origin.y, destination.origin.z, &src_location, nullptr);
+    return recording.value;
+}
+
+void D3D12UploadService::flush()
+{
+    if (recording.command == nullptr)
+        return;
+
+    ThrowIfFailed(recording.command->Close());
+
+    ID3D12CommandList* command_lists[] = {recording.command};
+    command_queue->ExecuteCommandLists(1, command_lists);
+    timeline.signal(command_queue, recording.value);
+
+    submitted_value = recording.value;
+    inflight.push_back(recording);
+    recording = {};
+}
+
+void D3D12UploadService::retire()
+{
+    if (inflight.empty())
+        return;
+
+    completed_value = timeline.fence->GetCompletedValue();
+
+    // recycle the staging memory of completed batches
+    auto it = inflight.begin();
+    for (; it != inflight.end() && it->value <= completed_value; it++) {
+        for (auto& chunk : it->staging) {
+            if (recycled.size() < MAX_RECYCLED_CHUNKS) {
+                recycled.push_back(chunk);
+            } else {
+                chunk.destroy();
+            }
+        }
+        it->command->Release();
+        it->pool.destroy();
+    }
+    inflight.erase(inflight.begin(), it);
+}
+
+bool D3D12UploadService::ready(uint64_t value)
+{
+    if (value > submitted_value)
+        return false;
+
+    if (value > completed_value)
+        retire();
+
+    return value <= completed_value;
+}
+
+void D3D12UploadService::wait(uint64_t value)
+{
+    if (value > submitted_value)
+        flush();
+
+    timeline.target = value;
+    timeline.wait();
+    retire();
+}
+
+void D3D12UploadService::acquire(D3D12CommandBuffer& cmd, uint64_t value)
+{
+    // the wait is per command buffer, any of them might be submitted first
+    if (value <= cmd.upload_value)
+        return;
+
+    // make sure the batch is on its way
+    if (value > submitted_value)
+        flush();
+
+    // GPU-side wait, the host never blocks on uploads here
+    auto fence   = timeline;
+    fence.target = value;
+    cmd.wait(fence, GPUBarrierSync::ALL);
+
+    cmd.upload_value = value;
+}
+
+bool api::upload_buffer(GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size, GPUUploadToken& token)
+{
+    auto  rhi   = get_rhi();
+    auto& buf   = fetch_resource(rhi->buffers, buffer);
+    token.value = rhi->uploads.upload(buf, offset, data, size);
+    return true;
+}
+
+bool api::upload_texture(const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size, GPUUploadToken& token)
+{
+    auto  rhi   = get_rhi();
+    auto& tex   = fetch_resource(rhi->textures, destination.texture);
+    token.value = rhi->uploads.upload(tex, destination, data, layout, size);
+    return true;
+}
+
+void api::flush_uploads()
+{
+    get_rhi()->uploads.flush();
+}
+
+bool api::query_upload(GPUUploadToken token)
+{
+    return get_rhi()->uploads.ready(token.value);
+}
+
+void api::wait_upload(GPUUploadToken token)
+{
+    get_rhi()->uploads.wait(token.value);
+}
+
+void cmd::wait_upload(GPUCommandEncoderHandle cmdbuffer, GPUUploadToken token, GPUBarrierSyncFlags)
+{
+    // NOTE: D3D12 does not support fine-grain control at pipeline stage level,
+    // therefore sync flags is not used.
+
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    rhi->uploads.acquire(cmd, token.value);
+}
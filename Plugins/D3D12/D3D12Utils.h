@@ -5,6 +5,7 @@
 
 #include <d3d12.h>
 #include <dxgi1_6.h>
+#include <mutex>
 #include <exception>
 #include <wrl/client.h>
 using Microsoft::WRL::ComPtr;
@@ -13,6 +14,7 @@ using Microsoft::WRL::ComPtr;
 #include <Lyra/Common/Logger.h>
 #include <Lyra/Common/Msgbox.h>
 #include <Lyra/Common/Slotmap.h>
+#include <Lyra/Common/Function.h>
 #include <Lyra/Common/Container.h>
 #include <Lyra/Common/Compatibility.h>
 #include <Lyra/Render/RHI/RHIDescs.h>
@@ -167,6 +169,7 @@ struct D3D12Buffer
     uint64_t size_       = 0ull;
     uint8_t* mapped_data = nullptr;
     uint64_t mapped_size = 0ull;
+    bool     map_pending = false; // waiting in the map queue
 
     // implementation in D3D12Buffer.cpp
     explicit D3D12Buffer();
@@ -194,6 +197,37 @@ struct D3D12Buffer
     }
 };
 
+struct D3D12MemoryBudget
+{
+    float                   threshold = 0.9f;
+    GPUMemoryBudgetCallback callback  = {};
+    Vector<bool>            exceeded  = {}; // per heap, callback only fires when crossing the threshold
+
+    // implementation in D3D12Buffer.cpp
+    void check();
+    auto heaps(bool detailed) const -> Vector<GPUMemoryHeapStats>;
+};
+
+struct D3D12UploadRing
+{
+    // persistently mapped buffer, sub-allocated linearly within a frame
+    GPUBufferHandle buffer   = {};
+    uint8_t*        mapped   = nullptr;
+    GPUSize64       capacity = 0ull;
+    GPUSize64       head     = 0ull;
+
+    // buffers outgrown within the frame, released once the frame completes
+    Vector<GPUBufferHandle> retired = {};
+
+    // implementation in D3D12Buffer.cpp
+    void reset();
+    void destroy();
+    auto allocate(GPUSize64 size, GPUSize64 alignment) -> GPUTransientAllocation;
+
+private:
+    void grow(GPUSize64 size);
+};
+
 struct D3D12TextureView;
 struct D3D12Texture
 {
@@ -262,9 +296,31 @@ struct D3D12Sampler
     bool valid() const { return sampler.valid(); }
 };
 
+// identical sampler states share one sampler descriptor,
+// shared handles are reference counted, the sampler is deleted with its last reference.
+struct D3D12SamplerCache
+{
+    struct Entry
+    {
+        GPUSamplerDescriptor desc;
+        GPUSamplerHandle     handle;
+        uint                 refs = 0;
+    };
+
+    HashMap<size_t, Entry> entries; // descriptor hash -> shared sampler
+    HashMap<uint, size_t>  keys;    // sampler handle -> descriptor hash
+    std::mutex             mutex;
+
+    // implementation in D3D12Sampler.cpp
+    auto acquire(const GPUSamplerDescriptor& desc) -> GPUSamplerHandle;
+    bool release(GPUSamplerHandle handle);
+    void clear();
+};
+
 struct D3D12Shader
 {
     std::vector<uint8_t> binary;
+    uint64_t             hash = 0ull; // content hash of the binary
 
     // implementation in D3D12Shader.cpp
     explicit D3D12Shader();
@@ -275,6 +331,28 @@ struct D3D12Shader
     bool valid() const { return !binary.empty(); }
 };
 
+// identical shader binaries share one shader object keyed by the content hash,
+// shared handles are reference counted, the shader is deleted with its last reference.
+struct D3D12ShaderCache
+{
+    struct Entry
+    {
+        GPUShaderModuleHandle handle;
+        uint                  refs = 0;
+    };
+
+    HashMap<uint64_t, Entry> entries;  // content hash -> shared shader
+    HashMap<uint, uint64_t>  keys;     // shader handle -> content hash
+    GPUSize64                hits = 0; // requests served by an existing shader
+    std::mutex               mutex;
+
+    // implementation in D3D12Shader.cpp
+    auto acquire(const GPUShaderModuleDescriptor& desc) -> GPUShaderModuleHandle;
+    bool release(GPUShaderModuleHandle handle);
+    void stats(GPUShaderModuleStats& stats);
+    void clear();
+};
+
 struct D3D12BindGroup
 {
     // NOTE: D3D12 requires an explicit separation of cbv_srv_uav vs sampler heap,
@@ -466,6 +544,7 @@ struct D3D12CommandBuffer
 
     Vector<FenceOps> wait_fences;
     Vector<FenceOps> signal_fences;
+    uint64_t         upload_value = 0ull; // upload fence value this command buffer waits for
 
     // implementation in D3D12CommandBuffer.cpp
     void wait(const D3D12Fence& fence, GPUBarrierSyncFlags sync);
@@ -488,6 +567,87 @@ struct D3D12CommandPool
     auto allocate() -> ID3D12GraphicsCommandList*;
 };
 
+// objects deleted by the user might still be referenced by frames in flight,
+// their release is postponed until the GPU retires the frame that deleted them.
+struct D3D12DeleteQueue
+{
+    struct Entry
+    {
+        uint             frame = 0u;
+        Function<void()> release;
+    };
+
+    Deque<Entry> entries;
+
+    // implementation in D3D12Frame.cpp
+    void push(uint frame, Function<void()>&& release);
+    void retire(uint completed_frame);
+    void flush();
+};
+
+struct D3D12MapQueue
+{
+    struct Request
+    {
+        uint                 frame  = 0u;
+        GPUBufferHandle      buffer = {};
+        GPUSize64            offset = 0ull;
+        GPUSize64            size   = 0ull;
+        GPUBufferMapCallback callback;
+    };
+
+    Deque<Request> requests;
+    std::mutex     mutex;
+
+    // implementation in D3D12Frame.cpp
+    void push(Request&& request);
+    void retire(uint completed_frame);
+    void cancel(GPUBufferHandle buffer);
+    void flush();
+
+private:
+    void fulfill(Vector<Request>& ready, bool success);
+};
+
+struct D3D12UploadService
+{
+    struct Batch
+    {
+        uint64_t                   value   = 0ull; // fence value signaled when this batch completes
+        D3D12CommandPool           pool    = {};
+        ID3D12GraphicsCommandList* command = nullptr;
+        Vector<D3D12Buffer>        staging = {};
+        GPUSize64                  head    = 0ull; // write offset into the last staging buffer
+    };
+
+    // transfer work is signaled on a dedicated fence
+    D3D12Fence          timeline;
+    ID3D12CommandQueue* command_queue = nullptr;
+
+    // fence tracking
+    uint64_t submitted_value = 0ull;
+    uint64_t completed_value = 0ull;
+
+    Batch               recording = {};
+    Vector<Batch>       inflight  = {};
+    Vector<D3D12Buffer> recycled  = {};
+
+    // implementation in D3D12Upload.cpp
+    void init();
+    void destroy();
+    void flush();
+    void retire();
+    void wait(uint64_t value);
+    bool ready(uint64_t value);
+    void acquire(D3D12CommandBuffer& cmd, uint64_t value);
+    auto upload(D3D12Buffer& buffer, GPUSize64 offset, const void* data, GPUSize64 size) -> uint64_t;
+    auto upload(D3D12Texture& texture, const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size) -> uint64_t;
+
+private:
+    auto begin() -> Batch&;
+    auto stage(GPUSize64 size, GPUSize64 alignment, D3D12Buffer*& buffer) -> GPUSize64;
+};
+
 struct D3D12Frame
 {
     struct CommandBuffer
@@ -525,6 +685,9 @@ struct D3D12Frame
     Heap<D3D12BindGroupDynamic> dynamic_heap;
     Vector<D3D12BindGroup>      allocated_descriptors;
 
+    // transient upload memory, recycled when this frame is reused
+    D3D12UploadRing upload_ring;
+
     // allocate command buffers
     Vector<CommandBuffer> allocated_command_buffers;
 
@@ -618,6 +781,25 @@ struct D3D12RHI
     // frame objects
     Vector<D3D12Frame> frames = {};
 
+    // initial size of per-frame upload rings
+    GPUSize64 upload_ring_size = 0ull;
+
+    // asynchronous uploads on the copy queue
+    D3D12UploadService uploads;
+
+    // memory budget tracking
+    D3D12MemoryBudget budget;
+
+    // deferred destruction of user-deleted objects
+    D3D12DeleteQueue deletes;
+
+    // asynchronous buffer mapping, fulfilled once the requesting frame completes
+    D3D12MapQueue maps;
+
+    // shared samplers and shaders
+    D3D12SamplerCache sampler_cache;
+    D3D12ShaderCache  shader_cache;
+
     // frame tracker
     uint current_frame_index = 0;
     uint current_image_index = 0;
@@ -690,9 +872,25 @@ namespace api
     bool create_buffer(GPUBufferHandle& buffer, const GPUBufferDescriptor& desc);
     void delete_buffer(GPUBufferHandle buffer);
     void map_buffer(GPUBufferHandle buffer, GPUMapMode mode, GPUSize64 offset, GPUSize64 size);
+    void map_buffer_async(GPUBufferHandle buffer, GPUMapMode mode, GPUSize64 offset, GPUSize64 size, const GPUBufferMapCallback& callback);
     void unmap_buffer(GPUBufferHandle buffer);
     void get_mapped_range(GPUBufferHandle buffer, MappedBufferRange& range);
     void get_mapped_state(GPUBufferHandle buffer, GPUMapState& state);
+    bool allocate_transient(GPUSize64 size, GPUSize64 alignment, GPUTransientAllocation& allocation);
+    bool get_memory_pool_stats(GPUMemoryPool pool, GPUMemoryPoolStats& stats);
+    bool get_memory_stats(GPUMemoryStats& stats);
+    void set_memory_budget_callback(float threshold, const GPUMemoryBudgetCallback& callback);
+    bool get_command_stats(GPUCommandStats& stats);
+    bool get_shader_module_stats(GPUShaderModuleStats& stats);
+    bool get_staging_stats(GPUStagingStats& stats);
+    bool get_defragment_stats(GPUDefragmentStats& stats);
+
+    // upload apis
+    bool upload_buffer(GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size, GPUUploadToken& token);
+    bool upload_texture(const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size, GPUUploadToken& token);
+    void flush_uploads();
+    bool query_upload(GPUUploadToken token);
+    void wait_upload(GPUUploadToken token);
 
     // sampler apis
     bool create_sampler(GPUSamplerHandle& sampler, const GPUSamplerDescriptor& desc);
@@ -707,6 +905,7 @@ namespace api
     // shader apis
     bool create_shader_module(GPUShaderModuleHandle& shader, const GPUShaderModuleDescriptor& desc);
     void delete_shader_module(GPUShaderModuleHandle shader);
+    bool get_shader_module_hash(GPUShaderModuleHandle shader, GPUSize64& hash);
 
     // bvh blas apis
     bool create_blas(GPUBlasHandle& blas, const GPUBlasDescriptor& descriptor, GPUBlasGeometrySizeDescriptors sizes);
@@ -721,6 +920,7 @@ namespace api
     // query set apis
     bool create_query_set(GPUQuerySetHandle& query_set, const GPUQuerySetDescriptor& descriptor);
     void delete_query_set(GPUQuerySetHandle query_set);
+    void reset_query_set(GPUQuerySetHandle query_set, GPUSize32 first_query, GPUSize32 query_count);
 
     // bind group layout apis
     bool create_bind_group_layout(GPUBindGroupLayoutHandle& handle, const GPUBindGroupLayoutDescriptor& desc);
@@ -737,10 +937,16 @@ namespace api
     void delete_compute_pipeline(GPUComputePipelineHandle pipeline);
     bool create_raytracing_pipeline(GPURayTracingPipelineHandle& handle, const GPURayTracingPipelineDescriptor& desc);
     void delete_raytracing_pipeline(GPURayTracingPipelineHandle pipeline);
+    bool get_render_pipeline_status(GPURenderPipelineHandle pipeline, GPUPipelineStatus& status);
+    bool get_compute_pipeline_status(GPUComputePipelineHandle pipeline, GPUPipelineStatus& status);
+    void wait_pipelines();
 
     // d3d12 frame logic
     void new_frame();
     void end_frame();
+    void set_frame_pacing(const GPUFramePacing& pacing);
+    bool get_frame_timing(GPUFrameTiming& timing);
+    bool get_frame_slot(GPUFrameSlot& slot);
 
     // d3d12 swapchain
     bool acquire_next_frame(GPUSurfaceHandle surface, GPUTextureHandle& texture, GPUTextureViewHandle& view, GPUFenceHandle& image_available_fence, GPUFenceHandle& render_complete_fence, bool& suboptimal);
@@ -753,10 +959,12 @@ namespace api
     bool create_command_buffer(GPUCommandEncoderHandle& cmdbuffer, const GPUCommandBufferDescriptor& descriptor);
     bool create_command_bundle(GPUCommandEncoderHandle& cmdbuffer, const GPUCommandBundleDescriptor& descriptor);
     bool submit_command_buffer(GPUCommandEncoderHandle cmdbuffer);
+    bool finish_command_bundle(GPUCommandEncoderHandle cmdbuffer);
 
     // device/queue related
     void wait_idle();
     void wait_fence(GPUFenceHandle handle);
+    void flush_submissions();
 
 } // namespace api
 
@@ -768,8 +976,10 @@ namespace cmd
     void pop_debug_group(GPUCommandEncoderHandle cmdbuffer);
     void wait_fence(GPUCommandEncoderHandle cmdbuffer, GPUFenceHandle fence, GPUBarrierSyncFlags sync);
     void signal_fence(GPUCommandEncoderHandle cmdbuffer, GPUFenceHandle fence, GPUBarrierSyncFlags sync);
+    void wait_upload(GPUCommandEncoderHandle cmdbuffer, GPUUploadToken token, GPUBarrierSyncFlags sync);
     void begin_render_pass(GPUCommandEncoderHandle cmdbuffer, const GPURenderPassDescriptor& descriptor);
     void end_render_pass(GPUCommandEncoderHandle cmdbuffer);
+    void execute_bundles(GPUCommandEncoderHandle cmdbuffer, GPUCommandEncoderHandles bundles);
     void set_render_pipeline(GPUCommandEncoderHandle cmdbuffer, GPURenderPipelineHandle pipeline);
     void set_compute_pipeline(GPUCommandEncoderHandle cmdbuffer, GPUComputePipelineHandle pipeline);
     void set_raytracing_pipeline(GPUCommandEncoderHandle cmdbuffer, GPURayTracingPipelineHandle pipeline);
@@ -781,9 +991,12 @@ namespace cmd
     void draw_indexed(GPUCommandEncoderHandle cmdbuffer, GPUSize32 index_count, GPUSize32 instance_count, GPUSize32 first_index, GPUSignedOffset32 base_vertex, GPUSize32 first_instance);
     void draw_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUSize32 draw_count);
     void draw_indexed_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUSize32 draw_count);
+    void draw_indirect_count(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count);
+    void draw_indexed_indirect_count(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count);
     void dispatch_workgroups(GPUCommandEncoderHandle cmdbuffer, GPUSize32 x, GPUSize32 y, GPUSize32 z);
     void dispatch_workgroups_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset);
     void copy_buffer_to_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle source, GPUSize64 source_offset, GPUBufferHandle destination, GPUSize64 destination_offset, GPUSize64 size);
+    void update_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size);
     void copy_buffer_to_texture(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyBufferInfo& source, const GPUTexelCopyTextureInfo& destination, GPUExtent3D copy_size);
     void copy_texture_to_buffer(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyTextureInfo& source, const GPUTexelCopyBufferInfo& destination, const GPUExtent3D& copy_size);
     void copy_texture_to_texture(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyTextureInfo& source, const GPUTexelCopyTextureInfo& destination, const GPUExtent3D& copy_size);
@@ -795,13 +1008,18 @@ namespace cmd
     void begin_occlusion_query(GPUCommandEncoderHandle cmdbuffer, GPUSize32 query_index);
     void end_occlusion_query(GPUCommandEncoderHandle cmdbuffer);
     void write_timestamp(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
+    void begin_pipeline_statistics_query(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
+    void end_pipeline_statistics_query(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
     void write_blas_properties(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index, GPUBlasHandle blas);
     void resolve_query_set(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 first_query, GPUSize32 query_count, GPUBufferHandle destination, GPUSize64 destination_offset);
     void memory_barrier(GPUCommandEncoderHandle cmdbuffer, GPUMemoryBarriers barriers);
     void buffer_barrier(GPUCommandEncoderHandle cmdbuffer, GPUBufferBarriers barriers);
     void texture_barrier(GPUCommandEncoderHandle cmdbuffer, GPUTextureBarriers barriers);
+    void update_tlas_instances(GPUCommandEncoderHandle cmdbuffer, GPUTlasHandle tlas, GPUTlasInstanceUpdates updates);
     void build_tlases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUTlasBuildEntries entries);
     void build_blases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUBlasBuildEntries entries);
+    void copy_blas(GPUCommandEncoderHandle cmdbuffer, GPUBlasHandle old_blas, GPUBlasHandle new_blas);
+    void defragment_memory(GPUCommandEncoderHandle cmdbuffer, const GPUDefragmentDescriptor& descriptor);
 } // namespace cmd
 
 auto get_logger() -> Logger;
@@ -846,13 +1064,13 @@ T& fetch_resource(D3D12ResourceManager<T>& manager, Handle handle)
         exit(1);
     }
 
-    // check resource range
-    if (handle.value >= manager.data.size()) {
-        get_logger()->error("Resource handle {} with value={} access out of range!", Handle::type_name(), handle.value);
+    // check resource liveness (out of range or stale generation)
+    if (!manager.contains(handle.value)) {
+        get_logger()->error("Resource handle {} with value={} is stale or out of range!", Handle::type_name(), handle.value);
         exit(1);
     }
 
-    T& resource = manager.data.at(handle.value);
+    T& resource = manager.at(handle.value);
     if (!resource.valid()) {
         get_logger()->error("Resource handle {} with value={} has invalid object!", Handle::type_name(), handle.value);
         exit(1);
@@ -860,6 +1078,21 @@ T& fetch_resource(D3D12ResourceManager<T>& manager, Handle handle)
     return resource;
 }
 
+template <typename T, typename Handle>
+void defer_delete(D3D12ResourceManager<T>& manager, Handle handle)
+{
+    // stale handles are ignored, same as deleting an invalid handle
+    if (!manager.contains(handle.value))
+        return;
+
+    // the handle is invalidated right away, the object itself outlives the frames in flight
+    auto rhi = get_rhi();
+    auto obj = manager.release(handle.value);
+    rhi->deletes.push(rhi->current_frame_index, [obj]() mutable {
+        D3D12Destroyer<T>()(obj);
+    });
+}
+
 template <typename T>
 void print_refcnt(T* data)
 {
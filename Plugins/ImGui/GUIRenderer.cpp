@@ -27,40 +27,9 @@ namespace ImGui
     extern ImGuiIO& GetIO(ImGuiContext*);
 }
 
-static GUIRendererData* imgui_make_renderer(uint frame_count)
+static GUIRendererData* imgui_make_renderer()
 {
-    auto renderer = new GUIRendererData();
-    renderer->ibuffers.resize(frame_count);
-    renderer->vbuffers.resize(frame_count);
-    return renderer;
-}
-
-static GPUBuffer imgui_create_buffer(uint size, GPUBufferUsageFlags usages)
-{
-    auto& device = RHI::get_current_device();
-    return execute([&]() {
-        GPUBufferDescriptor desc{};
-        desc.size               = size;
-        desc.usage              = usages;
-        desc.mapped_at_creation = false;
-        return device.create_buffer(desc);
-    });
-}
-
-static GPUBuffer imgui_prepare_buffer(GPUBuffer buffer, GUIRendererData* renderer_data, uint size, GPUBufferUsageFlags usages)
-{
-    // check if buffer is valid
-    if (!buffer.handle.valid())
-        return imgui_create_buffer(size, usages);
-
-    // check if buffer is big enough
-    if (buffer.size < size) {
-        renderer_data->garbage_buffers.push_back(GUIGarbageBuffer{buffer, 0});
-        return imgui_create_buffer(size, usages);
-    }
-
-    // keep using the original buffer
-    return buffer;
+    return new GUIRendererData();
 }
 
 static void imgui_create_vertex_buffers(GUIPipelineData* pipeline_data, GUIRendererData* renderer_data, ImDrawData* draw_data)
@@ -68,43 +37,28 @@ static void imgui_create_vertex_buffers(GUIPipelineData* pipeline_data, GUIRende
     // no vertex/index data
     if (draw_data->TotalVtxCount == 0) return;
 
-    auto& vbuffer = renderer_data->vbuffers.at(pipeline_data->frame_index);
-    auto& ibuffer = renderer_data->ibuffers.at(pipeline_data->frame_index);
-
-    // create/resize index buffer on the fly
-    ibuffer = imgui_prepare_buffer(
-        ibuffer,
-        renderer_data,
-        draw_data->TotalIdxCount * sizeof(ImDrawIdx),
-        GPUBufferUsage::INDEX | GPUBufferUsage::MAP_WRITE);
-
-    // create/resize vertex buffer on the fly
-    vbuffer = imgui_prepare_buffer(
-        vbuffer,
-        renderer_data,
-        draw_data->TotalVtxCount * sizeof(ImDrawVert),
-        GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE);
+    auto& device = RHI::get_current_device();
 
-    ibuffer.map(GPUMapMode::WRITE);
-    vbuffer.map(GPUMapMode::WRITE);
+    // sub-allocate index/vertex data from the per-frame upload ring
+    auto& indices  = renderer_data->indices;
+    auto& vertices = renderer_data->vertices;
+    indices        = device.allocate_transient(draw_data->TotalIdxCount * sizeof(ImDrawIdx));
+    vertices       = device.allocate_transient(draw_data->TotalVtxCount * sizeof(ImDrawVert));
 
     // copy index/vertex from all cmdlists
-    auto idx_dst = ibuffer.get_mapped_range<ImDrawIdx>().data;
-    auto vtx_dst = vbuffer.get_mapped_range<ImDrawVert>().data;
+    auto idx_dst = indices.as<ImDrawIdx>();
+    auto vtx_dst = vertices.as<ImDrawVert>();
     for (const ImDrawList* draw_list : draw_data->CmdLists) {
         std::memcpy(vtx_dst, draw_list->VtxBuffer.Data, draw_list->VtxBuffer.Size * sizeof(ImDrawVert));
         std::memcpy(idx_dst, draw_list->IdxBuffer.Data, draw_list->IdxBuffer.Size * sizeof(ImDrawIdx));
         vtx_dst += draw_list->VtxBuffer.Size;
         idx_dst += draw_list->IdxBuffer.Size;
     }
-
-    ibuffer.unmap();
-    vbuffer.unmap();
 }
 
 static void imgui_reset_texture_descriptors(GUIRendererData* renderer_data)
 {
-    for (auto& texinfo : renderer_data->textures.data)
+    for (auto& texinfo : renderer_data->textures)
         texinfo.bindgroup.handle.reset();
 }
 
@@ -167,28 +121,27 @@ static void imgui_create_texture(GUIPipelineData* pipeline_data, GUIRendererData
 
 static void imgui_update_texture(GPUCommandBuffer cmdbuffer, GUIRendererData* renderer_data, ImTextureData* tex)
 {
+    auto& device = RHI::get_current_device();
+
     uint alignment = RHI::get_current_adapter().properties.texture_row_pitch_alignment;
     uint row_pitch = (tex->GetPitch() + alignment - 1) & ~(alignment - 1);
     uint buf_size  = row_pitch * tex->Height;
 
-    // copy from texture data to staging buffer
-    auto staging = imgui_create_buffer(buf_size, GPUBufferUsage::COPY_SRC | GPUBufferUsage::MAP_WRITE);
-    staging.map(GPUMapMode::WRITE);
-    auto mapped = staging.get_mapped_range();
+    // copy from texture data to staging memory (recycled once the frame completes)
+    auto staging = device.allocate_transient(buf_size);
     for (int i = 0; i < tex->Height; i++) {
-        uint8_t* dst = mapped.data + row_pitch * i;
+        uint8_t* dst = staging.data + row_pitch * i;
         uint8_t* src = (uint8_t*)tex->GetPixels() + tex->GetPitch() * i;
         std::memcpy(dst, src, tex->GetPitch());
     }
-    staging.unmap();
 
     auto  texid   = tex->GetTexID();
     auto& texture = renderer_data->textures.at(static_cast<uint>(texid));
 
     GPUTexelCopyBufferInfo source{};
-    source.buffer         = staging;
+    source.buffer         = staging.buffer;
     source.bytes_per_row  = tex->GetPitch();
-    source.offset         = 0;
+    source.offset         = staging.offset;
     source.rows_per_image = tex->Height;
 
     GPUTexelCopyTextureInfo dest{};
@@ -207,26 +160,25 @@ static void imgui_update_texture(GPUCommandBuffer cmdbuffer, GUIRendererData* re
     cmdbuffer.copy_buffer_to_texture(source, dest, copy_size);
     cmdbuffer.resource_barrier(state_transition(texture.texture, copy_dst_state(), shader_resource_state(GPUBarrierSync::PIXEL_SHADING)));
 
-    // deferred deletion of the staging buffer, because this buffer is still used before the command buffer completes.
-    renderer_data->garbage_buffers.push_back(GUIGarbageBuffer{staging, 0});
-
     // update the texture status back to OK (required by ImGui)
     tex->SetStatus(ImTextureStatus_OK);
 }
 
-static void imgui_delete_texture(GUIPipelineData* pipeline_data, GUIRendererData* renderer_data, ImTextureID texid)
+static void imgui_delete_texture(GUIRendererData* renderer_data, ImTextureID texid)
 {
-    // deferred deletion of texture, because the current texture/view might still be used in some frames in flight
-    auto& texinfo = renderer_data->textures.at(static_cast<uint>(texid));
+    // NOTE: the backend defers the actual release until frames in flight have retired,
+    // copy before removal, the slot is reset once removed from the slotmap
+    auto texinfo = renderer_data->textures.at(static_cast<uint>(texid));
     if (texinfo.valid()) {
         renderer_data->textures.remove(static_cast<uint>(texid));
-        renderer_data->garbage_textures.push_back(GUIGarbageTexture{texinfo, pipeline_data->frame_count});
+        if (texinfo.view.valid()) texinfo.view.destroy();
+        if (texinfo.texture.valid()) texinfo.texture.destroy();
     }
 }
 
-static void imgui_delete_texture(GUIPipelineData* pipeline_data, GUIRendererData* renderer_data, ImTextureData* tex)
+static void imgui_delete_texture(GUIRendererData* renderer_data, ImTextureData* tex)
 {
-    imgui_delete_texture(pipeline_data, renderer_data, tex->GetTexID());
+    imgui_delete_texture(renderer_data, tex->GetTexID());
 
     // reset texture id
     tex->SetTexID(ImTextureID_Invalid);
@@ -248,7 +200,7 @@ static void imgui_process_texture(GPUCommandBuffer cmdbuffer, GUIPipelineData* p
 
     // delete texture if necessary
     if (tex->Status == ImTextureStatus_WantDestroy)
-        imgui_delete_texture(pipeline_data, renderer_data, tex);
+        imgui_delete_texture(renderer_data, tex);
 }
 
 static void imgui_prepare(GPUCommandBuffer cmdbuffer, GUIPipelineData* pipeline_data, GUIRendererData* renderer_data, ImDrawData* draw_data)
@@ -271,11 +223,15 @@ static void imgui_setup_render_state(GPUCommandBuffer cmdbuffer, GUIPipelineData
 
     // bind index/vertex buffers
     if (draw_data->TotalVtxCount > 0) {
-        auto& vbuffer = renderer_data->vbuffers.at(pipeline_data->frame_index);
-        auto& ibuffer = renderer_data->ibuffers.at(pipeline_data->frame_index);
-        auto  iformat = sizeof(ImDrawIdx) == 2 ? GPUIndexFormat::UINT16 : GPUIndexFormat::UINT32;
-        cmdbuffer.set_vertex_buffer(0, vbuffer);
-        cmdbuffer.set_index_buffer(ibuffer, iformat);
+        auto& vertices = renderer_data->vertices;
+        auto& indices  = renderer_data->indices;
+        auto  iformat  = sizeof(ImDrawIdx) == 2 ? GPUIndexFormat::UINT16 : GPUIndexFormat::UINT32;
+
+        GPUBuffer vbuffer, ibuffer;
+        vbuffer.handle = vertices.buffer;
+        ibuffer.handle = indices.buffer;
+        cmdbuffer.set_vertex_buffer(0, vbuffer, vertices.offset, vertices.size);
+        cmdbuffer.set_index_buffer(ibuffer, iformat, indices.offset, indices.size);
     }
 
     // setup scale and translation:
@@ -439,7 +395,7 @@ static void platform_create_window(ImGuiViewport* viewport)
     // viewport data
     GUIViewportData* vd = new GUIViewportData{};
     vd->pipeline        = pipeline_data;
-    vd->renderer        = imgui_make_renderer(vd->pipeline->frame_count);
+    vd->renderer        = imgui_make_renderer();
     vd->surface         = surface;
     vd->window          = window;
     vd->owned           = true;
@@ -718,33 +674,6 @@ void GUIRenderer::reset()
     assert(renderer_data && "ImGui renderer data has not been initialized!");
     assert(pipeline_data && "ImGui pipeline data has not been initialized!");
 
-    uint frame_count = pipeline_data->frame_count;
-
-    // reclaim unused buffers
-    auto& garbage_buffers = renderer_data->garbage_buffers;
-    for (auto it = garbage_buffers.begin(); it != garbage_buffers.end();) {
-        auto& garbage = *it;
-        if (garbage.should_remove(frame_count)) {
-            garbage.object.destroy();
-            it = garbage_buffers.erase(it);
-        } else {
-            it++;
-        }
-    }
-
-    // reclaim unused textures
-    auto& garbage_textures = renderer_data->garbage_textures;
-    for (auto it = garbage_textures.begin(); it != garbage_textures.end();) {
-        auto& garbage = *it;
-        if (garbage.should_remove(frame_count)) {
-            if (garbage.object.texture.valid()) garbage.object.texture.destroy();
-            if (garbage.object.view.valid()) garbage.object.view.destroy();
-            it = garbage_textures.erase(it);
-        } else {
-            it++;
-        }
-    }
-
     // update frame index
     pipeline_data->frame_index = (pipeline_data->frame_index + 1) % pipeline_data->frame_count;
 
@@ -872,7 +801,7 @@ uint GUIRenderer::create_texture(GPUTextureHandle texture, GPUTextureViewHandle
 
 void GUIRenderer::delete_texture(uint texid)
 {
-    imgui_delete_texture(pipeline_data.get(), renderer_data.get(), (ImTextureID)texid);
+    imgui_delete_texture(renderer_data.get(), (ImTextureID)texid);
 }
 
 ImGuiContext* GUIRenderer::context() const
@@ -1073,7 +1002,7 @@ void GUIRenderer::init_renderer_data(const GUIDescriptor& descriptor)
 {
     auto& device = RHI::get_current_device();
 
-    renderer_data.reset(imgui_make_renderer(pipeline_data->frame_count));
+    renderer_data.reset(imgui_make_renderer());
 
     // sampler
     renderer_data->sampler = execute([&]() {
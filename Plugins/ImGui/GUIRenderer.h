@@ -19,15 +19,6 @@ using namespace lyra;
 
 Logger get_logger();
 
-template <typename T>
-struct GUIGarbage
-{
-    T    object;
-    uint unused = 0;
-
-    bool should_remove(uint threshold) { return unused++ >= threshold; }
-};
-
 struct GUITexture
 {
     GPUBindGroup   bindgroup;
@@ -66,7 +57,7 @@ struct GUIPlatformData
 
 struct GUITextureDeleter
 {
-    // deferred deletion, only reset the handles
+    // objects are destroyed by imgui_delete_texture, only reset the handles
     void operator()(GUITexture& texture)
     {
         texture.texture.handle.reset();
@@ -74,11 +65,7 @@ struct GUITextureDeleter
     }
 };
 
-using GUIGarbageBuffer   = GUIGarbage<GPUBuffer>;
-using GUIGarbageBuffers  = Vector<GUIGarbageBuffer>;
-using GUIGarbageTexture  = GUIGarbage<GUITexture>;
-using GUIGarbageTextures = Vector<GUIGarbageTexture>;
-using GUITextureManager  = Slotmap<GUITexture, GUITextureDeleter>;
+using GUITextureManager = Slotmap<GUITexture, GUITextureDeleter>;
 
 struct GUIPipelineData
 {
@@ -93,12 +80,10 @@ struct GUIPipelineData
 
 struct GUIRendererData
 {
-    Vector<GPUBuffer>  vbuffers;
-    Vector<GPUBuffer>  ibuffers;
-    GPUSampler         sampler;
-    GUITextureManager  textures;
-    GUIGarbageBuffers  garbage_buffers;
-    GUIGarbageTextures garbage_textures;
+    GPUTransientAllocation vertices;
+    GPUTransientAllocation indices;
+    GPUSampler             sampler;
+    GUITextureManager      textures;
 };
 
 struct GUIRenderer
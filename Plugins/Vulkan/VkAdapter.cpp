@@ -74,6 +74,9 @@ void populate_device_properties(GPUProperties& properties)
     // texture row pitch alignment (buffer image properties)
     properties.texture_row_pitch_alignment = 4; // common minimum, may need device-specific query
 
+    // timestamp queries
+    properties.timestamp_period = rhi->props.limits.timestampPeriod;
+
     // subgroup properties (requires VK_KHR_shader_subgroup_extended_types or Vulkan 1.1+)
     if (rhi->props2.pNext) {
         // look for VkPhysicalDeviceSubgroupProperties in the pNext chain
@@ -11,7 +11,7 @@ VulkanBlas::VulkanBlas(const GPUBlasDescriptor& desc, GPUBlasGeometrySizeDescrip
 
     ranges.clear();
     geometries.clear();
-    uint32_t max_primitive_count = 0;
+    Vector<uint32_t> max_primitive_counts = {};
 
     update_mode = desc.update_mode;
 
@@ -19,6 +19,9 @@ VulkanBlas::VulkanBlas(const GPUBlasDescriptor& desc, GPUBlasGeometrySizeDescrip
         ranges.push_back({});
         geometries.push_back({});
 
+        // geometry without indices builds one triangle per three vertices
+        bool indexed = size.triangles.index_count != 0;
+
         // define geometry data
         auto& geometry        = geometries.back();
         geometry.sType        = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
@@ -33,17 +36,17 @@ VulkanBlas::VulkanBlas(const GPUBlasDescriptor& desc, GPUBlasGeometrySizeDescrip
         geometry.geometry.triangles.vertexFormat           = vkenum(size.triangles.vertex_format);
         geometry.geometry.triangles.maxVertex              = size.triangles.vertex_count - 1;
         geometry.geometry.triangles.indexData.hostAddress  = nullptr;
-        geometry.geometry.triangles.indexType              = vkenum(size.triangles.index_format);
+        geometry.geometry.triangles.indexType              = indexed ? vkenum(size.triangles.index_format) : VK_INDEX_TYPE_NONE_KHR;
 
         // triangle build range
         auto& range           = ranges.back();
-        range.primitiveCount  = size.triangles.index_count / 3;
+        range.primitiveCount  = indexed ? size.triangles.index_count / 3 : size.triangles.vertex_count / 3;
         range.primitiveOffset = 0;
         range.firstVertex     = 0;
         range.transformOffset = 0;
 
-        // update max primitive count
-        max_primitive_count = std::max(max_primitive_count, range.primitiveOffset);
+        // sizes are queried with the primitive count of each geometry
+        max_primitive_counts.push_back(range.primitiveCount);
     }
 
     // configure build info
@@ -61,7 +64,11 @@ VulkanBlas::VulkanBlas(const GPUBlasDescriptor& desc, GPUBlasGeometrySizeDescrip
     this->sizes.pNext = nullptr;
     rhi->vtable.vkGetAccelerationStructureBuildSizesKHR(rhi->device,
         VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
-        &build, &max_primitive_count, &this->sizes);
+        &build, max_primitive_counts.data(), &this->sizes);
+
+    // compacted blas only needs storage for the compacted copy
+    if (desc.compacted_size != 0)
+        this->sizes.accelerationStructureSize = desc.compacted_size;
 
     // create buffer to store BLAS
     auto additional             = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR;
@@ -82,6 +89,13 @@ VulkanBlas::VulkanBlas(const GPUBlasDescriptor& desc, GPUBlasGeometrySizeDescrip
     if (result != VK_SUCCESS) destroy();
     vk_check(result);
 
+    // device address referenced by tlas instances
+    auto address_info                  = VkAccelerationStructureDeviceAddressInfoKHR{};
+    address_info.sType                 = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+    address_info.pNext                 = nullptr;
+    address_info.accelerationStructure = blas;
+    reference                          = rhi->vtable.vkGetAccelerationStructureDeviceAddressKHR(rhi->device, &address_info);
+
     if (desc.label)
         rhi->set_debug_label(VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)blas, desc.label);
 }
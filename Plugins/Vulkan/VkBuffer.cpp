@@ -26,39 +26,50 @@ VulkanBuffer::VulkanBuffer(const GPUBufferDescriptor& desc, VkBufferUsageFlags a
     alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO;
     alloc_create_info.flags = 0;
 
-    bool dedicate_memory = true;
-
     if (desc.mapped_at_creation) {
         alloc_create_info.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
-        dedicate_memory = false;
+        if (!desc.usage.contains(GPUBufferUsage::MAP_READ))
+            alloc_create_info.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
     }
 
     if (desc.usage.contains(GPUBufferUsage::MAP_READ)) {
         alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
         alloc_create_info.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
-        dedicate_memory = false;
     }
 
     if (desc.usage.contains(GPUBufferUsage::MAP_WRITE)) {
         alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
         alloc_create_info.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
-        dedicate_memory = false;
     }
 
     if (desc.usage.contains(GPUBufferUsage::UNIFORM)) {
         alloc_create_info.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT;
         alloc_create_info.flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
-        dedicate_memory = false;
     }
 
-    if (dedicate_memory) {
-        alloc_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
-    }
+    // sub-allocate from the pool of the matching usage class,
+    // memory type is taken from the pool when one is selected.
+    alloc_create_info.pool = rhi->pools.select(desc);
 
     // create buffer
-    vk_check(vmaCreateBuffer(
+    auto result = vmaCreateBuffer(
         rhi->alloc, &buffer_create_info, &alloc_create_info,
-        &buffer, &allocation, &alloc_info));
+        &buffer, &allocation, &alloc_info);
+
+    // fallback to the default allocator if the pool memory type is incompatible with this buffer,
+    // other failures (e.g. out of memory) are not hidden behind a second allocation
+    if (result == VK_ERROR_FEATURE_NOT_PRESENT && alloc_create_info.pool != VK_NULL_HANDLE) {
+        get_logger()->warn("Memory pool is incompatible with buffer {}, using the default allocator!", desc.label);
+        alloc_create_info.pool = VK_NULL_HANDLE;
+        result                 = vmaCreateBuffer(
+            rhi->alloc, &buffer_create_info, &alloc_create_info,
+            &buffer, &allocation, &alloc_info);
+    }
+    vk_check(result);
+
+    // record the create parameters
+    size  = buffer_create_info.size;
+    usage = buffer_create_info.usage;
 
     if (desc.mapped_at_creation) {
         mapped_data = reinterpret_cast<uint8_t*>(alloc_info.pMappedData);
@@ -81,6 +92,9 @@ void VulkanBuffer::map(GPUSize64 offset, GPUSize64 size)
     vk_check(vmaMapMemory(get_rhi()->alloc, allocation, &data));
     mapped_data = reinterpret_cast<uint8_t*>(data) + offset;
     mapped_size = size == 0 ? alloc_info.size : size;
+
+    // make device writes visible to host (no-op for host coherent memory)
+    vk_check(vmaInvalidateAllocation(get_rhi()->alloc, allocation, offset, size == 0 ? VK_WHOLE_SIZE : size));
 }
 
 void VulkanBuffer::unmap()
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <algorithm>
 #include "VkUtils.h"
 
@@ -16,7 +17,6 @@ void VulkanCommandBuffer::wait(const VulkanSemaphore& fence, GPUBarrierSyncFlags
 
 void VulkanCommandBuffer::signal(const VulkanSemaphore& fence, GPUBarrierSyncFlags sync)
 {
-    auto rhi = get_rhi();
     signal_semaphores.push_back(VkSemaphoreSubmitInfo{});
 
     auto& submit_info       = signal_semaphores.back();
@@ -26,23 +26,21 @@ void VulkanCommandBuffer::signal(const VulkanSemaphore& fence, GPUBarrierSyncFla
     submit_info.value       = fence.type == VK_SEMAPHORE_TYPE_BINARY ? 0 : fence.target;
     submit_info.stageMask   = vkenum(sync);
     submit_info.deviceIndex = 0;
-
-    // attach the inflight fence if this command buffer signals render complete semaphore
-    auto& frame    = rhi->current_frame();
-    auto& complete = fetch_resource(rhi->fences, frame.render_complete_semaphore);
-    if (fence.semaphore == complete.semaphore)
-        this->fence = frame.inflight_fence;
 }
 
 void VulkanCommandBuffer::reset()
 {
-    for (auto& buffer : temporary_buffers)
-        buffer.destroy();
+    auto rhi = get_rhi();
+
+    // the frame has completed on GPU, staging buffers can be reused
+    for (auto& staging : temporary_buffers)
+        rhi->staging.recycle(staging);
 
     temporary_buffers.clear();
+    temporary_head = 0ull;
 }
 
-void VulkanCommandBuffer::submit()
+void VulkanCommandBuffer::submit(VkCommandBuffer prologue)
 {
     auto rhi = get_rhi();
 
@@ -52,18 +50,91 @@ void VulkanCommandBuffer::submit()
     cmd_submit_info.commandBuffer = command_buffer;
     cmd_submit_info.deviceMask    = 0;
 
-    auto submit_info                     = VkSubmitInfo2{};
-    submit_info.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
-    submit_info.pNext                    = nullptr;
-    submit_info.flags                    = 0;
-    submit_info.commandBufferInfoCount   = 1;
-    submit_info.pCommandBufferInfos      = &cmd_submit_info;
-    submit_info.waitSemaphoreInfoCount   = static_cast<uint32_t>(wait_semaphores.size());
-    submit_info.pWaitSemaphoreInfos      = wait_semaphores.data();
-    submit_info.signalSemaphoreInfoCount = static_cast<uint32_t>(signal_semaphores.size());
-    submit_info.pSignalSemaphoreInfos    = signal_semaphores.data();
+    auto submission    = VulkanSubmitQueue::Submission{};
+    submission.queue   = command_queue;
+    submission.waits   = wait_semaphores;
+    submission.signals = signal_semaphores;
+
+    // prologue (if any) is executed right before this command buffer
+    if (prologue != VK_NULL_HANDLE) {
+        auto prologue_info          = cmd_submit_info;
+        prologue_info.commandBuffer = prologue;
+        submission.commands.push_back(prologue_info);
+    }
+    submission.commands.push_back(cmd_submit_info);
+
+    rhi->submits.push(std::move(submission));
+}
+
+void VulkanSubmitQueue::push(Submission&& submission)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(submission));
+}
+
+void VulkanSubmitQueue::flush()
+{
+    auto rhi = get_rhi();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.empty())
+        return;
+
+    Vector<VkSubmitInfo2> submit_infos(pending.size());
+    for (size_t i = 0; i < pending.size(); i++) {
+        auto& submission                     = pending.at(i);
+        auto& submit_info                    = submit_infos.at(i);
+        submit_info.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        submit_info.pNext                    = nullptr;
+        submit_info.flags                    = 0;
+        submit_info.commandBufferInfoCount   = static_cast<uint32_t>(submission.commands.size());
+        submit_info.pCommandBufferInfos      = submission.commands.data();
+        submit_info.waitSemaphoreInfoCount   = static_cast<uint32_t>(submission.waits.size());
+        submit_info.pWaitSemaphoreInfos      = submission.waits.data();
+        submit_info.signalSemaphoreInfoCount = static_cast<uint32_t>(submission.signals.size());
+        submit_info.pSignalSemaphoreInfos    = submission.signals.data();
+    }
+
+    // runs of submissions to the same queue are submitted together, runs are submitted in order
+    GPUSize64 queue_submits = 0;
+    {
+        // queues must be externally synchronized
+        std::lock_guard<std::mutex> queue_lock(rhi->queue_mutex);
+        for (size_t first = 0, last = 0; first < pending.size(); first = last) {
+            while (last < pending.size() && pending.at(last).queue == pending.at(first).queue)
+                last++;
+
+            auto count = static_cast<uint32_t>(last - first);
+            vk_check(rhi->vtable.vkQueueSubmit2KHR(pending.at(first).queue, count, submit_infos.data() + first, VK_NULL_HANDLE));
+            queue_submits++;
+        }
+    }
 
-    vk_check(rhi->vtable.vkQueueSubmit2KHR(command_queue, 1, &submit_info, fence.fence));
+    {
+        std::lock_guard<std::mutex> stats_lock(rhi->stats_mutex);
+        rhi->command_stats.submissions += pending.size();
+        rhi->command_stats.queue_submits += queue_submits;
+    }
+    pending.clear();
+}
+
+bool VulkanSubmitQueue::empty()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.empty();
+}
+
+void VulkanCommandBuffer::end_statistics(VkCommandBuffer primary)
+{
+    if (statistics_pool == VK_NULL_HANDLE)
+        return;
+
+    auto rhi = get_rhi();
+    rhi->vtable.vkCmdEndQuery(primary, statistics_pool, statistics_query);
+
+    statistics_pool  = VK_NULL_HANDLE;
+    statistics_query = 0;
+    statistics       = 0;
 }
 
 void VulkanCommandBuffer::begin()
@@ -79,10 +150,174 @@ void VulkanCommandBuffer::begin()
     vk_check(rhi->vtable.vkBeginCommandBuffer(command_buffer, &begin_info));
 }
 
+void VulkanCommandBuffer::begin(const GPUCommandBundleDescriptor& desc)
+{
+    auto rhi = get_rhi();
+
+    Vector<VkFormat> color_formats;
+    for (auto& format : desc.color_formats)
+        color_formats.push_back(vkenum(format));
+
+    // bundles recorded for a render pass inherit its attachment layout
+    auto rendering_info                    = VkCommandBufferInheritanceRenderingInfo{};
+    rendering_info.sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    rendering_info.pNext                   = nullptr;
+    rendering_info.flags                   = 0;
+    rendering_info.viewMask                = 0;
+    rendering_info.colorAttachmentCount    = static_cast<uint32_t>(color_formats.size());
+    rendering_info.pColorAttachmentFormats = color_formats.data();
+    rendering_info.depthAttachmentFormat   = is_depth_format(desc.depth_stencil_format) ? vkenum(desc.depth_stencil_format) : VK_FORMAT_UNDEFINED;
+    rendering_info.stencilAttachmentFormat = is_stencil_format(desc.depth_stencil_format) ? vkenum(desc.depth_stencil_format) : VK_FORMAT_UNDEFINED;
+    rendering_info.rasterizationSamples    = vkenum(desc.sample_count);
+
+    bool inside_render_pass = !color_formats.empty() || is_depth_stencil_format(desc.depth_stencil_format);
+
+    auto inheritance_info  = VkCommandBufferInheritanceInfo{};
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.pNext = inside_render_pass ? &rendering_info : nullptr;
+
+    auto begin_info             = VkCommandBufferBeginInfo{};
+    begin_info.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.pNext            = nullptr;
+    begin_info.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = &inheritance_info;
+
+    if (inside_render_pass)
+        begin_info.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+
+    vk_check(rhi->vtable.vkBeginCommandBuffer(command_buffer, &begin_info));
+}
+
 void VulkanCommandBuffer::end()
 {
     auto rhi = get_rhi();
     vk_check(rhi->vtable.vkEndCommandBuffer(command_buffer));
+
+    std::lock_guard<std::mutex> lock(rhi->stats_mutex);
+    rhi->command_stats += stats;
+    stats = GPUCommandStats{};
+}
+
+void VulkanCommandBuffer::flush_vertex_buffers()
+{
+    auto rhi = get_rhi();
+
+    // bind each run of consecutive dirty slots with a single command
+    while (dirty_vertex_buffers != 0) {
+        uint first = 0;
+        while (!(dirty_vertex_buffers & (1u << first)))
+            first++;
+
+        uint last = first;
+        while (last < MAX_VERTEX_BUFFERS && (dirty_vertex_buffers & (1u << last)))
+            last++;
+
+        Array<VkBuffer, MAX_VERTEX_BUFFERS>     buffers;
+        Array<VkDeviceSize, MAX_VERTEX_BUFFERS> offsets;
+        Array<VkDeviceSize, MAX_VERTEX_BUFFERS> sizes;
+
+        bool sized = false;
+        for (uint i = first; i < last; i++) {
+            auto& binding              = vertex_buffers.at(i);
+            buffers.at(i - first)      = binding.buffer;
+            offsets.at(i - first)      = binding.offset;
+            sizes.at(i - first)        = binding.size == 0 ? VK_WHOLE_SIZE : binding.size;
+            bound_vertex_buffers.at(i) = binding;
+            sized |= binding.size != 0;
+        }
+
+        uint count = last - first;
+        if (sized) {
+            rhi->vtable.vkCmdBindVertexBuffers2(command_buffer, first, count, buffers.data(), offsets.data(), sizes.data(), nullptr);
+        } else {
+            rhi->vtable.vkCmdBindVertexBuffers(command_buffer, first, count, buffers.data(), offsets.data());
+        }
+        stats.merged_vertex_buffers += count - 1;
+
+        for (uint i = first; i < last; i++)
+            dirty_vertex_buffers &= ~(1u << i);
+    }
+}
+
+void VulkanCommandBuffer::invalidate_bindings()
+{
+    // descriptor sets and push constants are not guaranteed to survive a pipeline layout change
+    bound_bind_groups.fill(BoundBindGroup{});
+    push_constants_valid  = 0;
+    push_constants_stages = 0;
+}
+
+void VulkanCommandBuffer::invalidate_state()
+{
+    invalidate_bindings();
+
+    last_bound_pipeline = VK_NULL_HANDLE;
+    last_bound_layout   = VK_NULL_HANDLE;
+
+    // force the requested vertex buffers to be re-emitted before the next draw
+    for (uint i = 0; i < MAX_VERTEX_BUFFERS; i++) {
+        bound_vertex_buffers.at(i) = BoundBuffer{};
+        if (vertex_buffers.at(i).buffer != VK_NULL_HANDLE)
+            dirty_vertex_buffers |= 1u << i;
+    }
+
+    bound_index_buffer = BoundBuffer{};
+    bound_viewport.reset();
+    bound_scissor.reset();
+}
+
+// draws and dispatches are dropped while the bound pipeline is still compiling
+static bool skip_action(VulkanCommandBuffer& cmd)
+{
+    if (cmd.pipeline_pending)
+        cmd.stats.skipped_actions++;
+    return cmd.pipeline_pending;
+}
+
+// tracked command buffers synchronize the resources used by draws and dispatches
+static void track_action(VulkanCommandBuffer& cmd, GPUBufferHandle indirect_buffer = {}, GPUBufferHandle count_buffer = {})
+{
+    if (!cmd.tracked)
+        return;
+
+    // storage writes of consecutive dispatches depend on each other, hence always tracked
+    if (!cmd.bindings_tracked || cmd.last_bound_point != VK_PIPELINE_BIND_POINT_GRAPHICS) {
+        cmd.track_bindings();
+        cmd.bindings_tracked = true;
+    }
+
+    auto access   = VulkanResourceAccess{};
+    access.stages = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+    access.access = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+    if (indirect_buffer.valid())
+        cmd.track(indirect_buffer, access);
+    if (count_buffer.valid())
+        cmd.track(count_buffer, access);
+
+    cmd.flush_barriers();
+}
+
+static void track_transfer(VulkanCommandBuffer& cmd, GPUBufferHandle buffer, bool write)
+{
+    auto access   = VulkanResourceAccess{};
+    access.stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    access.access = write ? VK_ACCESS_2_TRANSFER_WRITE_BIT : VK_ACCESS_2_TRANSFER_READ_BIT;
+    cmd.track(buffer, access);
+}
+
+static void track_transfer(VulkanCommandBuffer& cmd, const GPUTexelCopyTextureInfo& texture, bool write)
+{
+    auto range           = VkImageSubresourceRange{};
+    range.baseMipLevel   = texture.mip_level;
+    range.levelCount     = 1;
+    range.baseArrayLayer = 0;
+    range.layerCount     = 1;
+
+    auto access   = VulkanResourceAccess{};
+    access.stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    access.access = write ? VK_ACCESS_2_TRANSFER_WRITE_BIT : VK_ACCESS_2_TRANSFER_READ_BIT;
+    access.layout = write ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    cmd.track(texture.texture, range, access);
 }
 
 void cmd::insert_debug_marker(GPUCommandEncoderHandle cmdbuffer, CString marker_label)
@@ -224,6 +459,7 @@ void cmd::begin_render_pass(GPUCommandEncoderHandle cmdbuffer, const GPURenderPa
     auto rendering                 = VkRenderingInfo{};
     rendering.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO;
     rendering.pNext                = nullptr;
+    rendering.flags                = descriptor.bundles_only ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
     rendering.renderArea           = render_area;
     rendering.layerCount           = 1;
     rendering.colorAttachmentCount = static_cast<uint32_t>(descriptor.color_attachments.size());
@@ -231,7 +467,40 @@ void cmd::begin_render_pass(GPUCommandEncoderHandle cmdbuffer, const GPURenderPa
     rendering.pDepthAttachment     = has_depth_attachment ? &depth_attachment : nullptr;
     rendering.pStencilAttachment   = has_stencil_attachment ? &stencil_attachment : nullptr;
 
-    rhi->vtable.vkCmdBeginRenderingKHR(cmd.command_buffer, &rendering);
+    if (!cmd.tracked) {
+        rhi->vtable.vkCmdBeginRenderingKHR(cmd.command_buffer, &rendering);
+    } else {
+        // the pass begins once its contents (and hence its barriers) are known
+        auto pass      = VulkanCommandBuffer::DeferredRenderPass{};
+        pass.colors    = color_attachments;
+        pass.depth     = depth_attachment;
+        pass.stencil   = stencil_attachment;
+        pass.rendering = rendering;
+        pass.samples   = view.samples;
+        for (auto& attachment : descriptor.color_attachments)
+            pass.color_formats.push_back(fetch_resource(rhi->views, attachment.view).format);
+        if (has_depth_stencil) {
+            auto& ds            = fetch_resource(rhi->views, descriptor.depth_stencil_attachment.view);
+            pass.depth_format   = has_depth_attachment ? ds.format : VK_FORMAT_UNDEFINED;
+            pass.stencil_format = has_stencil_attachment ? ds.format : VK_FORMAT_UNDEFINED;
+        }
+        cmd.begin_deferred_pass(std::move(pass));
+
+        auto color   = VulkanResourceAccess{};
+        color.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        color.access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        color.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        for (auto& attachment : descriptor.color_attachments)
+            cmd.track(attachment.view, color);
+
+        if (has_depth_stencil) {
+            auto depth   = VulkanResourceAccess{};
+            depth.stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+            depth.access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            depth.layout = depth_attachment.imageLayout;
+            cmd.track(descriptor.depth_stencil_attachment.view, depth);
+        }
+    }
 
     // record the query set used for this render pass
     if (descriptor.occlusion_query_set.valid()) {
@@ -244,21 +513,82 @@ void cmd::end_render_pass(GPUCommandEncoderHandle cmdbuffer)
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
 
+    if (cmd.deferred_pass.has_value()) {
+        cmd.end_deferred_pass();
+        return;
+    }
+
     rhi->vtable.vkCmdEndRenderingKHR(cmd.command_buffer);
 }
 
+void cmd::execute_bundles(GPUCommandEncoderHandle cmdbuffer, GPUCommandEncoderHandles bundles)
+{
+    auto  rhi = get_rhi();
+    auto& frm = rhi->current_frame();
+    auto& cmd = frm.command(cmdbuffer);
+
+    Vector<VkCommandBuffer> command_buffers;
+    for (auto& bundle : bundles)
+        command_buffers.push_back(frm.command(bundle).command_buffer);
+
+    // bundles do not inherit pipeline statistics, the active query ends before the pass or the bundles
+    cmd.end_statistics(cmd.deferred_pass.has_value() ? cmd.deferred_pass.value().primary : cmd.command_buffer);
+
+    // deferred passes are made of secondary command buffers, bundles are simply appended
+    if (cmd.deferred_pass.has_value()) {
+        vk_check(rhi->vtable.vkEndCommandBuffer(cmd.command_buffer));
+
+        auto& contents = cmd.deferred_pass.value().contents;
+        contents.insert(contents.end(), command_buffers.begin(), command_buffers.end());
+
+        cmd.invalidate_state();
+        cmd.next_deferred_contents();
+        return;
+    }
+
+    uint count = static_cast<uint>(command_buffers.size());
+    rhi->vtable.vkCmdExecuteCommands(cmd.command_buffer, count, command_buffers.data());
+
+    // bound state is undefined after executing secondary command buffers
+    cmd.invalidate_state();
+}
+
+static void bind_pipeline(VulkanCommandBuffer& cmd, const VulkanPipeline& pip, VkPipelineBindPoint point)
+{
+    auto rhi = get_rhi();
+
+    cmd.stats.state_commands++;
+
+    // asynchronous pipeline still compiling, actions are skipped until a ready pipeline is bound
+    cmd.pipeline_pending = pip.pending;
+
+    if (!pip.pending && pip.pipeline == cmd.last_bound_pipeline) {
+        cmd.stats.dropped_pipelines++;
+        return;
+    }
+
+    if (pip.layout != cmd.last_bound_layout || cmd.last_bound_point != point)
+        cmd.invalidate_bindings();
+
+    if (cmd.last_bound_point != point)
+        cmd.bind_group_handles.fill(GPUBindGroupHandle{});
+    cmd.bindings_tracked = false;
+
+    // bind groups and push constants set while the pipeline compiles use its layout and bind point,
+    // the pipeline itself is bound once a ready one is set.
+    cmd.last_bound_point    = point;
+    cmd.last_bound_layout   = pip.layout;
+    cmd.last_bound_pipeline = pip.pipeline;
+    if (!pip.pending)
+        rhi->vtable.vkCmdBindPipeline(cmd.command_buffer, cmd.last_bound_point, cmd.last_bound_pipeline);
+}
+
 void cmd::set_render_pipeline(GPUCommandEncoderHandle cmdbuffer, GPURenderPipelineHandle pipeline)
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto& pip = fetch_resource(rhi->pipelines, pipeline);
-
-    if (pip.pipeline != cmd.last_bound_pipeline) {
-        cmd.last_bound_point    = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        cmd.last_bound_layout   = pip.layout;
-        cmd.last_bound_pipeline = pip.pipeline;
-        rhi->vtable.vkCmdBindPipeline(cmd.command_buffer, cmd.last_bound_point, cmd.last_bound_pipeline);
-    }
+    bind_pipeline(cmd, pip, VK_PIPELINE_BIND_POINT_GRAPHICS);
 }
 
 void cmd::set_compute_pipeline(GPUCommandEncoderHandle cmdbuffer, GPUComputePipelineHandle pipeline)
@@ -266,13 +596,7 @@ void cmd::set_compute_pipeline(GPUCommandEncoderHandle cmdbuffer, GPUComputePipe
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto& pip = fetch_resource(rhi->pipelines, pipeline);
-
-    if (pip.pipeline != cmd.last_bound_pipeline) {
-        cmd.last_bound_point    = VK_PIPELINE_BIND_POINT_COMPUTE;
-        cmd.last_bound_layout   = pip.layout;
-        cmd.last_bound_pipeline = pip.pipeline;
-        rhi->vtable.vkCmdBindPipeline(cmd.command_buffer, cmd.last_bound_point, cmd.last_bound_pipeline);
-    }
+    bind_pipeline(cmd, pip, VK_PIPELINE_BIND_POINT_COMPUTE);
 }
 
 void cmd::set_raytracing_pipeline(GPUCommandEncoderHandle cmdbuffer, GPURayTracingPipelineHandle pipeline)
@@ -280,13 +604,7 @@ void cmd::set_raytracing_pipeline(GPUCommandEncoderHandle cmdbuffer, GPURayTraci
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto& pip = fetch_resource(rhi->pipelines, pipeline);
-
-    if (pip.pipeline != cmd.last_bound_pipeline) {
-        cmd.last_bound_point    = VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR;
-        cmd.last_bound_layout   = pip.layout;
-        cmd.last_bound_pipeline = pip.pipeline;
-        rhi->vtable.vkCmdBindPipeline(cmd.command_buffer, cmd.last_bound_point, cmd.last_bound_pipeline);
-    }
+    bind_pipeline(cmd, pip, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR);
 }
 
 void cmd::set_bind_group(GPUCommandEncoderHandle cmdbuffer, GPUIndex32 index, GPUBindGroupHandle bind_group, GPUBufferDynamicOffsets dynamic_offsets)
@@ -294,6 +612,23 @@ void cmd::set_bind_group(GPUCommandEncoderHandle cmdbuffer, GPUIndex32 index, GP
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto  des = rhi->current_frame().descriptor(bind_group);
+
+    cmd.stats.state_commands++;
+    if (index < VulkanCommandBuffer::MAX_BIND_GROUPS) {
+        cmd.bind_group_handles.at(index) = bind_group;
+        cmd.bindings_tracked             = false;
+
+        auto& bound = cmd.bound_bind_groups.at(index);
+        auto  same  = bound.descriptor == des && bound.offsets.size() == dynamic_offsets.size() &&
+                    std::equal(bound.offsets.begin(), bound.offsets.end(), dynamic_offsets.data());
+        if (same) {
+            cmd.stats.dropped_bind_groups++;
+            return;
+        }
+        bound.descriptor = des;
+        bound.offsets.assign(dynamic_offsets.data(), dynamic_offsets.data() + dynamic_offsets.size());
+    }
+
     rhi->vtable.vkCmdBindDescriptorSets(cmd.command_buffer, cmd.last_bound_point, cmd.last_bound_layout,
         index, 1, &des,
         static_cast<uint32_t>(dynamic_offsets.size()), dynamic_offsets.data());
@@ -303,7 +638,30 @@ void cmd::set_push_constants(GPUCommandEncoderHandle cmdbuffer, GPUShaderStageFl
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
-    rhi->vtable.vkCmdPushConstants(cmd.command_buffer, cmd.last_bound_layout, vkenum(visibility), offset, size, data);
+    auto  stg = vkenum(visibility);
+
+    cmd.stats.state_commands++;
+    if (offset + size <= VulkanCommandBuffer::MAX_PUSH_CONSTANTS) {
+        // push constant offset and size are multiples of 4
+        uint     first = offset / sizeof(uint32_t);
+        uint     count = size / sizeof(uint32_t);
+        uint64_t mask  = (count == 64 ? ~0ull : ((1ull << count) - 1)) << first;
+        auto     words = cmd.push_constants.data() + first;
+
+        if (stg != cmd.push_constants_stages) {
+            cmd.push_constants_valid  = 0;
+            cmd.push_constants_stages = stg;
+        }
+
+        if ((cmd.push_constants_valid & mask) == mask && std::memcmp(words, data, size) == 0) {
+            cmd.stats.dropped_push_constants++;
+            return;
+        }
+        std::memcpy(words, data, size);
+        cmd.push_constants_valid |= mask;
+    }
+
+    rhi->vtable.vkCmdPushConstants(cmd.command_buffer, cmd.last_bound_layout, stg, offset, size, data);
 }
 
 void cmd::set_index_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle buffer, GPUIndexFormat format, GPUSize64 offset, GPUSize64 size)
@@ -311,6 +669,23 @@ void cmd::set_index_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle bu
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto& buf = fetch_resource(rhi->buffers, buffer);
+
+    auto binding   = VulkanCommandBuffer::BoundBuffer{};
+    binding.buffer = buf.buffer;
+    binding.offset = offset;
+    binding.size   = size;
+    binding.type   = vkenum(format);
+
+    cmd.index_buffer_handle = buffer;
+    cmd.bindings_tracked    = false;
+
+    cmd.stats.state_commands++;
+    if (binding == cmd.bound_index_buffer) {
+        cmd.stats.dropped_index_buffers++;
+        return;
+    }
+    cmd.bound_index_buffer = binding;
+
     if (size == 0) {
         rhi->vtable.vkCmdBindIndexBuffer(cmd.command_buffer, buf.buffer, offset, vkenum(format));
     } else {
@@ -323,6 +698,32 @@ void cmd::set_vertex_buffer(GPUCommandEncoderHandle cmdbuffer, GPUIndex32 slot,
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto& buf = fetch_resource(rhi->buffers, buffer);
+
+    cmd.stats.state_commands++;
+    if (slot < VulkanCommandBuffer::MAX_VERTEX_BUFFERS) {
+        cmd.vertex_buffer_handles.at(slot) = buffer;
+        cmd.bindings_tracked               = false;
+
+        auto binding   = VulkanCommandBuffer::BoundBuffer{};
+        binding.buffer = buf.buffer;
+        binding.offset = offset;
+        binding.size   = size;
+
+        // overriding a pending bind or restoring the recorded one emits nothing
+        uint32_t bit = 1u << slot;
+        if (binding == cmd.bound_vertex_buffers.at(slot) || (cmd.dirty_vertex_buffers & bit))
+            cmd.stats.dropped_vertex_buffers++;
+
+        // binds are deferred until the next draw, so that consecutive slots are merged
+        cmd.vertex_buffers.at(slot) = binding;
+        if (binding == cmd.bound_vertex_buffers.at(slot)) {
+            cmd.dirty_vertex_buffers &= ~bit;
+        } else {
+            cmd.dirty_vertex_buffers |= bit;
+        }
+        return;
+    }
+
     if (size == 0) {
         rhi->vtable.vkCmdBindVertexBuffers(cmd.command_buffer, slot, 1, &buf.buffer, &offset);
     } else {
@@ -334,6 +735,11 @@ void cmd::draw(GPUCommandEncoderHandle cmdbuffer, GPUSize32 vertex_count, GPUSiz
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
+    if (skip_action(cmd))
+        return;
+
+    track_action(cmd);
+    cmd.flush_vertex_buffers();
     rhi->vtable.vkCmdDraw(cmd.command_buffer, vertex_count, instance_count, first_vertex, first_instance);
 }
 
@@ -341,6 +747,11 @@ void cmd::draw_indexed(GPUCommandEncoderHandle cmdbuffer, GPUSize32 index_count,
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
+    if (skip_action(cmd))
+        return;
+
+    track_action(cmd);
+    cmd.flush_vertex_buffers();
     rhi->vtable.vkCmdDrawIndexed(cmd.command_buffer, index_count, instance_count, first_index, base_vertex, first_instance);
 }
 
@@ -348,7 +759,12 @@ void cmd::draw_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indir
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
+    if (skip_action(cmd))
+        return;
+
     auto& buf = fetch_resource(rhi->buffers, indirect_buffer);
+    track_action(cmd, indirect_buffer);
+    cmd.flush_vertex_buffers();
     rhi->vtable.vkCmdDrawIndirect(cmd.command_buffer, buf.buffer, indirect_offset, draw_count, static_cast<uint32_t>(sizeof(VkDrawIndirectCommand)));
 }
 
@@ -356,14 +772,51 @@ void cmd::draw_indexed_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHand
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
+    if (skip_action(cmd))
+        return;
+
     auto& buf = fetch_resource(rhi->buffers, indirect_buffer);
+    track_action(cmd, indirect_buffer);
+    cmd.flush_vertex_buffers();
     rhi->vtable.vkCmdDrawIndexedIndirect(cmd.command_buffer, buf.buffer, indirect_offset, draw_count, static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand)));
 }
 
+void cmd::draw_indirect_count(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    if (skip_action(cmd))
+        return;
+
+    auto& buf = fetch_resource(rhi->buffers, indirect_buffer);
+    auto& cnt = fetch_resource(rhi->buffers, count_buffer);
+    track_action(cmd, indirect_buffer, count_buffer);
+    cmd.flush_vertex_buffers();
+    rhi->vtable.vkCmdDrawIndirectCountKHR(cmd.command_buffer, buf.buffer, indirect_offset, cnt.buffer, count_offset, max_draw_count, static_cast<uint32_t>(sizeof(VkDrawIndirectCommand)));
+}
+
+void cmd::draw_indexed_indirect_count(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    if (skip_action(cmd))
+        return;
+
+    auto& buf = fetch_resource(rhi->buffers, indirect_buffer);
+    auto& cnt = fetch_resource(rhi->buffers, count_buffer);
+    track_action(cmd, indirect_buffer, count_buffer);
+    cmd.flush_vertex_buffers();
+    rhi->vtable.vkCmdDrawIndexedIndirectCountKHR(cmd.command_buffer, buf.buffer, indirect_offset, cnt.buffer, count_offset, max_draw_count, static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand)));
+}
+
 void cmd::dispatch_workgroups(GPUCommandEncoderHandle cmdbuffer, GPUSize32 x, GPUSize32 y, GPUSize32 z)
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
+    if (skip_action(cmd))
+        return;
+
+    track_action(cmd);
     rhi->vtable.vkCmdDispatch(cmd.command_buffer, x, y, z);
 }
 
@@ -371,7 +824,11 @@ void cmd::dispatch_workgroups_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBuf
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
+    if (skip_action(cmd))
+        return;
+
     auto& buf = fetch_resource(rhi->buffers, indirect_buffer);
+    track_action(cmd, indirect_buffer);
     rhi->vtable.vkCmdDispatchIndirect(cmd.command_buffer, buf.buffer, indirect_offset);
 }
 
@@ -387,9 +844,57 @@ void cmd::copy_buffer_to_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHand
     copy.srcOffset = source_offset;
     copy.dstOffset = destination_offset;
 
+    if (cmd.tracked) {
+        track_transfer(cmd, source, false);
+        track_transfer(cmd, destination, true);
+        cmd.flush_barriers();
+    }
+
     rhi->vtable.vkCmdCopyBuffer(cmd.command_buffer, src.buffer, dst.buffer, 1, &copy);
 }
 
+// copies data into the staging buffers of the command buffer, returns the offset into the last staging buffer
+static auto stage_temporary(VulkanCommandBuffer& cmd, const void* data, GPUSize64 size) -> GPUSize64
+{
+    auto rhi = get_rhi();
+
+    // updates are packed into the last staging buffer of this command buffer while they fit
+    GPUSize64 head = (cmd.temporary_head + 15) / 16 * 16;
+    if (cmd.temporary_buffers.empty() || head + size > cmd.temporary_buffers.back().size) {
+        cmd.temporary_buffers.push_back(rhi->staging.acquire(size));
+        head = 0ull;
+    }
+
+    // no-op flush for host coherent memory
+    auto& staging = cmd.temporary_buffers.back().buffer;
+    std::memcpy(staging.mapped_data + head, data, size);
+    vk_check(vmaFlushAllocation(rhi->alloc, staging.allocation, head, size));
+    cmd.temporary_head = head + size;
+    return head;
+}
+
+void cmd::update_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    auto& dst = fetch_resource(rhi->buffers, buffer);
+
+    auto  head    = stage_temporary(cmd, data, size);
+    auto& staging = cmd.temporary_buffers.back().buffer;
+
+    auto copy      = VkBufferCopy{};
+    copy.size      = size;
+    copy.srcOffset = head;
+    copy.dstOffset = offset;
+
+    if (cmd.tracked) {
+        track_transfer(cmd, buffer, true);
+        cmd.flush_barriers();
+    }
+
+    rhi->vtable.vkCmdCopyBuffer(cmd.command_buffer, staging.buffer, dst.buffer, 1, &copy);
+}
+
 void cmd::copy_buffer_to_texture(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyBufferInfo& source, const GPUTexelCopyTextureInfo& destination, GPUExtent3D copy_size)
 {
     auto  rhi = get_rhi();
@@ -412,6 +917,12 @@ void cmd::copy_buffer_to_texture(GPUCommandEncoderHandle cmdbuffer, const GPUTex
     copy.imageSubresource.baseArrayLayer = 0; // TODO: Is WebGPU able to set this?
     copy.imageSubresource.layerCount     = 1; // TODO: Is WebGPU able to set this?
 
+    if (cmd.tracked) {
+        track_transfer(cmd, source.buffer, false);
+        track_transfer(cmd, destination, true);
+        cmd.flush_barriers();
+    }
+
     auto layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     rhi->vtable.vkCmdCopyBufferToImage(cmd.command_buffer, src.buffer, dst.image, layout, 1, &copy);
 }
@@ -441,6 +952,12 @@ void cmd::copy_texture_to_buffer(GPUCommandEncoderHandle cmdbuffer, const GPUTex
     copy.imageSubresource.baseArrayLayer = 0; // TODO: Is WebGPU able to set this?
     copy.imageSubresource.layerCount     = 1; // TODO: Is WebGPU able to set this?
 
+    if (cmd.tracked) {
+        track_transfer(cmd, source, false);
+        track_transfer(cmd, destination.buffer, true);
+        cmd.flush_barriers();
+    }
+
     auto layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
     rhi->vtable.vkCmdCopyImageToBuffer(cmd.command_buffer, src.image, layout, dst.buffer, 1, &copy);
 }
@@ -471,6 +988,12 @@ void cmd::copy_texture_to_texture(GPUCommandEncoderHandle cmdbuffer, const GPUTe
     copy.dstSubresource.baseArrayLayer = 0; // TODO: Is WebGPU able to set this?
     copy.dstSubresource.layerCount     = 1; // TODO: Is WebGPU able to set this?
 
+    if (cmd.tracked) {
+        track_transfer(cmd, source, false);
+        track_transfer(cmd, destination, true);
+        cmd.flush_barriers();
+    }
+
     auto src_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
     auto dst_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     rhi->vtable.vkCmdCopyImage(cmd.command_buffer, src.image, src_layout, dst.image, dst_layout, 1, &copy);
@@ -482,6 +1005,11 @@ void cmd::clear_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle buffer
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto& buf = fetch_resource(rhi->buffers, buffer);
 
+    if (cmd.tracked) {
+        track_transfer(cmd, buffer, true);
+        cmd.flush_barriers();
+    }
+
     rhi->vtable.vkCmdFillBuffer(
         cmd.command_buffer,
         buf.buffer,
@@ -503,6 +1031,13 @@ void cmd::set_viewport(GPUCommandEncoderHandle cmdbuffer, float x, float y, floa
     viewport.minDepth = min_depth;
     viewport.maxDepth = max_depth;
 
+    cmd.stats.state_commands++;
+    if (cmd.bound_viewport.has_value() && std::memcmp(&cmd.bound_viewport.value(), &viewport, sizeof(VkViewport)) == 0) {
+        cmd.stats.dropped_viewports++;
+        return;
+    }
+    cmd.bound_viewport = viewport;
+
     rhi->vtable.vkCmdSetViewport(cmd.command_buffer, 0, 1, &viewport);
 }
 
@@ -517,6 +1052,13 @@ void cmd::set_scissor_rect(GPUCommandEncoderHandle cmdbuffer, GPUIntegerCoordina
     scissor.extent.width  = w;
     scissor.extent.height = h;
 
+    cmd.stats.state_commands++;
+    if (cmd.bound_scissor.has_value() && std::memcmp(&cmd.bound_scissor.value(), &scissor, sizeof(VkRect2D)) == 0) {
+        cmd.stats.dropped_scissors++;
+        return;
+    }
+    cmd.bound_scissor = scissor;
+
     rhi->vtable.vkCmdSetScissor(cmd.command_buffer, 0, 1, &scissor);
 }
 
@@ -573,7 +1115,39 @@ void cmd::write_timestamp(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle q
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto& qry = fetch_resource(rhi->query_sets, query_set);
 
-    rhi->vtable.vkCmdWriteTimestamp(cmd.command_buffer, VK_PIPELINE_STAGE_NONE, qry.pool, query_index);
+    // timestamp is written once all previous commands have completed
+    rhi->vtable.vkCmdWriteTimestamp(cmd.command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, qry.pool, query_index);
+}
+
+void cmd::begin_pipeline_statistics_query(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    auto& qry = fetch_resource(rhi->query_sets, query_set);
+
+    assert(qry.type == VK_QUERY_TYPE_PIPELINE_STATISTICS);
+    assert(!cmd.deferred_pass.has_value() && "Pipeline statistics queries must begin outside of render passes!");
+    assert(cmd.statistics_pool == VK_NULL_HANDLE && "At most one pipeline statistics query may be active!");
+    rhi->vtable.vkCmdBeginQuery(cmd.command_buffer, qry.pool, query_index, 0);
+
+    // deferred render pass contents inherit the active query when the device allows it
+    cmd.statistics_pool  = qry.pool;
+    cmd.statistics_query = query_index;
+    cmd.statistics       = rhi->inherited_queries ? qry.statistics : 0;
+}
+
+void cmd::end_pipeline_statistics_query(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    auto& qry = fetch_resource(rhi->query_sets, query_set);
+
+    assert(qry.type == VK_QUERY_TYPE_PIPELINE_STATISTICS);
+    assert(!cmd.deferred_pass.has_value() && "Pipeline statistics queries must end outside of render passes!");
+
+    // the query may have been ended early, before secondary command buffers it could not cover
+    if (cmd.statistics_pool == qry.pool && cmd.statistics_query == query_index)
+        cmd.end_statistics(cmd.command_buffer);
 }
 
 void cmd::write_blas_properties(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index, GPUBlasHandle blas)
@@ -593,8 +1167,14 @@ void cmd::resolve_query_set(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle
     auto& qry = fetch_resource(rhi->query_sets, query_set);
     auto& buf = fetch_resource(rhi->buffers, destination);
 
-    auto stride = sizeof(uint64_t); // NOTE: This might not be good enough. We might determine the stride based on query type.
-    rhi->vtable.vkCmdCopyQueryPoolResults(cmd.command_buffer, qry.pool, first_query, query_count, buf.buffer, destination_offset, stride, 0);
+    if (cmd.tracked) {
+        track_transfer(cmd, destination, true);
+        cmd.flush_barriers();
+    }
+
+    auto stride = qry.stride;
+    auto flags  = VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT;
+    rhi->vtable.vkCmdCopyQueryPoolResults(cmd.command_buffer, qry.pool, first_query, query_count, buf.buffer, destination_offset, stride, flags);
 }
 
 void cmd::memory_barrier(GPUCommandEncoderHandle cmdbuffer, GPUMemoryBarriers barriers)
@@ -632,6 +1212,19 @@ void cmd::buffer_barrier(GPUCommandEncoderHandle cmdbuffer, GPUBufferBarriers ba
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
 
+    // destination states are recorded, tracked command buffers infer the source states
+    for (auto& barrier : barriers) {
+        auto access   = VulkanResourceAccess{};
+        access.stages = vkenum(barrier.dst_sync);
+        access.access = vkenum(barrier.dst_access);
+        cmd.track(barrier.buffer, access);
+    }
+
+    if (cmd.tracked) {
+        cmd.flush_barriers();
+        return;
+    }
+
     Vector<VkBufferMemoryBarrier2KHR> bars;
     for (auto& barrier : barriers) {
         auto b                = VkBufferMemoryBarrier2KHR{};
@@ -667,6 +1260,26 @@ void cmd::texture_barrier(GPUCommandEncoderHandle cmdbuffer, GPUTextureBarriers
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
 
+    // destination states are recorded, tracked command buffers infer the source states
+    for (auto& barrier : barriers) {
+        auto range           = VkImageSubresourceRange{};
+        range.baseMipLevel   = barrier.subresources.base_mip_level;
+        range.levelCount     = barrier.subresources.mip_level_count;
+        range.baseArrayLayer = barrier.subresources.base_array_layer;
+        range.layerCount     = barrier.subresources.array_layers;
+
+        auto access   = VulkanResourceAccess{};
+        access.stages = vkenum(barrier.dst_sync);
+        access.access = vkenum(barrier.dst_access);
+        access.layout = vkenum(barrier.dst_layout);
+        cmd.track(barrier.texture, range, access);
+    }
+
+    if (cmd.tracked) {
+        cmd.flush_barriers();
+        return;
+    }
+
     Vector<VkImageMemoryBarrier2KHR> bars;
     for (auto& barrier : barriers) {
         auto& t         = fetch_resource(rhi->textures, barrier.texture);
@@ -703,17 +1316,94 @@ void cmd::texture_barrier(GPUCommandEncoderHandle cmdbuffer, GPUTextureBarriers
     rhi->vtable.vkCmdPipelineBarrier2KHR(cmd.command_buffer, &dependency);
 }
 
+// converts the column major 4x3 transform into the row major 3x4 matrix of vulkan instances
+static void write_tlas_instance(VkAccelerationStructureInstanceKHR& record, const GPUTlasInstance& instance)
+{
+    auto  rhi  = get_rhi();
+    auto& blas = fetch_resource(rhi->blases, instance.blas);
+
+    for (uint row = 0; row < 3; row++)
+        for (uint col = 0; col < 4; col++)
+            record.transform.matrix[row][col] = instance.transform[col][row];
+
+    record.instanceCustomIndex                    = instance.custom_data;
+    record.instanceShaderBindingTableRecordOffset = 0; // NOTE: We don't support more complex cases for now.
+    record.mask                                   = instance.mask;
+    record.flags                                  = blas.build.flags;
+    record.accelerationStructureReference         = blas.reference;
+}
+
+void cmd::update_tlas_instances(GPUCommandEncoderHandle cmdbuffer, GPUTlasHandle tlas, GPUTlasInstanceUpdates updates)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    auto& dst = fetch_resource(rhi->tlases, tlas);
+
+    if (updates.empty())
+        return;
+
+    Vector<VkAccelerationStructureInstanceKHR> records(updates.size());
+    for (uint i = 0; i < updates.size(); i++) {
+        assert(updates.at(i).index < dst.max_instance_count && "tlas instance index out of range!");
+        write_tlas_instance(records.at(i), updates.at(i).instance);
+    }
+
+    auto  stride  = GPUSize64(sizeof(VkAccelerationStructureInstanceKHR));
+    auto  head    = stage_temporary(cmd, records.data(), stride * records.size());
+    auto& staging = cmd.temporary_buffers.back().buffer;
+
+    // consecutive instance indices are merged into a single copy region
+    Vector<VkBufferCopy> copies;
+    for (uint i = 0; i < updates.size(); i++) {
+        auto index = GPUSize64(updates.at(i).index);
+        if (!copies.empty() && copies.back().dstOffset + copies.back().size == index * stride) {
+            copies.back().size += stride;
+            continue;
+        }
+
+        auto copy      = VkBufferCopy{};
+        copy.srcOffset = head + stride * i;
+        copy.dstOffset = index * stride;
+        copy.size      = stride;
+        copies.push_back(copy);
+    }
+
+    // previous builds may still read the instance records
+    auto before          = VkMemoryBarrier{};
+    before.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    before.pNext         = nullptr;
+    before.srcAccessMask = 0;
+    before.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    rhi->vtable.vkCmdPipelineBarrier(
+        cmd.command_buffer,
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &before, 0, nullptr, 0, nullptr);
+
+    rhi->vtable.vkCmdCopyBuffer(cmd.command_buffer, staging.buffer, dst.instances.buffer, static_cast<uint32_t>(copies.size()), copies.data());
+
+    // wait until copies have completed
+    auto after          = VkMemoryBarrier{};
+    after.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    after.pNext         = nullptr;
+    after.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    after.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+    rhi->vtable.vkCmdPipelineBarrier(
+        cmd.command_buffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+        0, 1, &after, 0, nullptr, 0, nullptr);
+}
+
 void cmd::build_tlases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUTlasBuildEntries entries)
 {
     auto  rhi = get_rhi();
     auto& cmd = rhi->current_frame().command(cmdbuffer);
     auto& buf = fetch_resource(rhi->buffers, scratch_buffer);
 
-    Vector<VkBufferMemoryBarrier>                       barriers;
     Vector<VkAccelerationStructureBuildGeometryInfoKHR> build_infos  = {};
     Vector<VkAccelerationStructureBuildRangeInfoKHR*>   build_ranges = {};
 
-    barriers.reserve(entries.size());
     build_infos.reserve(entries.size());
     build_ranges.reserve(entries.size());
 
@@ -721,77 +1411,47 @@ void cmd::build_tlases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratc
     for (auto& entry : entries) {
         auto& tlas = fetch_resource(rhi->tlases, entry.tlas);
 
-        // create VkAccelerationStructureInstanceKHR on the fly
-        auto address = tlas.staging.map<VkAccelerationStructureInstanceKHR>();
-        for (auto& instance : entry.instances) {
-            auto& blas = fetch_resource(rhi->blases, instance.blas);
-
-            float* src_transform = reinterpret_cast<float*>(instance.transform);
-            float* dst_transform = reinterpret_cast<float*>(address->transform.matrix);
-            std::memcpy(dst_transform, src_transform, 12);
-            address->instanceCustomIndex                    = instance.custom_data;
-            address->instanceShaderBindingTableRecordOffset = 0; // NOTE: We don't support more complex cases for now.
-            address->mask                                   = instance.mask;
-            address->flags                                  = blas.build.flags;
-            address->accelerationStructureReference         = blas.reference;
-
-            address++;
+        // instances given with the build replace all instance records
+        uint instance_count = entry.instance_count;
+        if (!entry.instances.empty()) {
+            Vector<GPUTlasInstanceUpdate> updates(entry.instances.size());
+            for (uint i = 0; i < updates.size(); i++) {
+                updates.at(i).index    = i;
+                updates.at(i).instance = entry.instances.at(i);
+            }
+            update_tlas_instances(cmdbuffer, entry.tlas, updates);
+            instance_count = static_cast<uint>(updates.size());
         }
-        tlas.staging.unmap();
 
-        // copy from staging buffer to instance buffer
-        auto copy      = VkBufferCopy{};
-        copy.size      = entry.instances.size() * sizeof(VkAccelerationStructureInstanceKHR);
-        copy.srcOffset = 0;
-        copy.dstOffset = 0;
-        rhi->vtable.vkCmdCopyBuffer(cmd.command_buffer, tlas.staging.buffer, tlas.instances.buffer, 1, &copy);
-
-        // prepare buffer barrier
-        barriers.push_back({});
-        auto& barrier               = barriers.back();
-        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-        barrier.pNext               = nullptr;
-        barrier.offset              = 0u;
-        barrier.size                = copy.size;
-        barrier.buffer              = tlas.instances.buffer;
-        barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL;
+        // refit in place only when the instance count is unchanged since the last build
+        bool refit = tlas.built && !entry.rebuild &&
+                     tlas.update_mode == GPUBVHUpdateMode::PREFER_UPDATE &&
+                     tlas.built_count == instance_count;
 
         // prepare build info
-        tlas.build.srcAccelerationStructure  = tlas.tlas;
+        tlas.build.srcAccelerationStructure  = refit ? tlas.tlas : VK_NULL_HANDLE;
         tlas.build.dstAccelerationStructure  = tlas.tlas;
         tlas.build.geometryCount             = 1;
         tlas.build.pGeometries               = &tlas.geometry;
         tlas.build.scratchData.deviceAddress = scratch_address;
-        tlas.build.mode                      = (tlas.tlas == VK_NULL_HANDLE)
-                                                   ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR
-                                                   : vkenum(tlas.update_mode);
+        tlas.build.mode                      = refit
+                                                   ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR
+                                                   : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
 
         // prepare build range
         tlas.range.firstVertex     = 0;
-        tlas.range.primitiveCount  = static_cast<uint>(entry.instances.size());
+        tlas.range.primitiveCount  = instance_count;
         tlas.range.primitiveOffset = 0;
         tlas.range.transformOffset = 0;
 
         build_infos.push_back(tlas.build);
         build_ranges.push_back(&tlas.range);
 
-        scratch_address += (tlas.build.mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR)
-                               ? tlas.sizes.buildScratchSize
-                               : tlas.sizes.updateScratchSize;
-    }
+        scratch_address += refit ? tlas.sizes.updateScratchSize : tlas.sizes.buildScratchSize;
 
-    // wait until copies have completed
-    rhi->vtable.vkCmdPipelineBarrier(
-        cmd.command_buffer,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
-        VK_DEPENDENCY_BY_REGION_BIT,
-        0, nullptr,
-        static_cast<uint32_t>(barriers.size()), barriers.data(),
-        0, nullptr);
+        tlas.built       = true;
+        tlas.built_count = instance_count;
+    }
 
     rhi->vtable.vkCmdBuildAccelerationStructuresKHR(
         cmd.command_buffer,
@@ -800,6 +1460,11 @@ void cmd::build_tlases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratc
         build_ranges.data());
 }
 
+static uint32_t index_size(GPUIndexFormat format)
+{
+    return format == GPUIndexFormat::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
 void cmd::build_blases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUBlasBuildEntries entries)
 {
     auto  rhi = get_rhi();
@@ -827,8 +1492,9 @@ void cmd::build_blases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratc
             auto& src_geometry = entry.geometries.triangles.at(k);
             auto& dst_geometry = blas.geometries.at(k);
 
+            bool indexed    = src_geometry.index_buffer.valid();
             auto index_data = VkDeviceAddress{0};
-            if (src_geometry.index_buffer.valid())
+            if (indexed)
                 index_data = fetch_resource(rhi->buffers, src_geometry.index_buffer).device_address;
 
             auto vertex_data = VkDeviceAddress{0};
@@ -838,17 +1504,18 @@ void cmd::build_blases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratc
             dst_geometry.sType                                       = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
             dst_geometry.geometryType                                = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
             dst_geometry.geometry.triangles.sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
-            dst_geometry.geometry.triangles.indexType                = vkenum(src_geometry.size.index_format);
+            dst_geometry.geometry.triangles.indexType                = indexed ? vkenum(src_geometry.size.index_format) : VK_INDEX_TYPE_NONE_KHR;
             dst_geometry.geometry.triangles.indexData.deviceAddress  = index_data;
             dst_geometry.geometry.triangles.vertexStride             = src_geometry.vertex_stride;
             dst_geometry.geometry.triangles.vertexFormat             = vkenum(src_geometry.size.vertex_format);
             dst_geometry.geometry.triangles.vertexData.deviceAddress = vertex_data;
             dst_geometry.geometry.triangles.maxVertex                = src_geometry.size.vertex_count - 1;
 
+            // primitive offset is in bytes, non-indexed geometry starts at first_vertex
             auto& range           = blas.ranges.at(k);
             range.firstVertex     = src_geometry.first_vertex;
-            range.primitiveCount  = src_geometry.size.vertex_count / 3;
-            range.primitiveOffset = src_geometry.first_index;
+            range.primitiveCount  = indexed ? src_geometry.size.index_count / 3 : src_geometry.size.vertex_count / 3;
+            range.primitiveOffset = indexed ? src_geometry.first_index * index_size(src_geometry.size.index_format) : 0;
             range.transformOffset = 0;
         }
 
@@ -876,3 +1543,32 @@ void cmd::build_blases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratc
         build_infos.data(),
         build_ranges.data());
 }
+
+void cmd::copy_blas(GPUCommandEncoderHandle cmdbuffer, GPUBlasHandle old_blas, GPUBlasHandle new_blas)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    auto& src = fetch_resource(rhi->blases, old_blas);
+    auto& dst = fetch_resource(rhi->blases, new_blas);
+
+    // blas built with compaction allowed are compacted, others are cloned
+    auto compact = (src.build.flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR) != 0;
+
+    auto copy_info  = VkCopyAccelerationStructureInfoKHR{};
+    copy_info.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+    copy_info.pNext = nullptr;
+    copy_info.src   = src.blas;
+    copy_info.dst   = dst.blas;
+    copy_info.mode  = compact
+                          ? VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR
+                          : VK_COPY_ACCELERATION_STRUCTURE_MODE_CLONE_KHR;
+
+    rhi->vtable.vkCmdCopyAccelerationStructureKHR(cmd.command_buffer, &copy_info);
+}
+
+void cmd::defragment_memory(GPUCommandEncoderHandle cmdbuffer, const GPUDefragmentDescriptor& descriptor)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+    rhi->defrag.record(cmd, descriptor);
+}
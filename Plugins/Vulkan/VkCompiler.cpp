@@ -0,0 +1,150 @@
+#include <algorithm>
+#include "VkUtils.h"
+
+void VulkanPipelineCompiler::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    // pipelines compiled but never installed are not referenced by any slot
+    for (auto& job : compiled)
+        job.result.destroy();
+
+    workers.clear();
+    queued.clear();
+    active.clear();
+    compiled.clear();
+    discarded.clear();
+    stopping = false;
+}
+
+void VulkanPipelineCompiler::compile(uint handle, std::unique_ptr<VulkanPipelineState>&& state)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // workers are started on first use, one core is left for the recording thread
+    if (workers.empty()) {
+        uint count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        for (uint i = 0; i < count; i++)
+            workers.emplace_back([this]() { work(); });
+    }
+
+    Job job;
+    job.handle = handle;
+    job.state  = std::move(state);
+    queued.push_back(std::move(job));
+    wakeup.notify_one();
+}
+
+void VulkanPipelineCompiler::discard(uint handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto is_handle = [&](const Job& job) { return job.handle == handle; };
+
+    // not started yet, simply drop it
+    auto it = std::find_if(queued.begin(), queued.end(), is_handle);
+    if (it != queued.end()) {
+        queued.erase(it);
+        return;
+    }
+
+    // compiled but not installed yet, the pipeline was never bound
+    auto jt = std::find_if(compiled.begin(), compiled.end(), is_handle);
+    if (jt != compiled.end()) {
+        jt->result.destroy();
+        compiled.erase(jt);
+        return;
+    }
+
+    // compiling right now, the worker destroys it when done
+    if (active.count(handle))
+        discarded.insert(handle);
+}
+
+void VulkanPipelineCompiler::install()
+{
+    auto rhi = get_rhi();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& job : compiled)
+        rhi->pipelines.at(job.handle) = job.result;
+    compiled.clear();
+}
+
+void VulkanPipelineCompiler::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&]() { return queued.empty() && running == 0; });
+}
+
+void VulkanPipelineCompiler::wait_module(VkShaderModule module)
+{
+    wait_unused([&](const VulkanPipelineState& state) {
+        return std::any_of(state.stages.begin(), state.stages.end(), [&](const VkPipelineShaderStageCreateInfo& stage) {
+            return stage.module == module;
+        });
+    });
+}
+
+void VulkanPipelineCompiler::wait_layout(VkPipelineLayout layout)
+{
+    wait_unused([&](const VulkanPipelineState& state) {
+        return state.layout == layout;
+    });
+}
+
+void VulkanPipelineCompiler::wait_unused(const Function<bool(const VulkanPipelineState&)>& uses)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&]() {
+        for (auto& job : queued)
+            if (uses(*job.state))
+                return false;
+
+        for (auto& kv : active)
+            if (uses(*kv.second))
+                return false;
+
+        return true;
+    });
+}
+
+void VulkanPipelineCompiler::work()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [&]() { return stopping || !queued.empty(); });
+            if (stopping)
+                return;
+
+            job = std::move(queued.front());
+            queued.pop_front();
+            active.emplace(job.handle, job.state.get());
+            running++;
+        }
+
+        // pipeline creation is free-threaded, as long as no pipeline cache is shared
+        job.result = VulkanPipeline(*job.state);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active.erase(job.handle);
+            job.state.reset();
+            running--;
+            if (discarded.erase(job.handle))
+                job.result.destroy();
+            else
+                compiled.push_back(std::move(job));
+        }
+        idle.notify_all();
+    }
+}
@@ -20,6 +20,7 @@ void VulkanDescriptorPool::reset()
     poolindex = 0;
 
     allocated.clear();
+    resources.clear();
 
     for (auto& count : counts)
         count = 0;
@@ -54,6 +55,7 @@ GPUBindGroupHandle VulkanDescriptorPool::allocate(VkDescriptorSet& descriptor, V
 
     uint handle = static_cast<uint>(allocated.size());
     allocated.push_back(descriptor);
+    resources.emplace_back();
     return GPUBindGroupHandle(handle);
 }
 
@@ -155,6 +157,22 @@ GPUBindGroupHandle create_bind_group(const GPUBindGroupDescriptor& desc)
         fill_descriptor_write(writes.back(), objects, descriptor, layout, entry);
     }
 
+    // record referenced resources for tracked command buffers
+    auto& resources = frame.descriptor_pool.resources.at(handle.value);
+    for (auto& entry : desc.entries) {
+        auto resource     = VulkanBindingResource{};
+        resource.type     = layout.binding_types.at(entry.binding);
+        resource.stages   = layout.binding_stages.at(entry.binding);
+        resource.writable = layout.binding_writable.at(entry.binding);
+        if (entry.type == GPUBindingResourceType::BUFFER)
+            resource.buffer = entry.buffer.buffer;
+        else if (entry.type == GPUBindingResourceType::TEXTURE || entry.type == GPUBindingResourceType::STORAGE_TEXTURE)
+            resource.view = entry.texture;
+        else
+            continue;
+        resources.push_back(resource);
+    }
+
     // update descriptor sets
     rhi->vtable.vkUpdateDescriptorSets(rhi->device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
     return handle;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "VkUtils.h"
 
 #define VK_LOAD(HANDLE, FUNC)                                                             \
@@ -20,7 +21,7 @@ bool is_required(GPUFeatureNames features, GPUFeatureName feature)
     return std::find(features.begin(), features.end(), feature) != features.end();
 }
 
-void create_allocator(VulkanRHI* rhi, bool enable_buffer_device_address)
+void create_allocator(VulkanRHI* rhi, bool enable_buffer_device_address, bool enable_memory_budget)
 {
     // need to manually map functions to vma
     VmaVulkanFunctions vulkan_functions;
@@ -59,6 +60,10 @@ void create_allocator(VulkanRHI* rhi, bool enable_buffer_device_address)
     if (enable_buffer_device_address)
         allocator_info.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
 
+    // query accurate heap budgets from the driver (otherwise estimated by vma)
+    if (enable_memory_budget)
+        allocator_info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+
     vk_check(vmaCreateAllocator(&allocator_info, &rhi->alloc));
 }
 
@@ -86,6 +91,9 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
         debugger_extensions.push_back(VK_EXT_DEBUG_MARKER_EXTENSION_NAME);
     }
 
+    // extensions supported by the adapter
+    auto supported_extensions = get_supported_device_extensions(rhi->adapter);
+
     // add portability (if present)
     if (has_portability_subset(rhi->adapter)) {
         device_extensions.push_back(KHR_PORTABILITY_EXTENSION_NAME);
@@ -96,12 +104,18 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
     device_extensions.push_back(VK_KHR_MAINTENANCE2_EXTENSION_NAME);
     device_extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
     device_extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    device_extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
 
     // load swapchain extensions
     if (rhi->surface) {
         device_extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     }
 
+    // load memory budget extension (optional, improves budget accuracy)
+    if (supported_extensions.count(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
     // load bindless extensions
     if (required_features.bindless)
         device_extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
@@ -125,6 +139,15 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
     features.features.multiDrawIndirect = VK_TRUE;
     features.features.fillModeNonSolid  = VK_TRUE;
 
+    // pipeline statistics queries (optional, used for per-pass counter reports)
+    VkPhysicalDeviceFeatures supported = {};
+    vkGetPhysicalDeviceFeatures(rhi->adapter, &supported);
+    features.features.pipelineStatisticsQuery = supported.pipelineStatisticsQuery;
+
+    // deferred render passes run within the statistics query of their command buffer (optional)
+    features.features.inheritedQueries = supported.inheritedQueries;
+    rhi->inherited_queries             = supported.inheritedQueries == VK_TRUE;
+
     // append to features linked list
     auto append_feature = [&](VulkanBase* feature) {
         feature->pNext = features.pNext;
@@ -214,17 +237,13 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
         }
     }
 
-    // optional: used for host query reset in raytracing
+    // host query reset (essential: used to recycle query sets without recording commands, core since Vulkan 1.2)
     auto host_query_reset = VkPhysicalDeviceHostQueryResetFeatures{};
-    if (required_features.raytracing) {
+    {
         host_query_reset.sType          = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES;
         host_query_reset.pNext          = nullptr;
         host_query_reset.hostQueryReset = VK_TRUE;
         append_feature((VulkanBase*)&host_query_reset);
-        if (!is_supported(device_extensions, VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME)) {
-            get_logger()->error("Device extension {} is not supported!", VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME);
-            exit(1);
-        }
     }
 
     // optional: used to support bvh building
@@ -288,7 +307,6 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
     }
 
     // check availability of extensions
-    auto supported_extensions        = get_supported_device_extensions(rhi->adapter);
     uint unsatisfied_extension_count = 0;
     for (auto& extension : device_extensions) {
         auto ext = String(extension);
@@ -376,6 +394,7 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
         VK_LOAD(rhi, vkCreateAccelerationStructureKHR);
         VK_LOAD(rhi, vkDestroyAccelerationStructureKHR);
         VK_LOAD(rhi, vkCmdCopyAccelerationStructureKHR);
+        VK_LOAD(rhi, vkCmdWriteAccelerationStructuresPropertiesKHR);
         VK_LOAD(rhi, vkCmdBuildAccelerationStructuresKHR);
         VK_LOAD(rhi, vkCmdBuildAccelerationStructuresIndirectKHR);
     }
@@ -396,7 +415,11 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
 
     // create memory allocator
     bool enable_buffer_device_address = required_features.raytracing;
-    create_allocator(rhi, enable_buffer_device_address);
+    bool enable_memory_budget         = is_supported(device_extensions, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    create_allocator(rhi, enable_buffer_device_address, enable_memory_budget);
+
+    // create memory pools for buffer sub-allocation
+    rhi->pools.init(desc.memory_pools, enable_buffer_device_address ? VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT : 0);
 
     // transfer queues
     if (queue_family_indices.transfer.has_value())
@@ -414,9 +437,16 @@ bool api::create_device(const GPUDeviceDescriptor& desc)
     if (queue_family_indices.present.has_value())
         rhi->vtable.vkGetDeviceQueue(rhi->device, queue_family_indices.present.value(), 0, &rhi->present_queue);
 
-    // create a default frame (for headless cases)
-    rhi->frames.emplace_back();
-    rhi->frames.back().init();
+    // asynchronous uploads (after all queues are known)
+    rhi->uploads.init();
+
+    // frame timeline
+    rhi->pacer.init();
+
+    // create the default frames (for headless cases)
+    rhi->frames.resize(std::max(desc.frames, 1u));
+    for (auto& frame : rhi->frames)
+        frame.init();
 
     if (desc.label)
         rhi->set_debug_label(VK_OBJECT_TYPE_DEVICE, (uint64_t)rhi->device, desc.label);
@@ -430,59 +460,79 @@ void api::delete_device()
 
     auto rhi = get_rhi();
 
+    // stop pipeline compilation (before shader modules and layouts are gone)
+    rhi->compiler.destroy();
+
+    // staging buffers were returned by the command buffers when waiting idle
+    rhi->staging.destroy();
+
+    // the open defragmentation pass was finished by the deletion queue when waiting idle
+    rhi->defrag.destroy();
+
     // clean up remaining swapchains
     // needs to be deleted first, because it contains other handles
-    for (auto& swapchain : rhi->swapchains.data)
+    for (auto& swapchain : rhi->swapchains)
         swapchain.destroy();
 
     // clean up remaining blases
-    for (auto& blas : rhi->blases.data)
+    for (auto& blas : rhi->blases)
         blas.destroy();
 
     // clean up remaining tlases
-    for (auto& tlas : rhi->tlases.data)
+    for (auto& tlas : rhi->tlases)
         tlas.destroy();
 
     // clean up remaining fences
     for (auto& frame : rhi->frames)
         frame.destroy();
 
+    // clean up pending uploads and staging memory
+    rhi->uploads.destroy();
+
+    // clean up frame timeline and timestamps
+    rhi->pacer.destroy();
+
     // clean up remaining fences
-    for (auto& fence : rhi->fences.data)
+    for (auto& fence : rhi->fences)
         fence.destroy();
 
     // clean up remaining buffers
-    for (auto& buffer : rhi->buffers.data)
+    for (auto& buffer : rhi->buffers)
         buffer.destroy();
 
     // clean up remaining texture views
-    for (auto& view : rhi->views.data)
+    for (auto& view : rhi->views)
         view.destroy();
 
     // clean up remaining textures
-    for (auto& texture : rhi->textures.data)
+    for (auto& texture : rhi->textures)
         texture.destroy();
 
     // clean up remaining samplers
-    for (auto& sampler : rhi->samplers.data)
+    rhi->sampler_cache.clear();
+    for (auto& sampler : rhi->samplers)
         sampler.destroy();
 
     // clean up remaining shaders
-    for (auto& shader : rhi->shaders.data)
+    rhi->shader_cache.clear();
+    for (auto& shader : rhi->shaders)
         shader.destroy();
 
     // clean up remaining bind group layouts
-    for (auto& layout : rhi->bind_group_layouts.data)
+    for (auto& layout : rhi->bind_group_layouts)
         layout.destroy();
 
     // clean up remaining pipeline layouts
-    for (auto& layout : rhi->pipeline_layouts.data)
+    for (auto& layout : rhi->pipeline_layouts)
         layout.destroy();
 
     // clean up remaining pipelines
-    for (auto& pipeline : rhi->pipelines.data)
+    for (auto& pipeline : rhi->pipelines)
         pipeline.destroy();
 
+    // clean up memory pools (after all buffers are released)
+    rhi->pools.destroy();
+
     if (rhi->alloc) {
         vmaDestroyAllocator(rhi->alloc);
         rhi->alloc = VK_NULL_HANDLE;
@@ -1,28 +1,11 @@
+#include <algorithm>
 #include "VkUtils.h"
 
 void VulkanFrame::init()
 {
     api::create_fence(image_available_semaphore, VK_SEMAPHORE_TYPE_BINARY);
 
-    auto rhi = get_rhi();
-
-    if (rhi->queues.compute.has_value())
-        compute_command_pool.init(rhi->queues.compute.value());
-
-    if (rhi->queues.graphics.has_value())
-        graphics_command_pool.init(rhi->queues.graphics.value());
-
-    if (rhi->queues.transfer.has_value())
-        transfer_command_pool.init(rhi->queues.transfer.value());
-}
-
-void VulkanFrame::wait()
-{
-    if (!existing_fences.empty()) {
-        auto rhi = get_rhi();
-        uint cnt = static_cast<uint>(existing_fences.size());
-        rhi->vtable.vkWaitForFences(rhi->device, cnt, existing_fences.data(), VK_TRUE, UINT64_MAX);
-    }
+    // NOTE: command pools are created lazily by each recording thread
 }
 
 void VulkanFrame::reset()
@@ -31,17 +14,24 @@ void VulkanFrame::reset()
     for (auto& command_buffer : allocated_command_buffers)
         command_buffer.reset();
 
-    // reset all fences
-    if (!existing_fences.empty()) {
-        auto rhi = get_rhi();
-        uint cnt = static_cast<uint>(existing_fences.size());
-        rhi->vtable.vkResetFences(rhi->device, cnt, existing_fences.data());
-    }
-
     descriptor_pool.reset();
-    compute_command_pool.reset();
-    graphics_command_pool.reset();
-    transfer_command_pool.reset();
+    upload_ring.reset();
+    for (auto it = command_pools.begin(); it != command_pools.end();) {
+        auto& pools = it->second;
+        if (!pools.used) {
+            // the thread has not recorded for a whole frame cycle
+            pools.compute.destroy();
+            pools.graphics.destroy();
+            pools.transfer.destroy();
+            it = command_pools.erase(it);
+            continue;
+        }
+        pools.compute.reset();
+        pools.graphics.reset();
+        pools.transfer.reset();
+        pools.used = false;
+        it++;
+    }
     allocated_command_buffers.clear();
 }
 
@@ -57,9 +47,11 @@ void VulkanFrame::free()
     // descriptor_pool.reset();
 
     // reset and free all commands
-    compute_command_pool.reset(true);
-    graphics_command_pool.reset(true);
-    transfer_command_pool.reset(true);
+    for (auto& kv : command_pools) {
+        kv.second.compute.reset(true);
+        kv.second.graphics.reset(true);
+        kv.second.transfer.reset(true);
+    }
     allocated_command_buffers.clear();
 }
 
@@ -67,20 +59,25 @@ GPUCommandEncoderHandle VulkanFrame::allocate(GPUQueueType type, bool primary)
 {
     auto rhi = get_rhi();
 
+    // command buffers can be allocated from any thread
+    std::unique_lock<std::shared_mutex> lock(rhi->frame_mutex);
+
+    auto& pools = thread_command_pools();
+
     VulkanCommandBuffer command_buffer;
     command_buffer.frame_id = frame_id;
     switch (type) {
         case GPUQueueType::DEFAULT:
             command_buffer.command_queue  = rhi->graphics_queue;
-            command_buffer.command_buffer = graphics_command_pool.allocate(primary);
+            command_buffer.command_buffer = pools.graphics.allocate(primary);
             break;
         case GPUQueueType::COMPUTE:
             command_buffer.command_queue  = rhi->compute_queue;
-            command_buffer.command_buffer = compute_command_pool.allocate(primary);
+            command_buffer.command_buffer = pools.compute.allocate(primary);
             break;
         case GPUQueueType::TRANSFER:
             command_buffer.command_queue  = rhi->transfer_queue;
-            command_buffer.command_buffer = transfer_command_pool.allocate(primary);
+            command_buffer.command_buffer = pools.transfer.allocate(primary);
             break;
     }
 
@@ -90,10 +87,150 @@ GPUCommandEncoderHandle VulkanFrame::allocate(GPUQueueType type, bool primary)
     return handle;
 }
 
+VulkanCommandBuffer& VulkanFrame::command(GPUCommandEncoderHandle handle)
+{
+    // references remain valid after the lock is released, see allocated_command_buffers
+    std::shared_lock<std::shared_mutex> lock(get_rhi()->frame_mutex);
+    return allocated_command_buffers.at(handle.value);
+}
+
+VkDescriptorSet VulkanFrame::descriptor(GPUBindGroupHandle handle)
+{
+    std::shared_lock<std::shared_mutex> lock(get_rhi()->frame_mutex);
+    return descriptor_pool.allocated.at(handle.value);
+}
+
+const Vector<VulkanBindingResource>& VulkanFrame::bindings(GPUBindGroupHandle handle)
+{
+    // references remain valid after the lock is released, see VulkanDescriptorPool::resources
+    std::shared_lock<std::shared_mutex> lock(get_rhi()->frame_mutex);
+    return descriptor_pool.resources.at(handle.value);
+}
+
+VulkanFrame::CommandPools& VulkanFrame::thread_command_pools()
+{
+    auto it = command_pools.find(std::this_thread::get_id());
+    if (it != command_pools.end()) {
+        it->second.used = true;
+        return it->second;
+    }
+
+    auto  rhi   = get_rhi();
+    auto& pools = command_pools[std::this_thread::get_id()];
+    pools.used  = true;
+
+    if (rhi->queues.compute.has_value())
+        pools.compute.init(rhi->queues.compute.value());
+
+    if (rhi->queues.graphics.has_value())
+        pools.graphics.init(rhi->queues.graphics.value());
+
+    if (rhi->queues.transfer.has_value())
+        pools.transfer.init(rhi->queues.transfer.value());
+
+    return pools;
+}
+
 void VulkanFrame::destroy()
 {
     descriptor_pool.destroy();
-    compute_command_pool.destroy();
-    graphics_command_pool.destroy();
-    transfer_command_pool.destroy();
+    upload_ring.destroy();
+    for (auto& kv : command_pools) {
+        kv.second.compute.destroy();
+        kv.second.graphics.destroy();
+        kv.second.transfer.destroy();
+    }
+    command_pools.clear();
+}
+
+void VulkanDeleteQueue::push(uint frame, Function<void()>&& release)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back(Entry{frame, std::move(release)});
+}
+
+void VulkanDeleteQueue::retire(uint completed_frame)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // entries are pushed in frame order
+    while (!entries.empty() && entries.front().frame <= completed_frame) {
+        entries.front().release();
+        entries.pop_front();
+    }
+}
+
+void VulkanDeleteQueue::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& entry : entries)
+        entry.release();
+
+    entries.clear();
+}
+
+void VulkanMapQueue::push(Request&& request)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(std::move(request));
+}
+
+void VulkanMapQueue::retire(uint completed_frame)
+{
+    Vector<Request> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // requests are pushed in frame order
+        while (!requests.empty() && requests.front().frame <= completed_frame) {
+            ready.push_back(std::move(requests.front()));
+            requests.pop_front();
+        }
+    }
+    fulfill(ready, true);
+}
+
+void VulkanMapQueue::cancel(GPUBufferHandle buffer)
+{
+    Vector<Request> aborted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = std::remove_if(requests.begin(), requests.end(), [&](Request& request) {
+            if (request.buffer.value != buffer.value)
+                return false;
+            aborted.push_back(std::move(request));
+            return true;
+        });
+        requests.erase(it, requests.end());
+    }
+    fulfill(aborted, false);
+}
+
+void VulkanMapQueue::flush()
+{
+    Vector<Request> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& request : requests)
+            ready.push_back(std::move(request));
+        requests.clear();
+    }
+    fulfill(ready, true);
+}
+
+void VulkanMapQueue::fulfill(Vector<Request>& ready, bool success)
+{
+    auto rhi = get_rhi();
+
+    // callbacks run without the lock held, they are free to request another mapping
+    for (auto& request : ready) {
+        auto& buf       = fetch_resource(rhi->buffers, request.buffer);
+        buf.map_pending = false;
+        if (success)
+            buf.map(request.offset, request.size);
+        if (request.callback)
+            request.callback(request.buffer, success);
+    }
 }
@@ -40,6 +40,14 @@ VulkanTexture::VulkanTexture(const GPUTextureDescriptor& desc) : aspects(0)
     alloc_create_info.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
     alloc_create_info.flags         = 0;
 
+    // only large render targets receive dedicated memory, others are sub-allocated
+    if (desc.usage.contains(GPUTextureUsage::RENDER_ATTACHMENT)) {
+        GPUSize64 estimated_size = GPUSize64(desc.size.width) * desc.size.height * desc.size.depth *
+                                   desc.array_layers * desc.sample_count * size_of(tex_create_info.format);
+        if (estimated_size >= rhi->pools.desc.dedicated_threshold)
+            alloc_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    }
+
     // create texture
     vk_check(vmaCreateImage(rhi->alloc,
         &tex_create_info, &alloc_create_info,
@@ -62,6 +70,14 @@ VulkanTexture::VulkanTexture(const GPUTextureDescriptor& desc) : aspects(0)
     // record the render area
     area.width  = desc.size.width;
     area.height = desc.size.height;
+
+    // record the subresources
+    mip_levels   = desc.mip_level_count;
+    array_layers = desc.array_layers;
+    samples      = tex_create_info.samples;
+
+    // record the create parameters
+    create_info = tex_create_info;
 }
 
 void VulkanTexture::destroy()
@@ -109,6 +125,12 @@ VulkanTextureView::VulkanTextureView(const VulkanTexture& texture, const GPUText
 
     // record the aspect flags
     aspects = texture.aspects;
+
+    // record the viewed subresources
+    type        = create_info.viewType;
+    format      = create_info.format;
+    samples     = texture.samples;
+    subresource = create_info.subresourceRange;
 }
 
 void VulkanTextureView::destroy()
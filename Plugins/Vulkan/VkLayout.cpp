@@ -70,6 +70,8 @@ VulkanBindGroupLayout::VulkanBindGroupLayout(const GPUBindGroupLayoutDescriptor&
 
     // extract binding information for the descriptor set
     binding_types.clear();
+    binding_stages.clear();
+    binding_writable.clear();
     Vector<VkDescriptorSetLayoutBinding> bindings;
     for (auto& entry : desc.entries) {
         auto type                  = infer_descriptor_type(entry);
@@ -83,6 +85,10 @@ VulkanBindGroupLayout::VulkanBindGroupLayout(const GPUBindGroupLayoutDescriptor&
 
         // keep track of basic properties for bind group layout
         binding_types.push_back(binding.descriptorType);
+        binding_stages.push_back(binding.stageFlags);
+        binding_writable.push_back(
+            (entry.type == GPUBindingResourceType::BUFFER && entry.buffer.type == GPUBufferBindingType::STORAGE) ||
+            (entry.type == GPUBindingResourceType::STORAGE_TEXTURE && entry.storage_texture.access != GPUStorageTextureAccess::READ_ONLY));
 
         // variable size descriptor binding
         if (bindless)
@@ -127,7 +133,7 @@ VulkanPipelineLayout::VulkanPipelineLayout(const GPUPipelineLayoutDescriptor& de
 
     Vector<VkDescriptorSetLayout> bind_group_layouts;
     for (const auto& handle : desc.bind_group_layouts) {
-        auto& bind_group_layout = rhi->bind_group_layouts.data.at(handle.value);
+        auto& bind_group_layout = rhi->bind_group_layouts.at(handle.value);
         assert(bind_group_layout.layout != VK_NULL_HANDLE);
         bind_group_layouts.push_back(bind_group_layout.layout);
     }
@@ -859,7 +859,7 @@ VkAccessFlags2 vkenum(GPUBarrierAccessFlags access)
     if (access.contains(GPUBarrierAccess::UNIFORM_BUFFER))               flags |= VK_ACCESS_2_UNIFORM_READ_BIT;
     if (access.contains(GPUBarrierAccess::INDEX_BUFFER))                 flags |= VK_ACCESS_2_INDEX_READ_BIT;
     if (access.contains(GPUBarrierAccess::RENDER_TARGET))                flags |= VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
-    if (access.contains(GPUBarrierAccess::UNORDERED_ACCESS))             flags |= VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+    if (access.contains(GPUBarrierAccess::UNORDERED_ACCESS))             flags |= VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
     if (access.contains(GPUBarrierAccess::DEPTH_STENCIL_WRITE))          flags |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     if (access.contains(GPUBarrierAccess::DEPTH_STENCIL_READ))           flags |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
     if (access.contains(GPUBarrierAccess::SHADER_RESOURCE))              flags |= VK_ACCESS_2_SHADER_READ_BIT;
@@ -888,11 +888,11 @@ VkBuildAccelerationStructureFlagsKHR vkenum(GPUBVHFlags flags)
 {
     VkBuildAccelerationStructureFlagsKHR result = 0;
     // clang-format off
-    if (flags.contains(GPUBVHFlag::ALLOW_COMPACTION))  result = VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
-    if (flags.contains(GPUBVHFlag::ALLOW_UPDATE))      result = VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
-    if (flags.contains(GPUBVHFlag::PREFER_FAST_BUILD)) result = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
-    if (flags.contains(GPUBVHFlag::PREFER_FAST_TRACE)) result = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
-    if (flags.contains(GPUBVHFlag::LOW_MEMORY))        result = VK_BUILD_ACCELERATION_STRUCTURE_LOW_MEMORY_BIT_KHR;
+    if (flags.contains(GPUBVHFlag::ALLOW_COMPACTION))  result |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+    if (flags.contains(GPUBVHFlag::ALLOW_UPDATE))      result |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+    if (flags.contains(GPUBVHFlag::PREFER_FAST_BUILD)) result |= VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+    if (flags.contains(GPUBVHFlag::PREFER_FAST_TRACE)) result |= VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+    if (flags.contains(GPUBVHFlag::LOW_MEMORY))        result |= VK_BUILD_ACCELERATION_STRUCTURE_LOW_MEMORY_BIT_KHR;
     // clang-format on
     return result;
 }
@@ -907,6 +907,23 @@ VkGeometryFlagsKHR vkenum(GPUBVHGeometryFlags flags)
     return result;
 }
 
+VkQueryPipelineStatisticFlags vkenum(GPUQueryStatisticFlags statistics)
+{
+    VkQueryPipelineStatisticFlags flags = 0;
+
+    // clang-format off
+    if (statistics.contains(GPUQueryStatistic::INPUT_VERTICES))       flags |= VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT;
+    if (statistics.contains(GPUQueryStatistic::INPUT_PRIMITIVES))     flags |= VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT;
+    if (statistics.contains(GPUQueryStatistic::VERTEX_INVOCATIONS))   flags |= VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT;
+    if (statistics.contains(GPUQueryStatistic::CLIPPING_INVOCATIONS)) flags |= VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT;
+    if (statistics.contains(GPUQueryStatistic::CLIPPING_PRIMITIVES))  flags |= VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT;
+    if (statistics.contains(GPUQueryStatistic::FRAGMENT_INVOCATIONS)) flags |= VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+    if (statistics.contains(GPUQueryStatistic::COMPUTE_INVOCATIONS))  flags |= VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+    // clang-format on
+
+    return flags;
+}
+
 uint size_of(VkFormat format)
 {
     switch (format) {
@@ -0,0 +1,891 @@
+#include <algorithm>
+#include "VkUtils.h"
+
+VmaPool create_memory_pool(VkBufferUsageFlags usages, VmaMemoryUsage memory_usage, VmaAllocationCreateFlags flags, GPUSize64 block_size)
+{
+    auto rhi = get_rhi();
+
+    // representative buffer for this usage class (used to find the memory type)
+    auto buffer_create_info  = VkBufferCreateInfo{};
+    buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_create_info.size  = 0x1000;
+    buffer_create_info.usage = usages;
+
+    auto alloc_create_info  = VmaAllocationCreateInfo{};
+    alloc_create_info.usage = memory_usage;
+    alloc_create_info.flags = flags;
+
+    uint32_t memory_type_index = 0;
+    vk_check(vmaFindMemoryTypeIndexForBufferInfo(rhi->alloc, &buffer_create_info, &alloc_create_info, &memory_type_index));
+
+    auto pool_create_info            = VmaPoolCreateInfo{};
+    pool_create_info.memoryTypeIndex = memory_type_index;
+    pool_create_info.blockSize       = block_size;
+    pool_create_info.minBlockCount   = 0;
+    pool_create_info.maxBlockCount   = 0; // unlimited
+
+    VmaPool pool = VK_NULL_HANDLE;
+    vk_check(vmaCreatePool(rhi->alloc, &pool_create_info, &pool));
+    return pool;
+}
+
+void VulkanMemoryPools::init(const GPUMemoryPoolDescriptor& desc, VkBufferUsageFlags additional_usages)
+{
+    this->desc = desc;
+
+    auto device_usages = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                         VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                         VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                         additional_usages;
+
+    auto uniform_usages = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                          VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                          additional_usages;
+
+    auto upload_usages   = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | additional_usages;
+    auto readback_usages = VK_BUFFER_USAGE_TRANSFER_DST_BIT | additional_usages;
+
+    // NOTE: allocation flags must match the ones used by VulkanBuffer for the same usage class,
+    // otherwise the memory type selected here might not be the one VMA would have picked.
+    device = create_memory_pool(device_usages, VMA_MEMORY_USAGE_AUTO, 0, desc.device_block_size);
+
+    uniform = create_memory_pool(uniform_usages, VMA_MEMORY_USAGE_AUTO,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        desc.uniform_block_size);
+
+    upload = create_memory_pool(upload_usages, VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        desc.upload_block_size);
+
+    readback = create_memory_pool(readback_usages, VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+        desc.readback_block_size);
+}
+
+void VulkanMemoryPools::destroy()
+{
+    auto rhi = get_rhi();
+
+    for (auto pool : {&device, &uniform, &upload, &readback}) {
+        if (*pool != VK_NULL_HANDLE) {
+            vmaDestroyPool(rhi->alloc, *pool);
+            *pool = VK_NULL_HANDLE;
+        }
+    }
+}
+
+VmaPool VulkanMemoryPools::handle(GPUMemoryPool pool) const
+{
+    // clang-format off
+    switch (pool) {
+        case GPUMemoryPool::DEVICE:   return device;
+        case GPUMemoryPool::UNIFORM:  return uniform;
+        case GPUMemoryPool::UPLOAD:   return upload;
+        case GPUMemoryPool::READBACK: return readback;
+        default:                      return VK_NULL_HANDLE;
+    }
+    // clang-format on
+}
+
+GPUSize64 VulkanMemoryPools::block_size(GPUMemoryPool pool) const
+{
+    // clang-format off
+    switch (pool) {
+        case GPUMemoryPool::DEVICE:   return desc.device_block_size;
+        case GPUMemoryPool::UNIFORM:  return desc.uniform_block_size;
+        case GPUMemoryPool::UPLOAD:   return desc.upload_block_size;
+        case GPUMemoryPool::READBACK: return desc.readback_block_size;
+        default:                      return 0;
+    }
+    // clang-format on
+}
+
+GPUMemoryPool VulkanMemoryPools::classify(const GPUBufferDescriptor& desc) const
+{
+    if (desc.usage.contains(GPUBufferUsage::MAP_READ))
+        return GPUMemoryPool::READBACK;
+
+    if (desc.usage.contains(GPUBufferUsage::MAP_WRITE) || desc.mapped_at_creation)
+        return GPUMemoryPool::UPLOAD;
+
+    if (desc.usage.contains(GPUBufferUsage::UNIFORM))
+        return GPUMemoryPool::UNIFORM;
+
+    return GPUMemoryPool::DEVICE;
+}
+
+VmaPool VulkanMemoryPools::select(const GPUBufferDescriptor& desc) const
+{
+    auto pool = classify(desc);
+
+    // large buffers would occupy most of a block on their own,
+    // leave them to the default VMA heuristics instead.
+    if (desc.size > block_size(pool) / 2)
+        return VK_NULL_HANDLE;
+
+    return handle(pool);
+}
+
+static auto pool_stats(const VmaDetailedStatistics& detailed) -> GPUMemoryPoolStats
+{
+    auto stats = GPUMemoryPoolStats{};
+
+    stats.block_count          = detailed.statistics.blockCount;
+    stats.block_bytes          = detailed.statistics.blockBytes;
+    stats.allocation_count     = detailed.statistics.allocationCount;
+    stats.allocation_bytes     = detailed.statistics.allocationBytes;
+    stats.unused_range_count   = detailed.unusedRangeCount;
+    stats.largest_unused_range = detailed.unusedRangeCount ? detailed.unusedRangeSizeMax : 0;
+
+    if (stats.block_bytes != 0)
+        stats.utilization = static_cast<float>(stats.allocation_bytes) / static_cast<float>(stats.block_bytes);
+
+    // fragmentation is zero when all free space is a single contiguous range
+    GPUSize64 unused_bytes = stats.block_bytes - stats.allocation_bytes;
+    if (unused_bytes != 0)
+        stats.fragmentation = 1.0f - static_cast<float>(stats.largest_unused_range) / static_cast<float>(unused_bytes);
+
+    return stats;
+}
+
+GPUMemoryPoolStats VulkanMemoryPools::stats(GPUMemoryPool pool) const
+{
+    auto vma_pool = handle(pool);
+    if (vma_pool == VK_NULL_HANDLE)
+        return GPUMemoryPoolStats{};
+
+    auto detailed = VmaDetailedStatistics{};
+    vmaCalculatePoolStatistics(get_rhi()->alloc, vma_pool, &detailed);
+    return pool_stats(detailed);
+}
+
+bool api::get_memory_pool_stats(GPUMemoryPool pool, GPUMemoryPoolStats& stats)
+{
+    auto rhi = get_rhi();
+    stats    = rhi->pools.stats(pool);
+    return true;
+}
+
+Vector<GPUMemoryHeapStats> VulkanMemoryBudget::heaps(bool detailed) const
+{
+    auto rhi = get_rhi();
+
+    const VkPhysicalDeviceMemoryProperties* props = nullptr;
+    vmaGetMemoryProperties(rhi->alloc, &props);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(rhi->alloc, budgets);
+
+    // full statistics walk through all blocks, skipped for per-frame budget checks
+    auto total = VmaTotalStatistics{};
+    if (detailed)
+        vmaCalculateStatistics(rhi->alloc, &total);
+
+    Vector<GPUMemoryHeapStats> heaps(props->memoryHeapCount);
+    for (uint i = 0; i < props->memoryHeapCount; i++) {
+        auto& heap            = heaps.at(i);
+        heap.device_local     = (props->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        heap.budget           = budgets[i].budget;
+        heap.usage            = budgets[i].usage;
+        heap.block_count      = budgets[i].statistics.blockCount;
+        heap.block_bytes      = budgets[i].statistics.blockBytes;
+        heap.allocation_count = budgets[i].statistics.allocationCount;
+        heap.allocation_bytes = budgets[i].statistics.allocationBytes;
+
+        if (detailed && total.memoryHeap[i].unusedRangeCount)
+            heap.largest_unused_range = total.memoryHeap[i].unusedRangeSizeMax;
+    }
+    return heaps;
+}
+
+void VulkanMemoryBudget::check()
+{
+    if (!callback)
+        return;
+
+    auto stats = heaps(false);
+    exceeded.resize(stats.size(), false);
+
+    for (uint i = 0; i < stats.size(); i++) {
+        auto& heap = stats.at(i);
+        bool  over = heap.budget != 0 && static_cast<float>(heap.usage) > threshold * static_cast<float>(heap.budget);
+        if (over && !exceeded.at(i))
+            callback(i, heap);
+        exceeded.at(i) = over;
+    }
+}
+
+bool api::get_memory_stats(GPUMemoryStats& stats)
+{
+    auto rhi    = get_rhi();
+    stats.heaps = rhi->budget.heaps(true);
+
+    for (auto& heap : stats.heaps)
+        stats.largest_unused_range = std::max(stats.largest_unused_range, heap.largest_unused_range);
+
+    stats.buffer_count    = static_cast<uint>(rhi->buffers.size());
+    stats.texture_count   = static_cast<uint>(rhi->textures.size());
+    stats.view_count      = static_cast<uint>(rhi->views.size());
+    stats.sampler_count   = static_cast<uint>(rhi->samplers.size());
+    stats.shader_count    = static_cast<uint>(rhi->shaders.size());
+    stats.pipeline_count  = static_cast<uint>(rhi->pipelines.size());
+    stats.blas_count      = static_cast<uint>(rhi->blases.size());
+    stats.tlas_count      = static_cast<uint>(rhi->tlases.size());
+    stats.query_set_count = static_cast<uint>(rhi->query_sets.size());
+    return true;
+}
+
+void api::set_memory_budget_callback(float threshold, const GPUMemoryBudgetCallback& callback)
+{
+    auto rhi              = get_rhi();
+    rhi->budget.threshold = threshold;
+    rhi->budget.callback  = callback;
+    rhi->budget.exceeded.clear();
+}
+
+void VulkanUploadRing::reset()
+{
+    auto rhi = get_rhi();
+
+    // the frame has completed on GPU, outgrown buffers are no longer referenced
+    for (auto& handle : retired)
+        rhi->buffers.remove(handle.value);
+
+    retired.clear();
+    head = 0ull;
+}
+
+void VulkanUploadRing::flush()
+{
+    // no-op for host coherent memory
+    auto rhi = get_rhi();
+
+    // outgrown buffers may still have been written after the ring moved on
+    for (auto& handle : retired) {
+        auto& buf = fetch_resource(rhi->buffers, handle);
+        vk_check(vmaFlushAllocation(rhi->alloc, buf.allocation, 0, VK_WHOLE_SIZE));
+    }
+
+    if (!buffer.valid() || head == 0ull)
+        return;
+
+    auto& buf = fetch_resource(rhi->buffers, buffer);
+    vk_check(vmaFlushAllocation(rhi->alloc, buf.allocation, 0, head));
+}
+
+void VulkanUploadRing::destroy()
+{
+    auto rhi = get_rhi();
+
+    for (auto& handle : retired)
+        rhi->buffers.remove(handle.value);
+
+    if (buffer.valid())
+        rhi->buffers.remove(buffer.value);
+
+    retired.clear();
+    buffer.reset();
+    mapped   = nullptr;
+    capacity = 0ull;
+    head     = 0ull;
+}
+
+void VulkanUploadRing::grow(GPUSize64 size)
+{
+    auto rhi = get_rhi();
+
+    // keep the current buffer alive until the frame completes
+    if (buffer.valid())
+        retired.push_back(buffer);
+
+    // grow geometrically, so that the ring settles after a few frames
+    capacity = std::max(capacity * 2, rhi->pools.desc.upload_ring_size);
+    while (capacity < size)
+        capacity *= 2;
+
+    auto desc               = GPUBufferDescriptor{};
+    desc.label              = "upload_ring";
+    desc.size               = capacity;
+    desc.usage              = GPUBufferUsage::MAP_WRITE | GPUBufferUsage::COPY_SRC;
+    desc.mapped_at_creation = true;
+
+    // transient data is also consumed directly as uniforms and geometry
+    auto additional_usages = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                             VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                             VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
+    auto obj = VulkanBuffer(desc, additional_usages);
+    mapped   = obj.mapped_data;
+    buffer   = GPUBufferHandle(rhi->buffers.add(obj));
+    head     = 0ull;
+}
+
+GPUTransientAllocation VulkanUploadRing::allocate(GPUSize64 size, GPUSize64 alignment)
+{
+    alignment = std::max(alignment, GPUSize64(1));
+
+    GPUSize64 offset = (head + alignment - 1) / alignment * alignment;
+    if (!buffer.valid() || offset + size > capacity) {
+        grow(size);
+        offset = 0ull;
+    }
+
+    head = offset + size;
+
+    auto allocation   = GPUTransientAllocation{};
+    allocation.buffer = buffer;
+    allocation.offset = offset;
+    allocation.size   = size;
+    allocation.data   = mapped + offset;
+    return allocation;
+}
+
+void VulkanStagingPool::destroy()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // NOTE: caller must make sure all command buffers are reset (buffers in use are returned by then)
+    for (auto& bucket : buckets) {
+        for (auto& staging : bucket.free)
+            staging.buffer.destroy();
+        bucket = Bucket{};
+    }
+    current = {};
+    last    = {};
+}
+
+void VulkanStagingPool::new_frame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // trim idle buffers beyond what was in use at once since the last trim
+    if (++frames % TRIM_INTERVAL == 0) {
+        for (auto& bucket : buckets) {
+            while (!bucket.free.empty() && bucket.used + bucket.free.size() > bucket.peak) {
+                bucket.free.back().buffer.destroy();
+                bucket.free.pop_back();
+            }
+            bucket.peak = bucket.used;
+        }
+    }
+
+    last    = current;
+    current = {};
+    for (uint i = 0; i < BUCKET_COUNT; i++) {
+        auto& bucket = buckets.at(i);
+        uint  count  = bucket.used + static_cast<uint>(bucket.free.size());
+        last.pooled_buffers += count;
+        last.pooled_bytes += (MIN_SIZE << i) * count;
+    }
+}
+
+auto VulkanStagingPool::acquire(GPUSize64 size) -> Buffer
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // smallest bucket which fits
+    uint index = 0;
+    while (index < BUCKET_COUNT && (MIN_SIZE << index) < size)
+        index++;
+
+    if (index < BUCKET_COUNT) {
+        auto& bucket = buckets.at(index);
+        bucket.used++;
+        bucket.peak = std::max(bucket.peak, bucket.used);
+
+        if (!bucket.free.empty()) {
+            auto staging = std::move(bucket.free.back());
+            bucket.free.pop_back();
+            current.reuses++;
+            return staging;
+        }
+    }
+
+    auto desc               = GPUBufferDescriptor{};
+    desc.label              = "staging_pool";
+    desc.size               = index < BUCKET_COUNT ? MIN_SIZE << index : size;
+    desc.usage              = GPUBufferUsage::MAP_WRITE | GPUBufferUsage::COPY_SRC;
+    desc.mapped_at_creation = true;
+
+    Buffer staging;
+    staging.buffer = VulkanBuffer(desc);
+    staging.size   = desc.size;
+    staging.bucket = index;
+
+    current.allocations++;
+    return staging;
+}
+
+void VulkanStagingPool::recycle(Buffer& staging)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (staging.bucket >= BUCKET_COUNT) {
+        staging.buffer.destroy();
+        return;
+    }
+
+    auto& bucket = buckets.at(staging.bucket);
+    bucket.used--;
+    bucket.free.push_back(std::move(staging));
+}
+
+bool api::allocate_transient(GPUSize64 size, GPUSize64 alignment, GPUTransientAllocation& allocation)
+{
+    auto rhi = get_rhi();
+
+    // transient memory can be allocated from any thread
+    std::unique_lock<std::shared_mutex> lock(rhi->frame_mutex);
+    allocation = rhi->current_frame().upload_ring.allocate(size, alignment);
+    return true;
+}
+
+// defragmentation walks the default pools first, then the device pool (other pools are host visible)
+constexpr uint DEFRAGMENT_TARGETS = 2;
+
+// resources are copied, hence they need both copy usages
+constexpr VkBufferUsageFlags DEFRAGMENT_BUFFER_USAGES = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+constexpr VkImageUsageFlags  DEFRAGMENT_IMAGE_USAGES  = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+// commands of the pass being recorded, copies are recorded between the two barrier batches
+struct DefragmentCopies
+{
+    struct BufferCopy
+    {
+        VkBuffer     src;
+        VkBuffer     dst;
+        VkBufferCopy region;
+    };
+
+    struct ImageCopy
+    {
+        VkImage             src;
+        VkImage             dst;
+        Vector<VkImageCopy> regions;
+    };
+
+    Vector<BufferCopy>            buffers = {};
+    Vector<ImageCopy>             images  = {};
+    Vector<VkImageMemoryBarrier2> before  = {};
+    Vector<VkImageMemoryBarrier2> after   = {};
+};
+
+static auto allocator_stats() -> GPUMemoryPoolStats
+{
+    auto total = VmaTotalStatistics{};
+    vmaCalculateStatistics(get_rhi()->alloc, &total);
+    return pool_stats(total.total);
+}
+
+static bool movable(const VulkanBuffer& buffer)
+{
+    if ((buffer.usage & DEFRAGMENT_BUFFER_USAGES) != DEFRAGMENT_BUFFER_USAGES)
+        return false;
+
+    // device addresses might be stored in GPU memory, host mappings point into the old memory
+    if (buffer.device_address != 0 || buffer.mapped() || buffer.map_pending)
+        return false;
+
+    VkMemoryPropertyFlags props = 0;
+    vmaGetAllocationMemoryProperties(get_rhi()->alloc, buffer.allocation, &props);
+    return (props & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0;
+}
+
+static auto image_barrier(VkImage image, VkImageAspectFlags aspects, uint32_t mip, uint32_t layer, VkImageLayout src, VkImageLayout dst) -> VkImageMemoryBarrier2
+{
+    bool to_transfer = dst == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL || dst == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+    auto barrier                            = VkImageMemoryBarrier2{};
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask                    = to_transfer ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    barrier.srcAccessMask                   = to_transfer ? VK_ACCESS_2_MEMORY_WRITE_BIT : VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.dstStageMask                    = to_transfer ? VK_PIPELINE_STAGE_2_TRANSFER_BIT : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    barrier.dstAccessMask                   = to_transfer ? VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT : VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+    barrier.oldLayout                       = src;
+    barrier.newLayout                       = dst;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                           = image;
+    barrier.subresourceRange.aspectMask     = aspects;
+    barrier.subresourceRange.baseMipLevel   = mip;
+    barrier.subresourceRange.levelCount     = 1;
+    barrier.subresourceRange.baseArrayLayer = layer;
+    barrier.subresourceRange.layerCount     = 1;
+    return barrier;
+}
+
+static bool move_buffer(VulkanDefragmenter& defrag, DefragmentCopies& copies, VulkanBuffer& buffer, const VmaDefragmentationMove& move)
+{
+    auto rhi = get_rhi();
+
+    if (!movable(buffer))
+        return false;
+
+    auto create_info  = VkBufferCreateInfo{};
+    create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    create_info.size  = buffer.size;
+    create_info.usage = buffer.usage;
+
+    // the new buffer lives in the memory reserved by the move
+    VkBuffer dst = VK_NULL_HANDLE;
+    vk_check(rhi->vtable.vkCreateBuffer(rhi->device, &create_info, nullptr, &dst));
+    vk_check(vmaBindBufferMemory(rhi->alloc, move.dstTmpAllocation, dst));
+
+    auto copy        = DefragmentCopies::BufferCopy{};
+    copy.src         = buffer.buffer;
+    copy.dst         = dst;
+    copy.region.size = buffer.size;
+    copies.buffers.push_back(copy);
+
+    // the handle refers to the new buffer from now on
+    defrag.retired_buffers.push_back(buffer.buffer);
+    buffer.buffer = dst;
+    return true;
+}
+
+static bool move_texture(VulkanDefragmenter& defrag, DefragmentCopies& copies, GPUTextureHandle handle, VulkanTexture& texture, const VmaDefragmentationMove& move)
+{
+    auto rhi = get_rhi();
+
+    if ((texture.create_info.usage & DEFRAGMENT_IMAGE_USAGES) != DEFRAGMENT_IMAGE_USAGES)
+        return false;
+
+    // layouts come from the states left by submitted command buffers, textures without known contents stay
+    Vector<VkImageLayout> layouts;
+    {
+        std::lock_guard<std::mutex> lock(rhi->tracker.mutex);
+        for (uint32_t mip = 0; mip < texture.mip_levels; mip++) {
+            for (uint32_t layer = 0; layer < texture.array_layers; layer++) {
+                auto it = rhi->tracker.states.find(VulkanResourceTracker::key(handle, mip, layer));
+                if (it == rhi->tracker.states.end() || it->second.layout == VK_IMAGE_LAYOUT_UNDEFINED)
+                    return false;
+                layouts.push_back(it->second.layout);
+            }
+        }
+    }
+
+    // the new image lives in the memory reserved by the move
+    VkImage dst = VK_NULL_HANDLE;
+    vk_check(rhi->vtable.vkCreateImage(rhi->device, &texture.create_info, nullptr, &dst));
+    vk_check(vmaBindImageMemory(rhi->alloc, move.dstTmpAllocation, dst));
+
+    auto copy = DefragmentCopies::ImageCopy{};
+    copy.src  = texture.image;
+    copy.dst  = dst;
+
+    auto extent = texture.create_info.extent;
+    for (uint32_t mip = 0; mip < texture.mip_levels; mip++) {
+        auto region                          = VkImageCopy{};
+        region.srcSubresource.aspectMask     = texture.aspects;
+        region.srcSubresource.mipLevel       = mip;
+        region.srcSubresource.baseArrayLayer = 0;
+        region.srcSubresource.layerCount     = texture.array_layers;
+        region.dstSubresource                = region.srcSubresource;
+        region.extent.width                  = std::max(extent.width >> mip, 1u);
+        region.extent.height                 = std::max(extent.height >> mip, 1u);
+        region.extent.depth                  = std::max(extent.depth >> mip, 1u);
+        copy.regions.push_back(region);
+
+        // subresources return to their layouts once copied
+        for (uint32_t layer = 0; layer < texture.array_layers; layer++) {
+            auto layout = layouts.at(mip * texture.array_layers + layer);
+            copies.before.push_back(image_barrier(texture.image, texture.aspects, mip, layer, layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
+            copies.before.push_back(image_barrier(dst, texture.aspects, mip, layer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+            copies.after.push_back(image_barrier(dst, texture.aspects, mip, layer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, layout));
+        }
+    }
+    copies.images.push_back(copy);
+
+    // views of the texture are recreated on the new image
+    for (auto& view : rhi->views) {
+        if (view.texture.value != handle.value)
+            continue;
+
+        auto create_info             = VkImageViewCreateInfo{};
+        create_info.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        create_info.image            = dst;
+        create_info.viewType         = view.type;
+        create_info.format           = view.format;
+        create_info.components       = {};
+        create_info.subresourceRange = view.subresource;
+
+        defrag.retired_views.push_back(view.view);
+        vk_check(rhi->vtable.vkCreateImageView(rhi->device, &create_info, nullptr, &view.view));
+    }
+
+    // the handle refers to the new image from now on
+    defrag.retired_images.push_back(texture.image);
+    texture.image = dst;
+    return true;
+}
+
+static void record_copies(VulkanCommandBuffer& cmd, const DefragmentCopies& copies)
+{
+    auto rhi = get_rhi();
+
+    // previous commands may still access the moved resources
+    auto memory          = VkMemoryBarrier2{};
+    memory.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    memory.srcStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    memory.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+    memory.dstStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    memory.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    auto dependency                    = VkDependencyInfo{};
+    dependency.sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency.memoryBarrierCount      = 1;
+    dependency.pMemoryBarriers         = &memory;
+    dependency.imageMemoryBarrierCount = static_cast<uint32_t>(copies.before.size());
+    dependency.pImageMemoryBarriers    = copies.before.data();
+    rhi->vtable.vkCmdPipelineBarrier2KHR(cmd.command_buffer, &dependency);
+
+    for (auto& copy : copies.buffers)
+        rhi->vtable.vkCmdCopyBuffer(cmd.command_buffer, copy.src, copy.dst, 1, &copy.region);
+
+    for (auto& copy : copies.images)
+        rhi->vtable.vkCmdCopyImage(cmd.command_buffer,
+            copy.src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            copy.dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(copy.regions.size()), copy.regions.data());
+
+    // later commands access the new resources
+    memory.srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    memory.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    memory.dstStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    memory.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+    dependency.imageMemoryBarrierCount = static_cast<uint32_t>(copies.after.size());
+    dependency.pImageMemoryBarriers    = copies.after.data();
+    rhi->vtable.vkCmdPipelineBarrier2KHR(cmd.command_buffer, &dependency);
+}
+
+static bool no_open_commands(const VulkanCommandBuffer& cmd)
+{
+    auto rhi = get_rhi();
+
+    std::shared_lock<std::shared_mutex> lock(rhi->frame_mutex);
+    auto& commands = rhi->current_frame().allocated_command_buffers;
+    return std::none_of(commands.begin(), commands.end(), [&](const VulkanCommandBuffer& other) {
+        return other.open && &other != &cmd;
+    });
+}
+
+void VulkanDefragmenter::record(VulkanCommandBuffer& cmd, const GPUDefragmentDescriptor& desc)
+{
+    auto rhi = get_rhi();
+
+    assert(!cmd.deferred_pass.has_value() && "defragmentation must be recorded outside of render passes!");
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // the previous pass ends once the frame which recorded it retires
+        if (open)
+            return;
+
+        // pending uploads would write to the old locations
+        {
+            std::lock_guard<std::mutex> uploads(rhi->uploads.mutex);
+            if (rhi->uploads.recording.command != VK_NULL_HANDLE || !rhi->uploads.inflight.empty() || !rhi->uploads.acquires.empty())
+                return;
+        }
+
+        // command buffers recorded before the pass but submitted after it would access the old resources
+        assert(no_open_commands(cmd) && "defragmentation must be recorded before other command buffers of the frame are created!");
+
+        if (!begin(desc))
+            return;
+
+        // descriptor sets of the current frame might be bound already, their resources stay
+        HashSet<uint32_t> bound_buffers;
+        HashSet<uint32_t> bound_textures;
+        {
+            std::shared_lock<std::shared_mutex> frame_lock(rhi->frame_mutex);
+            for (auto& resources : rhi->current_frame().descriptor_pool.resources) {
+                for (auto& resource : resources) {
+                    if (resource.buffer.valid())
+                        bound_buffers.insert(resource.buffer.value);
+                    if (resource.view.valid())
+                        bound_textures.insert(fetch_resource(rhi->views, resource.view).texture.value);
+                }
+            }
+        }
+
+        // resources owned by the user, other allocations (acceleration structures, staging memory) never move
+        HashMap<VmaAllocation, VulkanBuffer*>    buffers;
+        HashMap<VmaAllocation, GPUTextureHandle> textures;
+        for (auto it = rhi->buffers.begin(); it != rhi->buffers.end(); ++it)
+            if (!bound_buffers.count(GPUBufferHandle(it.handle()).value))
+                buffers.emplace((*it).allocation, &(*it));
+        for (auto it = rhi->textures.begin(); it != rhi->textures.end(); ++it)
+            if ((*it).alloc_info.size != 0 && !bound_textures.count(GPUTextureHandle(it.handle()).value))
+                textures.emplace((*it).allocation, GPUTextureHandle(it.handle()));
+
+        // the scan above is not part of the time budget
+        auto start  = Clock::now();
+        auto copies = DefragmentCopies{};
+        for (uint32_t i = 0; i < pass.moveCount; i++) {
+            auto& move    = pass.pMoves[i];
+            bool  success = false;
+
+            // the budget covers host time creating and binding the moved resources, not the GPU copies.
+            // moves beyond it are ignored, VMA then keeps their allocations in place for the rest of the context,
+            // they are only proposed by the next context on this pool. every pass moves at least one
+            // resource, so that a tight budget still makes progress.
+            auto elapsed   = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+            bool in_budget = moved.empty() || elapsed < desc.max_time_ms;
+            if (in_budget) {
+                auto buffer  = buffers.find(move.srcAllocation);
+                auto texture = textures.find(move.srcAllocation);
+                if (buffer != buffers.end())
+                    success = move_buffer(*this, copies, *buffer->second, move);
+                else if (texture != textures.end())
+                    success = move_texture(*this, copies, texture->second, fetch_resource(rhi->textures, texture->second), move);
+            }
+
+            if (!success) {
+                move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                if (in_budget)
+                    stats.skipped++;
+                else
+                    stats.abandoned++;
+                continue;
+            }
+
+            auto info = VmaAllocationInfo{};
+            vmaGetAllocationInfo(rhi->alloc, move.srcAllocation, &info);
+            moved.insert(move.srcAllocation);
+            stats.moves++;
+            stats.bytes_moved += info.size;
+        }
+
+        stats.pass_ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        // nothing to wait for. no move is skipped for time before the first one succeeds, hence all moves
+        // of this pass were rejected, VMA would propose them again and the pool is ended instead.
+        if (moved.empty()) {
+            vmaEndDefragmentationPass(rhi->alloc, context, &pass);
+            end();
+            return;
+        }
+
+        if (cmd.tracked)
+            cmd.flush_barriers();
+
+        record_copies(cmd, copies);
+        open = true;
+    }
+
+    // old objects are released, and the moved allocations take over the new memory, once the copies complete
+    rhi->deletes.push(rhi->current_frame_index, []() {
+        get_rhi()->defrag.finish();
+    });
+}
+
+void VulkanDefragmenter::finish()
+{
+    auto rhi = get_rhi();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!open)
+        return;
+
+    for (auto buffer : retired_buffers)
+        rhi->vtable.vkDestroyBuffer(rhi->device, buffer, nullptr);
+    for (auto view : retired_views)
+        rhi->vtable.vkDestroyImageView(rhi->device, view, nullptr);
+    for (auto image : retired_images)
+        rhi->vtable.vkDestroyImage(rhi->device, image, nullptr);
+
+    retired_buffers.clear();
+    retired_views.clear();
+    retired_images.clear();
+
+    auto result = vmaEndDefragmentationPass(rhi->alloc, context, &pass);
+
+    // offsets and memory blocks of the moved allocations have changed
+    for (auto& buffer : rhi->buffers)
+        if (moved.count(buffer.allocation))
+            vmaGetAllocationInfo(rhi->alloc, buffer.allocation, &buffer.alloc_info);
+    for (auto& texture : rhi->textures)
+        if (moved.count(texture.allocation))
+            vmaGetAllocationInfo(rhi->alloc, texture.allocation, &texture.alloc_info);
+
+    moved.clear();
+    open = false;
+
+    stats.passes++;
+    stats.before = before;
+    stats.after  = allocator_stats();
+
+    // no more moves in this pool
+    if (result == VK_SUCCESS)
+        end();
+}
+
+void VulkanDefragmenter::destroy()
+{
+    // NOTE: caller must wait idle first, the deletion queue has finished the open pass by then
+    finish();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (context != VK_NULL_HANDLE)
+        end();
+}
+
+bool VulkanDefragmenter::begin(const GPUDefragmentDescriptor& desc)
+{
+    auto rhi = get_rhi();
+
+    // pass limits are fixed for the whole context
+    if (context == VK_NULL_HANDLE) {
+        auto info                  = VmaDefragmentationInfo{};
+        info.flags                 = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        info.pool                  = target == 0 ? VK_NULL_HANDLE : rhi->pools.device;
+        info.maxBytesPerPass       = desc.max_bytes_per_pass;
+        info.maxAllocationsPerPass = desc.max_moves_per_pass;
+        vk_check(vmaBeginDefragmentation(rhi->alloc, &info, &context));
+    }
+
+    // nothing left to move in this pool
+    auto result = vmaBeginDefragmentationPass(rhi->alloc, context, &pass);
+    if (result == VK_SUCCESS) {
+        end();
+        return false;
+    }
+
+    if (result != VK_INCOMPLETE)
+        vk_check(result);
+
+    before = allocator_stats();
+    return true;
+}
+
+void VulkanDefragmenter::end()
+{
+    auto rhi = get_rhi();
+
+    auto result = VmaDefragmentationStats{};
+    vmaEndDefragmentation(rhi->alloc, context, &result);
+    context = VK_NULL_HANDLE;
+
+    stats.bytes_freed += result.bytesFreed;
+    stats.blocks_freed += result.deviceMemoryBlocksFreed;
+
+    // the next context continues with the next pool
+    target = (target + 1) % DEFRAGMENT_TARGETS;
+}
+
+bool api::get_defragment_stats(GPUDefragmentStats& stats)
+{
+    auto rhi = get_rhi();
+
+    std::lock_guard<std::mutex> lock(rhi->defrag.mutex);
+    stats = rhi->defrag.stats;
+    return true;
+}
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include "VkUtils.h"
+
+// weight of the latest frame in the smoothed CPU and GPU times
+constexpr float ESTIMATE_WEIGHT = 0.1f;
+
+// headroom kept between the predicted and the actual time the GPU needs the next frame (in milliseconds)
+constexpr float LOW_LATENCY_MARGIN = 1.0f;
+
+static float elapsed_ms(VulkanFramePacer::Clock::time_point since)
+{
+    return std::chrono::duration<float, std::milli>(VulkanFramePacer::Clock::now() - since).count();
+}
+
+static float smooth(float estimate, float sample)
+{
+    return estimate == 0.0f ? sample : estimate + (sample - estimate) * ESTIMATE_WEIGHT;
+}
+
+void VulkanFramePacer::init()
+{
+    auto rhi = get_rhi();
+
+    timeline   = VulkanSemaphore(VK_SEMAPHORE_TYPE_TIMELINE);
+    timestamps = rhi->props.limits.timestampComputeAndGraphics == VK_TRUE;
+}
+
+void VulkanFramePacer::destroy()
+{
+    auto rhi = get_rhi();
+
+    // NOTE: caller must make sure the device is idle
+    for (auto& slot : slots)
+        if (slot.pool != VK_NULL_HANDLE)
+            rhi->vtable.vkDestroyQueryPool(rhi->device, slot.pool, nullptr);
+
+    for (auto& [queue, semaphore] : queue_timelines)
+        semaphore.destroy();
+
+    timeline.destroy();
+    slots.clear();
+    queues.clear();
+    queue_timelines.clear();
+}
+
+uint VulkanFramePacer::frames_in_flight() const
+{
+    uint available = static_cast<uint>(get_rhi()->frames.size());
+    return frames == 0 ? available : std::min(frames, available);
+}
+
+uint64_t VulkanFramePacer::completed()
+{
+    auto rhi = get_rhi();
+
+    uint64_t value = 0ull;
+    vk_check(rhi->vtable.vkGetSemaphoreCounterValue(rhi->device, timeline.semaphore, &value));
+    return value;
+}
+
+void VulkanFramePacer::begin(uint frame)
+{
+    auto rhi   = get_rhi();
+    auto start = Clock::now();
+    uint count = frames_in_flight();
+
+    // slots follow the frame objects (more frames are created along with swapchains)
+    if (slots.size() < rhi->frames.size())
+        slots.resize(rhi->frames.size());
+
+    current    = frame % static_cast<uint>(rhi->frames.size());
+    auto& slot = slots.at(current);
+
+    // frame N - count must be complete, low latency mode additionally keeps at most one frame queued
+    uint64_t value = frame >= count ? frame - count + 1 : 0ull;
+    if (low_latency && frame >= 2)
+        value = std::max(value, uint64_t(frame - 1));
+
+    // the previous frame of this slot must be complete before its objects are reused
+    value = std::max(value, slot.value);
+    if (value > 0)
+        wait(value);
+
+    // the GPU is now working on the previous frame, and needs this frame right after it,
+    // therefore recording starts as late as possible, but no later than the previous frame completes.
+    timing.latency_sleep = 0.0f;
+    if (low_latency && frame >= 1 && gpu_estimate > cpu_estimate + LOW_LATENCY_MARGIN) {
+        auto sleep_start = Clock::now();
+        auto slack       = gpu_estimate - cpu_estimate - LOW_LATENCY_MARGIN;
+        wait(frame, static_cast<uint64_t>(slack * 1e6f));
+        timing.latency_sleep = elapsed_ms(sleep_start);
+    }
+
+    // the frame previously using this slot is complete, collect its measurements
+    if (slot.value > 0)
+        measure(slot);
+
+    // timestamps are written by the first graphics command buffer and at the end of the frame
+    if (timestamps && slot.pool == VK_NULL_HANDLE) {
+        auto create_info       = VkQueryPoolCreateInfo{};
+        create_info.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        create_info.pNext      = nullptr;
+        create_info.flags      = 0;
+        create_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+        create_info.queryCount = 2;
+        vk_check(rhi->vtable.vkCreateQueryPool(rhi->device, &create_info, nullptr, &slot.pool));
+    }
+    if (timestamps)
+        rhi->vtable.vkResetQueryPool(rhi->device, slot.pool, 0, 2);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slot.value = frame + 1ull;
+        slot.began = false;
+        queues.clear();
+    }
+
+    timing.frames   = count;
+    timing.cpu_wait = elapsed_ms(start);
+    frame_start     = Clock::now();
+}
+
+void VulkanFramePacer::end(uint frame)
+{
+    auto  rhi  = get_rhi();
+    auto& slot = slots.at(current);
+    auto& frm  = rhi->current_frame();
+
+    assert(slot.value == frame + 1ull && "end_frame() must follow new_frame() of the same frame!");
+    slot.cpu = elapsed_ms(frame_start);
+
+    // the end marker signals the frame timeline after all previous graphics work
+    auto& marker = frm.command(frm.allocate(GPUQueueType::DEFAULT, true));
+    marker.begin();
+    if (timestamps)
+        rhi->vtable.vkCmdWriteTimestamp(marker.command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, slot.pool, 1);
+    marker.end();
+
+    Vector<VkQueue> used;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        used.swap(queues);
+    }
+
+    // other queues signal once their work of this frame completes, the end marker waits on them
+    for (auto queue : used) {
+        auto& semaphore = queue_timelines[queue];
+        if (!semaphore.valid())
+            semaphore = VulkanSemaphore(VK_SEMAPHORE_TYPE_TIMELINE);
+        semaphore.target = slot.value;
+
+        auto signal_info        = VkSemaphoreSubmitInfo{};
+        signal_info.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        signal_info.pNext       = nullptr;
+        signal_info.semaphore   = semaphore.semaphore;
+        signal_info.value       = semaphore.target;
+        signal_info.stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        signal_info.deviceIndex = 0;
+
+        auto submission    = VulkanSubmitQueue::Submission{};
+        submission.queue   = queue;
+        submission.signals = {signal_info};
+        rhi->submits.push(std::move(submission));
+
+        marker.wait(semaphore, GPUBarrierSync::ALL);
+    }
+
+    auto semaphore   = timeline;
+    semaphore.target = slot.value;
+    marker.signal(semaphore, GPUBarrierSync::ALL);
+    marker.submit();
+}
+
+void VulkanFramePacer::mark(VulkanCommandBuffer& cmd)
+{
+    auto rhi = get_rhi();
+    if (!timestamps || slots.empty() || cmd.command_queue != rhi->graphics_queue)
+        return;
+
+    // the frame begins on GPU with its first graphics command buffer,
+    // command buffers created later but submitted earlier are not included in the GPU time.
+    auto& slot = slots.at(current);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (slot.began)
+            return;
+        slot.began = true;
+    }
+    rhi->vtable.vkCmdWriteTimestamp(cmd.command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.pool, 0);
+}
+
+void VulkanFramePacer::track(VkQueue queue)
+{
+    auto rhi = get_rhi();
+    if (queue == rhi->graphics_queue)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (std::find(queues.begin(), queues.end(), queue) == queues.end())
+        queues.push_back(queue);
+}
+
+void VulkanFramePacer::measure(Slot& slot)
+{
+    auto rhi = get_rhi();
+
+    timing.frame    = static_cast<uint>(slot.value - 1);
+    timing.cpu_time = slot.cpu;
+    timing.gpu_time = 0.0f;
+    timing.gpu_idle = 0.0f;
+    cpu_estimate    = smooth(cpu_estimate, slot.cpu);
+
+    if (!timestamps)
+        return;
+
+    // frames without graphics submissions only have the end timestamp
+    Array<uint64_t, 2> ticks = {};
+
+    uint first = slot.began ? 0 : 1;
+    auto data  = ticks.data() + first;
+    auto size  = sizeof(uint64_t) * (2 - first);
+    if (rhi->vtable.vkGetQueryPoolResults(rhi->device, slot.pool, first, 2 - first, size, data, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return;
+
+    // timestamp period is in nanoseconds per tick
+    float period = rhi->props.limits.timestampPeriod * 1e-6f;
+    if (slot.began) {
+        timing.gpu_time = static_cast<float>(ticks.at(1) - ticks.at(0)) * period;
+        timing.gpu_idle = last_end != 0 && ticks.at(0) > last_end ? static_cast<float>(ticks.at(0) - last_end) * period : 0.0f;
+        gpu_estimate    = smooth(gpu_estimate, timing.gpu_time);
+    }
+    last_end = ticks.at(1);
+}
+
+bool VulkanFramePacer::wait(uint64_t value, uint64_t timeout)
+{
+    auto wait_info           = VkSemaphoreWaitInfo{};
+    wait_info.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.pNext          = nullptr;
+    wait_info.flags          = 0;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores    = &timeline.semaphore;
+    wait_info.pValues        = &value;
+
+    auto rhi    = get_rhi();
+    auto result = rhi->vtable.vkWaitSemaphores(rhi->device, &wait_info, timeout);
+    if (result == VK_TIMEOUT)
+        return false;
+
+    vk_check(result);
+    return true;
+}
@@ -17,23 +17,24 @@ VulkanPipeline::VulkanPipeline() : pipeline(VK_NULL_HANDLE), cache(VK_NULL_HANDL
     // do nothing
 }
 
-VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
+VulkanPipelineState::VulkanPipelineState(const GPURenderPipelineDescriptor& desc) : bind_point(VK_PIPELINE_BIND_POINT_GRAPHICS)
 {
     auto rhi = get_rhi();
 
-    auto& layout  = fetch_resource(rhi->pipeline_layouts, desc.layout);
     auto& vshader = fetch_resource(rhi->shaders, desc.vertex.module);
     auto& fshader = fetch_resource(rhi->shaders, desc.fragment.module);
 
+    layout = fetch_resource(rhi->pipeline_layouts, desc.layout).layout;
+    label  = desc.label ? desc.label : "";
+
     // shader stages
-    Vector<VkPipelineShaderStageCreateInfo> stages;
-    stages.push_back(create_shader_stage(vshader, desc.vertex.entry_point, VK_SHADER_STAGE_VERTEX_BIT));
-    stages.push_back(create_shader_stage(fshader, desc.fragment.entry_point, VK_SHADER_STAGE_FRAGMENT_BIT));
+    entry_points.at(0) = desc.vertex.entry_point;
+    entry_points.at(1) = desc.fragment.entry_point;
+    stages.push_back(create_shader_stage(vshader, entry_points.at(0).c_str(), VK_SHADER_STAGE_VERTEX_BIT));
+    stages.push_back(create_shader_stage(fshader, entry_points.at(1).c_str(), VK_SHADER_STAGE_FRAGMENT_BIT));
 
     // vertex attributes
-    uint                                      binding = 0;
-    Vector<VkVertexInputBindingDescription>   vertex_layouts;
-    Vector<VkVertexInputAttributeDescription> vertex_attribs;
+    uint binding = 0;
     for (auto& layout : desc.vertex.buffers) {
         auto vertex_layout      = VkVertexInputBindingDescription{};
         vertex_layout.binding   = binding++;
@@ -52,8 +53,6 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     }
 
     // color blend attachments
-    Vector<VkFormat>                            formats{};
-    Vector<VkPipelineColorBlendAttachmentState> attachments;
     for (auto& attachment : desc.fragment.targets) {
         auto blend                = VkPipelineColorBlendAttachmentState{};
         blend.blendEnable         = attachment.blend_enable;
@@ -71,11 +70,11 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     // use dummy swapchain extent for non-windowed workload,
     // but also query from the first available swapchain
     VkExtent2D extent = {1920, 1080};
-    if (!rhi->swapchains.data.empty())
-        extent = rhi->swapchains.data.at(0).extent;
+    if (!rhi->swapchains.empty())
+        extent = (*rhi->swapchains.begin()).extent;
 
     // dummy viewport (supposed to be replaced by vkCmdSetViewport)
-    auto viewport     = VkViewport{};
+    viewport          = VkViewport{};
     viewport.x        = 0;
     viewport.y        = 0;
     viewport.width    = static_cast<float>(extent.width);
@@ -84,14 +83,14 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     viewport.maxDepth = 1.0f;
 
     // dummy scissor (supposed to be replaced by vkCmdSetScissor)
-    auto scissor          = VkRect2D{};
+    scissor               = VkRect2D{};
     scissor.offset.x      = 0;
     scissor.offset.y      = 0;
     scissor.extent.width  = extent.width;
     scissor.extent.height = extent.height;
 
     // allow viewport/scissor/etc to be reset at rendering time
-    Vector<VkDynamicState> dynamics = {
+    dynamics = {
         VK_DYNAMIC_STATE_VIEWPORT,
         VK_DYNAMIC_STATE_SCISSOR,
         VK_DYNAMIC_STATE_LINE_WIDTH,
@@ -99,7 +98,7 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
         VK_DYNAMIC_STATE_STENCIL_REFERENCE,
     };
 
-    auto vertex_input_state                            = VkPipelineVertexInputStateCreateInfo{};
+    vertex_input_state                                 = VkPipelineVertexInputStateCreateInfo{};
     vertex_input_state.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertex_input_state.pNext                           = nullptr;
     vertex_input_state.pVertexBindingDescriptions      = vertex_layouts.data();
@@ -107,17 +106,17 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     vertex_input_state.pVertexAttributeDescriptions    = vertex_attribs.data();
     vertex_input_state.vertexAttributeDescriptionCount = static_cast<uint>(vertex_attribs.size());
 
-    auto input_assembly_state                   = VkPipelineInputAssemblyStateCreateInfo{};
+    input_assembly_state                        = VkPipelineInputAssemblyStateCreateInfo{};
     input_assembly_state.sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     input_assembly_state.pNext                  = nullptr;
     input_assembly_state.topology               = vkenum(desc.primitive.topology);
     input_assembly_state.primitiveRestartEnable = false;
 
-    auto tessellation_state  = VkPipelineTessellationStateCreateInfo{};
+    tessellation_state       = VkPipelineTessellationStateCreateInfo{};
     tessellation_state.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
     tessellation_state.pNext = nullptr;
 
-    auto viewport_state          = VkPipelineViewportStateCreateInfo{};
+    viewport_state               = VkPipelineViewportStateCreateInfo{};
     viewport_state.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewport_state.pNext         = nullptr;
     viewport_state.pViewports    = &viewport;
@@ -125,7 +124,7 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     viewport_state.pScissors     = &scissor;
     viewport_state.scissorCount  = 1;
 
-    auto rasterization_state                    = VkPipelineRasterizationStateCreateInfo{};
+    rasterization_state                         = VkPipelineRasterizationStateCreateInfo{};
     rasterization_state.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterization_state.pNext                   = nullptr;
     rasterization_state.cullMode                = vkenum(desc.primitive.cull_mode);
@@ -138,7 +137,7 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     rasterization_state.depthBiasSlopeFactor    = desc.depth_stencil.depth_bias_slope_scale;
     rasterization_state.depthBiasClamp          = desc.depth_stencil.depth_bias_clamp;
 
-    auto multisample_state                  = VkPipelineMultisampleStateCreateInfo{};
+    multisample_state                       = VkPipelineMultisampleStateCreateInfo{};
     multisample_state.sType                 = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisample_state.pNext                 = nullptr;
     multisample_state.pSampleMask           = nullptr;
@@ -148,7 +147,7 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     multisample_state.alphaToCoverageEnable = desc.multisample.alpha_to_coverage_enabled;
     multisample_state.rasterizationSamples  = vkenum(int(desc.multisample.count));
 
-    auto depth_stencil_state                  = VkPipelineDepthStencilStateCreateInfo{};
+    depth_stencil_state                       = VkPipelineDepthStencilStateCreateInfo{};
     depth_stencil_state.sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     depth_stencil_state.pNext                 = nullptr;
     depth_stencil_state.depthTestEnable       = desc.depth_stencil.depth_compare != GPUCompareFunction::ALWAYS || desc.depth_stencil.depth_write_enabled;
@@ -179,7 +178,7 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     depth_stencil_state.back.compareMask  = desc.depth_stencil.stencil_read_mask;
     depth_stencil_state.back.reference    = 0; // need to be set dynamically
 
-    auto color_blend_state            = VkPipelineColorBlendStateCreateInfo{};
+    color_blend_state                 = VkPipelineColorBlendStateCreateInfo{};
     color_blend_state.sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     color_blend_state.pNext           = nullptr;
     color_blend_state.logicOpEnable   = VK_FALSE;
@@ -187,13 +186,13 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
     color_blend_state.pAttachments    = attachments.data();
     color_blend_state.attachmentCount = static_cast<uint>(attachments.size());
 
-    auto dynamic_states              = VkPipelineDynamicStateCreateInfo{};
+    dynamic_states                   = VkPipelineDynamicStateCreateInfo{};
     dynamic_states.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     dynamic_states.pNext             = nullptr;
     dynamic_states.pDynamicStates    = dynamics.data();
     dynamic_states.dynamicStateCount = static_cast<uint>(dynamics.size());
 
-    auto pipeline_rendering_create_info                    = VkPipelineRenderingCreateInfo{};
+    pipeline_rendering_create_info                         = VkPipelineRenderingCreateInfo{};
     pipeline_rendering_create_info.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
     pipeline_rendering_create_info.pNext                   = nullptr;
     pipeline_rendering_create_info.colorAttachmentCount    = static_cast<uint>(formats.size());
@@ -207,54 +206,70 @@ VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc)
             pipeline_rendering_create_info.stencilAttachmentFormat = vkenum(desc.depth_stencil.format);
     }
 
-    auto create_info                = VkGraphicsPipelineCreateInfo{};
-    create_info.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    create_info.pNext               = &pipeline_rendering_create_info;
-    create_info.layout              = layout.layout;
-    create_info.flags               = VkPipelineCreateFlags(0);
-    create_info.pStages             = stages.data();
-    create_info.stageCount          = static_cast<uint>(stages.size());
-    create_info.pVertexInputState   = &vertex_input_state;
-    create_info.pInputAssemblyState = &input_assembly_state;
-    create_info.pTessellationState  = &tessellation_state;
-    create_info.pViewportState      = &viewport_state;
-    create_info.pRasterizationState = &rasterization_state;
-    create_info.pMultisampleState   = &multisample_state;
-    create_info.pDepthStencilState  = &depth_stencil_state;
-    create_info.pColorBlendState    = &color_blend_state;
-    create_info.pDynamicState       = &dynamic_states;
-    create_info.subpass             = 0;              // enable feature: dynamic rendering
-    create_info.renderPass          = VK_NULL_HANDLE; // enable feature: dynamic rendering
-                                                      //
-    // TODO: support specialization constants
-
-    this->layout = layout.layout; // record the pipeline layout
-    vk_check(rhi->vtable.vkCreateGraphicsPipelines(rhi->device, cache, 1, &create_info, nullptr, &pipeline));
+    graphics_create_info                     = VkGraphicsPipelineCreateInfo{};
+    graphics_create_info.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    graphics_create_info.pNext               = &pipeline_rendering_create_info;
+    graphics_create_info.layout              = layout;
+    graphics_create_info.flags               = VkPipelineCreateFlags(0);
+    graphics_create_info.pStages             = stages.data();
+    graphics_create_info.stageCount          = static_cast<uint>(stages.size());
+    graphics_create_info.pVertexInputState   = &vertex_input_state;
+    graphics_create_info.pInputAssemblyState = &input_assembly_state;
+    graphics_create_info.pTessellationState  = &tessellation_state;
+    graphics_create_info.pViewportState      = &viewport_state;
+    graphics_create_info.pRasterizationState = &rasterization_state;
+    graphics_create_info.pMultisampleState   = &multisample_state;
+    graphics_create_info.pDepthStencilState  = &depth_stencil_state;
+    graphics_create_info.pColorBlendState    = &color_blend_state;
+    graphics_create_info.pDynamicState       = &dynamic_states;
+    graphics_create_info.subpass             = 0;              // enable feature: dynamic rendering
+    graphics_create_info.renderPass          = VK_NULL_HANDLE; // enable feature: dynamic rendering
 
-    if (desc.label)
-        rhi->set_debug_label(VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline, desc.label);
+    // TODO: support specialization constants
 }
 
-VulkanPipeline::VulkanPipeline(const GPUComputePipelineDescriptor& desc)
+VulkanPipelineState::VulkanPipelineState(const GPUComputePipelineDescriptor& desc) : bind_point(VK_PIPELINE_BIND_POINT_COMPUTE)
 {
     auto rhi = get_rhi();
 
-    auto& layout = fetch_resource(rhi->pipeline_layouts, desc.layout);
     auto& shader = fetch_resource(rhi->shaders, desc.compute.module);
 
-    auto create_info   = VkComputePipelineCreateInfo{};
-    create_info.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-    create_info.pNext  = nullptr;
-    create_info.layout = layout.layout;
-    create_info.stage  = create_shader_stage(shader, desc.compute.entry_point, VK_SHADER_STAGE_COMPUTE_BIT);
+    layout = fetch_resource(rhi->pipeline_layouts, desc.layout).layout;
+    label  = desc.label ? desc.label : "";
+
+    entry_points.at(0) = desc.compute.entry_point;
+
+    compute_create_info        = VkComputePipelineCreateInfo{};
+    compute_create_info.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    compute_create_info.pNext  = nullptr;
+    compute_create_info.layout = layout;
+    compute_create_info.stage  = create_shader_stage(shader, entry_points.at(0).c_str(), VK_SHADER_STAGE_COMPUTE_BIT);
 
     // TODO: support specialization constants
+}
+
+VulkanPipeline::VulkanPipeline(const GPURenderPipelineDescriptor& desc) : VulkanPipeline(VulkanPipelineState(desc))
+{
+    // do nothing
+}
+
+VulkanPipeline::VulkanPipeline(const GPUComputePipelineDescriptor& desc) : VulkanPipeline(VulkanPipelineState(desc))
+{
+    // do nothing
+}
+
+VulkanPipeline::VulkanPipeline(const VulkanPipelineState& state)
+{
+    auto rhi = get_rhi();
 
-    this->layout = layout.layout; // record the pipeline layout
-    vk_check(rhi->vtable.vkCreateComputePipelines(rhi->device, cache, 1, &create_info, nullptr, &pipeline));
+    this->layout = state.layout; // record the pipeline layout
+    if (state.bind_point == VK_PIPELINE_BIND_POINT_GRAPHICS)
+        vk_check(rhi->vtable.vkCreateGraphicsPipelines(rhi->device, cache, 1, &state.graphics_create_info, nullptr, &pipeline));
+    if (state.bind_point == VK_PIPELINE_BIND_POINT_COMPUTE)
+        vk_check(rhi->vtable.vkCreateComputePipelines(rhi->device, cache, 1, &state.compute_create_info, nullptr, &pipeline));
 
-    if (desc.label)
-        rhi->set_debug_label(VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline, desc.label);
+    if (!state.label.empty())
+        rhi->set_debug_label(VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline, state.label.c_str());
 }
 
 VulkanPipeline::VulkanPipeline(const GPURayTracingPipelineDescriptor& desc)
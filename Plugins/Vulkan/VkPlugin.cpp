@@ -70,7 +70,10 @@ bool api::create_buffer(GPUBufferHandle& buffer, const GPUBufferDescriptor& desc
 
 void api::delete_buffer(GPUBufferHandle buffer)
 {
-    get_rhi()->buffers.remove(buffer.value);
+    auto rhi = get_rhi();
+    rhi->tracker.forget(buffer);
+    rhi->maps.cancel(buffer);
+    defer_delete(rhi->buffers, buffer);
 }
 
 void api::map_buffer(GPUBufferHandle buffer, GPUMapMode, GPUSize64 offset, GPUSize64 size)
@@ -80,10 +83,34 @@ void api::map_buffer(GPUBufferHandle buffer, GPUMapMode, GPUSize64 offset, GPUSi
     buf.map(offset, size);
 }
 
+void api::map_buffer_async(GPUBufferHandle buffer, GPUMapMode, GPUSize64 offset, GPUSize64 size, const GPUBufferMapCallback& callback)
+{
+    auto  rhi = get_rhi();
+    auto& buf = fetch_resource(rhi->buffers, buffer);
+    assert(!buf.mapped() && !buf.map_pending && "buffer is already mapped or pending!");
+    buf.map_pending = true;
+
+    // GPU writes submitted up to this frame are complete once this frame retires
+    auto request     = VulkanMapQueue::Request{};
+    request.frame    = rhi->current_frame_index;
+    request.buffer   = buffer;
+    request.offset   = offset;
+    request.size     = size;
+    request.callback = callback;
+    rhi->maps.push(std::move(request));
+}
+
 void api::unmap_buffer(GPUBufferHandle buffer)
 {
     auto  rhi = get_rhi();
     auto& buf = fetch_resource(rhi->buffers, buffer);
+
+    // unmapping a pending buffer aborts the request
+    if (buf.map_pending) {
+        rhi->maps.cancel(buffer);
+        return;
+    }
+
     buf.unmap();
     buf.mapped_size = 0;
 }
@@ -92,7 +119,7 @@ void api::get_mapped_state(GPUBufferHandle buffer, GPUMapState& state)
 {
     auto  rhi = get_rhi();
     auto& buf = fetch_resource(rhi->buffers, buffer);
-    state     = buf.mapped() ? GPUMapState::MAPPED : GPUMapState::UNMAPPED;
+    state     = buf.map_pending ? GPUMapState::PENDING : buf.mapped() ? GPUMapState::MAPPED : GPUMapState::UNMAPPED;
 }
 
 void api::get_mapped_range(GPUBufferHandle buffer, MappedBufferRange& range)
@@ -105,17 +132,16 @@ void api::get_mapped_range(GPUBufferHandle buffer, MappedBufferRange& range)
 
 bool api::create_sampler(GPUSamplerHandle& sampler, const GPUSamplerDescriptor& desc)
 {
-    auto obj = VulkanSampler(desc);
-    auto rhi = get_rhi();
-    auto ind = rhi->samplers.add(obj);
-
-    sampler = GPUSamplerHandle(ind);
+    // identical samplers share the same handle
+    sampler = get_rhi()->sampler_cache.acquire(desc);
     return true;
 }
 
 void api::delete_sampler(GPUSamplerHandle sampler)
 {
-    get_rhi()->samplers.remove(sampler.value);
+    auto rhi = get_rhi();
+    if (rhi->sampler_cache.release(sampler))
+        defer_delete(rhi->samplers, sampler);
 }
 
 bool api::create_texture(GPUTextureHandle& texture, const GPUTextureDescriptor& desc)
@@ -130,7 +156,12 @@ bool api::create_texture(GPUTextureHandle& texture, const GPUTextureDescriptor&
 
 void api::delete_texture(GPUTextureHandle handle)
 {
-    get_rhi()->textures.remove(handle.value);
+    auto rhi = get_rhi();
+    if (rhi->textures.contains(handle.value)) {
+        auto& tex = fetch_resource(rhi->textures, handle);
+        rhi->tracker.forget(handle, tex.mip_levels, tex.array_layers);
+    }
+    defer_delete(rhi->textures, handle);
 }
 
 bool api::create_texture_view(GPUTextureViewHandle& handle, GPUTextureHandle texture, const GPUTextureViewDescriptor& desc)
@@ -138,7 +169,11 @@ bool api::create_texture_view(GPUTextureViewHandle& handle, GPUTextureHandle tex
     auto  rhi = get_rhi();
     auto& tex = fetch_resource(rhi->textures, texture);
     auto  obj = VulkanTextureView(tex, desc);
-    auto  ind = rhi->views.add(obj);
+
+    // views are tracked as their texture's subresources
+    obj.texture = texture;
+
+    auto ind = rhi->views.add(obj);
 
     handle = GPUTextureViewHandle(ind);
     return true;
@@ -146,22 +181,30 @@ bool api::create_texture_view(GPUTextureViewHandle& handle, GPUTextureHandle tex
 
 void api::delete_texture_view(GPUTextureViewHandle handle)
 {
-    get_rhi()->views.remove(handle.value);
+    defer_delete(get_rhi()->views, handle);
 }
 
 bool api::create_shader_module(GPUShaderModuleHandle& shader, const GPUShaderModuleDescriptor& desc)
 {
-    auto obj = VulkanShader(desc);
-    auto rhi = get_rhi();
-    auto ind = rhi->shaders.add(obj);
-
-    shader = GPUShaderModuleHandle(ind);
+    // identical blobs share the same handle
+    shader = get_rhi()->shader_cache.acquire(desc);
     return true;
 }
 
 void api::delete_shader_module(GPUShaderModuleHandle shader)
 {
-    get_rhi()->shaders.remove(shader.value);
+    auto rhi = get_rhi();
+    if (rhi->shader_cache.release(shader)) {
+        // queued compilations may still use the module
+        rhi->compiler.wait_module(fetch_resource(rhi->shaders, shader).module);
+        defer_delete(rhi->shaders, shader);
+    }
+}
+
+bool api::get_shader_module_hash(GPUShaderModuleHandle shader, GPUSize64& hash)
+{
+    hash = fetch_resource(get_rhi()->shaders, shader).hash;
+    return true;
 }
 
 bool api::create_fence(GPUFenceHandle& fence, VkSemaphoreType type)
@@ -186,7 +229,7 @@ bool api::create_fence(GPUFenceHandle& fence)
 
 void api::delete_fence(GPUFenceHandle fence)
 {
-    get_rhi()->fences.remove(fence.value);
+    defer_delete(get_rhi()->fences, fence);
 }
 
 bool api::create_blas(GPUBlasHandle& blas, const GPUBlasDescriptor& desc, GPUBlasGeometrySizeDescriptors sizes)
@@ -201,7 +244,7 @@ bool api::create_blas(GPUBlasHandle& blas, const GPUBlasDescriptor& desc, GPUBla
 
 void api::delete_blas(GPUBlasHandle blas)
 {
-    get_rhi()->blases.remove(blas.value);
+    defer_delete(get_rhi()->blases, blas);
 }
 
 bool api::create_tlas(GPUTlasHandle& tlas, const GPUTlasDescriptor& desc)
@@ -216,7 +259,7 @@ bool api::create_tlas(GPUTlasHandle& tlas, const GPUTlasDescriptor& desc)
 
 void api::delete_tlas(GPUTlasHandle tlas)
 {
-    get_rhi()->tlases.remove(tlas.value);
+    defer_delete(get_rhi()->tlases, tlas);
 }
 
 bool api::get_blas_sizes(GPUBlasHandle blas, GPUBVHSizes& sizes)
@@ -249,7 +292,14 @@ bool api::create_query_set(GPUQuerySetHandle& query_set, const GPUQuerySetDescri
 
 void api::delete_query_set(GPUQuerySetHandle query_set)
 {
-    get_rhi()->query_sets.remove(query_set.value);
+    defer_delete(get_rhi()->query_sets, query_set);
+}
+
+void api::reset_query_set(GPUQuerySetHandle query_set, GPUSize32 first_query, GPUSize32 query_count)
+{
+    auto  rhi = get_rhi();
+    auto& qry = fetch_resource(rhi->query_sets, query_set);
+    rhi->vtable.vkResetQueryPool(rhi->device, qry.pool, first_query, query_count);
 }
 
 bool api::create_bind_group_layout(GPUBindGroupLayoutHandle& layout, const GPUBindGroupLayoutDescriptor& desc)
@@ -264,7 +314,7 @@ bool api::create_bind_group_layout(GPUBindGroupLayoutHandle& layout, const GPUBi
 
 void api::delete_bind_group_layout(GPUBindGroupLayoutHandle layout)
 {
-    get_rhi()->bind_group_layouts.remove(layout.value);
+    defer_delete(get_rhi()->bind_group_layouts, layout);
 }
 
 bool api::create_pipeline_layout(GPUPipelineLayoutHandle& layout, const GPUPipelineLayoutDescriptor& desc)
@@ -279,13 +329,40 @@ bool api::create_pipeline_layout(GPUPipelineLayoutHandle& layout, const GPUPipel
 
 void api::delete_pipeline_layout(GPUPipelineLayoutHandle layout)
 {
-    get_rhi()->pipeline_layouts.remove(layout.value);
+    auto rhi = get_rhi();
+
+    // queued compilations may still use the layout
+    rhi->compiler.wait_layout(fetch_resource(rhi->pipeline_layouts, layout).layout);
+    defer_delete(rhi->pipeline_layouts, layout);
+}
+
+template <typename Descriptor>
+static uint create_async_pipeline(const Descriptor& desc)
+{
+    auto rhi = get_rhi();
+
+    // the state is built here, only pipeline creation itself runs on the workers
+    auto state = std::make_unique<VulkanPipelineState>(desc);
+
+    // the slot is reserved right away, commands using it are skipped until the pipeline is installed
+    auto obj    = VulkanPipeline();
+    obj.layout  = state->layout;
+    obj.pending = true;
+    auto ind    = rhi->pipelines.add(obj);
+
+    rhi->compiler.compile(ind, std::move(state));
+    return ind;
 }
 
 bool api::create_render_pipeline(GPURenderPipelineHandle& pipeline, const GPURenderPipelineDescriptor& desc)
 {
-    auto obj = VulkanPipeline(desc);
     auto rhi = get_rhi();
+    if (desc.async) {
+        pipeline = GPURenderPipelineHandle(create_async_pipeline(desc));
+        return true;
+    }
+
+    auto obj = VulkanPipeline(desc);
     auto ind = rhi->pipelines.add(obj);
 
     pipeline = GPURenderPipelineHandle(ind);
@@ -294,13 +371,27 @@ bool api::create_render_pipeline(GPURenderPipelineHandle& pipeline, const GPURen
 
 void api::delete_render_pipeline(GPURenderPipelineHandle pipeline)
 {
-    get_rhi()->pipelines.remove(pipeline.value);
+    auto rhi = get_rhi();
+    rhi->compiler.discard(pipeline.value);
+    defer_delete(rhi->pipelines, pipeline);
+}
+
+bool api::get_render_pipeline_status(GPURenderPipelineHandle pipeline, GPUPipelineStatus& status)
+{
+    auto& obj = fetch_resource(get_rhi()->pipelines, pipeline);
+    status    = obj.pending ? GPUPipelineStatus::PENDING : GPUPipelineStatus::READY;
+    return true;
 }
 
 bool api::create_compute_pipeline(GPUComputePipelineHandle& pipeline, const GPUComputePipelineDescriptor& desc)
 {
-    auto obj = VulkanPipeline(desc);
     auto rhi = get_rhi();
+    if (desc.async) {
+        pipeline = GPUComputePipelineHandle(create_async_pipeline(desc));
+        return true;
+    }
+
+    auto obj = VulkanPipeline(desc);
     auto ind = rhi->pipelines.add(obj);
 
     pipeline = GPUComputePipelineHandle(ind);
@@ -309,7 +400,16 @@ bool api::create_compute_pipeline(GPUComputePipelineHandle& pipeline, const GPUC
 
 void api::delete_compute_pipeline(GPUComputePipelineHandle pipeline)
 {
-    get_rhi()->pipelines.remove(pipeline.value);
+    auto rhi = get_rhi();
+    rhi->compiler.discard(pipeline.value);
+    defer_delete(rhi->pipelines, pipeline);
+}
+
+bool api::get_compute_pipeline_status(GPUComputePipelineHandle pipeline, GPUPipelineStatus& status)
+{
+    auto& obj = fetch_resource(get_rhi()->pipelines, pipeline);
+    status    = obj.pending ? GPUPipelineStatus::PENDING : GPUPipelineStatus::READY;
+    return true;
 }
 
 bool api::create_raytracing_pipeline(GPURayTracingPipelineHandle& handle, const GPURayTracingPipelineDescriptor& desc)
@@ -324,11 +424,20 @@ bool api::create_raytracing_pipeline(GPURayTracingPipelineHandle& handle, const
 
 void api::delete_raytracing_pipeline(GPURayTracingPipelineHandle pipeline)
 {
-    get_rhi()->pipelines.remove(pipeline.value);
+    defer_delete(get_rhi()->pipelines, pipeline);
+}
+
+void api::wait_pipelines()
+{
+    auto rhi = get_rhi();
+    rhi->compiler.wait();
+    rhi->compiler.install();
 }
 
 bool api::create_bind_group(GPUBindGroupHandle& bind_group, const GPUBindGroupDescriptor& desc)
 {
+    // descriptor sets are allocated from the per-frame descriptor pool
+    std::unique_lock<std::shared_mutex> lock(get_rhi()->frame_mutex);
     bind_group = ::create_bind_group(desc);
     return true;
 }
@@ -338,7 +447,23 @@ bool api::create_command_buffer(GPUCommandEncoderHandle& cmdbuffer, const GPUCom
     auto  rhi = get_rhi();
     auto& frm = rhi->current_frame();
     cmdbuffer = frm.allocate(descriptor.queue, true);
-    frm.command(cmdbuffer).begin();
+
+    auto& cmd   = frm.command(cmdbuffer);
+    cmd.tracked = descriptor.tracked;
+    cmd.queue   = descriptor.queue;
+    cmd.open    = true;
+    cmd.begin();
+
+    // the first graphics command buffer of the frame carries the begin timestamp
+    rhi->pacer.mark(cmd);
+
+    // make completed uploads visible to graphics work without blocking
+    if (descriptor.queue == GPUQueueType::DEFAULT) {
+        std::lock_guard<std::mutex> lock(rhi->uploads.mutex);
+        rhi->uploads.retire();
+        if (rhi->uploads.completed_value > cmd.upload_value)
+            rhi->uploads.acquire(cmd, rhi->uploads.completed_value, GPUBarrierSync::ALL);
+    }
     return true;
 }
 
@@ -347,7 +472,10 @@ bool api::create_command_bundle(GPUCommandEncoderHandle& cmdbuffer, const GPUCom
     auto  rhi = get_rhi();
     auto& frm = rhi->current_frame();
     cmdbuffer = frm.allocate(descriptor.queue, false);
-    frm.command(cmdbuffer).begin();
+
+    auto& cmd = frm.command(cmdbuffer);
+    cmd.open  = true;
+    cmd.begin(descriptor);
     return true;
 }
 
@@ -356,37 +484,81 @@ bool api::submit_command_buffer(GPUCommandEncoderHandle cmdbuffer)
     auto  rhi = get_rhi();
     auto& frm = rhi->current_frame();
     auto& cmd = frm.command(cmdbuffer);
+    {
+        std::shared_lock<std::shared_mutex> lock(rhi->frame_mutex);
+        frm.upload_ring.flush();
+    }
     cmd.end();
-    cmd.submit();
+    cmd.open = false;
+
+    // states left by previous submissions are patched by a prologue,
+    // the tracker lock is held until submitted to keep the submission order.
+    std::lock_guard<std::mutex> lock(rhi->tracker.mutex);
+    rhi->pacer.track(cmd.command_queue);
+    cmd.submit(rhi->tracker.patch(cmd));
+    return true;
+}
+
+bool api::finish_command_bundle(GPUCommandEncoderHandle cmdbuffer)
+{
+    auto rhi = get_rhi();
+    rhi->current_frame().command(cmdbuffer).end();
+    return true;
+}
+
+bool api::get_command_stats(GPUCommandStats& stats)
+{
+    auto rhi = get_rhi();
+
+    std::lock_guard<std::mutex> lock(rhi->stats_mutex);
+    stats = rhi->command_stats;
+    return true;
+}
+
+bool api::get_shader_module_stats(GPUShaderModuleStats& stats)
+{
+    get_rhi()->shader_cache.stats(stats);
+    return true;
+}
+
+bool api::get_staging_stats(GPUStagingStats& stats)
+{
+    auto rhi = get_rhi();
+
+    std::lock_guard<std::mutex> lock(rhi->staging.mutex);
+    stats = rhi->staging.last;
     return true;
 }
 
 void api::wait_idle()
 {
     auto rhi = get_rhi();
+    rhi->submits.flush();
     vk_check(rhi->vtable.vkDeviceWaitIdle(rhi->device));
 
+    // nothing is in flight, release all deferred deletions and pending mappings
+    rhi->deletes.flush();
+    rhi->maps.flush();
+
     // clean up all pools from all frames
     for (auto& frame : rhi->frames)
         frame.free();
-
-    // reset all fences
-    for (auto& frame : rhi->frames) {
-        if (!frame.existing_fences.empty()) {
-            auto rhi = get_rhi();
-            uint cnt = static_cast<uint>(frame.existing_fences.size());
-            rhi->vtable.vkResetFences(rhi->device, cnt, frame.existing_fences.data());
-            frame.existing_fences.clear();
-        }
-    }
 }
 
 void api::wait_fence(GPUFenceHandle handle)
 {
     auto rhi = get_rhi();
+
+    // the fence might be signaled by a batched submission
+    rhi->submits.flush();
     fetch_resource(rhi->fences, handle).wait();
 }
 
+void api::flush_submissions()
+{
+    get_rhi()->submits.flush();
+}
+
 LYRA_EXPORT auto prepare() -> void
 {
     vk_check(volkInitialize());
@@ -400,96 +572,134 @@ LYRA_EXPORT auto cleanup() -> void
 LYRA_EXPORT auto create() -> RenderAPI
 {
     auto api                             = RenderAPI{};
-    api.get_api_name                     = get_api_name;
-    api.create_instance                  = api::create_instance;
-    api.delete_instance                  = api::delete_instance;
-    api.create_adapter                   = api::create_adapter;
-    api.delete_adapter                   = api::delete_adapter;
-    api.create_device                    = api::create_device;
-    api.delete_device                    = api::delete_device;
-    api.create_surface                   = api::create_surface;
-    api.delete_surface                   = api::delete_surface;
-    api.get_surface_extent               = api::get_surface_extent;
-    api.get_surface_format               = api::get_surface_format;
-    api.get_surface_frames               = api::get_surface_frames;
-    api.create_buffer                    = api::create_buffer;
-    api.delete_buffer                    = api::delete_buffer;
-    api.create_texture                   = api::create_texture;
-    api.delete_texture                   = api::delete_texture;
-    api.create_texture_view              = api::create_texture_view;
-    api.delete_texture_view              = api::delete_texture_view;
-    api.create_sampler                   = api::create_sampler;
-    api.delete_sampler                   = api::delete_sampler;
-    api.create_fence                     = api::create_fence;
-    api.delete_fence                     = api::delete_fence;
-    api.create_shader_module             = api::create_shader_module;
-    api.delete_shader_module             = api::delete_shader_module;
-    api.create_blas                      = api::create_blas;
-    api.delete_blas                      = api::delete_blas;
-    api.create_tlas                      = api::create_tlas;
-    api.delete_tlas                      = api::delete_tlas;
-    api.create_pipeline_layout           = api::create_pipeline_layout;
-    api.delete_pipeline_layout           = api::delete_pipeline_layout;
-    api.create_render_pipeline           = api::create_render_pipeline;
-    api.delete_render_pipeline           = api::delete_render_pipeline;
-    api.create_compute_pipeline          = api::create_compute_pipeline;
-    api.delete_compute_pipeline          = api::delete_compute_pipeline;
-    api.create_raytracing_pipeline       = api::create_raytracing_pipeline;
-    api.delete_raytracing_pipeline       = api::delete_raytracing_pipeline;
-    api.create_bind_group                = api::create_bind_group;
-    api.create_bind_group_layout         = api::create_bind_group_layout;
-    api.delete_bind_group_layout         = api::delete_bind_group_layout;
-    api.wait_idle                        = api::wait_idle;
-    api.wait_fence                       = api::wait_fence;
-    api.new_frame                        = api::new_frame;
-    api.end_frame                        = api::end_frame;
-    api.map_buffer                       = api::map_buffer;
-    api.unmap_buffer                     = api::unmap_buffer;
-    api.get_mapped_state                 = api::get_mapped_state;
-    api.get_mapped_range                 = api::get_mapped_range;
-    api.create_command_buffer            = api::create_command_buffer;
-    api.create_command_bundle            = api::create_command_bundle;
-    api.submit_command_buffer            = api::submit_command_buffer;
-    api.get_blas_sizes                   = api::get_blas_sizes;
-    api.get_tlas_sizes                   = api::get_tlas_sizes;
-    api.acquire_next_frame               = api::acquire_next_frame;
-    api.present_curr_frame               = api::present_curr_frame;
-    api.cmd_insert_debug_marker          = cmd::insert_debug_marker;
-    api.cmd_push_debug_group             = cmd::push_debug_group;
-    api.cmd_pop_debug_group              = cmd::pop_debug_group;
-    api.cmd_wait_fence                   = cmd::wait_fence;
-    api.cmd_signal_fence                 = cmd::signal_fence;
-    api.cmd_begin_render_pass            = cmd::begin_render_pass;
-    api.cmd_end_render_pass              = cmd::end_render_pass;
-    api.cmd_set_render_pipeline          = cmd::set_render_pipeline;
-    api.cmd_set_compute_pipeline         = cmd::set_compute_pipeline;
-    api.cmd_set_raytracing_pipeline      = cmd::set_raytracing_pipeline;
-    api.cmd_set_bind_group               = cmd::set_bind_group;
-    api.cmd_set_push_constants           = cmd::set_push_constants;
-    api.cmd_set_index_buffer             = cmd::set_index_buffer;
-    api.cmd_set_vertex_buffer            = cmd::set_vertex_buffer;
-    api.cmd_draw                         = cmd::draw;
-    api.cmd_draw_indexed                 = cmd::draw_indexed;
-    api.cmd_draw_indirect                = cmd::draw_indirect;
-    api.cmd_draw_indexed_indirect        = cmd::draw_indexed_indirect;
-    api.cmd_dispatch_workgroups          = cmd::dispatch_workgroups;
-    api.cmd_dispatch_workgroups_indirect = cmd::dispatch_workgroups_indirect;
-    api.cmd_copy_buffer_to_buffer        = cmd::copy_buffer_to_buffer;
-    api.cmd_copy_buffer_to_texture       = cmd::copy_buffer_to_texture;
-    api.cmd_copy_texture_to_buffer       = cmd::copy_texture_to_buffer;
-    api.cmd_copy_texture_to_texture      = cmd::copy_texture_to_texture;
-    api.cmd_clear_buffer                 = cmd::clear_buffer;
-    api.cmd_set_viewport                 = cmd::set_viewport;
-    api.cmd_set_scissor_rect             = cmd::set_scissor_rect;
-    api.cmd_set_blend_constant           = cmd::set_blend_constant;
-    api.cmd_set_stencil_reference        = cmd::set_stencil_reference;
-    api.cmd_begin_occlusion_query        = cmd::begin_occlusion_query;
-    api.cmd_end_occlusion_query          = cmd::end_occlusion_query;
-    api.cmd_write_timestamp              = cmd::write_timestamp;
-    api.cmd_write_blas_properties        = cmd::write_blas_properties;
-    api.cmd_resolve_query_set            = cmd::resolve_query_set;
-    api.cmd_memory_barrier               = cmd::memory_barrier;
-    api.cmd_buffer_barrier               = cmd::buffer_barrier;
-    api.cmd_texture_barrier              = cmd::texture_barrier;
+    api.get_api_name                        = get_api_name;
+    api.create_instance                     = api::create_instance;
+    api.delete_instance                     = api::delete_instance;
+    api.create_adapter                      = api::create_adapter;
+    api.delete_adapter                      = api::delete_adapter;
+    api.create_device                       = api::create_device;
+    api.delete_device                       = api::delete_device;
+    api.create_surface                      = api::create_surface;
+    api.delete_surface                      = api::delete_surface;
+    api.get_surface_extent                  = api::get_surface_extent;
+    api.get_surface_format                  = api::get_surface_format;
+    api.get_surface_frames                  = api::get_surface_frames;
+    api.create_buffer                       = api::create_buffer;
+    api.delete_buffer                       = api::delete_buffer;
+    api.create_texture                      = api::create_texture;
+    api.delete_texture                      = api::delete_texture;
+    api.create_texture_view                 = api::create_texture_view;
+    api.delete_texture_view                 = api::delete_texture_view;
+    api.create_sampler                      = api::create_sampler;
+    api.delete_sampler                      = api::delete_sampler;
+    api.create_fence                        = api::create_fence;
+    api.delete_fence                        = api::delete_fence;
+    api.create_shader_module                = api::create_shader_module;
+    api.delete_shader_module                = api::delete_shader_module;
+    api.create_blas                         = api::create_blas;
+    api.delete_blas                         = api::delete_blas;
+    api.create_tlas                         = api::create_tlas;
+    api.delete_tlas                         = api::delete_tlas;
+    api.create_pipeline_layout              = api::create_pipeline_layout;
+    api.delete_pipeline_layout              = api::delete_pipeline_layout;
+    api.create_render_pipeline              = api::create_render_pipeline;
+    api.delete_render_pipeline              = api::delete_render_pipeline;
+    api.create_compute_pipeline             = api::create_compute_pipeline;
+    api.delete_compute_pipeline             = api::delete_compute_pipeline;
+    api.create_raytracing_pipeline          = api::create_raytracing_pipeline;
+    api.delete_raytracing_pipeline          = api::delete_raytracing_pipeline;
+    api.create_bind_group                   = api::create_bind_group;
+    api.create_query_set                    = api::create_query_set;
+    api.delete_query_set                    = api::delete_query_set;
+    api.reset_query_set                     = api::reset_query_set;
+    api.create_bind_group_layout            = api::create_bind_group_layout;
+    api.delete_bind_group_layout            = api::delete_bind_group_layout;
+    api.wait_idle                           = api::wait_idle;
+    api.wait_fence                          = api::wait_fence;
+    api.flush_submissions                   = api::flush_submissions;
+    api.new_frame                           = api::new_frame;
+    api.end_frame                           = api::end_frame;
+    api.set_frame_pacing                    = api::set_frame_pacing;
+    api.get_frame_timing                    = api::get_frame_timing;
+    api.get_frame_slot                      = api::get_frame_slot;
+    api.map_buffer                          = api::map_buffer;
+    api.map_buffer_async                    = api::map_buffer_async;
+    api.unmap_buffer                        = api::unmap_buffer;
+    api.get_mapped_state                    = api::get_mapped_state;
+    api.get_mapped_range                    = api::get_mapped_range;
+    api.create_command_buffer               = api::create_command_buffer;
+    api.create_command_bundle               = api::create_command_bundle;
+    api.submit_command_buffer               = api::submit_command_buffer;
+    api.finish_command_bundle               = api::finish_command_bundle;
+    api.get_blas_sizes                      = api::get_blas_sizes;
+    api.get_tlas_sizes                      = api::get_tlas_sizes;
+    api.get_memory_pool_stats               = api::get_memory_pool_stats;
+    api.get_memory_stats                    = api::get_memory_stats;
+    api.set_memory_budget_callback          = api::set_memory_budget_callback;
+    api.get_command_stats                   = api::get_command_stats;
+    api.get_shader_module_stats             = api::get_shader_module_stats;
+    api.get_staging_stats                   = api::get_staging_stats;
+    api.get_defragment_stats                = api::get_defragment_stats;
+    api.get_shader_module_hash              = api::get_shader_module_hash;
+    api.get_render_pipeline_status          = api::get_render_pipeline_status;
+    api.get_compute_pipeline_status         = api::get_compute_pipeline_status;
+    api.wait_pipelines                      = api::wait_pipelines;
+    api.allocate_transient                  = api::allocate_transient;
+    api.upload_buffer                       = api::upload_buffer;
+    api.upload_texture                      = api::upload_texture;
+    api.flush_uploads                       = api::flush_uploads;
+    api.query_upload                        = api::query_upload;
+    api.wait_upload                         = api::wait_upload;
+    api.acquire_next_frame                  = api::acquire_next_frame;
+    api.present_curr_frame                  = api::present_curr_frame;
+    api.cmd_insert_debug_marker             = cmd::insert_debug_marker;
+    api.cmd_push_debug_group                = cmd::push_debug_group;
+    api.cmd_pop_debug_group                 = cmd::pop_debug_group;
+    api.cmd_wait_fence                      = cmd::wait_fence;
+    api.cmd_signal_fence                    = cmd::signal_fence;
+    api.cmd_wait_upload                     = cmd::wait_upload;
+    api.cmd_begin_render_pass               = cmd::begin_render_pass;
+    api.cmd_end_render_pass                 = cmd::end_render_pass;
+    api.cmd_execute_bundles                 = cmd::execute_bundles;
+    api.cmd_set_render_pipeline             = cmd::set_render_pipeline;
+    api.cmd_set_compute_pipeline            = cmd::set_compute_pipeline;
+    api.cmd_set_raytracing_pipeline         = cmd::set_raytracing_pipeline;
+    api.cmd_set_bind_group                  = cmd::set_bind_group;
+    api.cmd_set_push_constants              = cmd::set_push_constants;
+    api.cmd_set_index_buffer                = cmd::set_index_buffer;
+    api.cmd_set_vertex_buffer               = cmd::set_vertex_buffer;
+    api.cmd_draw                            = cmd::draw;
+    api.cmd_draw_indexed                    = cmd::draw_indexed;
+    api.cmd_draw_indirect                   = cmd::draw_indirect;
+    api.cmd_draw_indexed_indirect           = cmd::draw_indexed_indirect;
+    api.cmd_draw_indirect_count             = cmd::draw_indirect_count;
+    api.cmd_draw_indexed_indirect_count     = cmd::draw_indexed_indirect_count;
+    api.cmd_dispatch_workgroups             = cmd::dispatch_workgroups;
+    api.cmd_dispatch_workgroups_indirect    = cmd::dispatch_workgroups_indirect;
+    api.cmd_copy_buffer_to_buffer           = cmd::copy_buffer_to_buffer;
+    api.cmd_update_buffer                   = cmd::update_buffer;
+    api.cmd_copy_buffer_to_texture          = cmd::copy_buffer_to_texture;
+    api.cmd_copy_texture_to_buffer          = cmd::copy_texture_to_buffer;
+    api.cmd_copy_texture_to_texture         = cmd::copy_texture_to_texture;
+    api.cmd_clear_buffer                    = cmd::clear_buffer;
+    api.cmd_set_viewport                    = cmd::set_viewport;
+    api.cmd_set_scissor_rect                = cmd::set_scissor_rect;
+    api.cmd_set_blend_constant              = cmd::set_blend_constant;
+    api.cmd_set_stencil_reference           = cmd::set_stencil_reference;
+    api.cmd_begin_occlusion_query           = cmd::begin_occlusion_query;
+    api.cmd_end_occlusion_query             = cmd::end_occlusion_query;
+    api.cmd_write_timestamp                 = cmd::write_timestamp;
+    api.cmd_begin_pipeline_statistics_query = cmd::begin_pipeline_statistics_query;
+    api.cmd_end_pipeline_statistics_query   = cmd::end_pipeline_statistics_query;
+    api.cmd_write_blas_properties           = cmd::write_blas_properties;
+    api.cmd_resolve_query_set               = cmd::resolve_query_set;
+    api.cmd_memory_barrier                  = cmd::memory_barrier;
+    api.cmd_buffer_barrier                  = cmd::buffer_barrier;
+    api.cmd_texture_barrier                 = cmd::texture_barrier;
+    api.cmd_update_tlas_instances           = cmd::update_tlas_instances;
+    api.cmd_build_tlases                    = cmd::build_tlases;
+    api.cmd_build_blases                    = cmd::build_blases;
+    api.cmd_copy_blas                       = cmd::copy_blas;
+    api.cmd_defragment_memory               = cmd::defragment_memory;
     return api;
 }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "VkUtils.h"
 
 VulkanQuerySet::VulkanQuerySet() : pool(VK_NULL_HANDLE)
@@ -15,12 +16,25 @@ VulkanQuerySet::VulkanQuerySet(const GPUQuerySetDescriptor& desc) : pool(VK_NULL
     create_info.flags              = 0;
     create_info.pipelineStatistics = 0;
 
+    // pipeline statistics requires at least one counter
+    if (desc.type == GPUQueryType::PIPELINE_STATISTICS) {
+        auto statistics                = desc.statistics.value == 0 ? GPUQueryStatisticFlags(GPUQueryStatistic::ALL) : desc.statistics;
+        create_info.pipelineStatistics = vkenum(statistics);
+    }
+
     auto rhi = get_rhi();
     vk_check(rhi->vtable.vkCreateQueryPool(rhi->device, &create_info, nullptr, &pool));
 
     // record basic info
-    type  = create_info.queryType;
-    count = create_info.queryCount;
+    type       = create_info.queryType;
+    count      = create_info.queryCount;
+    statistics = create_info.pipelineStatistics;
+
+    // pipeline statistics queries write one value per enabled counter
+    stride = 0;
+    for (uint32_t bits = statistics; bits != 0; bits &= bits - 1)
+        stride += sizeof(uint64_t);
+    stride = std::max(stride, static_cast<uint32_t>(sizeof(uint64_t)));
 }
 
 void VulkanQuerySet::destroy()
@@ -1,9 +1,6 @@
+#include <Lyra/Render/RHI/RHIHash.h>
 #include "VkUtils.h"
 
-// NOTE: A possible optimization is that we could hash the sampler descriptor
-// to avoid creating identical samplers because many of the times the sampler
-// is the same.
-
 VulkanSampler::VulkanSampler() : sampler(VK_NULL_HANDLE)
 {
     // do nothing
@@ -43,3 +40,56 @@ void VulkanSampler::destroy()
         sampler = VK_NULL_HANDLE;
     }
 }
+
+GPUSamplerHandle VulkanSamplerCache::acquire(const GPUSamplerDescriptor& desc)
+{
+    auto rhi = get_rhi();
+    auto key = std::hash<GPUSamplerDescriptor>{}(desc);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = entries.find(key);
+    if (it != entries.end() && std::equal_to<GPUSamplerDescriptor>{}(it->second.desc, desc)) {
+        it->second.refs++;
+        return it->second.handle;
+    }
+
+    auto handle = GPUSamplerHandle(rhi->samplers.add(VulkanSampler(desc)));
+
+    // hash collisions are rare, colliding samplers are simply not shared
+    if (it == entries.end()) {
+        auto& entry        = entries[key];
+        entry.desc         = desc;
+        entry.desc.label   = nullptr;
+        entry.handle       = handle;
+        entry.refs         = 1;
+        keys[handle.value] = key;
+    }
+    return handle;
+}
+
+bool VulkanSamplerCache::release(GPUSamplerHandle handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // samplers that are not shared are deleted right away
+    auto it = keys.find(handle.value);
+    if (it == keys.end())
+        return true;
+
+    auto& entry = entries.at(it->second);
+    if (--entry.refs > 0)
+        return false;
+
+    entries.erase(it->second);
+    keys.erase(it);
+    return true;
+}
+
+void VulkanSamplerCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    keys.clear();
+}
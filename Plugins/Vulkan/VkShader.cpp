@@ -1,3 +1,5 @@
+#include <cstring>
+#include <Lyra/Common/Hash.h>
 #include "VkUtils.h"
 
 VulkanShader::VulkanShader() : module(VK_NULL_HANDLE)
@@ -28,3 +30,76 @@ void VulkanShader::destroy()
         module = VK_NULL_HANDLE;
     }
 }
+
+GPUShaderModuleHandle VulkanShaderCache::acquire(const GPUShaderModuleDescriptor& desc)
+{
+    auto rhi  = get_rhi();
+    auto hash = hash_bytes(desc.data, desc.size);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // hits are verified byte by byte, a hash match alone is not enough
+    auto it = entries.find(hash);
+    if (it != entries.end()) {
+        auto& blob = it->second.blob;
+        if (blob.size() == desc.size && std::memcmp(blob.data(), desc.data, desc.size) == 0) {
+            it->second.refs++;
+            hits++;
+            return it->second.handle;
+        }
+    }
+
+    auto obj    = VulkanShader(desc);
+    obj.hash    = hash;
+    auto handle = GPUShaderModuleHandle(rhi->shaders.add(obj));
+
+    // hash collisions are rare, colliding blobs are simply not shared
+    if (it == entries.end()) {
+        auto& entry        = entries[hash];
+        entry.handle       = handle;
+        entry.refs         = 1;
+        keys[handle.value] = hash;
+        entry.blob.assign(desc.data, desc.data + desc.size);
+    }
+    return handle;
+}
+
+bool VulkanShaderCache::release(GPUShaderModuleHandle handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // modules that are not shared are deleted right away
+    auto it = keys.find(handle.value);
+    if (it == keys.end())
+        return true;
+
+    auto& entry = entries.at(it->second);
+    if (--entry.refs > 0)
+        return false;
+
+    entries.erase(it->second);
+    keys.erase(it);
+    return true;
+}
+
+void VulkanShaderCache::stats(GPUShaderModuleStats& stats)
+{
+    auto rhi = get_rhi();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    stats              = GPUShaderModuleStats{};
+    stats.unique_count = static_cast<uint>(rhi->shaders.size());
+    stats.module_count = stats.unique_count;
+    stats.cache_hits   = hits;
+    for (auto& kv : entries)
+        stats.module_count += kv.second.refs - 1;
+}
+
+void VulkanShaderCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    keys.clear();
+}
@@ -16,15 +16,6 @@ VulkanSwapchain::VulkanSwapchain(const GPUSurfaceDescriptor& desc, VkSurfaceKHR
     uint image_frame_count = static_cast<uint>(frames.size());
     uint logic_frame_count = static_cast<uint>(desc.frames);
 
-    // create inflight fences
-    uint existing_fence_count = static_cast<uint>(inflight_fences.size());
-    assert(existing_fence_count == 0u || existing_fence_count == logic_frame_count);
-    if (existing_fence_count == 0u) {
-        inflight_fences.resize(logic_frame_count);
-        for (uint i = 0; i < logic_frame_count; i++)
-            inflight_fences.at(i) = VulkanFence(false);
-    }
-
     // create image available semaphores
     uint existing_image_available_semaphores = static_cast<uint>(image_available_semaphores.size());
     assert(existing_image_available_semaphores == 0u || existing_image_available_semaphores == logic_frame_count);
@@ -60,7 +51,7 @@ void VulkanSwapchain::recreate()
     SwapchainSupportDetails swapchain_support = query_swapchain_support(rhi->adapter, surface);
     VkExtent2D              swapchain_extent  = choose_swap_extent(desc, swapchain_support.capabilities);
     VkSurfaceFormatKHR      surface_format    = choose_swap_surface_format(swapchain_support.formats);
-    VkPresentModeKHR        present_mode      = choose_swap_present_mode(swapchain_support.present_modes);
+    VkPresentModeKHR        present_mode      = choose_swap_present_mode(desc.present_mode, swapchain_support.present_modes);
 
     uint32_t image_count = std::clamp(
         desc.frames,
@@ -133,10 +124,6 @@ void VulkanSwapchain::destroy()
     for (auto& frame : frames)
         frame.destroy();
 
-    // destroy fences
-    for (auto& fence : inflight_fences)
-        fence.destroy();
-
     // destroy semaphores
     for (auto& semaphore : image_available_semaphores)
         api::delete_fence(semaphore);
@@ -158,7 +145,6 @@ void VulkanSwapchain::destroy()
     }
 
     frames.clear();
-    inflight_fences.clear();
     image_available_semaphores.clear();
     render_complete_semaphores.clear();
 }
@@ -180,8 +166,10 @@ void VulkanSwapchain::Frame::init(VkImage image, VkFormat format, VkExtent2D ext
     this->texture   = GPUTextureHandle(rhi->textures.add(texture));
 
     // re-create new texture view
-    auto view = VulkanTextureView();
-    view.area = extent; // record the render area
+    auto view    = VulkanTextureView();
+    view.area    = extent; // record the render area
+    view.texture = this->texture;
+    view.format  = format;
 
     auto create_info = VkImageViewCreateInfo{};
     {
@@ -200,7 +188,8 @@ void VulkanSwapchain::Frame::init(VkImage image, VkFormat format, VkExtent2D ext
         create_info.subresourceRange.layerCount     = 1;
     }
     vk_check(rhi->vtable.vkCreateImageView(rhi->device, &create_info, nullptr, &view.view));
-    this->view = GPUTextureViewHandle(rhi->views.add(view));
+    view.subresource = create_info.subresourceRange;
+    this->view       = GPUTextureViewHandle(rhi->views.add(view));
 }
 
 void VulkanSwapchain::Frame::destroy()
@@ -209,6 +198,7 @@ void VulkanSwapchain::Frame::destroy()
 
     // clean up texture if already created
     if (this->texture.valid()) {
+        rhi->tracker.forget(texture, 1, 1);
         fetch_resource(rhi->textures, texture).destroy();
         rhi->textures.remove(texture.value);
         this->texture.reset();
@@ -260,25 +250,81 @@ void api::new_frame()
 {
     auto rhi = get_rhi();
 
-    // wait for the current frame to complete
-    auto& frame = rhi->current_frame();
+    // wait on the frame timeline until this frame is allowed to start
+    rhi->pacer.begin(rhi->current_frame_index);
 
-    // wait for inflight frame to complete
-    frame.wait();
+    // command buffers submitted outside of a frame (before the first one, or between end_frame() and here)
+    // come from the pools of this frame object, they must reach the queues and complete before the reset.
+    if (!rhi->submits.empty())
+        api::wait_idle();
+
+    // the previous frame using this frame object is complete
+    auto& frame    = rhi->current_frame();
+    frame.frame_id = rhi->current_frame_index;
     frame.reset();
+    rhi->staging.new_frame();
+
+    // objects deleted during completed frames can be released, and their pending mappings fulfilled
+    uint64_t completed = rhi->pacer.completed();
+    if (completed > 0) {
+        rhi->deletes.retire(static_cast<uint>(completed - 1));
+        rhi->maps.retire(static_cast<uint>(completed - 1));
+    }
 
-    // clear all existing fences
-    frame.existing_fences.clear();
+    // asynchronous pipelines compiled since the last frame become ready
+    rhi->compiler.install();
 }
 
 void api::end_frame()
 {
     auto rhi = get_rhi();
 
+    // submit uploads recorded during this frame
+    {
+        std::lock_guard<std::mutex> lock(rhi->uploads.mutex);
+        rhi->uploads.flush();
+        rhi->uploads.retire();
+    }
+
+    // notify when memory usage crosses the budget threshold
+    rhi->budget.check();
+
+    // signal the frame timeline once all work of this frame completes
+    rhi->pacer.end(rhi->current_frame_index);
+
+    // all submissions of this frame go to the queues at once
+    rhi->submits.flush();
+
     // increment the current frame index
     rhi->current_frame_index++;
 }
 
+void api::set_frame_pacing(const GPUFramePacing& pacing)
+{
+    auto rhi = get_rhi();
+
+    rhi->pacer.frames      = pacing.frames;
+    rhi->pacer.low_latency = pacing.low_latency;
+}
+
+bool api::get_frame_timing(GPUFrameTiming& timing)
+{
+    auto rhi = get_rhi();
+
+    timing = rhi->pacer.timing;
+    return true;
+}
+
+bool api::get_frame_slot(GPUFrameSlot& slot)
+{
+    auto rhi = get_rhi();
+
+    slot.frame = rhi->current_frame_index;
+    slot.count = static_cast<uint>(rhi->frames.size());
+    slot.index = slot.frame % slot.count;
+    return true;
+}
+
 // vulkan swapchain utils
 bool api::acquire_next_frame(GPUSurfaceHandle surface, GPUTextureHandle& texture, GPUTextureViewHandle& view, GPUFenceHandle& image_available_fence, GPUFenceHandle& render_complete_fence, bool& suboptimal)
 {
@@ -299,10 +345,7 @@ bool api::acquire_next_frame(GPUSurfaceHandle surface, GPUTextureHandle& texture
 
     // query the current frame (and assign the synchronization primitives for this swapchain)
     auto& frame                     = rhi->current_frame();
-    frame.frame_id                  = rhi->current_frame_index;
-    frame.inflight_fence            = swp.inflight_fences.at(ind);
     frame.image_available_semaphore = swp.image_available_semaphores.at(ind);
-    frame.existing_fences.push_back(frame.inflight_fence.fence);
 
     // initialize suboptimal
     suboptimal = false;
@@ -324,6 +367,12 @@ bool api::acquire_next_frame(GPUSurfaceHandle surface, GPUTextureHandle& texture
     texture          = swap_frame.texture;
     view             = swap_frame.view;
 
+    // acquired images have undefined contents, ordered by the image available semaphore
+    auto state         = VulkanResourceState{};
+    state.layout       = VK_IMAGE_LAYOUT_UNDEFINED;
+    state.write_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    rhi->tracker.set(texture, fetch_resource(rhi->views, view).subresource, state);
+
     // track the render complete semaphore in frame (after acquiring the new image index)
     frame.render_complete_semaphore = swp.render_complete_semaphores.at(rhi->current_image_index);
 
@@ -368,6 +417,9 @@ bool api::present_curr_frame(GPUSurfaceHandle surface)
         command_buffer.submit();
     }
 
+    // the render complete semaphore is signaled by a batched submission
+    rhi->submits.flush();
+
     // present to swapchain
     auto present_info               = VkPresentInfoKHR{};
     present_info.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -379,7 +431,12 @@ bool api::present_curr_frame(GPUSurfaceHandle surface)
     present_info.pImageIndices      = &rhi->current_image_index;
     present_info.pResults           = nullptr;
 
-    VkResult result = rhi->vtable.vkQueuePresentKHR(rhi->present_queue, &present_info);
+    VkResult result = VK_SUCCESS;
+    {
+        // present queue is usually the graphics queue
+        std::lock_guard<std::mutex> lock(rhi->queue_mutex);
+        result = rhi->vtable.vkQueuePresentKHR(rhi->present_queue, &present_info);
+    }
     if (result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR) {
         // recreate the swapchain if window resizes or moved to other displays
         api::wait_idle();
@@ -24,14 +24,6 @@ VulkanTlas::VulkanTlas(const GPUTlasDescriptor& desc)
         return VulkanBuffer(desc);
     });
 
-    // create staging buffer
-    staging = execute([&]() {
-        auto desc  = GPUBufferDescriptor{};
-        desc.size  = sizeof(VkAccelerationStructureInstanceKHR) * max_instance_count;
-        desc.usage = GPUBufferUsage::COPY_SRC | GPUBufferUsage::MAP_WRITE;
-        return VulkanBuffer(desc);
-    });
-
     // setup geometry for instances
     geometry.sType                                 = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
     geometry.geometryType                          = VK_GEOMETRY_TYPE_INSTANCES_KHR;
@@ -43,12 +35,15 @@ VulkanTlas::VulkanTlas(const GPUTlasDescriptor& desc)
     // setup build info
     build.sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
     build.type          = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-    build.flags         = vkenum(desc.update_mode);
     build.mode          = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
     build.geometryCount = 1;
     build.pGeometries   = &geometry;
     build.flags         = vkenum(desc.flags);
 
+    // refits require the tlas to be built with updates allowed
+    if (update_mode == GPUBVHUpdateMode::PREFER_UPDATE)
+        build.flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+
     // setup build range info
     range.primitiveCount  = max_instance_count;
     range.primitiveOffset = 0;
@@ -90,7 +85,6 @@ void VulkanTlas::destroy()
     auto rhi = get_rhi();
 
     storage.destroy();
-    staging.destroy();
     instances.destroy();
 
     if (tlas != VK_NULL_HANDLE) {
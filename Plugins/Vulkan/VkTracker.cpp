@@ -0,0 +1,529 @@
+#include "VkUtils.h"
+
+// accesses that modify memory
+static constexpr VkAccessFlags2 WRITE_ACCESS =
+    VK_ACCESS_2_SHADER_WRITE_BIT |
+    VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_2_TRANSFER_WRITE_BIT |
+    VK_ACCESS_2_HOST_WRITE_BIT |
+    VK_ACCESS_2_MEMORY_WRITE_BIT |
+    VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+static auto shader_stages(VkShaderStageFlags stages, VkPipelineBindPoint point) -> VkPipelineStageFlags2
+{
+    if (point == VK_PIPELINE_BIND_POINT_COMPUTE)
+        return VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+    if (point == VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR)
+        return VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
+
+    VkPipelineStageFlags2 flags = VK_PIPELINE_STAGE_2_NONE;
+    if (stages & VK_SHADER_STAGE_VERTEX_BIT)
+        flags |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
+    if (stages & VK_SHADER_STAGE_FRAGMENT_BIT)
+        flags |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+
+    // other graphics stages are rarely used for resources, be conservative
+    if (flags == VK_PIPELINE_STAGE_2_NONE)
+        flags = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT;
+    return flags;
+}
+
+static void append_barrier(Vector<VkBufferMemoryBarrier2>& buffers, Vector<VkImageMemoryBarrier2>& images, const VulkanTrackedResource& resource, const VulkanResourceAccess& src, const VulkanResourceAccess& dst)
+{
+    if (resource.buffer != VK_NULL_HANDLE) {
+        auto b                = VkBufferMemoryBarrier2{};
+        b.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+        b.pNext               = nullptr;
+        b.srcStageMask        = src.stages;
+        b.srcAccessMask       = src.access;
+        b.dstStageMask        = dst.stages;
+        b.dstAccessMask       = dst.access;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.buffer              = resource.buffer;
+        b.offset              = 0;
+        b.size                = VK_WHOLE_SIZE;
+        buffers.push_back(b);
+    } else {
+        auto b                = VkImageMemoryBarrier2{};
+        b.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        b.pNext               = nullptr;
+        b.srcStageMask        = src.stages;
+        b.srcAccessMask       = src.access;
+        b.dstStageMask        = dst.stages;
+        b.dstAccessMask       = dst.access;
+        b.oldLayout           = src.layout;
+        b.newLayout           = dst.layout;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.image               = resource.image;
+
+        b.subresourceRange.aspectMask     = resource.aspects;
+        b.subresourceRange.baseMipLevel   = resource.mip_level;
+        b.subresourceRange.levelCount     = 1;
+        b.subresourceRange.baseArrayLayer = resource.array_layer;
+        b.subresourceRange.layerCount     = 1;
+        images.push_back(b);
+    }
+}
+
+static void record_barriers(VkCommandBuffer command_buffer, Vector<VkBufferMemoryBarrier2>& buffers, Vector<VkImageMemoryBarrier2>& images)
+{
+    if (buffers.empty() && images.empty())
+        return;
+
+    auto dependency                     = VkDependencyInfoKHR{};
+    dependency.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+    dependency.pNext                    = nullptr;
+    dependency.dependencyFlags          = 0;
+    dependency.memoryBarrierCount       = 0;
+    dependency.pMemoryBarriers          = nullptr;
+    dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(buffers.size());
+    dependency.pBufferMemoryBarriers    = buffers.data();
+    dependency.imageMemoryBarrierCount  = static_cast<uint32_t>(images.size());
+    dependency.pImageMemoryBarriers     = images.data();
+
+    get_rhi()->vtable.vkCmdPipelineBarrier2KHR(command_buffer, &dependency);
+
+    buffers.clear();
+    images.clear();
+}
+
+#pragma region VulkanResourceState
+bool VulkanResourceAccess::writes() const
+{
+    return (access & WRITE_ACCESS) != 0;
+}
+
+bool VulkanResourceState::transition(const VulkanResourceAccess& next, VulkanResourceAccess& src)
+{
+    src        = VulkanResourceAccess{};
+    src.layout = layout;
+
+    // layout transitions and writes are ordered after all previous accesses,
+    // a layout transition is a write by itself, hence later readers wait for it.
+    if (next.layout != layout || next.writes()) {
+        src.stages = write_stages | read_stages;
+        src.access = write_access;
+
+        bool needed  = next.layout != layout || src.stages != VK_PIPELINE_STAGE_2_NONE;
+        layout       = next.layout;
+        write_stages = next.stages;
+        write_access = next.access & WRITE_ACCESS;
+        read_stages  = next.writes() ? VK_PIPELINE_STAGE_2_NONE : next.stages;
+        read_access  = next.writes() ? VK_ACCESS_2_NONE : next.access;
+        return needed;
+    }
+
+    // reads are ordered after the last write, unless an earlier barrier already covers them
+    bool covered = (next.stages & ~read_stages) == 0 && (next.access & ~read_access) == 0;
+    bool needed  = write_stages != VK_PIPELINE_STAGE_2_NONE && !covered;
+    if (needed) {
+        src.stages = write_stages;
+        src.access = write_access;
+    }
+
+    read_stages |= next.stages;
+    read_access |= next.access;
+    return needed;
+}
+
+void VulkanResourceState::merge(const VulkanResourceAccess& next)
+{
+    if (next.writes()) {
+        write_stages |= next.stages;
+        write_access |= next.access & WRITE_ACCESS;
+    } else {
+        read_stages |= next.stages;
+        read_access |= next.access;
+    }
+}
+#pragma endregion VulkanResourceState
+
+#pragma region VulkanResourceTracker
+void VulkanResourceTracker::set(GPUTextureHandle texture, const VkImageSubresourceRange& range, const VulkanResourceState& state)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t mip = 0; mip < range.levelCount; mip++)
+        for (uint32_t layer = 0; layer < range.layerCount; layer++)
+            states[key(texture, range.baseMipLevel + mip, range.baseArrayLayer + layer)] = state;
+}
+
+void VulkanResourceTracker::forget(GPUBufferHandle buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    states.erase(key(buffer));
+}
+
+void VulkanResourceTracker::forget(GPUTextureHandle texture, uint32_t mip_levels, uint32_t array_layers)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t mip = 0; mip < mip_levels; mip++)
+        for (uint32_t layer = 0; layer < array_layers; layer++)
+            states.erase(key(texture, mip, layer));
+}
+
+auto VulkanResourceTracker::patch(VulkanCommandBuffer& cmd) -> VkCommandBuffer
+{
+    auto rhi = get_rhi();
+
+    Vector<VkBufferMemoryBarrier2> buffers;
+    Vector<VkImageMemoryBarrier2>  images;
+
+    // NOTE: caller holds the mutex until the command buffer is submitted
+    for (auto& kv : cmd.tracked_resources) {
+        auto& resource = kv.second;
+
+        // resources deleted since recording must not leave states behind
+        bool live = resource.buffer != VK_NULL_HANDLE
+                        ? rhi->buffers.contains(static_cast<uint32_t>(kv.first))
+                        : rhi->textures.contains(static_cast<uint32_t>(kv.first >> 32));
+        if (!live)
+            continue;
+
+        // synchronize the first accesses with the state left by previous submissions
+        auto& state = states[kv.first];
+        auto  src   = VulkanResourceAccess{};
+        if (cmd.tracked && state.transition(resource.first, src))
+            append_barrier(buffers, images, resource, src, resource.first);
+
+        state = resource.state;
+    }
+
+    if (buffers.empty() && images.empty())
+        return VK_NULL_HANDLE;
+
+    {
+        std::lock_guard<std::mutex> stats_lock(rhi->stats_mutex);
+        rhi->command_stats.prologue_barriers += buffers.size() + images.size();
+    }
+
+    // prologue is executed right before the command buffer, within the same submission
+    auto& frame    = rhi->current_frame();
+    auto& prologue = frame.command(frame.allocate(cmd.queue, true));
+    prologue.begin();
+    record_barriers(prologue.command_buffer, buffers, images);
+    vk_check(rhi->vtable.vkEndCommandBuffer(prologue.command_buffer));
+    return prologue.command_buffer;
+}
+#pragma endregion VulkanResourceTracker
+
+#pragma region VulkanCommandBuffer
+void VulkanCommandBuffer::track(uint64_t key, VulkanTrackedResource&& resource, const VulkanResourceAccess& access)
+{
+    uint32_t pass = deferred_pass.has_value() ? pass_index : 0;
+
+    auto it = tracked_resources.find(key);
+    if (it == tracked_resources.end()) {
+        // the first access is synchronized with previous command buffers on submission,
+        // untracked command buffers only record the state set by explicit barriers.
+        auto src              = VulkanResourceAccess{};
+        resource.pass         = pass;
+        resource.first        = access;
+        resource.synchronized = !tracked;
+        resource.state.layout = access.layout;
+        resource.state.transition(access, src);
+        tracked_resources.emplace(key, std::move(resource));
+        return;
+    }
+
+    auto& existing = it->second;
+    auto  src      = VulkanResourceAccess{};
+    if (!tracked) {
+        existing.state        = VulkanResourceState{};
+        existing.state.layout = access.layout;
+        existing.state.transition(access, src);
+        return;
+    }
+
+    // accesses within the same render pass cannot be separated by barriers
+    if (pass != 0 && existing.pass == pass && existing.state.layout == access.layout) {
+        existing.state.merge(access);
+        if (!existing.synchronized) {
+            existing.first.stages |= access.stages;
+            existing.first.access |= access.access;
+        }
+        return;
+    }
+    existing.pass = pass;
+
+    if (!existing.state.transition(access, src)) {
+        // reads without barriers in between are synchronized together on submission
+        if (!existing.synchronized) {
+            existing.first.stages |= access.stages;
+            existing.first.access |= access.access;
+        }
+        return;
+    }
+
+    existing.synchronized = true;
+    append_barrier(buffer_barriers, image_barriers, existing, src, access);
+    stats.tracked_barriers++;
+}
+
+void VulkanCommandBuffer::track(GPUBufferHandle buffer, const VulkanResourceAccess& access)
+{
+    auto resource   = VulkanTrackedResource{};
+    resource.buffer = fetch_resource(get_rhi()->buffers, buffer).buffer;
+    track(VulkanResourceTracker::key(buffer), std::move(resource), access);
+}
+
+void VulkanCommandBuffer::track(GPUTextureHandle texture, const VkImageSubresourceRange& range, const VulkanResourceAccess& access)
+{
+    auto& tex = fetch_resource(get_rhi()->textures, texture);
+
+    uint32_t levels = range.levelCount == VK_REMAINING_MIP_LEVELS ? tex.mip_levels - range.baseMipLevel : range.levelCount;
+    uint32_t layers = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? tex.array_layers - range.baseArrayLayer : range.layerCount;
+
+    // textures are tracked per subresource
+    for (uint32_t mip = range.baseMipLevel; mip < range.baseMipLevel + levels; mip++) {
+        for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + layers; layer++) {
+            auto resource        = VulkanTrackedResource{};
+            resource.image       = tex.image;
+            resource.aspects     = tex.aspects;
+            resource.mip_level   = mip;
+            resource.array_layer = layer;
+            track(VulkanResourceTracker::key(texture, mip, layer), std::move(resource), access);
+        }
+    }
+}
+
+void VulkanCommandBuffer::track(GPUTextureViewHandle view, const VulkanResourceAccess& access)
+{
+    auto& obj = fetch_resource(get_rhi()->views, view);
+    track(obj.texture, obj.subresource, access);
+}
+
+void VulkanCommandBuffer::track_bindings()
+{
+    auto& frame = get_rhi()->current_frame();
+
+    for (auto& handle : bind_group_handles) {
+        if (!handle.valid())
+            continue;
+
+        for (auto& binding : frame.bindings(handle)) {
+            auto access   = VulkanResourceAccess{};
+            access.stages = shader_stages(binding.stages, last_bound_point);
+
+            switch (binding.type) {
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+                    access.access = VK_ACCESS_2_UNIFORM_READ_BIT;
+                    break;
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                    access.access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+                    access.access |= binding.writable ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_NONE;
+                    break;
+                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                    access.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+                    access.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                    break;
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                    access.access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+                    access.access |= binding.writable ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_NONE;
+                    access.layout = VK_IMAGE_LAYOUT_GENERAL;
+                    break;
+                default:
+                    continue;
+            }
+
+            if (binding.buffer.valid())
+                track(binding.buffer, access);
+            else if (binding.view.valid())
+                track(binding.view, access);
+        }
+    }
+
+    if (last_bound_point != VK_PIPELINE_BIND_POINT_GRAPHICS)
+        return;
+
+    for (auto& handle : vertex_buffer_handles) {
+        if (!handle.valid())
+            continue;
+
+        auto access   = VulkanResourceAccess{};
+        access.stages = VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT;
+        access.access = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT;
+        track(handle, access);
+    }
+
+    if (index_buffer_handle.valid()) {
+        auto access   = VulkanResourceAccess{};
+        access.stages = VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+        access.access = VK_ACCESS_2_INDEX_READ_BIT;
+        track(index_buffer_handle, access);
+    }
+}
+
+void VulkanCommandBuffer::flush_barriers()
+{
+    // barriers found within a deferred render pass are recorded before the pass
+    if (deferred_pass.has_value())
+        return;
+
+    record_barriers(command_buffer, buffer_barriers, image_barriers);
+}
+
+void VulkanCommandBuffer::begin_deferred_pass(DeferredRenderPass&& pass)
+{
+    flush_barriers();
+
+    // without inherited queries, pass contents cannot run within the active query
+    if (!get_rhi()->inherited_queries)
+        end_statistics(command_buffer);
+
+    pass.primary     = command_buffer;
+    deferred_pass    = std::move(pass);
+    bindings_tracked = false;
+    pass_index++;
+
+    next_deferred_contents();
+}
+
+void VulkanCommandBuffer::next_deferred_contents()
+{
+    auto  rhi   = get_rhi();
+    auto& frame = rhi->current_frame();
+    auto& pass  = deferred_pass.value();
+
+    // pass contents are secondary command buffers owned by the frame
+    command_buffer = frame.command(frame.allocate(queue, false)).command_buffer;
+    pass.contents.push_back(command_buffer);
+
+    auto rendering_info                    = VkCommandBufferInheritanceRenderingInfo{};
+    rendering_info.sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    rendering_info.pNext                   = nullptr;
+    rendering_info.flags                   = 0;
+    rendering_info.viewMask                = 0;
+    rendering_info.colorAttachmentCount    = static_cast<uint32_t>(pass.color_formats.size());
+    rendering_info.pColorAttachmentFormats = pass.color_formats.data();
+    rendering_info.depthAttachmentFormat   = pass.depth_format;
+    rendering_info.stencilAttachmentFormat = pass.stencil_format;
+    rendering_info.rasterizationSamples    = pass.samples;
+
+    auto inheritance_info               = VkCommandBufferInheritanceInfo{};
+    inheritance_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.pNext              = &rendering_info;
+    inheritance_info.pipelineStatistics = statistics;
+
+    auto begin_info             = VkCommandBufferBeginInfo{};
+    begin_info.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.pNext            = nullptr;
+    begin_info.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    begin_info.pInheritanceInfo = &inheritance_info;
+
+    vk_check(rhi->vtable.vkBeginCommandBuffer(command_buffer, &begin_info));
+
+    // secondary command buffers do not inherit any state
+    restore_state();
+}
+
+void VulkanCommandBuffer::end_deferred_pass()
+{
+    auto rhi = get_rhi();
+
+    vk_check(rhi->vtable.vkEndCommandBuffer(command_buffer));
+
+    auto pass = std::move(deferred_pass.value());
+    deferred_pass.reset();
+    command_buffer = pass.primary;
+
+    // barriers required by the pass, followed by the pass itself
+    flush_barriers();
+
+    // attachment pointers are fixed up, the pass has been moved since it began
+    auto& rendering              = pass.rendering;
+    rendering.flags              = rendering.flags | VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+    rendering.pColorAttachments  = pass.colors.data();
+    rendering.pDepthAttachment   = rendering.pDepthAttachment ? &pass.depth : nullptr;
+    rendering.pStencilAttachment = rendering.pStencilAttachment ? &pass.stencil : nullptr;
+
+    uint count = static_cast<uint>(pass.contents.size());
+    rhi->vtable.vkCmdBeginRenderingKHR(command_buffer, &rendering);
+    rhi->vtable.vkCmdExecuteCommands(command_buffer, count, pass.contents.data());
+    rhi->vtable.vkCmdEndRenderingKHR(command_buffer);
+
+    // state set within the pass continues after it
+    restore_state();
+}
+
+void VulkanCommandBuffer::restore_state()
+{
+    auto rhi = get_rhi();
+
+    // keep the shadow state, then record it again into the current command buffer
+    auto pipeline  = last_bound_pipeline;
+    auto layout    = last_bound_layout;
+    auto groups    = bound_bind_groups;
+    auto constants = push_constants;
+    auto valid     = push_constants_valid;
+    auto stages    = push_constants_stages;
+    auto index     = bound_index_buffer;
+    auto viewport  = bound_viewport;
+    auto scissor   = bound_scissor;
+
+    invalidate_state();
+
+    if (pipeline != VK_NULL_HANDLE) {
+        last_bound_pipeline = pipeline;
+        last_bound_layout   = layout;
+        rhi->vtable.vkCmdBindPipeline(command_buffer, last_bound_point, pipeline);
+    }
+
+    for (uint i = 0; i < MAX_BIND_GROUPS; i++) {
+        auto& group = groups.at(i);
+        if (group.descriptor == VK_NULL_HANDLE || layout == VK_NULL_HANDLE)
+            continue;
+
+        rhi->vtable.vkCmdBindDescriptorSets(command_buffer, last_bound_point, layout,
+            i, 1, &group.descriptor,
+            static_cast<uint32_t>(group.offsets.size()), group.offsets.data());
+        bound_bind_groups.at(i) = group;
+    }
+
+    // push constants are restored in runs of consecutive valid words
+    for (uint first = 0; first < PUSH_CONSTANT_WORDS && layout != VK_NULL_HANDLE;) {
+        if (!(valid & (1ull << first))) {
+            first++;
+            continue;
+        }
+
+        uint last = first;
+        while (last < PUSH_CONSTANT_WORDS && (valid & (1ull << last)))
+            last++;
+
+        uint offset = first * sizeof(uint32_t);
+        uint size   = (last - first) * sizeof(uint32_t);
+        rhi->vtable.vkCmdPushConstants(command_buffer, layout, stages, offset, size, constants.data() + first);
+        first = last;
+    }
+    push_constants        = constants;
+    push_constants_valid  = layout != VK_NULL_HANDLE ? valid : 0;
+    push_constants_stages = stages;
+
+    if (index.buffer != VK_NULL_HANDLE) {
+        if (index.size == 0) {
+            rhi->vtable.vkCmdBindIndexBuffer(command_buffer, index.buffer, index.offset, index.type);
+        } else {
+            rhi->vtable.vkCmdBindIndexBuffer2KHR(command_buffer, index.buffer, index.offset, index.size, index.type);
+        }
+        bound_index_buffer = index;
+    }
+
+    if (viewport.has_value()) {
+        rhi->vtable.vkCmdSetViewport(command_buffer, 0, 1, &viewport.value());
+        bound_viewport = viewport;
+    }
+
+    if (scissor.has_value()) {
+        rhi->vtable.vkCmdSetScissor(command_buffer, 0, 1, &scissor.value());
+        bound_scissor = scissor;
+    }
+}
+#pragma endregion VulkanCommandBuffer
@@ -0,0 +1,463 @@
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include "VkUtils.h"
+
+// staging memory is sub-allocated from chunks of at least this size
+constexpr GPUSize64 STAGING_CHUNK_SIZE = 4ull << 20;
+
+// completed staging chunks kept around for reuse
+constexpr size_t MAX_RECYCLED_CHUNKS = 8;
+
+// array layers (and cube faces) are addressed by the z origin and depth of the copy, except for 3D textures
+static void upload_layers(const VulkanTexture& texture, const GPUTexelCopyTextureInfo& destination, const GPUExtent3D& size, VkImageSubresourceRange& range)
+{
+    bool volume          = texture.create_info.imageType == VK_IMAGE_TYPE_3D;
+    range.baseArrayLayer = volume ? 0u : destination.origin.z;
+    range.layerCount     = volume ? 1u : size.depth;
+}
+
+void VulkanUploadService::init()
+{
+    auto rhi = get_rhi();
+
+    // fallback to the graphics queue when there is no transfer queue
+    bool has_transfer_queue = rhi->queues.transfer.has_value() && rhi->transfer_queue != VK_NULL_HANDLE;
+    src_family              = has_transfer_queue ? rhi->queues.transfer.value() : rhi->queues.graphics.value();
+    dst_family              = rhi->queues.graphics.value();
+    command_queue           = has_transfer_queue ? rhi->transfer_queue : rhi->graphics_queue;
+
+    auto pool_info             = VkCommandPoolCreateInfo{};
+    pool_info.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.pNext            = nullptr;
+    pool_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = src_family;
+    vk_check(rhi->vtable.vkCreateCommandPool(rhi->device, &pool_info, nullptr, &command_pool));
+
+    timeline = VulkanSemaphore(VK_SEMAPHORE_TYPE_TIMELINE);
+}
+
+void VulkanUploadService::destroy()
+{
+    auto rhi = get_rhi();
+
+    // NOTE: caller must make sure the device is idle
+    if (recording.command != VK_NULL_HANDLE)
+        inflight.push_back(recording);
+
+    for (auto& batch : inflight) {
+        for (auto& buffer : batch.staging)
+            buffer.destroy();
+        rhi->vtable.vkFreeCommandBuffers(rhi->device, command_pool, 1, &batch.command);
+    }
+
+    for (auto& buffer : recycled)
+        buffer.destroy();
+
+    if (command_pool != VK_NULL_HANDLE) {
+        rhi->vtable.vkDestroyCommandPool(rhi->device, command_pool, nullptr);
+        command_pool = VK_NULL_HANDLE;
+    }
+
+    timeline.destroy();
+    recording = {};
+    inflight.clear();
+    acquires.clear();
+    recycled.clear();
+}
+
+VulkanUploadService::Batch& VulkanUploadService::begin()
+{
+    if (recording.command != VK_NULL_HANDLE)
+        return recording;
+
+    auto rhi = get_rhi();
+
+    auto alloc_info               = VkCommandBufferAllocateInfo{};
+    alloc_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.pNext              = nullptr;
+    alloc_info.commandPool        = command_pool;
+    alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    vk_check(rhi->vtable.vkAllocateCommandBuffers(rhi->device, &alloc_info, &recording.command));
+
+    auto begin_info  = VkCommandBufferBeginInfo{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.pNext = nullptr;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vk_check(rhi->vtable.vkBeginCommandBuffer(recording.command, &begin_info));
+
+    recording.value = submitted_value + 1;
+    recording.head  = 0ull;
+
+    // ownership acquires are collected per batch
+    acquires.push_back(Acquire{});
+    acquires.back().value = recording.value;
+    return recording;
+}
+
+GPUSize64 VulkanUploadService::stage(const void* data, GPUSize64 size, GPUSize64 alignment, VkBuffer& buffer)
+{
+    auto& batch = begin();
+
+    // generic round up, texel sizes are not always a power of two
+    GPUSize64 offset = (batch.head + alignment - 1) / alignment * alignment;
+
+    if (batch.staging.empty() || offset + size > batch.staging.back().mapped_size) {
+        // reuse a completed chunk if possible
+        auto it = std::find_if(recycled.begin(), recycled.end(), [&](const VulkanBuffer& chunk) {
+            return chunk.mapped_size >= size;
+        });
+
+        if (it != recycled.end()) {
+            batch.staging.push_back(*it);
+            recycled.erase(it);
+        } else {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "upload_staging";
+            desc.size               = std::max(size, STAGING_CHUNK_SIZE);
+            desc.usage              = GPUBufferUsage::MAP_WRITE | GPUBufferUsage::COPY_SRC;
+            desc.mapped_at_creation = true;
+            batch.staging.push_back(VulkanBuffer(desc));
+        }
+        offset = 0ull;
+    }
+
+    auto& chunk = batch.staging.back();
+    std::memcpy(chunk.mapped_data + offset, data, size);
+    vk_check(vmaFlushAllocation(get_rhi()->alloc, chunk.allocation, offset, size));
+
+    batch.head = offset + size;
+    buffer     = chunk.buffer;
+    return offset;
+}
+
+uint64_t VulkanUploadService::upload(VulkanBuffer& buffer, GPUSize64 offset, const void* data, GPUSize64 size)
+{
+    auto rhi = get_rhi();
+
+    VkBuffer  staging        = VK_NULL_HANDLE;
+    GPUSize64 staging_offset = stage(data, size, 16, staging);
+
+    auto region      = VkBufferCopy{};
+    region.srcOffset = staging_offset;
+    region.dstOffset = offset;
+    region.size      = size;
+    rhi->vtable.vkCmdCopyBuffer(recording.command, staging, buffer.buffer, 1, &region);
+
+    if (ownership_transfer()) {
+        auto barrier                = VkBufferMemoryBarrier2{};
+        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+        barrier.pNext               = nullptr;
+        barrier.srcStageMask        = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask        = VK_PIPELINE_STAGE_2_NONE;
+        barrier.dstAccessMask       = VK_ACCESS_2_NONE;
+        barrier.srcQueueFamilyIndex = src_family;
+        barrier.dstQueueFamilyIndex = dst_family;
+        barrier.buffer              = buffer.buffer;
+        barrier.offset              = offset;
+        barrier.size                = size;
+
+        auto dependency                     = VkDependencyInfo{};
+        dependency.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency.bufferMemoryBarrierCount = 1;
+        dependency.pBufferMemoryBarriers    = &barrier;
+        rhi->vtable.vkCmdPipelineBarrier2KHR(recording.command, &dependency);
+
+        // matching acquire, recorded on the graphics queue later
+        barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+        acquires.back().buffers.push_back(barrier);
+    }
+
+    return recording.value;
+}
+
+uint64_t VulkanUploadService::upload(VulkanTexture& texture, const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size)
+{
+    auto rhi = get_rhi();
+
+    // infer the size of the source data
+    uint      texel_size     = size_of(texture.format);
+    GPUSize64 bytes_per_row  = layout.bytes_per_row ? layout.bytes_per_row : size.width * texel_size;
+    GPUSize64 rows_per_image = layout.rows_per_image ? layout.rows_per_image : size.height;
+    GPUSize64 data_size      = bytes_per_row * rows_per_image * size.depth;
+
+    // buffer offset must be a multiple of both the texel size and 4
+    VkBuffer  staging        = VK_NULL_HANDLE;
+    GPUSize64 alignment      = std::lcm(GPUSize64(texel_size), GPUSize64(4));
+    GPUSize64 staging_offset = stage(reinterpret_cast<const uint8_t*>(data) + layout.offset, data_size, alignment, staging);
+
+    // layers of array textures are copied as slices of the z dimension
+    bool volume = texture.create_info.imageType == VK_IMAGE_TYPE_3D;
+
+    auto range           = VkImageSubresourceRange{};
+    range.aspectMask     = vkenum(destination.aspect);
+    range.baseMipLevel   = destination.mip_level;
+    range.levelCount     = 1;
+    upload_layers(texture, destination, size, range);
+
+    // NOTE: previous content of the subresource is discarded
+    auto barrier                = VkImageMemoryBarrier2{};
+    barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.pNext               = nullptr;
+    barrier.srcStageMask        = VK_PIPELINE_STAGE_2_NONE;
+    barrier.srcAccessMask       = VK_ACCESS_2_NONE;
+    barrier.dstStageMask        = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.dstAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image               = texture.image;
+    barrier.subresourceRange    = range;
+
+    auto dependency                    = VkDependencyInfo{};
+    dependency.sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency.imageMemoryBarrierCount = 1;
+    dependency.pImageMemoryBarriers    = &barrier;
+    rhi->vtable.vkCmdPipelineBarrier2KHR(recording.command, &dependency);
+
+    auto copy                            = VkBufferImageCopy{};
+    copy.bufferOffset                    = staging_offset;
+    copy.bufferRowLength                 = infer_texture_row_length(texture.format, layout.bytes_per_row);
+    copy.bufferImageHeight               = layout.rows_per_image;
+    copy.imageOffset.x                   = destination.origin.x;
+    copy.imageOffset.y                   = destination.origin.y;
+    copy.imageOffset.z                   = volume ? destination.origin.z : 0;
+    copy.imageExtent.width               = size.width;
+    copy.imageExtent.height              = size.height;
+    copy.imageExtent.depth               = volume ? size.depth : 1;
+    copy.imageSubresource.aspectMask     = range.aspectMask;
+    copy.imageSubresource.mipLevel       = range.baseMipLevel;
+    copy.imageSubresource.baseArrayLayer = range.baseArrayLayer;
+    copy.imageSubresource.layerCount     = range.layerCount;
+    rhi->vtable.vkCmdCopyBufferToImage(recording.command, staging, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+    // leave the texture ready to be sampled (release to graphics queue if needed)
+    barrier.srcStageMask  = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.dstStageMask  = ownership_transfer() ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_NONE;
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    if (ownership_transfer()) {
+        barrier.srcQueueFamilyIndex = src_family;
+        barrier.dstQueueFamilyIndex = dst_family;
+    }
+    rhi->vtable.vkCmdPipelineBarrier2KHR(recording.command, &dependency);
+
+    if (ownership_transfer()) {
+        // matching acquire, recorded on the graphics queue later
+        barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+        acquires.back().images.push_back(barrier);
+    }
+
+    return recording.value;
+}
+
+void VulkanUploadService::flush()
+{
+    if (recording.command == VK_NULL_HANDLE)
+        return;
+
+    auto rhi = get_rhi();
+    vk_check(rhi->vtable.vkEndCommandBuffer(recording.command));
+
+    auto cmd_submit_info          = VkCommandBufferSubmitInfo{};
+    cmd_submit_info.sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    cmd_submit_info.pNext         = nullptr;
+    cmd_submit_info.commandBuffer = recording.command;
+    cmd_submit_info.deviceMask    = 0;
+
+    auto signal_info        = VkSemaphoreSubmitInfo{};
+    signal_info.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signal_info.pNext       = nullptr;
+    signal_info.semaphore   = timeline.semaphore;
+    signal_info.value       = recording.value;
+    signal_info.stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    signal_info.deviceIndex = 0;
+
+    auto submit_info                     = VkSubmitInfo2{};
+    submit_info.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submit_info.pNext                    = nullptr;
+    submit_info.flags                    = 0;
+    submit_info.commandBufferInfoCount   = 1;
+    submit_info.pCommandBufferInfos      = &cmd_submit_info;
+    submit_info.signalSemaphoreInfoCount = 1;
+    submit_info.pSignalSemaphoreInfos    = &signal_info;
+    {
+        // the transfer queue might be shared with graphics
+        std::lock_guard<std::mutex> lock(rhi->queue_mutex);
+        vk_check(rhi->vtable.vkQueueSubmit2KHR(command_queue, 1, &submit_info, VK_NULL_HANDLE));
+    }
+
+    submitted_value = recording.value;
+    inflight.push_back(recording);
+    recording = {};
+}
+
+void VulkanUploadService::retire()
+{
+    if (inflight.empty())
+        return;
+
+    auto rhi = get_rhi();
+    vk_check(rhi->vtable.vkGetSemaphoreCounterValue(rhi->device, timeline.semaphore, &completed_value));
+
+    // recycle the staging memory and command buffers of completed batches
+    auto it = inflight.begin();
+    for (; it != inflight.end() && it->value <= completed_value; it++) {
+        for (auto& chunk : it->staging) {
+            if (recycled.size() < MAX_RECYCLED_CHUNKS) {
+                recycled.push_back(chunk);
+            } else {
+                chunk.destroy();
+            }
+        }
+        rhi->vtable.vkFreeCommandBuffers(rhi->device, command_pool, 1, &it->command);
+    }
+    inflight.erase(inflight.begin(), it);
+}
+
+bool VulkanUploadService::ready(uint64_t value)
+{
+    if (value > submitted_value)
+        return false;
+
+    if (value > completed_value)
+        retire();
+
+    return value <= completed_value;
+}
+
+void VulkanUploadService::wait(uint64_t value)
+{
+    if (value > submitted_value)
+        flush();
+
+    auto wait_info           = VkSemaphoreWaitInfo{};
+    wait_info.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.pNext          = nullptr;
+    wait_info.flags          = 0;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores    = &timeline.semaphore;
+    wait_info.pValues        = &value;
+
+    auto rhi = get_rhi();
+    vk_check(rhi->vtable.vkWaitSemaphores(rhi->device, &wait_info, UINT64_MAX));
+    retire();
+}
+
+void VulkanUploadService::acquire(VulkanCommandBuffer& cmd, uint64_t value, GPUBarrierSyncFlags sync)
+{
+    // the wait is per command buffer, any of them might be submitted first
+    if (value <= cmd.upload_value)
+        return;
+
+    // make sure the batch is on its way
+    if (value > submitted_value)
+        flush();
+
+    // complete the ownership transfers of all batches up to the requested one,
+    // an acquire happens exactly once, so they are recorded by the first command buffer to wait.
+    Vector<VkBufferMemoryBarrier2> buffer_barriers;
+    Vector<VkImageMemoryBarrier2>  image_barriers;
+
+    auto it = acquires.begin();
+    for (; it != acquires.end() && it->value <= value; it++) {
+        buffer_barriers.insert(buffer_barriers.end(), it->buffers.begin(), it->buffers.end());
+        image_barriers.insert(image_barriers.end(), it->images.begin(), it->images.end());
+    }
+    acquires.erase(acquires.begin(), it);
+
+    if (!buffer_barriers.empty() || !image_barriers.empty()) {
+        auto dependency                     = VkDependencyInfo{};
+        dependency.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(buffer_barriers.size());
+        dependency.pBufferMemoryBarriers    = buffer_barriers.data();
+        dependency.imageMemoryBarrierCount  = static_cast<uint32_t>(image_barriers.size());
+        dependency.pImageMemoryBarriers     = image_barriers.data();
+        get_rhi()->vtable.vkCmdPipelineBarrier2KHR(cmd.command_buffer, &dependency);
+    }
+
+    // GPU-side wait, the host never blocks on uploads here
+    auto semaphore   = timeline;
+    semaphore.target = value;
+    cmd.wait(semaphore, sync);
+
+    cmd.upload_value = value;
+}
+
+bool api::upload_buffer(GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size, GPUUploadToken& token)
+{
+    auto  rhi = get_rhi();
+    auto& buf = fetch_resource(rhi->buffers, buffer);
+
+    std::lock_guard<std::mutex> lock(rhi->uploads.mutex);
+    token.value = rhi->uploads.upload(buf, offset, data, size);
+    return true;
+}
+
+bool api::upload_texture(const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size, GPUUploadToken& token)
+{
+    auto  rhi = get_rhi();
+    auto& tex = fetch_resource(rhi->textures, destination.texture);
+
+    {
+        std::lock_guard<std::mutex> lock(rhi->uploads.mutex);
+        token.value = rhi->uploads.upload(tex, destination, data, layout, size);
+    }
+
+    // uploads leave the subresource ready to be sampled, visible to all stages once acquired
+    auto range           = VkImageSubresourceRange{};
+    range.baseMipLevel   = destination.mip_level;
+    range.levelCount     = 1;
+    upload_layers(tex, destination, size, range);
+
+    auto state        = VulkanResourceState{};
+    state.layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    state.read_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    state.read_access = VK_ACCESS_2_MEMORY_READ_BIT;
+    rhi->tracker.set(destination.texture, range, state);
+    return true;
+}
+
+void api::flush_uploads()
+{
+    auto& uploads = get_rhi()->uploads;
+
+    std::lock_guard<std::mutex> lock(uploads.mutex);
+    uploads.flush();
+}
+
+bool api::query_upload(GPUUploadToken token)
+{
+    auto& uploads = get_rhi()->uploads;
+
+    std::lock_guard<std::mutex> lock(uploads.mutex);
+    return uploads.ready(token.value);
+}
+
+void api::wait_upload(GPUUploadToken token)
+{
+    auto& uploads = get_rhi()->uploads;
+
+    std::lock_guard<std::mutex> lock(uploads.mutex);
+    uploads.wait(token.value);
+}
+
+void cmd::wait_upload(GPUCommandEncoderHandle cmdbuffer, GPUUploadToken token, GPUBarrierSyncFlags sync)
+{
+    auto  rhi = get_rhi();
+    auto& cmd = rhi->current_frame().command(cmdbuffer);
+
+    std::lock_guard<std::mutex> lock(rhi->uploads.mutex);
+    rhi->uploads.acquire(cmd, token.value, sync);
+}
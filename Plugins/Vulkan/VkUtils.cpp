@@ -219,10 +219,12 @@ VkSurfaceFormatKHR choose_swap_surface_format(const Vector<VkSurfaceFormatKHR>&
     return availableFormats.at(0);
 }
 
-VkPresentModeKHR choose_swap_present_mode(const Vector<VkPresentModeKHR>& availablePresentModes)
+VkPresentModeKHR choose_swap_present_mode(GPUPresentMode mode, const Vector<VkPresentModeKHR>& availablePresentModes)
 {
+    // FIFO is the only present mode that is always available
+    auto requested = vkenum(mode);
     for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+        if (availablePresentMode == requested) {
             return availablePresentMode;
         }
     }
@@ -17,11 +17,17 @@
 #define VK_EXT_debug_utils
 #include <volk.h>
 #include <vk_mem_alloc.h>
+#include <mutex>
+#include <chrono>
+#include <thread>
 #include <sstream>
+#include <shared_mutex>
+#include <condition_variable>
 
 #include <Lyra/Common/Logger.h>
 #include <Lyra/Common/Msgbox.h>
 #include <Lyra/Common/Slotmap.h>
+#include <Lyra/Common/Function.h>
 #include <Lyra/Common/Container.h>
 #include <Lyra/Common/Compatibility.h>
 #include <Lyra/Render/RHI/RHIAPI.h>
@@ -72,8 +78,13 @@ struct VulkanBuffer
     VmaAllocationInfo alloc_info     = {};
     VkDeviceAddress   device_address = 0ull;
 
+    // create parameters, used to recreate the buffer when defragmentation moves it
+    VkDeviceSize       size  = 0ull;
+    VkBufferUsageFlags usage = 0;
+
     uint8_t* mapped_data = nullptr;
     uint64_t mapped_size = 0ull;
+    bool     map_pending = false; // waiting in the map queue
 
     // implementation in VkBuffer.cpp
     explicit VulkanBuffer();
@@ -110,6 +121,14 @@ struct VulkanTexture
     VkImageAspectFlags aspects    = 0;
     VkExtent2D         area       = {}; // only used for Render Area
 
+    // subresources, used by resource state tracking
+    uint32_t              mip_levels   = 1;
+    uint32_t              array_layers = 1;
+    VkSampleCountFlagBits samples      = VK_SAMPLE_COUNT_1_BIT;
+
+    // create parameters, used to recreate the image when defragmentation moves it
+    VkImageCreateInfo create_info = {};
+
     // implementation in VkImage.cpp
     explicit VulkanTexture();
     explicit VulkanTexture(const GPUTextureDescriptor& desc);
@@ -122,9 +141,16 @@ struct VulkanTexture
 struct VulkanTextureView
 {
     VkImageView        view    = VK_NULL_HANDLE;
+    VkImageViewType    type    = VK_IMAGE_VIEW_TYPE_2D;
     VkExtent2D         area    = {}; // only used for Render Area
     VkImageAspectFlags aspects = 0;
 
+    // viewed subresources, used by resource state tracking
+    GPUTextureHandle        texture;
+    VkFormat                format      = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits   samples     = VK_SAMPLE_COUNT_1_BIT;
+    VkImageSubresourceRange subresource = {};
+
     // implementation in VkImage.cpp
     explicit VulkanTextureView();
     explicit VulkanTextureView(const VulkanTexture& texture, const GPUTextureViewDescriptor& desc);
@@ -147,6 +173,27 @@ struct VulkanSampler
     bool valid() const { return sampler != VK_NULL_HANDLE; }
 };
 
+// identical sampler states share one sampler object (devices cap the number of samplers),
+// shared handles are reference counted, the sampler is deleted with its last reference.
+struct VulkanSamplerCache
+{
+    struct Entry
+    {
+        GPUSamplerDescriptor desc;
+        GPUSamplerHandle     handle;
+        uint                 refs = 0;
+    };
+
+    HashMap<size_t, Entry> entries; // descriptor hash -> shared sampler
+    HashMap<uint, size_t>  keys;    // sampler handle -> descriptor hash
+    std::mutex             mutex;
+
+    // implementation in VkSampler.cpp
+    auto acquire(const GPUSamplerDescriptor& desc) -> GPUSamplerHandle;
+    bool release(GPUSamplerHandle handle);
+    void clear();
+};
+
 struct VulkanFence
 {
     VkFence fence = VK_NULL_HANDLE;
@@ -187,9 +234,11 @@ struct VulkanSemaphore
 
 struct VulkanQuerySet
 {
-    VkQueryPool pool  = VK_NULL_HANDLE;
-    VkQueryType type  = VK_QUERY_TYPE_TIMESTAMP;
-    uint32_t    count = 0;
+    VkQueryPool                   pool       = VK_NULL_HANDLE;
+    VkQueryType                   type       = VK_QUERY_TYPE_TIMESTAMP;
+    VkQueryPipelineStatisticFlags statistics = 0;
+    uint32_t                      count      = 0;
+    uint32_t                      stride     = sizeof(uint64_t); // bytes of a resolved query
 
     // implementation in VkQuery.cpp
     explicit VulkanQuerySet();
@@ -203,6 +252,7 @@ struct VulkanQuerySet
 struct VulkanShader
 {
     VkShaderModule module = VK_NULL_HANDLE;
+    uint64_t       hash   = 0ull; // content hash of the SPIR-V blob
 
     // implementation in VkShader.cpp
     explicit VulkanShader();
@@ -213,12 +263,37 @@ struct VulkanShader
     bool valid() const { return module != VK_NULL_HANDLE; }
 };
 
+// identical SPIR-V blobs share one shader module keyed by the content hash,
+// shared handles are reference counted, the module is deleted with its last reference.
+struct VulkanShaderCache
+{
+    struct Entry
+    {
+        GPUShaderModuleHandle handle;
+        Vector<uint8_t>       blob = {}; // shader modules do not keep the code, hits are verified against this copy
+        uint                  refs = 0;
+    };
+
+    HashMap<uint64_t, Entry> entries;  // content hash -> shared module
+    HashMap<uint, uint64_t>  keys;     // module handle -> content hash
+    GPUSize64                hits = 0; // requests served by an existing module
+    std::mutex               mutex;
+
+    // implementation in VkShader.cpp
+    auto acquire(const GPUShaderModuleDescriptor& desc) -> GPUShaderModuleHandle;
+    bool release(GPUShaderModuleHandle handle);
+    void stats(GPUShaderModuleStats& stats);
+    void clear();
+};
+
 struct VulkanBindGroupLayout
 {
     VkDescriptorSetLayout layout   = VK_NULL_HANDLE;
     bool                  bindless = false;
 
-    Vector<VkDescriptorType> binding_types = {};
+    Vector<VkDescriptorType>   binding_types    = {};
+    Vector<VkShaderStageFlags> binding_stages   = {};
+    Vector<bool>               binding_writable = {}; // storage bindings that are not read-only
 
     // implementation in VkLayout.cpp
     explicit VulkanBindGroupLayout();
@@ -242,21 +317,104 @@ struct VulkanPipelineLayout
     bool valid() const { return layout != VK_NULL_HANDLE; }
 };
 
+// pipeline create info along with all the state it points to,
+// handles are resolved at construction, hence it can be compiled later on any thread.
+// NOTE: create info points into the object itself, therefore it is not copyable.
+struct VulkanPipelineState
+{
+    VkPipelineBindPoint bind_point   = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    VkPipelineLayout    layout       = VK_NULL_HANDLE;
+    String              label        = "";
+    Array<String, 2>    entry_points = {};
+
+    // graphics pipeline states
+    Vector<VkPipelineShaderStageCreateInfo>     stages                         = {};
+    Vector<VkVertexInputBindingDescription>     vertex_layouts                 = {};
+    Vector<VkVertexInputAttributeDescription>   vertex_attribs                 = {};
+    Vector<VkFormat>                            formats                        = {};
+    Vector<VkPipelineColorBlendAttachmentState> attachments                    = {};
+    Vector<VkDynamicState>                      dynamics                       = {};
+    VkViewport                                  viewport                       = {};
+    VkRect2D                                    scissor                        = {};
+    VkPipelineVertexInputStateCreateInfo        vertex_input_state             = {};
+    VkPipelineInputAssemblyStateCreateInfo      input_assembly_state           = {};
+    VkPipelineTessellationStateCreateInfo       tessellation_state             = {};
+    VkPipelineViewportStateCreateInfo           viewport_state                 = {};
+    VkPipelineRasterizationStateCreateInfo      rasterization_state            = {};
+    VkPipelineMultisampleStateCreateInfo        multisample_state              = {};
+    VkPipelineDepthStencilStateCreateInfo       depth_stencil_state            = {};
+    VkPipelineColorBlendStateCreateInfo         color_blend_state              = {};
+    VkPipelineDynamicStateCreateInfo            dynamic_states                 = {};
+    VkPipelineRenderingCreateInfo               pipeline_rendering_create_info = {};
+    VkGraphicsPipelineCreateInfo                graphics_create_info           = {};
+
+    // compute pipeline states
+    VkComputePipelineCreateInfo compute_create_info = {};
+
+    // implementation in VkPipeline.cpp
+    explicit VulkanPipelineState(const GPURenderPipelineDescriptor& desc);
+    explicit VulkanPipelineState(const GPUComputePipelineDescriptor& desc);
+    explicit VulkanPipelineState(VulkanPipelineState&&)      = delete;
+    explicit VulkanPipelineState(const VulkanPipelineState&) = delete;
+};
+
 struct VulkanPipeline
 {
     VkPipeline       pipeline = VK_NULL_HANDLE;
     VkPipelineCache  cache    = VK_NULL_HANDLE;
     VkPipelineLayout layout   = VK_NULL_HANDLE; // VulkanPipeline does NOT own this.
+    bool             pending  = false;          // still compiling, see VulkanPipelineCompiler
 
     // implementation in VkPipeline.cpp
     explicit VulkanPipeline();
     explicit VulkanPipeline(const GPURenderPipelineDescriptor& desc);
     explicit VulkanPipeline(const GPUComputePipelineDescriptor& desc);
     explicit VulkanPipeline(const GPURayTracingPipelineDescriptor& desc);
+    explicit VulkanPipeline(const VulkanPipelineState& state);
 
     void destroy();
 
-    bool valid() const { return pipeline != VK_NULL_HANDLE; }
+    bool valid() const { return pipeline != VK_NULL_HANDLE || pending; }
+};
+
+// compiles asynchronous pipelines on worker threads.
+// compiled pipelines are installed into their slots on the recording thread (at the start of a frame),
+// so that slots are never written while other threads may be recording commands.
+struct VulkanPipelineCompiler
+{
+    struct Job
+    {
+        uint                                 handle = 0;
+        std::unique_ptr<VulkanPipelineState> state  = {};
+        VulkanPipeline                       result;
+    };
+
+    Vector<std::thread>                       workers   = {};
+    Deque<Job>                                queued    = {};
+    HashMap<uint, const VulkanPipelineState*> active    = {}; // compiling right now, by pipeline handle
+    Vector<Job>                               compiled  = {}; // waiting to be installed
+    HashSet<uint>                             discarded = {}; // deleted while compiling
+    uint                                      running   = 0;
+    bool                                      stopping  = false;
+
+    std::mutex              mutex;
+    std::condition_variable wakeup; // signaled when jobs are queued
+    std::condition_variable idle;   // signaled when jobs are compiled
+
+    // implementation in VkCompiler.cpp
+    void destroy();
+    void compile(uint handle, std::unique_ptr<VulkanPipelineState>&& state);
+    void discard(uint handle);
+    void install();
+    void wait();
+
+    // waits only for the queued and running jobs using the given object
+    void wait_module(VkShaderModule module);
+    void wait_layout(VkPipelineLayout layout);
+
+private:
+    void work();
+    void wait_unused(const Function<bool(const VulkanPipelineState&)>& uses);
 };
 
 struct VulkanTlas
@@ -267,13 +425,14 @@ struct VulkanTlas
     VkAccelerationStructureBuildRangeInfoKHR    range    = {};
     VkAccelerationStructureGeometryKHR          geometry = {};
 
-    // used to build content of instances in memory
+    // persistent instance records, written through staging buffers of the command buffers
     VulkanBuffer storage;
-    VulkanBuffer staging;
     VulkanBuffer instances;
 
     // other info
     uint             max_instance_count = 0;
+    uint             built_count        = 0; // instance count of the last build, refits must match it
+    bool             built              = false;
     GPUBVHUpdateMode update_mode        = GPUBVHUpdateMode::BUILD;
 
     // implementation in VkTlas.cpp
@@ -309,6 +468,16 @@ struct VulkanBlas
     bool valid() const { return blas != VK_NULL_HANDLE; }
 };
 
+// resource referenced by a bind group, used by resource state tracking
+struct VulkanBindingResource
+{
+    GPUBufferHandle      buffer;
+    GPUTextureViewHandle view;
+    VkDescriptorType     type     = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+    VkShaderStageFlags   stages   = 0;
+    bool                 writable = false;
+};
+
 struct VulkanDescriptorPool
 {
     Vector<VkDescriptorPool> pools     = {};
@@ -316,6 +485,9 @@ struct VulkanDescriptorPool
     uint32_t                 poolindex = 0;
     Vector<VkDescriptorSet>  allocated = {};
 
+    // resources referenced by each allocated descriptor set (deque keeps references stable)
+    Deque<Vector<VulkanBindingResource>> resources = {};
+
     // implementation in VkDescriptorPool.cpp
     void destroy();
 
@@ -330,6 +502,362 @@ struct VulkanDescriptorPool
     uint find_pool_index(uint index);
 };
 
+struct VulkanMemoryPools
+{
+    GPUMemoryPoolDescriptor desc = {};
+
+    // sub-allocation pools per buffer usage class
+    VmaPool device   = VK_NULL_HANDLE;
+    VmaPool uniform  = VK_NULL_HANDLE;
+    VmaPool upload   = VK_NULL_HANDLE;
+    VmaPool readback = VK_NULL_HANDLE;
+
+    // implementation in VkMemory.cpp
+    void init(const GPUMemoryPoolDescriptor& desc, VkBufferUsageFlags additional_usages);
+    void destroy();
+
+    auto handle(GPUMemoryPool pool) const -> VmaPool;
+    auto block_size(GPUMemoryPool pool) const -> GPUSize64;
+    auto classify(const GPUBufferDescriptor& desc) const -> GPUMemoryPool;
+    auto select(const GPUBufferDescriptor& desc) const -> VmaPool;
+    auto stats(GPUMemoryPool pool) const -> GPUMemoryPoolStats;
+};
+
+struct VulkanMemoryBudget
+{
+    float                   threshold = 0.9f;
+    GPUMemoryBudgetCallback callback  = {};
+    Vector<bool>            exceeded  = {}; // per heap, callback only fires when crossing the threshold
+
+    // implementation in VkMemory.cpp
+    void check();
+    auto heaps(bool detailed) const -> Vector<GPUMemoryHeapStats>;
+};
+
+struct VulkanUploadRing
+{
+    // persistently mapped buffer, sub-allocated linearly within a frame
+    GPUBufferHandle buffer   = {};
+    uint8_t*        mapped   = nullptr;
+    GPUSize64       capacity = 0ull;
+    GPUSize64       head     = 0ull;
+
+    // buffers outgrown within the frame, released once the frame completes
+    Vector<GPUBufferHandle> retired = {};
+
+    // implementation in VkMemory.cpp
+    void reset();
+    void flush();
+    void destroy();
+    auto allocate(GPUSize64 size, GPUSize64 alignment) -> GPUTransientAllocation;
+
+private:
+    void grow(GPUSize64 size);
+};
+
+// persistently mapped staging buffers behind inline buffer updates, bucketed by power of two sizes.
+// buffers return to the pool once the frame using them completes, and idle buffers beyond
+// the high-water mark of the last trim interval are released.
+struct VulkanStagingPool
+{
+    static constexpr GPUSize64 MIN_SIZE      = 65536; // smallest bucket, small updates of a command buffer share one buffer
+    static constexpr uint      BUCKET_COUNT  = 8;     // largest bucket is MIN_SIZE << 7, larger buffers are not pooled
+    static constexpr uint      TRIM_INTERVAL = 120;   // frames between trims
+
+    struct Buffer
+    {
+        VulkanBuffer buffer;
+        GPUSize64    size   = 0ull;
+        uint         bucket = 0u; // BUCKET_COUNT for buffers not pooled
+    };
+
+    struct Bucket
+    {
+        Vector<Buffer> free = {};
+        uint           used = 0u; // buffers handed out and not yet recycled
+        uint           peak = 0u; // high-water mark of used buffers since the last trim
+    };
+
+    Array<Bucket, BUCKET_COUNT> buckets = {};
+    GPUStagingStats             current = {}; // counters of the frame being recorded
+    GPUStagingStats             last    = {}; // counters of the last recorded frame, snapshot by new_frame()
+    uint                        frames  = 0u;
+    std::mutex                  mutex;
+
+    // implementation in VkMemory.cpp
+    void destroy();
+    void new_frame();
+    auto acquire(GPUSize64 size) -> Buffer;
+    void recycle(Buffer& buffer);
+};
+
+struct VulkanCommandBuffer;
+
+// incremental defragmentation on top of the VMA defragmentation API, one pass per cmd::defragment_memory().
+// copies are recorded into the calling command buffer and the moved handles are patched right away,
+// the old memory is released once the frame which recorded the pass retires.
+// only device local buffers and textures with both copy usages are moved. resources referenced by
+// device addresses or host mappings, and textures without layouts known to the tracker, stay where they are.
+// descriptor sets may already be bound, hence resources referenced by bind groups of the current frame stay too.
+// other command buffers and bundles of the frame would keep the old handles, none may be open during the pass.
+struct VulkanDefragmenter
+{
+    using Clock = std::chrono::steady_clock;
+
+    VmaDefragmentationContext      context = VK_NULL_HANDLE;
+    VmaDefragmentationPassMoveInfo pass    = {};
+    uint                           target  = 0;     // pool being defragmented, the default pools and then the device pool
+    bool                           open    = false; // pass waiting for the frame which recorded its copies
+
+    // objects replaced by the open pass, destroyed when it ends
+    Vector<VkBuffer>       retired_buffers = {};
+    Vector<VkImage>        retired_images  = {};
+    Vector<VkImageView>    retired_views   = {};
+    HashSet<VmaAllocation> moved           = {}; // allocations of the moved resources, their info is refreshed when the pass ends
+    GPUDefragmentStats     stats           = {};
+    GPUMemoryPoolStats     before          = {}; // memory when the open pass began
+    std::mutex             mutex;
+
+    // implementation in VkMemory.cpp
+    void record(VulkanCommandBuffer& cmd, const GPUDefragmentDescriptor& desc);
+    void finish();
+    void destroy();
+
+private:
+    bool begin(const GPUDefragmentDescriptor& desc);
+    void end();
+};
+
+// objects deleted by the user might still be referenced by frames in flight,
+// their release is postponed until the GPU retires the frame that deleted them.
+struct VulkanDeleteQueue
+{
+    struct Entry
+    {
+        uint             frame = 0u;
+        Function<void()> release;
+    };
+
+    Deque<Entry> entries;
+    std::mutex   mutex;
+
+    // implementation in VkFrame.cpp
+    void push(uint frame, Function<void()>&& release);
+    void retire(uint completed_frame);
+    void flush();
+};
+
+// command buffer submissions are deferred, and flushed in submission order at the end of frame,
+// before presenting and before the host waits on the GPU. consecutive submissions to the same queue
+// are coalesced into a single vkQueueSubmit2, which keeps the order of semaphore signals and waits.
+struct VulkanSubmitQueue
+{
+    struct Submission
+    {
+        VkQueue                           queue    = VK_NULL_HANDLE;
+        Vector<VkCommandBufferSubmitInfo> commands = {};
+        Vector<VkSemaphoreSubmitInfo>     waits    = {};
+        Vector<VkSemaphoreSubmitInfo>     signals  = {};
+    };
+
+    Vector<Submission> pending;
+    std::mutex         mutex;
+
+    // implementation in VkCommandBuffer.cpp
+    void push(Submission&& submission);
+    void flush();
+    bool empty();
+};
+
+struct VulkanMapQueue
+{
+    struct Request
+    {
+        uint                 frame  = 0u;
+        GPUBufferHandle      buffer = {};
+        GPUSize64            offset = 0ull;
+        GPUSize64            size   = 0ull;
+        GPUBufferMapCallback callback;
+    };
+
+    Deque<Request> requests;
+    std::mutex     mutex;
+
+    // implementation in VkFrame.cpp
+    void push(Request&& request);
+    void retire(uint completed_frame);
+    void cancel(GPUBufferHandle buffer);
+    void flush();
+
+private:
+    void fulfill(Vector<Request>& ready, bool success);
+};
+
+struct VulkanUploadService
+{
+    struct Batch
+    {
+        uint64_t             value   = 0ull; // timeline value signaled when this batch completes
+        VkCommandBuffer      command = VK_NULL_HANDLE;
+        Vector<VulkanBuffer> staging = {};
+        GPUSize64            head    = 0ull; // write offset into the last staging buffer
+    };
+
+    struct Acquire
+    {
+        uint64_t                       value   = 0ull;
+        Vector<VkBufferMemoryBarrier2> buffers = {};
+        Vector<VkImageMemoryBarrier2>  images  = {};
+    };
+
+    // transfer work is signaled on a dedicated timeline
+    VulkanSemaphore timeline;
+    VkCommandPool   command_pool  = VK_NULL_HANDLE;
+    VkQueue         command_queue = VK_NULL_HANDLE;
+
+    // queue families involved in ownership transfers
+    uint32_t src_family = VK_QUEUE_FAMILY_IGNORED;
+    uint32_t dst_family = VK_QUEUE_FAMILY_IGNORED;
+
+    // timeline tracking
+    uint64_t submitted_value = 0ull;
+    uint64_t completed_value = 0ull;
+
+    Batch                recording = {};
+    Vector<Batch>        inflight  = {};
+    Vector<Acquire>      acquires  = {};
+    Vector<VulkanBuffer> recycled  = {};
+
+    // uploads may be issued from any thread
+    std::mutex mutex;
+
+    // implementation in VkUpload.cpp
+    void init();
+    void destroy();
+    void flush();
+    void retire();
+    void wait(uint64_t value);
+    bool ready(uint64_t value);
+    void acquire(VulkanCommandBuffer& cmd, uint64_t value, GPUBarrierSyncFlags sync);
+    auto upload(VulkanBuffer& buffer, GPUSize64 offset, const void* data, GPUSize64 size) -> uint64_t;
+    auto upload(VulkanTexture& texture, const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size) -> uint64_t;
+
+private:
+    auto begin() -> Batch&;
+    auto stage(const void* data, GPUSize64 size, GPUSize64 alignment, VkBuffer& buffer) -> GPUSize64;
+    auto ownership_transfer() const -> bool { return src_family != dst_family; }
+};
+
+// frames are paced on a single timeline, frame N signals N + 1 once its work completes on GPU.
+// work of the frame on other queues is included, each of them signals a timeline of its own
+// at the end of the frame, and the graphics queue waits on those before signaling the frame.
+struct VulkanFramePacer
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Slot
+    {
+        VkQueryPool pool  = VK_NULL_HANDLE; // frame begin and end timestamps
+        uint64_t    value = 0ull;           // timeline value signaled by the frame using this slot
+        bool        began = false;          // begin timestamp has been written
+        float       cpu   = 0.0f;           // CPU time of the frame using this slot
+    };
+
+    VulkanSemaphore timeline;
+    Vector<Slot>    slots;
+    uint            current = 0; // slot of the current frame
+
+    // queues other than graphics submitted to during the current frame
+    HashMap<VkQueue, VulkanSemaphore> queue_timelines;
+    Vector<VkQueue>                   queues;
+
+    // command buffers are created and submitted from any thread
+    std::mutex mutex;
+
+    // pacing parameters
+    uint frames      = 0; // 0 to use all frame slots
+    bool low_latency = false;
+
+    // measurements
+    GPUFrameTiming    timing       = {};
+    uint64_t          last_end     = 0ull; // end timestamp of the last measured frame
+    float             cpu_estimate = 0.0f; // smoothed CPU time (in milliseconds)
+    float             gpu_estimate = 0.0f; // smoothed GPU time (in milliseconds)
+    Clock::time_point frame_start  = {};
+    bool              timestamps   = false;
+
+    // implementation in VkPacer.cpp
+    void init();
+    void destroy();
+    void begin(uint frame);
+    void end(uint frame);
+    void mark(VulkanCommandBuffer& cmd);
+    void track(VkQueue queue);
+    auto completed() -> uint64_t;
+    auto frames_in_flight() const -> uint;
+
+private:
+    void measure(Slot& slot);
+    bool wait(uint64_t value, uint64_t timeout = UINT64_MAX);
+};
+
+// a single access to a buffer or a texture subresource
+struct VulkanResourceAccess
+{
+    VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2        access = VK_ACCESS_2_NONE;
+    VkImageLayout         layout = VK_IMAGE_LAYOUT_UNDEFINED; // always undefined for buffers
+
+    bool writes() const;
+};
+
+// accesses since the last write, used to decide whether the next access needs a barrier
+struct VulkanResourceState
+{
+    VkImageLayout         layout       = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags2 write_stages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2        write_access = VK_ACCESS_2_NONE;
+    VkPipelineStageFlags2 read_stages  = VK_PIPELINE_STAGE_2_NONE; // readers already synchronized with the last write
+    VkAccessFlags2        read_access  = VK_ACCESS_2_NONE;
+
+    // implementation in VkTracker.cpp
+    bool transition(const VulkanResourceAccess& next, VulkanResourceAccess& src);
+    void merge(const VulkanResourceAccess& next);
+};
+
+// resource state within a single command buffer
+struct VulkanTrackedResource
+{
+    VkBuffer             buffer       = VK_NULL_HANDLE;
+    VkImage              image        = VK_NULL_HANDLE;
+    VkImageAspectFlags   aspects      = 0;
+    uint32_t             mip_level    = 0;
+    uint32_t             array_layer  = 0;
+    uint32_t             pass         = 0;     // last render pass using this resource
+    bool                 synchronized = false; // a barrier has been recorded since the first access
+    VulkanResourceAccess first        = {};    // accesses before the first barrier, patched at submission
+    VulkanResourceState  state        = {};    // state after all recorded commands
+};
+
+// resource states across command buffers, advanced in submission order
+struct VulkanResourceTracker
+{
+    HashMap<uint64_t, VulkanResourceState> states = {};
+    std::mutex                             mutex;
+
+    static auto key(GPUBufferHandle buffer) -> uint64_t { return (1ull << 63) | buffer.value; }
+    static auto key(GPUTextureHandle texture, uint32_t mip_level, uint32_t array_layer) -> uint64_t
+    {
+        return (uint64_t(texture.value) << 32) | (uint64_t(mip_level) << 16) | array_layer;
+    }
+
+    // implementation in VkTracker.cpp
+    void set(GPUTextureHandle texture, const VkImageSubresourceRange& range, const VulkanResourceState& state);
+    void forget(GPUBufferHandle buffer);
+    void forget(GPUTextureHandle texture, uint32_t mip_levels, uint32_t array_layers);
+    auto patch(VulkanCommandBuffer& cmd) -> VkCommandBuffer;
+};
+
 struct VulkanCommandBuffer
 {
     // used to check vulkan buffer usage,
@@ -337,9 +865,6 @@ struct VulkanCommandBuffer
     // frame id must match VulkanFrame's id
     uint32_t frame_id = 0u;
 
-    // CPU/GPU synchronization
-    VulkanFence fence;
-
     // Query sets
     VulkanQuerySet     query_set;
     Optional<uint32_t> query_index;
@@ -351,21 +876,127 @@ struct VulkanCommandBuffer
     VkPipeline          last_bound_pipeline = VK_NULL_HANDLE;
     VkPipelineLayout    last_bound_layout   = VK_NULL_HANDLE;
     VkPipelineBindPoint last_bound_point    = VK_PIPELINE_BIND_POINT_COMPUTE;
+    bool                pipeline_pending    = false; // the last set pipeline is still compiling
+
+    // shadow state, used to drop redundant state commands.
+    // slots beyond the shadowed range are always emitted.
+    static constexpr uint MAX_BIND_GROUPS     = 8;
+    static constexpr uint MAX_VERTEX_BUFFERS  = 16;
+    static constexpr uint MAX_PUSH_CONSTANTS  = 256;
+    static constexpr uint PUSH_CONSTANT_WORDS = MAX_PUSH_CONSTANTS / sizeof(uint32_t);
+
+    struct BoundBindGroup
+    {
+        VkDescriptorSet  descriptor = VK_NULL_HANDLE;
+        Vector<uint32_t> offsets    = {};
+    };
+
+    struct BoundBuffer
+    {
+        VkBuffer     buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size   = 0;
+        VkIndexType  type   = VK_INDEX_TYPE_UINT32; // only used by index buffer
+
+        bool operator==(const BoundBuffer& other) const
+        {
+            return buffer == other.buffer && offset == other.offset && size == other.size && type == other.type;
+        }
+
+        bool operator!=(const BoundBuffer& other) const { return !(*this == other); }
+    };
+
+    Array<BoundBindGroup, MAX_BIND_GROUPS> bound_bind_groups     = {};
+    Array<BoundBuffer, MAX_VERTEX_BUFFERS> bound_vertex_buffers  = {}; // state recorded into the command buffer
+    Array<BoundBuffer, MAX_VERTEX_BUFFERS> vertex_buffers        = {}; // state requested by the user
+    uint32_t                               dirty_vertex_buffers  = 0;  // slots where the two above differ
+    BoundBuffer                            bound_index_buffer    = {};
+    Optional<VkViewport>                   bound_viewport        = {};
+    Optional<VkRect2D>                     bound_scissor         = {};
+    Array<uint32_t, PUSH_CONSTANT_WORDS>   push_constants        = {};
+    uint64_t                               push_constants_valid  = 0; // one bit per word of push_constants
+    VkShaderStageFlags                     push_constants_stages = 0;
+
+    // redundant state statistics, accumulated into VulkanRHI when recording ends
+    GPUCommandStats stats = {};
+
+    // created by the user and not submitted yet, bundles stay open for the rest of the frame
+    bool open = false;
+
+    // automatic barriers, see GPUCommandBufferDescriptor::tracked.
+    // untracked command buffers only record the states set by explicit barriers.
+    bool                                     tracked           = false;
+    GPUQueueType                             queue             = GPUQueueType::DEFAULT;
+    HashMap<uint64_t, VulkanTrackedResource> tracked_resources = {};
+    Vector<VkBufferMemoryBarrier2>           buffer_barriers   = {}; // pending until the next command
+    Vector<VkImageMemoryBarrier2>            image_barriers    = {}; // pending until the next command
+
+    // resources referenced by the current bindings, tracked before each draw or dispatch
+    Array<GPUBindGroupHandle, MAX_BIND_GROUPS> bind_group_handles    = {};
+    Array<GPUBufferHandle, MAX_VERTEX_BUFFERS> vertex_buffer_handles = {};
+    GPUBufferHandle                            index_buffer_handle   = {};
+    bool                                       bindings_tracked      = false;
+
+    // render passes recorded by tracked command buffers are deferred,
+    // their contents go to secondary command buffers, so that barriers
+    // required within the pass are recorded before the pass begins.
+    struct DeferredRenderPass
+    {
+        VkCommandBuffer                   primary        = VK_NULL_HANDLE;
+        Vector<VkCommandBuffer>           contents       = {};
+        Vector<VkRenderingAttachmentInfo> colors         = {};
+        Vector<VkFormat>                  color_formats  = {};
+        VkRenderingAttachmentInfo         depth          = {};
+        VkRenderingAttachmentInfo         stencil        = {};
+        VkRenderingInfo                   rendering      = {};
+        VkFormat                          depth_format   = VK_FORMAT_UNDEFINED;
+        VkFormat                          stencil_format = VK_FORMAT_UNDEFINED;
+        VkSampleCountFlagBits             samples        = VK_SAMPLE_COUNT_1_BIT;
+    };
+
+    Optional<DeferredRenderPass> deferred_pass;
+    uint32_t                     pass_index = 0; // increased by each render pass
+
+    // active pipeline statistics query, begun and ended in the primary command buffer
+    VkQueryPool                   statistics_pool  = VK_NULL_HANDLE;
+    uint32_t                      statistics_query = 0;
+    VkQueryPipelineStatisticFlags statistics       = 0; // counters inherited by deferred pass contents
 
     // GPU/GPU synchronization
     Vector<VkSemaphoreSubmitInfo> wait_semaphores   = {};
     Vector<VkSemaphoreSubmitInfo> signal_semaphores = {};
+    uint64_t                      upload_value      = 0ull; // upload timeline value this command buffer waits for
 
-    // additional resources to be clean-up after command buffer is reset
-    Vector<VulkanBuffer> temporary_buffers;
+    // staging buffers of inline updates, recycled after command buffer is reset
+    Vector<VulkanStagingPool::Buffer> temporary_buffers;
+    GPUSize64                         temporary_head = 0ull; // write offset into the last staging buffer
 
     // implementation in VkCommandBuffer.cpp
     void wait(const VulkanSemaphore& fence, GPUBarrierSyncFlags sync);
     void signal(const VulkanSemaphore& fence, GPUBarrierSyncFlags sync);
     void reset();
-    void submit();
+    void submit(VkCommandBuffer prologue = VK_NULL_HANDLE);
     void begin();
+    void begin(const GPUCommandBundleDescriptor& desc);
     void end();
+    void flush_vertex_buffers();
+    void invalidate_bindings();
+    void invalidate_state();
+    void end_statistics(VkCommandBuffer primary);
+
+    // implementation in VkTracker.cpp
+    void track(GPUBufferHandle buffer, const VulkanResourceAccess& access);
+    void track(GPUTextureHandle texture, const VkImageSubresourceRange& range, const VulkanResourceAccess& access);
+    void track(GPUTextureViewHandle view, const VulkanResourceAccess& access);
+    void track_bindings();
+    void flush_barriers();
+    void begin_deferred_pass(DeferredRenderPass&& pass);
+    void next_deferred_contents();
+    void end_deferred_pass();
+
+private:
+    void track(uint64_t key, VulkanTrackedResource&& resource, const VulkanResourceAccess& access);
+    void restore_state();
 };
 
 struct VulkanCommandPool
@@ -400,39 +1031,44 @@ struct VulkanFrame
 
     // NOTE: VulkanFrame does NOT own these synchronization primitives.
     // These should be copied from VulkanSwapchain::Frame when frame is selected.
-    VulkanFence     inflight_fence; // only the most recent one
-    GPUFenceHandle  image_available_semaphore;
-    GPUFenceHandle  render_complete_semaphore;
-    Vector<VkFence> existing_fences;
+    GPUFenceHandle image_available_semaphore;
+    GPUFenceHandle render_complete_semaphore;
+
+    // vulkan command pools must be externally synchronized,
+    // each recording thread therefore owns its own set of pools.
+    // pools of threads which did not record since the last reset of this frame are released,
+    // so short-lived threads do not leak them. a recycled thread id only ever finds the pools
+    // of an exited thread, which no longer records into them.
+    struct CommandPools
+    {
+        VulkanCommandPool compute;
+        VulkanCommandPool graphics;
+        VulkanCommandPool transfer;
+        bool              used = false; // allocated from since the last reset
+    };
 
-    VulkanCommandPool compute_command_pool;
-    VulkanCommandPool graphics_command_pool;
-    VulkanCommandPool transfer_command_pool;
+    HashMap<std::thread::id, CommandPools> command_pools;
 
     VulkanDescriptorPool descriptor_pool{};
 
-    // allocate command buffers
-    Vector<VulkanCommandBuffer> allocated_command_buffers;
+    // transient upload memory, recycled when this frame is reused
+    VulkanUploadRing upload_ring{};
 
-    // shortcut for cmd buffer
-    auto& command(GPUCommandEncoderHandle handle)
-    {
-        return allocated_command_buffers.at(handle.value);
-    }
-
-    // shortcut for descriptor set
-    auto descriptor(GPUBindGroupHandle handle)
-    {
-        return descriptor_pool.allocated.at(handle.value);
-    }
+    // allocate command buffers (deque keeps references stable while other threads allocate)
+    Deque<VulkanCommandBuffer> allocated_command_buffers;
 
     // implementation in VkFrame.cpp
     void init();
-    void wait();
     void reset();
     void free();
     auto allocate(GPUQueueType type, bool primary) -> GPUCommandEncoderHandle;
+    auto command(GPUCommandEncoderHandle handle) -> VulkanCommandBuffer&;
+    auto descriptor(GPUBindGroupHandle handle) -> VkDescriptorSet;
+    auto bindings(GPUBindGroupHandle handle) -> const Vector<VulkanBindingResource>&;
     void destroy();
+
+private:
+    auto thread_command_pools() -> CommandPools&;
 };
 
 struct VulkanSwapchain
@@ -464,8 +1100,7 @@ struct VulkanSwapchain
     // swapchain frames
     Vector<Frame> frames = {};
 
-    // fence objects
-    Vector<VulkanFence>    inflight_fences;
+    // semaphore objects
     Vector<GPUFenceHandle> image_available_semaphores;
     Vector<GPUFenceHandle> render_complete_semaphores;
 
@@ -494,10 +1129,58 @@ struct VulkanRHI
     VmaAllocator       alloc;
     QueueFamilyIndices queues;
 
+    // memory pools for buffer sub-allocation
+    VulkanMemoryPools pools;
+
+    // memory budget tracking
+    VulkanMemoryBudget budget;
+
+    // asynchronous uploads on the transfer queue
+    VulkanUploadService uploads;
+
+    // deferred destruction of user-deleted objects
+    VulkanDeleteQueue deletes;
+
+    // staging memory for inline buffer updates
+    VulkanStagingPool staging;
+
+    // opt-in incremental defragmentation
+    VulkanDefragmenter defrag;
+
+    // asynchronous buffer mapping, fulfilled once the requesting frame completes
+    VulkanMapQueue maps;
+
+    // batched command buffer submissions
+    VulkanSubmitQueue submits;
+
+    // shared samplers and shader modules
+    VulkanSamplerCache sampler_cache;
+    VulkanShaderCache  shader_cache;
+
+    // resource states for tracked command buffers
+    VulkanResourceTracker tracker;
+
+    // frame pacing on the frame timeline
+    VulkanFramePacer pacer;
+
+    // asynchronous pipeline compilation
+    VulkanPipelineCompiler compiler;
+
+    // synchronization for multi-threaded command recording
+    std::shared_mutex frame_mutex; // per-frame allocations (command buffers, descriptors, transient memory)
+    std::mutex        queue_mutex; // queue submission and presentation
+    std::mutex        stats_mutex; // command statistics
+
+    // redundant state statistics of all finished command buffers
+    GPUCommandStats command_stats = {};
+
     // additional properties
     VkPhysicalDeviceProperties  props  = {};
     VkPhysicalDeviceProperties2 props2 = {};
 
+    // secondary command buffers may execute within an active query
+    bool inherited_queries = false;
+
     // frame objects
     Vector<VulkanFrame> frames = {};
 
@@ -572,6 +1255,7 @@ namespace api
     bool create_buffer(GPUBufferHandle& buffer, const GPUBufferDescriptor& desc);
     void delete_buffer(GPUBufferHandle buffer);
     void map_buffer(GPUBufferHandle buffer, GPUMapMode mode, GPUSize64 offset, GPUSize64 size);
+    void map_buffer_async(GPUBufferHandle buffer, GPUMapMode mode, GPUSize64 offset, GPUSize64 size, const GPUBufferMapCallback& callback);
     void unmap_buffer(GPUBufferHandle buffer);
     void get_mapped_range(GPUBufferHandle buffer, MappedBufferRange& range);
     void get_mapped_state(GPUBufferHandle buffer, GPUMapState& state);
@@ -589,6 +1273,7 @@ namespace api
     // shader apis
     bool create_shader_module(GPUShaderModuleHandle& shader, const GPUShaderModuleDescriptor& desc);
     void delete_shader_module(GPUShaderModuleHandle shader);
+    bool get_shader_module_hash(GPUShaderModuleHandle shader, GPUSize64& hash);
 
     // bvh blas apis
     bool create_blas(GPUBlasHandle& blas, const GPUBlasDescriptor& descriptor, GPUBlasGeometrySizeDescriptors sizes);
@@ -600,9 +1285,27 @@ namespace api
     void delete_tlas(GPUTlasHandle tlas);
     bool get_tlas_sizes(GPUTlasHandle tlas, GPUBVHSizes& sizes);
 
+    // memory apis
+    bool get_memory_pool_stats(GPUMemoryPool pool, GPUMemoryPoolStats& stats);
+    bool get_memory_stats(GPUMemoryStats& stats);
+    void set_memory_budget_callback(float threshold, const GPUMemoryBudgetCallback& callback);
+    bool get_command_stats(GPUCommandStats& stats);
+    bool get_shader_module_stats(GPUShaderModuleStats& stats);
+    bool get_staging_stats(GPUStagingStats& stats);
+    bool get_defragment_stats(GPUDefragmentStats& stats);
+    bool allocate_transient(GPUSize64 size, GPUSize64 alignment, GPUTransientAllocation& allocation);
+
+    // upload apis
+    bool upload_buffer(GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size, GPUUploadToken& token);
+    bool upload_texture(const GPUTexelCopyTextureInfo& destination, const void* data, const GPUTexelCopyBufferLayout& layout, const GPUExtent3D& size, GPUUploadToken& token);
+    void flush_uploads();
+    bool query_upload(GPUUploadToken token);
+    void wait_upload(GPUUploadToken token);
+
     // query set apis
     bool create_query_set(GPUQuerySetHandle& query_set, const GPUQuerySetDescriptor& descriptor);
     void delete_query_set(GPUQuerySetHandle query_set);
+    void reset_query_set(GPUQuerySetHandle query_set, GPUSize32 first_query, GPUSize32 query_count);
 
     // bind group layout apis
     bool create_bind_group_layout(GPUBindGroupLayoutHandle& handle, const GPUBindGroupLayoutDescriptor& desc);
@@ -619,10 +1322,16 @@ namespace api
     void delete_compute_pipeline(GPUComputePipelineHandle pipeline);
     bool create_raytracing_pipeline(GPURayTracingPipelineHandle& handle, const GPURayTracingPipelineDescriptor& desc);
     void delete_raytracing_pipeline(GPURayTracingPipelineHandle pipeline);
+    bool get_render_pipeline_status(GPURenderPipelineHandle pipeline, GPUPipelineStatus& status);
+    bool get_compute_pipeline_status(GPUComputePipelineHandle pipeline, GPUPipelineStatus& status);
+    void wait_pipelines();
 
     // vulkan frame logic
     void new_frame();
     void end_frame();
+    void set_frame_pacing(const GPUFramePacing& pacing);
+    bool get_frame_timing(GPUFrameTiming& timing);
+    bool get_frame_slot(GPUFrameSlot& slot);
 
     // vulkan swapchain
     bool acquire_next_frame(GPUSurfaceHandle surface, GPUTextureHandle& texture, GPUTextureViewHandle& view, GPUFenceHandle& image_available_fence, GPUFenceHandle& render_complete_fence, bool& suboptimal);
@@ -635,10 +1344,12 @@ namespace api
     bool create_command_buffer(GPUCommandEncoderHandle& cmdbuffer, const GPUCommandBufferDescriptor& descriptor);
     bool create_command_bundle(GPUCommandEncoderHandle& cmdbuffer, const GPUCommandBundleDescriptor& descriptor);
     bool submit_command_buffer(GPUCommandEncoderHandle cmdbuffer);
+    bool finish_command_bundle(GPUCommandEncoderHandle cmdbuffer);
 
     // device/queue related
     void wait_idle();
     void wait_fence(GPUFenceHandle handle);
+    void flush_submissions();
 
 } // namespace api
 
@@ -650,8 +1361,10 @@ namespace cmd
     void pop_debug_group(GPUCommandEncoderHandle cmdbuffer);
     void wait_fence(GPUCommandEncoderHandle cmdbuffer, GPUFenceHandle fence, GPUBarrierSyncFlags sync);
     void signal_fence(GPUCommandEncoderHandle cmdbuffer, GPUFenceHandle fence, GPUBarrierSyncFlags sync);
+    void wait_upload(GPUCommandEncoderHandle cmdbuffer, GPUUploadToken token, GPUBarrierSyncFlags sync);
     void begin_render_pass(GPUCommandEncoderHandle cmdbuffer, const GPURenderPassDescriptor& descriptor);
     void end_render_pass(GPUCommandEncoderHandle cmdbuffer);
+    void execute_bundles(GPUCommandEncoderHandle cmdbuffer, GPUCommandEncoderHandles bundles);
     void set_render_pipeline(GPUCommandEncoderHandle cmdbuffer, GPURenderPipelineHandle pipeline);
     void set_compute_pipeline(GPUCommandEncoderHandle cmdbuffer, GPUComputePipelineHandle pipeline);
     void set_raytracing_pipeline(GPUCommandEncoderHandle cmdbuffer, GPURayTracingPipelineHandle pipeline);
@@ -663,9 +1376,12 @@ namespace cmd
     void draw_indexed(GPUCommandEncoderHandle cmdbuffer, GPUSize32 index_count, GPUSize32 instance_count, GPUSize32 first_index, GPUSignedOffset32 base_vertex, GPUSize32 first_instance);
     void draw_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUSize32 draw_count);
     void draw_indexed_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUSize32 draw_count);
+    void draw_indirect_count(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count);
+    void draw_indexed_indirect_count(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset, GPUBufferHandle count_buffer, GPUSize64 count_offset, GPUSize32 max_draw_count);
     void dispatch_workgroups(GPUCommandEncoderHandle cmdbuffer, GPUSize32 x, GPUSize32 y, GPUSize32 z);
     void dispatch_workgroups_indirect(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle indirect_buffer, GPUSize64 indirect_offset);
     void copy_buffer_to_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle source, GPUSize64 source_offset, GPUBufferHandle destination, GPUSize64 destination_offset, GPUSize64 size);
+    void update_buffer(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle buffer, GPUSize64 offset, const void* data, GPUSize64 size);
     void copy_buffer_to_texture(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyBufferInfo& source, const GPUTexelCopyTextureInfo& destination, GPUExtent3D copy_size);
     void copy_texture_to_buffer(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyTextureInfo& source, const GPUTexelCopyBufferInfo& destination, const GPUExtent3D& copy_size);
     void copy_texture_to_texture(GPUCommandEncoderHandle cmdbuffer, const GPUTexelCopyTextureInfo& source, const GPUTexelCopyTextureInfo& destination, const GPUExtent3D& copy_size);
@@ -677,13 +1393,18 @@ namespace cmd
     void begin_occlusion_query(GPUCommandEncoderHandle cmdbuffer, GPUSize32 query_index);
     void end_occlusion_query(GPUCommandEncoderHandle cmdbuffer);
     void write_timestamp(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
+    void begin_pipeline_statistics_query(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
+    void end_pipeline_statistics_query(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index);
     void write_blas_properties(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 query_index, GPUBlasHandle blas);
     void resolve_query_set(GPUCommandEncoderHandle cmdbuffer, GPUQuerySetHandle query_set, GPUSize32 first_query, GPUSize32 query_count, GPUBufferHandle destination, GPUSize64 destination_offset);
     void memory_barrier(GPUCommandEncoderHandle cmdbuffer, GPUMemoryBarriers barriers);
     void buffer_barrier(GPUCommandEncoderHandle cmdbuffer, GPUBufferBarriers barriers);
     void texture_barrier(GPUCommandEncoderHandle cmdbuffer, GPUTextureBarriers barriers);
+    void update_tlas_instances(GPUCommandEncoderHandle cmdbuffer, GPUTlasHandle tlas, GPUTlasInstanceUpdates updates);
     void build_tlases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUTlasBuildEntries entries);
     void build_blases(GPUCommandEncoderHandle cmdbuffer, GPUBufferHandle scratch_buffer, GPUBlasBuildEntries entries);
+    void copy_blas(GPUCommandEncoderHandle cmdbuffer, GPUBlasHandle old_blas, GPUBlasHandle new_blas);
+    void defragment_memory(GPUCommandEncoderHandle cmdbuffer, const GPUDefragmentDescriptor& descriptor);
 } // namespace cmd
 
 auto get_logger() -> Logger;
@@ -729,6 +1450,7 @@ auto vkenum(GPUBarrierSyncFlags flags) -> VkPipelineStageFlags2;
 auto vkenum(GPUBarrierAccessFlags flags) -> VkAccessFlags2;
 auto vkenum(GPUBVHFlags flags) -> VkBuildAccelerationStructureFlagsKHR;
 auto vkenum(GPUBVHGeometryFlags flags) -> VkGeometryFlagsKHR;
+auto vkenum(GPUQueryStatisticFlags flags) -> VkQueryPipelineStatisticFlags;
 
 // vulkan rhi
 void set_rhi(VulkanRHI* instance);
@@ -756,7 +1478,7 @@ auto find_queue_family_indices(VkPhysicalDevice device, VkSurfaceKHR surface) ->
 // swaphain utils
 auto query_swapchain_support(VkPhysicalDevice adapter, VkSurfaceKHR surface) -> SwapchainSupportDetails;
 auto choose_swap_surface_format(const Vector<VkSurfaceFormatKHR>& availableFormats) -> VkSurfaceFormatKHR;
-auto choose_swap_present_mode(const Vector<VkPresentModeKHR>& availablePresentModes) -> VkPresentModeKHR;
+auto choose_swap_present_mode(GPUPresentMode mode, const Vector<VkPresentModeKHR>& availablePresentModes) -> VkPresentModeKHR;
 auto choose_swap_extent(const GPUSurfaceDescriptor& desc, const VkSurfaceCapabilitiesKHR& capabilities) -> VkExtent2D;
 
 // size of
@@ -772,13 +1494,13 @@ T& fetch_resource(VulkanResourceManager<T>& manager, Handle handle)
         exit(1);
     }
 
-    // check resource range
-    if (handle.value >= manager.data.size()) {
-        get_logger()->error("Resource handle {} with value={} access out of range!", Handle::type_name(), handle.value);
+    // check resource liveness (out of range or stale generation)
+    if (!manager.contains(handle.value)) {
+        get_logger()->error("Resource handle {} with value={} is stale or out of range!", Handle::type_name(), handle.value);
         exit(1);
     }
 
-    T& resource = manager.data.at(handle.value);
+    T& resource = manager.at(handle.value);
     if (!resource.valid()) {
         get_logger()->error("Resource handle {} with value={} has invalid object!", Handle::type_name(), handle.value);
         exit(1);
@@ -786,6 +1508,21 @@ T& fetch_resource(VulkanResourceManager<T>& manager, Handle handle)
     return resource;
 }
 
+template <typename T, typename Handle>
+void defer_delete(VulkanResourceManager<T>& manager, Handle handle)
+{
+    // stale handles are ignored, same as deleting an invalid handle
+    if (!manager.contains(handle.value))
+        return;
+
+    // the handle is invalidated right away, the object itself outlives the frames in flight
+    auto rhi = get_rhi();
+    auto obj = manager.release(handle.value);
+    rhi->deletes.push(rhi->current_frame_index, [obj]() mutable {
+        VulkanDestroyer<T>()(obj);
+    });
+}
+
 inline VKAPI_ATTR VkBool32 VKAPI_CALL vulkan_debug_callback(
     VkDebugUtilsMessageSeverityFlagBitsEXT      messageSeverity,
     VkDebugUtilsMessageTypeFlagsEXT             messageType,
@@ -0,0 +1,183 @@
+#include "helper.h"
+#include <Lyra/Render/RPI/GPUBlasBuilder.h>
+
+// a few grid meshes, built one per batch under a tiny scratch budget
+constexpr uint NUM_MESHES    = 4;
+constexpr uint GRID_SEGMENTS = 32;
+
+struct BlasMesh
+{
+    GPUBuffer vbuffer;
+    GPUBuffer ibuffer;
+    uint      vertex_count = 0;
+    uint      index_count  = 0;
+};
+
+struct BlasCompactionApp : public TestApp
+{
+    Vector<BlasMesh> meshes;
+    Vector<uint>     entries;
+    GPUBlasBuilder   builder;
+
+    explicit BlasCompactionApp(const TestAppDescriptor& desc) : TestApp(desc), builder(builder_descriptor())
+    {
+        setup_meshes();
+    }
+
+    static auto builder_descriptor() -> GPUBlasBuilderDescriptor
+    {
+        auto desc           = GPUBlasBuilderDescriptor{};
+        desc.scratch_budget = 1;
+        return desc;
+    }
+
+    void setup_meshes()
+    {
+        auto& device = RHI::get_current_device();
+
+        for (uint m = 0; m < NUM_MESHES; m++) {
+            uint segments = GRID_SEGMENTS * (m + 1);
+
+            auto mesh         = BlasMesh{};
+            mesh.vertex_count = (segments + 1) * (segments + 1);
+            mesh.index_count  = segments * segments * 6;
+
+            mesh.vbuffer = execute([&]() {
+                auto desc               = GPUBufferDescriptor{};
+                desc.label              = "blas_vertex_buffer";
+                desc.size               = sizeof(glm::vec3) * mesh.vertex_count;
+                desc.usage              = GPUBufferUsage::BLAS_INPUT | GPUBufferUsage::MAP_WRITE;
+                desc.mapped_at_creation = true;
+                desc.virtual_address    = true;
+                return device.create_buffer(desc);
+            });
+
+            mesh.ibuffer = execute([&]() {
+                auto desc               = GPUBufferDescriptor{};
+                desc.label              = "blas_index_buffer";
+                desc.size               = sizeof(uint) * mesh.index_count;
+                desc.usage              = GPUBufferUsage::BLAS_INPUT | GPUBufferUsage::MAP_WRITE;
+                desc.mapped_at_creation = true;
+                desc.virtual_address    = true;
+                return device.create_buffer(desc);
+            });
+
+            auto vertices = mesh.vbuffer.get_mapped_range<glm::vec3>();
+            auto indices  = mesh.ibuffer.get_mapped_range<uint>();
+
+            for (uint y = 0; y <= segments; y++)
+                for (uint x = 0; x <= segments; x++)
+                    vertices.at(y * (segments + 1) + x) = {float(x) / segments, float(y) / segments, 0.0f};
+
+            uint index = 0;
+            for (uint y = 0; y < segments; y++) {
+                for (uint x = 0; x < segments; x++) {
+                    uint corner = y * (segments + 1) + x;
+                    indices.at(index++) = corner;
+                    indices.at(index++) = corner + 1;
+                    indices.at(index++) = corner + segments + 1;
+                    indices.at(index++) = corner + 1;
+                    indices.at(index++) = corner + segments + 2;
+                    indices.at(index++) = corner + segments + 1;
+                }
+            }
+
+            mesh.vbuffer.unmap();
+            mesh.ibuffer.unmap();
+            meshes.push_back(mesh);
+        }
+
+        for (auto& mesh : meshes) {
+            auto geometry               = GPUBlasTriangleGeometry{};
+            geometry.size.vertex_format = GPUVertexFormat::FLOAT32x3;
+            geometry.size.index_format  = GPUIndexFormat::UINT32;
+            geometry.size.vertex_count  = mesh.vertex_count;
+            geometry.size.index_count   = mesh.index_count;
+            geometry.size.flags         = GPUBVHGeometryFlag::BVH_OPAQUE;
+            geometry.vertex_buffer      = mesh.vbuffer;
+            geometry.index_buffer       = mesh.ibuffer;
+            geometry.vertex_stride      = sizeof(glm::vec3);
+
+            auto desc  = GPUBlasDescriptor{};
+            desc.label = "grid_blas";
+            desc.flags = GPUBVHFlag::ALLOW_COMPACTION | GPUBVHFlag::PREFER_FAST_TRACE;
+            entries.push_back(builder.add(desc, {geometry}));
+        }
+    }
+
+    void destroy()
+    {
+        for (auto& mesh : meshes) {
+            mesh.vbuffer.destroy();
+            mesh.ibuffer.destroy();
+        }
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // builds, queries and compacting copies are recorded outside of render passes
+        builder.update(command);
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+    }
+};
+
+TEST_CASE("rhi::vulkan::blas_compaction" * doctest::description("Building BLAS in batches under a scratch budget, then compacting them from asynchronously read back sizes."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 16;
+    desc.latency        = 2;
+    desc.features       = {GPUFeatureName::RAYTRACING};
+
+    BlasCompactionApp app(desc);
+    app.run();
+
+    // every mesh is built in a batch of its own, and compacted a few frames later
+    auto stats = app.builder.get_stats();
+    CHECK(stats.builds == NUM_MESHES);
+    CHECK(stats.batches == NUM_MESHES);
+    CHECK(stats.compactions > 0);
+    CHECK(stats.resident_size < stats.built_size);
+    CHECK(app.builder.pending() == 0);
+    MESSAGE("blas memory: ", stats.built_size, " bytes built, ", stats.resident_size, " bytes after ", stats.compactions, " compactions");
+
+    // compacted blas replace the originals
+    for (auto entry : app.entries)
+        CHECK(app.builder.get(entry).valid());
+
+    app.destroy();
+}
@@ -0,0 +1,104 @@
+#include "helper.h"
+
+// small updates per frame, all packed into the staging buffers of a single command buffer
+constexpr uint NUM_BUFFER_UPDATES = 256;
+
+struct BufferUpdateApp : public TestApp
+{
+    GPUBuffer buffer;
+    uint      frame = 0;
+
+    explicit BufferUpdateApp(const TestAppDescriptor& desc) : TestApp(desc)
+    {
+        setup_buffers();
+    }
+
+    void setup_buffers()
+    {
+        auto& device = RHI::get_current_device();
+
+        buffer = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "updated_buffer";
+            desc.size  = sizeof(uint) * NUM_BUFFER_UPDATES;
+            desc.usage = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            return device.create_buffer(desc);
+        });
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // inline updates are recorded outside of render passes
+        for (uint i = 0; i < NUM_BUFFER_UPDATES; i++)
+            command.update_buffer(buffer, sizeof(uint) * i, frame * NUM_BUFFER_UPDATES + i);
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+
+        frame++;
+    }
+};
+
+TEST_CASE("rhi::vulkan::buffer_update" * doctest::description("Updating buffers inline from command buffers, with staging buffers recycled across frames."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 8;
+    desc.latency        = 2;
+
+    BufferUpdateApp app(desc);
+    app.run();
+
+    // stats cover the second to last frame, by then every frame in flight owns a recycled staging buffer
+    auto stats = RHI::get_current_device().get_staging_stats();
+    CHECK(stats.allocations == 0);
+    CHECK(stats.reuses == 1);
+    CHECK(stats.pooled_buffers == desc.latency);
+
+    // each frame submits its command buffer along with the frame timeline markers, batched into a single queue submit
+    auto commands = RHI::get_current_device().get_command_stats();
+    CHECK(commands.submissions > desc.frames);
+    CHECK(commands.queue_submits <= desc.frames + 1);
+
+    // the buffer holds the values of the last frame
+    app.buffer.map(GPUMapMode::READ);
+    {
+        auto data = app.buffer.get_mapped_range<uint>();
+        for (uint i = 0; i < NUM_BUFFER_UPDATES; i++)
+            CHECK(data.at(i) == (desc.frames - 1) * NUM_BUFFER_UPDATES + i);
+    }
+    app.buffer.unmap();
+    app.buffer.destroy();
+}
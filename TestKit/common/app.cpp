@@ -1,3 +1,7 @@
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <doctest/doctest.h>
 #include "./app.h"
 
 TestApp::TestApp(const TestAppDescriptor& app_desc) : desc(app_desc)
@@ -29,8 +33,10 @@ TestApp::TestApp(const TestAppDescriptor& app_desc) : desc(app_desc)
 
     // initialize GPU device
     auto device = execute([&]() {
-        auto desc  = GPUDeviceDescriptor{};
-        desc.label = "main_device";
+        auto desc              = GPUDeviceDescriptor{};
+        desc.label             = "main_device";
+        desc.frames            = app_desc.latency;
+        desc.required_features = app_desc.features;
         return adapter.request_device(desc);
     });
 
@@ -85,22 +91,57 @@ void TestApp::run_with_window()
 
 void TestApp::run_without_window()
 {
-    GPUSurfaceTexture backbuffer;
-    backbuffer.texture = render_target.texture.handle;
-    backbuffer.view    = render_target.view.handle;
+    auto& device = RHI::get_current_device();
 
-    WindowInput input{}; // dummy window input (since we have no window)
+    // the frame timeline keeps at most latency frames in flight,
+    // hence a render target is reused only after the readback of its previous frame is mapped.
+    uint latency = std::max(desc.latency, 1u);
+    RHI::set_frame_pacing({latency, false});
 
-    RHI::new_frame();
-    update(input);
-    render(backbuffer);
-    RHI::end_frame();
+    Vector<RenderTarget> targets = {render_target};
+    while (targets.size() < std::min(latency + 1, std::max(desc.frames, 1u)))
+        targets.push_back(RenderTarget::create(get_backbuffer_format(), desc.width, desc.height));
 
-    auto& device = RHI::get_current_device();
+    WindowInput input{}; // dummy window input (since we have no window)
+    ImageWriter writer;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint i = 0; i < desc.frames; i++) {
+        render_target = targets.at(i % targets.size());
+
+        GPUSurfaceTexture backbuffer;
+        backbuffer.texture = render_target.texture.handle;
+        backbuffer.view    = render_target.view.handle;
+
+        RHI::new_frame();
+        update(input);
+        render(backbuffer);
+
+        // saved asynchronously once this frame completes, the writer picks the encoder from the extension
+        auto extension  = desc.hdr ? "exr" : "png";
+        char suffix[32] = {};
+        if (desc.frames > 1)
+            std::snprintf(suffix, sizeof(suffix), "_%04u.%s", i, extension);
+        else
+            std::snprintf(suffix, sizeof(suffix), ".%s", extension);
+
+        String name = String(desc.name) + suffix;
+        render_target.save(name.c_str(), writer);
+        RHI::end_frame();
+    }
+
+    // nothing else to render, waiting fulfills the pending readbacks
     device.wait();
+    writer.wait();
+
+    auto end     = std::chrono::high_resolution_clock::now();
+    auto seconds = std::chrono::duration<double>(end - start).count();
+    if (desc.frames > 1)
+        MESSAGE(desc.name, ": ", desc.frames / seconds, " frames/s");
 
-    String name = String(desc.name) + ".png";
-    render_target.save(name.c_str());
+    for (uint i = 1; i < targets.size(); i++)
+        targets.at(i).destroy();
+    render_target = targets.front();
 }
 
 void TestApp::postprocessing(const GPUCommandBuffer& cmd, GPUTextureHandle backbuffer)
@@ -118,6 +159,6 @@ GPUTextureFormat TestApp::get_backbuffer_format() const
     if (desc.window) {
         return swp.get_current_format();
     } else {
-        return GPUTextureFormat::RGBA8UNORM;
+        return desc.hdr ? GPUTextureFormat::RGBA16FLOAT : GPUTextureFormat::RGBA8UNORM;
     }
 }
@@ -14,6 +14,12 @@ struct TestAppDescriptor
     RHIFlags      rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
     CompileTarget compile_target = CompileTarget::SPIRV;
     CompileFlags  compile_flags  = CompileFlag::DEBUG;
+    uint          frames         = 1; // number of frames rendered without window, each saved as an image
+    uint          latency        = 2; // frames in flight without window
+    bool          hdr            = false; // frames without window are rendered in RGBA16FLOAT and saved as EXR
+
+    // device features required by the test
+    Vector<GPUFeatureName> features = {};
 };
 
 struct TestApp
@@ -1,3 +1,6 @@
+#include <cstring>
+#include <fstream>
+#include <algorithm>
 #include <stb_image_write.h>
 
 #include "render.h"
@@ -27,19 +30,41 @@ GPUExtent3D RenderTarget::copy_ext() const
     return GPUExtent3D{width, height, 1};
 }
 
-void RenderTarget::save(CString filename)
+uint RenderTarget::texel_size() const
 {
-    buffer.map(GPUMapMode::READ);
-    {
-        auto data = buffer.get_mapped_range<uint8_t>();
-        stbi_write_png(filename, width, height, 4, data.data, width * 4);
-    }
-    buffer.unmap();
+    return format == GPUTextureFormat::RGBA16FLOAT ? sizeof(uint16_t) * 4 : sizeof(uint8_t) * 4;
+}
+
+void RenderTarget::save(CString filename, ImageWriter& writer)
+{
+    // mapped once the frame copying into the buffer completes,
+    // the pixels are copied out so that the buffer can be reused while the image is encoded.
+    auto name  = String(filename);
+    auto bytes = width * height * texel_size();
+    buffer.map_async(GPUMapMode::READ, [buffer = buffer, width = width, height = height, bytes, name, &writer](GPUBufferHandle, bool success) mutable {
+        if (!success)
+            return;
+
+        auto data   = buffer.get_mapped_range<uint8_t>();
+        auto pixels = Vector<uint8_t>(data.data, data.data + bytes);
+        buffer.unmap();
+        writer.write(name, width, height, std::move(pixels));
+    });
+}
+
+void RenderTarget::destroy()
+{
+    view.destroy();
+    texture.destroy();
+    buffer.destroy();
 }
 
 RenderTarget RenderTarget::create(GPUTextureFormat format, uint width, uint height, uint samples)
 {
     RenderTarget res = {};
+    res.format       = format;
+    res.width        = width;
+    res.height       = height;
 
     GPUTextureDescriptor tex_desc{};
     tex_desc.label           = "render target";
@@ -56,14 +81,155 @@ RenderTarget RenderTarget::create(GPUTextureFormat format, uint width, uint heig
     GPUBufferDescriptor buf_desc{};
     buf_desc.label = "host backbuffer";
     buf_desc.usage = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
-    buf_desc.size  = sizeof(uint32_t) * width * height;
+    buf_desc.size  = res.texel_size() * width * height;
 
     auto& device = RHI::get_current_device();
-    res.format   = tex_desc.format;
-    res.width    = width;
-    res.height   = height;
     res.buffer   = device.create_buffer(buf_desc);
     res.texture  = device.create_texture(tex_desc);
     res.view     = res.texture.create_view();
     return res;
 }
+
+ImageWriter::ImageWriter()
+{
+    // one core is left for rendering
+    uint count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    for (uint i = 0; i < count; i++)
+        workers.emplace_back([this]() { work(); });
+}
+
+ImageWriter::~ImageWriter()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void ImageWriter::write(const String& filename, uint width, uint height, Vector<uint8_t>&& pixels)
+{
+    auto image     = Image{};
+    image.filename = filename;
+    image.width    = width;
+    image.height   = height;
+    image.pixels   = std::move(pixels);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.push_back(std::move(image));
+    }
+    wakeup.notify_one();
+}
+
+void ImageWriter::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&]() { return queued.empty() && running == 0; });
+}
+
+// single part scanline EXR with half RGBA channels, without compression (none of our dependencies encodes EXR).
+// pixels are interleaved RGBA16FLOAT, values are written as they are on a little-endian host.
+static void write_exr(const String& filename, uint width, uint height, const Vector<uint8_t>& pixels)
+{
+    Vector<uint8_t> file;
+
+    auto append = [&](const void* data, size_t size) {
+        auto bytes = reinterpret_cast<const uint8_t*>(data);
+        file.insert(file.end(), bytes, bytes + size);
+    };
+
+    auto append_attribute = [&](CString name, CString type, const void* value, int32_t size) {
+        append(name, std::strlen(name) + 1);
+        append(type, std::strlen(type) + 1);
+        append(&size, sizeof(size));
+        append(value, size);
+    };
+
+    // magic number, then version 2 without any flags
+    const uint8_t magic[] = {0x76, 0x2f, 0x31, 0x01, 0x02, 0x00, 0x00, 0x00};
+    append(magic, sizeof(magic));
+
+    // channels are sorted by name, each one is HALF (1), not linear, and not subsampled
+    const char      names[]  = {'A', 'B', 'G', 'R'};
+    const uint      source[] = {3, 2, 1, 0}; // channel index within an RGBA texel
+    Vector<uint8_t> channels;
+    for (auto name : names) {
+        const int32_t fields[] = {1, 0, 1, 1}; // pixel type, linear and reserved bytes, x and y sampling
+        channels.push_back(static_cast<uint8_t>(name));
+        channels.push_back(0);
+        channels.insert(channels.end(), reinterpret_cast<const uint8_t*>(fields), reinterpret_cast<const uint8_t*>(fields) + sizeof(fields));
+    }
+    channels.push_back(0);
+
+    const int32_t window[] = {0, 0, static_cast<int32_t>(width) - 1, static_cast<int32_t>(height) - 1};
+    const float   center[] = {0.0f, 0.0f};
+    const float   one      = 1.0f;
+    const uint8_t zero     = 0; // no compression, increasing y
+
+    append_attribute("channels", "chlist", channels.data(), static_cast<int32_t>(channels.size()));
+    append_attribute("compression", "compression", &zero, 1);
+    append_attribute("dataWindow", "box2i", window, sizeof(window));
+    append_attribute("displayWindow", "box2i", window, sizeof(window));
+    append_attribute("lineOrder", "lineOrder", &zero, 1);
+    append_attribute("pixelAspectRatio", "float", &one, sizeof(one));
+    append_attribute("screenWindowCenter", "v2f", center, sizeof(center));
+    append_attribute("screenWindowWidth", "float", &one, sizeof(one));
+    file.push_back(0);
+
+    // one scanline per block: y coordinate, data size, then each channel of the scanline in turn
+    int32_t  block_size = static_cast<int32_t>(width * 4 * sizeof(uint16_t));
+    uint64_t offset     = file.size() + height * sizeof(uint64_t);
+    for (uint y = 0; y < height; y++, offset += sizeof(int32_t) * 2 + block_size)
+        append(&offset, sizeof(offset));
+
+    auto texels = reinterpret_cast<const uint16_t*>(pixels.data());
+    for (uint y = 0; y < height; y++) {
+        int32_t line = static_cast<int32_t>(y);
+        append(&line, sizeof(line));
+        append(&block_size, sizeof(block_size));
+        for (auto channel : source)
+            for (uint x = 0; x < width; x++)
+                append(&texels[(y * width + x) * 4 + channel], sizeof(uint16_t));
+    }
+
+    std::ofstream stream(filename, std::ios::binary);
+    stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+}
+
+static bool ends_with(const String& value, CString suffix)
+{
+    auto length = std::strlen(suffix);
+    return value.size() >= length && value.compare(value.size() - length, length, suffix) == 0;
+}
+
+void ImageWriter::work()
+{
+    while (true) {
+        Image image;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [&]() { return stopping || !queued.empty(); });
+            if (stopping)
+                return;
+
+            image = std::move(queued.front());
+            queued.pop_front();
+            running++;
+        }
+
+        if (ends_with(image.filename, ".exr"))
+            write_exr(image.filename, image.width, image.height, image.pixels);
+        else
+            stbi_write_png(image.filename.c_str(), image.width, image.height, 4, image.pixels.data(), image.width * 4);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+        }
+        idle.notify_all();
+    }
+}
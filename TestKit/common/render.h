@@ -1,8 +1,41 @@
 #ifndef LYRA_TESTLIB_HELPER_RENDER_H
 #define LYRA_TESTLIB_HELPER_RENDER_H
 
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "./common.h"
 
+// encodes images into files on worker threads.
+// RGBA8 pixels are written as PNG, RGBA16FLOAT pixels as uncompressed EXR (files ending with .exr).
+struct ImageWriter
+{
+    explicit ImageWriter();
+    ~ImageWriter();
+
+    void write(const String& filename, uint width, uint height, Vector<uint8_t>&& pixels);
+    void wait();
+
+private:
+    struct Image
+    {
+        String          filename;
+        uint            width  = 0;
+        uint            height = 0;
+        Vector<uint8_t> pixels = {};
+    };
+
+    void work();
+
+    Vector<std::thread>     workers;
+    Deque<Image>            queued;
+    uint                    running  = 0;
+    bool                    stopping = false;
+    std::mutex              mutex;
+    std::condition_variable wakeup;
+    std::condition_variable idle;
+};
+
 struct RenderTarget
 {
     uint             width;
@@ -15,7 +48,9 @@ struct RenderTarget
     auto copy_src() const -> GPUTexelCopyTextureInfo;
     auto copy_dst() const -> GPUTexelCopyBufferInfo;
     auto copy_ext() const -> GPUExtent3D;
-    void save(CString name);
+    auto texel_size() const -> uint;
+    void save(CString name, ImageWriter& writer);
+    void destroy();
 
     static auto create(GPUTextureFormat format, uint width, uint height, uint samples = 1) -> RenderTarget;
 };
@@ -4,17 +4,10 @@ void SimpleTexture2D::upload()
 {
     auto& device = RHI::get_current_device();
 
-    auto command = execute([&]() {
-        auto desc  = GPUCommandBufferDescriptor{};
-        desc.queue = GPUQueueType::DEFAULT;
-        return device.create_command_buffer(desc);
-    });
-
-    auto copy_src           = GPUTexelCopyBufferInfo{};
-    copy_src.buffer         = buffer;
-    copy_src.bytes_per_row  = 0;
-    copy_src.offset         = 0;
-    copy_src.rows_per_image = height;
+    auto layout           = GPUTexelCopyBufferLayout{};
+    layout.bytes_per_row  = 0;
+    layout.offset         = 0;
+    layout.rows_per_image = height;
 
     auto copy_dst      = GPUTexelCopyTextureInfo{};
     copy_dst.texture   = texture;
@@ -27,38 +20,19 @@ void SimpleTexture2D::upload()
     copy_ext.height = height;
     copy_ext.depth  = 1;
 
-    command.resource_barrier(state_transition(texture, undefined_state(), copy_dst_state()));
-    command.copy_buffer_to_texture(copy_src, copy_dst, copy_ext);
-    command.resource_barrier(state_transition(texture, copy_dst_state(), shader_resource_state(GPUBarrierSync::PIXEL_SHADING)));
-    command.submit();
-
-    device.wait();
+    // rendering must wait on the token before sampling the texture
+    token = device.upload_texture(copy_dst, pixels.data(), layout, copy_ext);
 }
 
 SimpleTexture2D SimpleTexture2D::gradient(uint width, uint height)
 {
     SimpleTexture2D tex;
 
-    auto& adapter = RHI::get_current_adapter();
-    auto& device  = RHI::get_current_device();
-
-    uint row_pitch = align(
-        static_cast<uint>(width * sizeof(uint)),
-        adapter.properties.texture_row_pitch_alignment);
-
-    uint texels_per_row = row_pitch / sizeof(uint);
+    auto& device = RHI::get_current_device();
 
     tex.width  = width;
     tex.height = height;
 
-    tex.buffer = execute([&] {
-        auto desc  = GPUBufferDescriptor{};
-        desc.size  = row_pitch * height;
-        desc.usage = GPUBufferUsage::COPY_SRC | GPUBufferUsage::MAP_WRITE;
-        desc.label = "staging";
-        return device.create_buffer(desc);
-    });
-
     tex.texture = execute([&] {
         auto desc            = GPUTextureDescriptor{};
         desc.size.width      = width;
@@ -76,17 +50,15 @@ SimpleTexture2D SimpleTexture2D::gradient(uint width, uint height)
 
     tex.view = tex.texture.create_view();
 
-    tex.buffer.map(GPUMapMode::WRITE);
-    auto content = tex.buffer.get_mapped_range<uint>();
+    tex.pixels.resize(width * height);
     for (uint y = 0; y < height; y++) {
         for (uint x = 0; x < width; x++) {
-            uint index        = y * texels_per_row + x;
-            uint red          = uint(float(y) / float(height) * 255.0) & 0xFFu;
-            uint green        = uint(float(x) / float(width) * 255.0) & 0xFFu;
-            uint color        = (red << 0) | (green << 8) | 0xFF000000u;
-            content.at(index) = color;
+            uint index           = y * width + x;
+            uint red             = uint(float(y) / float(height) * 255.0) & 0xFFu;
+            uint green           = uint(float(x) / float(width) * 255.0) & 0xFFu;
+            uint color           = (red << 0) | (green << 8) | 0xFF000000u;
+            tex.pixels.at(index) = color;
         }
     }
-    tex.buffer.unmap();
     return tex;
 }
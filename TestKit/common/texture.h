@@ -7,9 +7,10 @@ struct SimpleTexture2D
 {
     uint           width;
     uint           height;
-    GPUBuffer      buffer;
+    Vector<uint>   pixels;
     GPUTexture     texture;
     GPUTextureView view;
+    GPUUploadToken token;
 
     void upload();
 
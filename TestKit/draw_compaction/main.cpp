@@ -0,0 +1,240 @@
+#include "helper.h"
+#include <Lyra/Render/RPI/GPUDrawCompactor.h>
+
+// candidate draws spanning several workgroups, every third one visible
+constexpr uint NUM_DRAWS      = 300;
+constexpr uint VISIBLE_PERIOD = 3;
+
+struct DrawCompactionApp : public TestApp
+{
+    GPUBuffer                  draws;
+    GPUBuffer                  visibility;
+    GPUBuffer                  output;
+    GPUBuffer                  count;
+    GPUBuffer                  readback;
+    Optional<GPUDrawCompactor> compactor;
+
+    explicit DrawCompactionApp(const TestAppDescriptor& desc) : TestApp(desc)
+    {
+        setup_buffers();
+        setup_compactor();
+    }
+
+    ~DrawCompactionApp()
+    {
+        RHI::get_current_device().wait();
+        compactor.reset();
+    }
+
+    void setup_buffers()
+    {
+        auto& device = RHI::get_current_device();
+
+        draws = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "candidate_draws";
+            desc.size  = sizeof(GPUDrawIndexedIndirectArgs) * NUM_DRAWS;
+            desc.usage = GPUBufferUsage::STORAGE | GPUBufferUsage::COPY_DST;
+            return device.create_buffer(desc);
+        });
+
+        visibility = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "draw_visibility";
+            desc.size  = sizeof(uint) * NUM_DRAWS;
+            desc.usage = GPUBufferUsage::STORAGE | GPUBufferUsage::COPY_DST;
+            return device.create_buffer(desc);
+        });
+
+        output = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "compacted_draws";
+            desc.size  = sizeof(GPUDrawIndexedIndirectArgs) * NUM_DRAWS;
+            desc.usage = GPUBufferUsage::STORAGE | GPUBufferUsage::INDIRECT | GPUBufferUsage::COPY_SRC;
+            return device.create_buffer(desc);
+        });
+
+        count = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "compacted_count";
+            desc.size  = sizeof(uint);
+            desc.usage = GPUBufferUsage::STORAGE | GPUBufferUsage::INDIRECT | GPUBufferUsage::COPY_SRC | GPUBufferUsage::COPY_DST;
+            return device.create_buffer(desc);
+        });
+
+        // compacted count first, then the compacted draws
+        readback = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "compaction_readback";
+            desc.size  = sizeof(uint) + sizeof(GPUDrawIndexedIndirectArgs) * NUM_DRAWS;
+            desc.usage = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            return device.create_buffer(desc);
+        });
+    }
+
+    void setup_compactor()
+    {
+        auto desc     = GPUDrawCompactorDescriptor{};
+        desc.compiler = *compiler;
+        compactor.emplace(desc);
+    }
+
+    void destroy()
+    {
+        draws.destroy();
+        visibility.destroy();
+        output.destroy();
+        count.destroy();
+        readback.destroy();
+    }
+
+    static auto candidate(uint i) -> GPUDrawIndexedIndirectArgs
+    {
+        auto args           = GPUDrawIndexedIndirectArgs{};
+        args.index_count    = 3 * (i + 1);
+        args.instance_count = 1;
+        args.first_index    = i;
+        args.base_vertex    = static_cast<GPUSignedOffset32>(i) - 1;
+        args.first_instance = i;
+        return args;
+    }
+
+    static bool visible(uint i)
+    {
+        return i % VISIBLE_PERIOD == 0;
+    }
+
+    static auto buffer_barrier(const GPUBuffer& buffer, GPUBarrierSync src_sync, GPUBarrierSync dst_sync, GPUBarrierAccess src_access, GPUBarrierAccess dst_access) -> GPUBufferBarrier
+    {
+        auto barrier       = GPUBufferBarrier{};
+        barrier.src_sync   = src_sync;
+        barrier.dst_sync   = dst_sync;
+        barrier.src_access = src_access;
+        barrier.dst_access = dst_access;
+        barrier.buffer     = buffer.handle;
+        barrier.offset     = 0;
+        barrier.size       = buffer.size;
+        return barrier;
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // candidate draws and their visibility
+        Vector<GPUDrawIndexedIndirectArgs> args;
+        Vector<uint>                       flags;
+        for (uint i = 0; i < NUM_DRAWS; i++) {
+            args.push_back(candidate(i));
+            flags.push_back(visible(i) ? 1 : 0);
+        }
+        command.update_buffer(draws, 0, args.data(), sizeof(GPUDrawIndexedIndirectArgs) * args.size());
+        command.update_buffer(visibility, 0, flags.data(), sizeof(uint) * flags.size());
+        command.resource_barrier(Vector<GPUBufferBarrier>{
+            buffer_barrier(draws, GPUBarrierSync::COPY, GPUBarrierSync::COMPUTE, GPUBarrierAccess::COPY_DEST, GPUBarrierAccess::SHADER_RESOURCE),
+            buffer_barrier(visibility, GPUBarrierSync::COPY, GPUBarrierSync::COMPUTE, GPUBarrierAccess::COPY_DEST, GPUBarrierAccess::SHADER_RESOURCE),
+        });
+
+        // compaction
+        auto compaction       = GPUDrawCompaction{};
+        compaction.draws      = GPUBufferBinding{draws.handle, 0, draws.size};
+        compaction.visibility = GPUBufferBinding{visibility.handle, 0, visibility.size};
+        compaction.output     = GPUBufferBinding{output.handle, 0, output.size};
+        compaction.count      = GPUBufferBinding{count.handle, 0, count.size};
+        compaction.draw_count = NUM_DRAWS;
+        compaction.indexed    = true;
+        compactor->compact(command, compaction);
+
+        // read back the compacted count and draws
+        command.resource_barrier(Vector<GPUBufferBarrier>{
+            buffer_barrier(output, GPUBarrierSync::EXECUTE_INDIRECT, GPUBarrierSync::COPY, GPUBarrierAccess::INDIRECT_ARGUMENT, GPUBarrierAccess::COPY_SOURCE),
+            buffer_barrier(count, GPUBarrierSync::EXECUTE_INDIRECT, GPUBarrierSync::COPY, GPUBarrierAccess::INDIRECT_ARGUMENT, GPUBarrierAccess::COPY_SOURCE),
+        });
+        command.copy_buffer_to_buffer(count, 0, readback, 0, sizeof(uint));
+        command.copy_buffer_to_buffer(output, 0, readback, sizeof(uint), output.size);
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+    }
+};
+
+TEST_CASE("rhi::vulkan::draw_compaction" * doctest::description("Compacting the draw arguments of visible objects on GPU, with one atomic per wave."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_draw_compaction";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+
+    DrawCompactionApp app(desc);
+    app.run();
+
+    uint expected = 0;
+    for (uint i = 0; i < NUM_DRAWS; i++)
+        expected += DrawCompactionApp::visible(i) ? 1 : 0;
+
+    Vector<GPUDrawIndexedIndirectArgs> compacted;
+    app.readback.map(GPUMapMode::READ);
+    {
+        auto data = app.readback.get_mapped_range<uint8_t>();
+        auto num  = *reinterpret_cast<const uint*>(data.data);
+        auto args = reinterpret_cast<const GPUDrawIndexedIndirectArgs*>(data.data + sizeof(uint));
+        REQUIRE(num == expected);
+        compacted.assign(args, args + num);
+    }
+    app.readback.unmap();
+
+    // waves claim their ranges in any order, while draws of the same wave stay contiguous and in candidate order
+    uint wave_size = std::max(RHI::get_current_adapter().properties.subgroup_min_size, 1u);
+    HashSet<uint> waves;
+    Vector<bool>  seen(NUM_DRAWS, false);
+    for (uint i = 0; i < compacted.size(); i++) {
+        auto& args = compacted.at(i);
+        REQUIRE(args.first_instance < NUM_DRAWS);
+        CHECK(DrawCompactionApp::visible(args.first_instance));
+        CHECK(!seen.at(args.first_instance));
+        seen.at(args.first_instance) = true;
+
+        auto source = DrawCompactionApp::candidate(args.first_instance);
+        CHECK(args.index_count == source.index_count);
+        CHECK(args.instance_count == source.instance_count);
+        CHECK(args.first_index == source.first_index);
+        CHECK(args.base_vertex == source.base_vertex);
+
+        uint wave = args.first_instance / wave_size;
+        if (i > 0 && compacted.at(i - 1).first_instance / wave_size == wave) {
+            CHECK(compacted.at(i - 1).first_instance < args.first_instance);
+        } else {
+            CHECK(waves.insert(wave).second);
+        }
+    }
+
+    app.destroy();
+}
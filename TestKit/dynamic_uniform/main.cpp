@@ -1,4 +1,5 @@
 #include "helper.h"
+#include <Lyra/Render/RPI/GPUUniformAllocator.h>
 
 CString dynamic_uniform_program = R"""(
 import lyra;
@@ -47,20 +48,28 @@ struct DynamicUniform
 
 struct DynamicUniformApp : public TestApp
 {
-    Uniform              uniform;
-    Geometry             geometry;
-    SimpleRenderPipeline pipeline;
+    Geometry                      geometry;
+    SimpleRenderPipeline          pipeline;
+    Array<DynamicUniform, 3>      uniforms;
+    Optional<GPUUniformAllocator> allocator;
+    HashMap<BufferSource, uint>   page_slots;          // frame slot of every allocation address
+    uint                          slot_mismatches = 0; // allocations reusing memory of another frame slot
 
     explicit DynamicUniformApp(const TestAppDescriptor& desc) : TestApp(desc)
     {
         setup_buffers();
         setup_pipeline();
+        setup_allocator();
     }
 
-    void setup_buffers()
+    ~DynamicUniformApp()
     {
-        auto& device = RHI::get_current_device();
+        RHI::get_current_device().wait();
+        allocator.reset();
+    }
 
+    void setup_buffers()
+    {
         uint  width  = desc.width;
         uint  height = desc.height;
         float fovy   = 1.05f;
@@ -73,19 +82,9 @@ struct DynamicUniformApp : public TestApp
 
         geometry = Geometry::create_triangle();
 
-        uniform.ubuffer = execute([&]() {
-            auto desc               = GPUBufferDescriptor{};
-            desc.label              = "dynamic_uniform_buffer";
-            desc.size               = sizeof(DynamicUniform) * 3;
-            desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
-            desc.mapped_at_creation = true;
-            return device.create_buffer(desc);
-        });
-
-        auto data      = uniform.ubuffer.get_mapped_range<DynamicUniform>();
-        data.at(0).mvp = proj * view * glm::translate(glm::mat4(1.0f), glm::vec3(-1.0, 0.0, 0.0));
-        data.at(1).mvp = proj * view * glm::translate(glm::mat4(1.0f), glm::vec3(+0.0, 0.0, 0.0));
-        data.at(2).mvp = proj * view * glm::translate(glm::mat4(1.0f), glm::vec3(+1.0, 0.0, 0.0));
+        uniforms.at(0).mvp = proj * view * glm::translate(glm::mat4(1.0f), glm::vec3(-1.0, 0.0, 0.0));
+        uniforms.at(1).mvp = proj * view * glm::translate(glm::mat4(1.0f), glm::vec3(+0.0, 0.0, 0.0));
+        uniforms.at(2).mvp = proj * view * glm::translate(glm::mat4(1.0f), glm::vec3(+1.0, 0.0, 0.0));
     }
 
     void setup_pipeline()
@@ -115,10 +114,24 @@ struct DynamicUniformApp : public TestApp
         pipeline.init_pipeline(device, reflection.get());
     }
 
+    void setup_allocator()
+    {
+        // small pages, so that every frame allocates from its own pages
+        auto desc      = GPUUniformAllocatorDescriptor{};
+        desc.layout    = pipeline.blayouts.at(0);
+        desc.binding   = 0;
+        desc.range     = sizeof(DynamicUniform);
+        desc.page_size = 4096;
+        allocator.emplace(desc);
+    }
+
     void render(const GPUSurfaceTexture& backbuffer) override
     {
         auto& device = RHI::get_current_device();
 
+        // pages of the current frame slot are free again
+        allocator->new_frame();
+
         // create command buffer
         auto command = execute([&]() {
             auto desc  = GPUCommandBufferDescriptor{};
@@ -126,23 +139,6 @@ struct DynamicUniformApp : public TestApp
             return device.create_command_buffer(desc);
         });
 
-        // create bind group
-        auto bind_group = execute([&]() {
-            Array<GPUBindGroupEntry, 1> entries = {};
-
-            auto& entry         = entries.at(0);
-            entry.type          = GPUBindingResourceType::BUFFER;
-            entry.binding       = 0;
-            entry.buffer.buffer = uniform.ubuffer;
-            entry.buffer.offset = 0;
-            entry.buffer.size   = sizeof(DynamicUniform); // NOTE: THIS MUST NOT BE 0 WHEN DYNAMIC UNIFORM IS ENABLED
-
-            auto desc    = GPUBindGroupDescriptor{};
-            desc.layout  = pipeline.blayouts.at(0);
-            desc.entries = entries;
-            return device.create_bind_group(desc);
-        });
-
         // color attachments
         auto color_attachment        = GPURenderPassColorAttachment{};
         color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
@@ -170,13 +166,24 @@ struct DynamicUniformApp : public TestApp
         command.set_vertex_buffer(0, geometry.vbuffer);
         command.set_index_buffer(geometry.ibuffer, GPUIndexFormat::UINT32);
         for (uint i = 0; i < 3; i++) {
-            command.set_bind_group(0, bind_group, {i * (uint)sizeof(DynamicUniform)});
+            auto allocation = allocator->allocate(uniforms.at(i));
+            track(allocation);
+            command.set_bind_group(0, allocation.bind_group, {allocation.offset});
             command.draw_indexed(3, 1, 0, 0, 0);
         }
         command.end_render_pass();
         postprocessing(command, backbuffer.texture);
         command.submit();
     }
+
+    void track(const GPUUniformAllocation& allocation)
+    {
+        // memory written this frame must only ever be reused by the same frame slot
+        auto slot = RHI::get_frame_slot().index;
+        auto it   = page_slots.emplace(allocation.data, slot).first;
+        if (it->second != slot)
+            slot_mismatches++;
+    }
 };
 
 TEST_CASE("rhi::vulkan::dynamic_uniform" * doctest::description("Rendering multiple triangles with the dynamic uniform buffer."))
@@ -193,6 +200,28 @@ TEST_CASE("rhi::vulkan::dynamic_uniform" * doctest::description("Rendering multi
     DynamicUniformApp(desc).run();
 }
 
+TEST_CASE("rhi::vulkan::uniform_allocator" * doctest::description("Uniform allocator pages follow the RHI frame slots, whatever the number of frames in flight."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_uniform_allocator";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 12;
+    desc.latency        = 4; // more frame slots than the allocator used to assume
+
+    DynamicUniformApp app(desc);
+    app.run();
+
+    // every frame slot owns its pages, and pages are never shared between slots
+    CHECK(app.page_slots.size() == 3 * desc.latency);
+    CHECK(app.slot_mismatches == 0);
+}
+
 #ifdef WIN32
 TEST_CASE("rhi::d3d12::dynamic_uniform" * doctest::description("Rendering multiple triangles with the dynamic uniform buffer."))
 {
@@ -0,0 +1,211 @@
+#include "helper.h"
+#include <Lyra/Render/RPI/GPUProfiler.h>
+#include <Lyra/Render/RPI/GPUPassStatistics.h>
+
+CString gpu_queries_program = R"""(
+struct VertexInput
+{
+    float3 position : POSITION;
+    float3 color    : COLOR0;
+};
+
+struct VertexOutput
+{
+    float4 position : SV_Position;
+    float4 color    : COLOR0;
+};
+
+[shader("vertex")]
+VertexOutput vsmain(VertexInput input)
+{
+    VertexOutput output;
+    output.position = float4(input.position, 1.0);
+    output.color = float4(input.color, 1.0);
+    return output;
+}
+
+[shader("fragment")]
+float4 fsmain(VertexOutput input) : SV_Target
+{
+    return input.color;
+}
+)""";
+
+// number of triangles drawn by the measured pass
+constexpr uint NUM_DRAWS = 4;
+
+struct GPUQueriesApp : public TestApp
+{
+    Geometry                    geometry;
+    SimpleRenderPipeline        pipeline;
+    Optional<GPUProfiler>       profiler;
+    Optional<GPUPassStatistics> statistics;
+
+    explicit GPUQueriesApp(const TestAppDescriptor& desc) : TestApp(desc)
+    {
+        setup_buffers();
+        setup_pipeline();
+        setup_queries();
+    }
+
+    ~GPUQueriesApp()
+    {
+        RHI::get_current_device().wait();
+        statistics.reset();
+        profiler.reset();
+    }
+
+    void setup_buffers()
+    {
+        geometry = Geometry::create_triangle();
+    }
+
+    void setup_pipeline()
+    {
+        auto& device = RHI::get_current_device();
+
+        auto module = execute([&]() {
+            auto desc   = CompileDescriptor{};
+            desc.module = "test";
+            desc.path   = "test.slang";
+            desc.source = gpu_queries_program;
+            return compiler->compile(desc);
+        });
+
+        auto reflection = compiler->reflect({
+            {*module, "vsmain"},
+            {*module, "fsmain"},
+        });
+
+        pipeline.vstride = sizeof(Vertex);
+        pipeline.attributes.push_back({"position", offsetof(Vertex, position)});
+        pipeline.attributes.push_back({"color", offsetof(Vertex, color)});
+        pipeline.init_color_state(get_backbuffer_format());
+        pipeline.init_vshader(device, module.get(), "vsmain");
+        pipeline.init_fshader(device, module.get(), "fsmain");
+        pipeline.init_playout(device, reflection.get());
+        pipeline.init_pipeline(device, reflection.get());
+    }
+
+    void setup_queries()
+    {
+        profiler.emplace(GPUProfilerDescriptor{});
+
+        auto desc       = GPUPassStatisticsDescriptor{};
+        desc.max_passes = 4;
+        desc.statistics = GPUQueryStatistic::VERTEX_INVOCATIONS | GPUQueryStatistic::FRAGMENT_INVOCATIONS;
+        statistics.emplace(desc);
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // results of the frame last completed in this frame slot
+        profiler->new_frame();
+        statistics->new_frame();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        profiler->begin_scope(command, "frame");
+        profiler->begin_scope(command, "triangles");
+        statistics->begin_pass(command, "triangles");
+        command.begin_render_pass(render_pass);
+        command.set_viewport(0, 0, static_cast<float>(desc.width), static_cast<float>(desc.height));
+        command.set_scissor_rect(0, 0, desc.width, desc.height);
+        command.set_pipeline(pipeline.pipeline);
+        command.set_vertex_buffer(0, geometry.vbuffer);
+        command.set_index_buffer(geometry.ibuffer, GPUIndexFormat::UINT32);
+        for (uint i = 0; i < NUM_DRAWS; i++)
+            command.draw_indexed(3, 1, 0, 0, 0);
+        command.end_render_pass();
+        statistics->end_pass(command);
+        profiler->end_scope(command);
+        profiler->resolve(command); // closes the "frame" scope
+        statistics->resolve(command);
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+    }
+};
+
+TEST_CASE("rhi::vulkan::pass_statistics" * doctest::description("Pipeline statistics of a named pass, read back from the per-frame query ring."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_pass_statistics";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 8;
+    desc.latency        = 3;
+
+    GPUQueriesApp app(desc);
+    app.run();
+
+    // the report lags behind by the frames in flight, but every frame draws the same triangles
+    auto& report = app.statistics->get_report();
+    MESSAGE("pass statistics: ", report.total.vertex_invocations, " vertex invocations, ", report.total.fragment_invocations, " fragment invocations");
+    REQUIRE(report.passes.size() == 1);
+    CHECK(report.passes.at(0).name == "triangles");
+    CHECK(report.passes.at(0).count == 1);
+    CHECK(report.total.vertex_invocations >= 3);
+    CHECK(report.total.fragment_invocations > 0);
+    CHECK(report.total.compute_invocations == 0);
+}
+
+TEST_CASE("rhi::vulkan::gpu_profiler" * doctest::description("Nested timestamp scopes, read back from the per-frame query ring."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_gpu_profiler";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 8;
+    desc.latency        = 3;
+
+    GPUQueriesApp app(desc);
+    app.run();
+
+    // scopes are reported in recording order, with their nesting depth
+    auto& scopes = app.profiler->get_results();
+    for (auto& scope : scopes)
+        MESSAGE("gpu scope: ", scope.name, " at depth ", scope.depth, ", ", scope.time, " ms");
+    REQUIRE(scopes.size() == 2);
+    CHECK(scopes.at(0).name == "frame");
+    CHECK(scopes.at(0).depth == 0);
+    CHECK(scopes.at(1).name == "triangles");
+    CHECK(scopes.at(1).depth == 1);
+
+    // the draws take time, and nested scopes lie within their parent
+    CHECK(scopes.at(0).start == 0.0);
+    CHECK(scopes.at(0).time > 0.0);
+    CHECK(scopes.at(1).time > 0.0);
+    CHECK(scopes.at(1).start >= scopes.at(0).start);
+    CHECK(scopes.at(1).start + scopes.at(1).time <= scopes.at(0).start + scopes.at(0).time);
+}
@@ -1,4 +1,5 @@
 #include "helper.h"
+#include <fstream>
 
 CString graphics_pipeline_program = R"""(
 struct VertexInput
@@ -163,6 +164,53 @@ TEST_CASE("rhi::vulkan::graphics_pipeline" * doctest::description("Rendering a t
     GraphicsPipelineApp(desc).run();
 }
 
+TEST_CASE("rhi::vulkan::graphics_pipeline_sequence" * doctest::description("Rendering an image sequence without window, with frames in flight and pipelined readback."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_sequence";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 60;
+    desc.latency        = 3;
+    GraphicsPipelineApp(desc).run();
+}
+
+TEST_CASE("rhi::vulkan::graphics_pipeline_sequence_hdr" * doctest::description("Rendering an image sequence without window into a float render target, saved as EXR."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_sequence_hdr";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 8;
+    desc.latency        = 3;
+    desc.hdr            = true;
+    GraphicsPipelineApp(desc).run();
+
+    // EXR magic number, version 2, then header and one block per scanline of half RGBA
+    std::ifstream file("vulkan_sequence_hdr_0007.exr", std::ios::binary | std::ios::ate);
+    REQUIRE(file.is_open());
+    CHECK(static_cast<uint>(file.tellg()) > desc.width * desc.height * 4 * sizeof(uint16_t));
+
+    uint8_t header[8] = {};
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    CHECK(header[0] == 0x76);
+    CHECK(header[1] == 0x2f);
+    CHECK(header[2] == 0x31);
+    CHECK(header[3] == 0x01);
+    CHECK(header[4] == 0x02);
+}
+
 #ifdef WIN32
 TEST_CASE("rhi::d3d12::graphics_pipeline" * doctest::description("Rendering a triangle with the most basic graphics pipeline."))
 {
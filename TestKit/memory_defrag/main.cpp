@@ -0,0 +1,347 @@
+#include "helper.h"
+
+// enough buffers to fill a few device pool blocks, every other one is released to fragment them
+constexpr uint      NUM_BUFFERS = 384;
+constexpr GPUSize64 BUFFER_SIZE = 512ull << 10;
+
+// released buffers return their memory once the frames in flight retire
+constexpr uint DEFRAG_FRAME = 4;
+
+// textures cleared through their views, every other one is released to fragment the default pool
+constexpr uint NUM_TEXTURES = 64;
+constexpr uint TEXTURE_SIZE = 128;
+
+struct MemoryDefragApp : public TestApp
+{
+    Vector<GPUBuffer>  buffers;
+    GPUBuffer          readback;
+    GPUMemoryPoolStats fragmented;
+    uint               frame = 0;
+    uint               last  = 0;
+
+    explicit MemoryDefragApp(const TestAppDescriptor& desc) : TestApp(desc), last(desc.frames - 1)
+    {
+        setup_buffers();
+    }
+
+    void setup_buffers()
+    {
+        auto& device = RHI::get_current_device();
+
+        for (uint i = 0; i < NUM_BUFFERS; i++) {
+            buffers.push_back(execute([&]() {
+                auto desc  = GPUBufferDescriptor{};
+                desc.label = "defrag_buffer";
+                desc.size  = BUFFER_SIZE;
+                desc.usage = GPUBufferUsage::STORAGE | GPUBufferUsage::COPY_SRC | GPUBufferUsage::COPY_DST;
+                return device.create_buffer(desc);
+            }));
+        }
+
+        readback = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "defrag_readback";
+            desc.size  = sizeof(uint) * 2 * NUM_BUFFERS;
+            desc.usage = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            return device.create_buffer(desc);
+        });
+    }
+
+    void destroy()
+    {
+        // odd buffers are already released
+        for (uint i = 0; i < NUM_BUFFERS; i += 2)
+            buffers.at(i).destroy();
+        readback.destroy();
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        if (frame == 0) {
+            // mark both ends of every buffer, then release every other buffer
+            for (uint i = 0; i < NUM_BUFFERS; i++) {
+                command.update_buffer(buffers.at(i), 0, i);
+                command.update_buffer(buffers.at(i), BUFFER_SIZE - sizeof(uint), ~i);
+            }
+            for (uint i = 1; i < NUM_BUFFERS; i += 2)
+                buffers.at(i).destroy();
+        }
+
+        if (frame == DEFRAG_FRAME)
+            fragmented = device.get_memory_pool_stats(GPUMemoryPool::DEVICE);
+
+        if (frame >= DEFRAG_FRAME) {
+            // passes are recorded ahead of other commands
+            auto desc               = GPUDefragmentDescriptor{};
+            desc.max_moves_per_pass = 16;
+            desc.max_time_ms        = 100.0f;
+            command.defragment_memory(desc);
+        }
+
+        // the markers follow the buffers wherever they have been moved
+        if (frame == last) {
+            for (uint i = 0; i < NUM_BUFFERS; i += 2) {
+                command.copy_buffer_to_buffer(buffers.at(i), 0, readback, sizeof(uint) * 2 * i, sizeof(uint));
+                command.copy_buffer_to_buffer(buffers.at(i), BUFFER_SIZE - sizeof(uint), readback, sizeof(uint) * (2 * i + 1), sizeof(uint));
+            }
+        }
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+
+        frame++;
+    }
+};
+
+// the contents of moved textures are copied, and their views are recreated on the new images
+struct TextureDefragApp : public TestApp
+{
+    Vector<GPUTexture>     textures;
+    Vector<GPUTextureView> views;
+    GPUBuffer              readback;
+    uint                   frame = 0;
+    uint                   last  = 0;
+
+    explicit TextureDefragApp(const TestAppDescriptor& desc) : TestApp(desc), last(desc.frames - 1)
+    {
+        setup_textures();
+    }
+
+    void setup_textures()
+    {
+        auto& device = RHI::get_current_device();
+
+        for (uint i = 0; i < NUM_TEXTURES; i++) {
+            textures.push_back(execute([&]() {
+                auto desc            = GPUTextureDescriptor{};
+                desc.label           = "defrag_texture";
+                desc.format          = GPUTextureFormat::RGBA8UNORM;
+                desc.dimension       = GPUTextureDimension::x2D;
+                desc.size.width      = TEXTURE_SIZE;
+                desc.size.height     = TEXTURE_SIZE;
+                desc.size.depth      = 1;
+                desc.array_layers    = 1;
+                desc.mip_level_count = 1;
+                desc.sample_count    = 1;
+                desc.usage           = GPUTextureUsage::COPY_SRC | GPUTextureUsage::COPY_DST | GPUTextureUsage::RENDER_ATTACHMENT;
+                return device.create_texture(desc);
+            }));
+            views.push_back(textures.back().create_view());
+        }
+
+        // two texels per texture, before and after clearing it again through its view
+        readback = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "defrag_readback";
+            desc.size  = sizeof(uint32_t) * 2 * NUM_TEXTURES;
+            desc.usage = GPUBufferUsage::COPY_DST | GPUBufferUsage::MAP_READ;
+            return device.create_buffer(desc);
+        });
+    }
+
+    void destroy()
+    {
+        // odd textures are already released
+        for (uint i = 0; i < NUM_TEXTURES; i += 2) {
+            views.at(i).destroy();
+            textures.at(i).destroy();
+        }
+        readback.destroy();
+    }
+
+    void clear(const GPUCommandBuffer& command, uint index, const GPUColor& color)
+    {
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = color;
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = views.at(index);
+
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        command.begin_render_pass(render_pass);
+        command.end_render_pass();
+    }
+
+    void copy_texel(const GPUCommandBuffer& command, uint index, uint slot)
+    {
+        auto src      = GPUTexelCopyTextureInfo{};
+        src.texture   = textures.at(index);
+        src.aspect    = GPUTextureAspect::COLOR;
+        src.mip_level = 0;
+        src.origin    = GPUOrigin3D{0, 0, 0};
+
+        auto dst           = GPUTexelCopyBufferInfo{};
+        dst.buffer         = readback;
+        dst.offset         = sizeof(uint32_t) * slot;
+        dst.bytes_per_row  = 0;
+        dst.rows_per_image = 1;
+
+        command.copy_texture_to_buffer(src, dst, GPUExtent3D{1, 1, 1});
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        if (frame == 0) {
+            // mark every texture with its index in red, the layout left by the barriers is known to the tracker
+            for (uint i = 0; i < NUM_TEXTURES; i++) {
+                command.resource_barrier(state_transition(textures.at(i), undefined_state(), color_attachment_state()));
+                clear(command, i, GPUColor{i / 255.0f, 0.0f, 0.0f, 1.0f});
+                command.resource_barrier(state_transition(textures.at(i), color_attachment_state(), copy_src_state()));
+            }
+            for (uint i = 1; i < NUM_TEXTURES; i += 2) {
+                views.at(i).destroy();
+                textures.at(i).destroy();
+            }
+        }
+
+        if (frame >= DEFRAG_FRAME) {
+            // passes are recorded ahead of other commands
+            auto desc               = GPUDefragmentDescriptor{};
+            desc.max_moves_per_pass = 4;
+            desc.max_time_ms        = 100.0f;
+            command.defragment_memory(desc);
+        }
+
+        // the contents follow the textures, and the views clear the new images
+        if (frame == last) {
+            for (uint i = 0; i < NUM_TEXTURES; i += 2) {
+                copy_texel(command, i, 2 * i);
+                command.resource_barrier(state_transition(textures.at(i), copy_src_state(), color_attachment_state()));
+                clear(command, i, GPUColor{0.0f, i / 255.0f, 0.0f, 1.0f});
+                command.resource_barrier(state_transition(textures.at(i), color_attachment_state(), copy_src_state()));
+                copy_texel(command, i, 2 * i + 1);
+            }
+        }
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+
+        frame++;
+    }
+};
+
+TEST_CASE("rhi::vulkan::memory_defrag" * doctest::description("Defragmenting device memory incrementally, moved buffers keep their handles and contents."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 32;
+    desc.latency        = 2;
+
+    MemoryDefragApp app(desc);
+    app.run();
+
+    // passes have moved buffers and returned the emptied blocks
+    auto stats = RHI::get_current_device().get_defragment_stats();
+    auto after = RHI::get_current_device().get_memory_pool_stats(GPUMemoryPool::DEVICE);
+    CHECK(stats.passes > 0);
+    CHECK(stats.moves > 0);
+    CHECK(after.block_count <= app.fragmented.block_count);
+    MESSAGE("defragmentation: ", stats.moves, " moves, ", stats.bytes_moved, " bytes moved, ", stats.blocks_freed, " blocks freed, ", stats.abandoned, " moves abandoned");
+    MESSAGE("device pool: ", app.fragmented.block_count, " blocks at ", app.fragmented.fragmentation, " fragmentation, ", after.block_count, " blocks at ", after.fragmentation, " after");
+
+    app.readback.map(GPUMapMode::READ);
+    {
+        auto data = app.readback.get_mapped_range<uint>();
+        for (uint i = 0; i < NUM_BUFFERS; i += 2) {
+            CHECK(data.at(2 * i) == i);
+            CHECK(data.at(2 * i + 1) == ~i);
+        }
+    }
+    app.readback.unmap();
+    app.destroy();
+}
+
+TEST_CASE("rhi::vulkan::memory_defrag_textures" * doctest::description("Defragmenting textures incrementally, moved textures keep their contents and their views follow them."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_textures";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 32;
+    desc.latency        = 2;
+
+    TextureDefragApp app(desc);
+    app.run();
+
+    // only the textures can move, everything else is host visible or lacks a copy usage
+    auto stats = RHI::get_current_device().get_defragment_stats();
+    CHECK(stats.passes > 0);
+    CHECK(stats.moves > 0);
+    MESSAGE("texture defragmentation: ", stats.moves, " moves, ", stats.bytes_moved, " bytes moved, ", stats.blocks_freed, " blocks freed");
+
+    app.readback.map(GPUMapMode::READ);
+    {
+        auto data = app.readback.get_mapped_range<uint32_t>();
+        for (uint i = 0; i < NUM_TEXTURES; i += 2) {
+            CHECK(data.at(2 * i) == (0xFF000000u | i));
+            CHECK(data.at(2 * i + 1) == (0xFF000000u | (i << 8)));
+        }
+    }
+    app.readback.unmap();
+    app.destroy();
+}
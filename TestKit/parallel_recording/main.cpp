@@ -0,0 +1,206 @@
+#include <thread>
+#include "helper.h"
+
+CString parallel_recording_program = R"""(
+struct VertexInput
+{
+    float3 position : POSITION;
+    float3 color    : COLOR0;
+};
+
+struct VertexOutput
+{
+    float4 position : SV_Position;
+    float4 color    : COLOR0;
+};
+
+struct Camera
+{
+    float4x4 proj;
+    float4x4 view;
+};
+
+ConstantBuffer<Camera> camera;
+
+[shader("vertex")]
+VertexOutput vsmain(VertexInput input)
+{
+    VertexOutput output;
+    output.position = mul(mul(float4(input.position, 1.0), camera.view), camera.proj);
+    output.color = float4(input.color, 1.0);
+    return output;
+}
+
+[shader("fragment")]
+float4 fsmain(VertexOutput input) : SV_Target
+{
+    return input.color;
+}
+)""";
+
+// 8 threads recording 8 bundles each, one bundle per tile of an 8x8 grid
+constexpr uint NUM_THREADS         = 8;
+constexpr uint BUNDLES_PER_THREAD  = 8;
+constexpr uint NUM_BUNDLES         = NUM_THREADS * BUNDLES_PER_THREAD;
+constexpr uint NUM_TILES_PER_SLICE = 8;
+
+struct ParallelRecordingApp : public TestApp
+{
+    Uniform              uniform;
+    Geometry             geometry;
+    SimpleRenderPipeline pipeline;
+
+    explicit ParallelRecordingApp(const TestAppDescriptor& desc) : TestApp(desc)
+    {
+        setup_buffers();
+        setup_pipeline();
+    }
+
+    void setup_buffers()
+    {
+        uint  width  = desc.width;
+        uint  height = desc.height;
+        float fovy   = 1.05f;
+        float aspect = float(width) / float(height);
+
+        geometry = Geometry::create_triangle();
+        uniform  = Uniform::create(fovy, aspect, glm::vec3(0.0, 0.0, 3.0));
+    }
+
+    void setup_pipeline()
+    {
+        auto& device = RHI::get_current_device();
+
+        auto module = execute([&]() {
+            auto desc   = CompileDescriptor{};
+            desc.module = "test";
+            desc.path   = "test.slang";
+            desc.source = parallel_recording_program;
+            return compiler->compile(desc);
+        });
+
+        auto reflection = compiler->reflect({
+            {*module, "vsmain"},
+            {*module, "fsmain"},
+        });
+
+        pipeline.vstride = sizeof(Vertex);
+        pipeline.attributes.push_back({"position", offsetof(Vertex, position)});
+        pipeline.attributes.push_back({"color", offsetof(Vertex, color)});
+        pipeline.init_color_state(get_backbuffer_format());
+        pipeline.init_vshader(device, module.get(), "vsmain");
+        pipeline.init_fshader(device, module.get(), "fsmain");
+        pipeline.init_playout(device, reflection.get());
+        pipeline.init_pipeline(device, reflection.get());
+    }
+
+    void record(GPUCommandBundle& bundle, GPUBindGroup bind_group, uint tile)
+    {
+        float tile_width  = float(desc.width) / NUM_TILES_PER_SLICE;
+        float tile_height = float(desc.height) / NUM_TILES_PER_SLICE;
+        float x           = float(tile % NUM_TILES_PER_SLICE) * tile_width;
+        float y           = float(tile / NUM_TILES_PER_SLICE) * tile_height;
+
+        bundle.set_viewport(x, y, tile_width, tile_height);
+        bundle.set_scissor_rect(uint(x), uint(y), uint(tile_width), uint(tile_height));
+        bundle.set_pipeline(pipeline.pipeline);
+        bundle.set_vertex_buffer(0, geometry.vbuffer);
+        bundle.set_index_buffer(geometry.ibuffer, GPUIndexFormat::UINT32);
+        bundle.set_bind_group(0, bind_group);
+        bundle.draw_indexed(3, 1, 0, 0, 0);
+        bundle.finish();
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // create bind group
+        auto bind_group = execute([&]() {
+            Array<GPUBindGroupEntry, 1> entries = {};
+
+            auto& entry         = entries.at(0);
+            entry.type          = GPUBindingResourceType::BUFFER;
+            entry.binding       = 0;
+            entry.buffer.buffer = uniform.ubuffer;
+            entry.buffer.offset = 0;
+            entry.buffer.size   = 0;
+
+            auto desc    = GPUBindGroupDescriptor{};
+            desc.layout  = pipeline.blayouts.at(0);
+            desc.entries = entries;
+            return device.create_bind_group(desc);
+        });
+
+        // record bundles in parallel
+        Vector<GPUCommandBundle> bundles(NUM_BUNDLES);
+        Vector<std::thread>      threads;
+        for (uint t = 0; t < NUM_THREADS; t++) {
+            threads.emplace_back([&, t]() {
+                GPUTextureFormat format = get_backbuffer_format();
+                for (uint i = 0; i < BUNDLES_PER_THREAD; i++) {
+                    uint tile = t * BUNDLES_PER_THREAD + i;
+
+                    bundles.at(tile) = execute([&]() {
+                        auto desc          = GPUCommandBundleDescriptor{};
+                        desc.queue         = GPUQueueType::DEFAULT;
+                        desc.color_formats = format;
+                        return device.create_command_bundle(desc);
+                    });
+
+                    record(bundles.at(tile), bind_group, tile);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+        render_pass.bundles_only             = true;
+
+        // synchronization when window is enabled
+        if (desc.window) {
+            command.wait(backbuffer.available, GPUBarrierSync::PIXEL_SHADING);
+            command.signal(backbuffer.complete, GPUBarrierSync::RENDER_TARGET);
+        }
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.execute_bundles(bundles);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+    }
+};
+
+TEST_CASE("rhi::vulkan::parallel_recording" * doctest::description("Rendering a grid of triangles from command bundles recorded on multiple threads."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    ParallelRecordingApp(desc).run();
+}
@@ -0,0 +1,443 @@
+#include <chrono>
+#include "helper.h"
+
+CString pipeline_compilation_program = R"""(
+struct VertexInput
+{
+    float3 position : POSITION;
+    float3 color    : COLOR0;
+};
+
+struct VertexOutput
+{
+    float4 position : SV_Position;
+    float4 color    : COLOR0;
+};
+
+[shader("vertex")]
+VertexOutput vsmain(VertexInput input)
+{
+    VertexOutput output;
+    output.position = float4(input.position, 1.0);
+    output.color = float4(input.color, 1.0);
+    return output;
+}
+
+[shader("fragment")]
+float4 fsmain(VertexOutput input) : SV_Target
+{
+    return input.color;
+}
+)""";
+
+CString pending_bindings_program = R"""(
+struct VertexInput
+{
+    float3 position : POSITION;
+    float3 color    : COLOR0;
+};
+
+struct VertexOutput
+{
+    float4 position : SV_Position;
+};
+
+struct Tint
+{
+    float4 color;
+};
+
+ConstantBuffer<Tint> tint;
+
+[shader("vertex")]
+VertexOutput vsmain(VertexInput input)
+{
+    VertexOutput output;
+    output.position = float4(input.position, 1.0);
+    return output;
+}
+
+[shader("fragment")]
+float4 fsmain(VertexOutput input) : SV_Target
+{
+    return tint.color;
+}
+)""";
+
+// 3 cull modes x 2 front faces x 16 write masks x 6 blend states = 576 distinct variants
+constexpr uint NUM_PIPELINE_VARIANTS = 500;
+
+struct PipelineCompilationApp : public TestApp
+{
+    Geometry              geometry;
+    SimpleRenderPipeline  pipeline;
+    Own<ShaderReflection> reflection;
+
+    explicit PipelineCompilationApp(const TestAppDescriptor& desc) : TestApp(desc)
+    {
+        setup_buffers();
+        setup_pipeline();
+    }
+
+    void setup_buffers()
+    {
+        geometry = Geometry::create_triangle();
+    }
+
+    void setup_pipeline()
+    {
+        auto& device = RHI::get_current_device();
+
+        auto module = execute([&]() {
+            auto desc   = CompileDescriptor{};
+            desc.module = "test";
+            desc.path   = "test.slang";
+            desc.source = pipeline_compilation_program;
+            return compiler->compile(desc);
+        });
+
+        reflection = compiler->reflect({
+            {*module, "vsmain"},
+            {*module, "fsmain"},
+        });
+
+        pipeline.vstride = sizeof(Vertex);
+        pipeline.attributes.push_back({"position", offsetof(Vertex, position)});
+        pipeline.attributes.push_back({"color", offsetof(Vertex, color)});
+        pipeline.init_color_state(get_backbuffer_format());
+        pipeline.init_vshader(device, module.get(), "vsmain");
+        pipeline.init_fshader(device, module.get(), "fsmain");
+        pipeline.init_playout(device, reflection.get());
+        pipeline.init_pipeline(device, reflection.get());
+    }
+
+    auto create_variant(uint variant, bool async) -> GPURenderPipeline
+    {
+        auto& device = RHI::get_current_device();
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = reflection->get_vertex_attributes(pipeline.attributes);
+        layout.array_stride = pipeline.vstride;
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        // the first variant has blending disabled, the others each use a different blend operation
+        uint blend = variant % 6;
+
+        auto target                  = GPUColorTargetState{};
+        target.format                = get_backbuffer_format();
+        target.write_mask            = (variant / 6) % 16;
+        target.blend_enable          = blend != 0;
+        target.blend.color.operation = blend != 0 ? GPUBlendOperation(blend - 1) : GPUBlendOperation::ADD;
+
+        auto desc                        = GPURenderPipelineDescriptor{};
+        desc.label                       = "pipeline_variant";
+        desc.async                       = async;
+        desc.layout                      = pipeline.playout;
+        desc.primitive.cull_mode         = GPUCullMode((variant / 96) % 3);
+        desc.primitive.front_face        = GPUFrontFace((variant / 288) % 2);
+        desc.primitive.topology          = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.depth_stencil.depth_compare = GPUCompareFunction::ALWAYS;
+        desc.multisample.count           = 1;
+        desc.vertex.module               = pipeline.vshader;
+        desc.vertex.buffers              = layout;
+        desc.fragment.module             = pipeline.fshader;
+        desc.fragment.targets            = target;
+        return device.create_render_pipeline(desc);
+    }
+
+    auto compile_variants(bool async) -> double
+    {
+        auto& device = RHI::get_current_device();
+        auto  start  = std::chrono::high_resolution_clock::now();
+
+        Vector<GPURenderPipeline> pipelines;
+        for (uint i = 0; i < NUM_PIPELINE_VARIANTS; i++)
+            pipelines.push_back(create_variant(i, async));
+
+        // asynchronous pipelines are all compiled once this returns
+        device.wait_pipelines();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        for (auto& variant : pipelines) {
+            CHECK(variant.get_status() == GPUPipelineStatus::READY);
+            variant.destroy();
+        }
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // still compiling within this frame, draws using it are skipped
+        auto pending = create_variant(0, true);
+        CHECK(pending.get_status() == GPUPipelineStatus::PENDING);
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // synchronization when window is enabled
+        if (desc.window) {
+            command.wait(backbuffer.available, GPUBarrierSync::PIXEL_SHADING);
+            command.signal(backbuffer.complete, GPUBarrierSync::RENDER_TARGET);
+        }
+
+        auto skipped = device.get_command_stats().skipped_actions;
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.set_viewport(0, 0, float(desc.width), float(desc.height));
+        command.set_scissor_rect(0, 0, desc.width, desc.height);
+        command.set_vertex_buffer(0, geometry.vbuffer);
+        command.set_index_buffer(geometry.ibuffer, GPUIndexFormat::UINT32);
+        command.set_pipeline(pending);
+        command.draw_indexed(3, 1, 0, 0, 0);
+        command.set_pipeline(pipeline.pipeline);
+        command.draw_indexed(3, 1, 0, 0, 0);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+
+        CHECK(device.get_command_stats().skipped_actions == skipped + 1);
+
+        // deleting a pipeline which is still compiling discards its result
+        pending.destroy();
+    }
+};
+
+// binds a bind group while a pending pipeline is set, then draws with a ready pipeline sharing its layout
+struct PendingBindingsApp : public TestApp
+{
+    GPUBuffer             vbuffer;
+    GPUBuffer             ubuffer;
+    SimpleRenderPipeline  pipeline;
+    Own<ShaderReflection> reflection;
+
+    explicit PendingBindingsApp(const TestAppDescriptor& desc) : TestApp(desc)
+    {
+        setup_buffers();
+        setup_pipeline();
+    }
+
+    void setup_buffers()
+    {
+        auto& device = RHI::get_current_device();
+
+        vbuffer = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "vertex_buffer";
+            desc.size               = sizeof(Vertex) * 3;
+            desc.usage              = GPUBufferUsage::VERTEX | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+
+        ubuffer = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "tint_buffer";
+            desc.size               = sizeof(glm::vec4);
+            desc.usage              = GPUBufferUsage::UNIFORM | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            return device.create_buffer(desc);
+        });
+
+        // a triangle covering the whole render target
+        auto vertices           = vbuffer.get_mapped_range<Vertex>();
+        vertices.at(0).position = {-1.0f, -1.0f, 0.0f};
+        vertices.at(1).position = {+3.0f, -1.0f, 0.0f};
+        vertices.at(2).position = {-1.0f, +3.0f, 0.0f};
+        vbuffer.unmap();
+
+        auto tint  = ubuffer.get_mapped_range<glm::vec4>();
+        tint.at(0) = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f);
+        ubuffer.unmap();
+    }
+
+    void setup_pipeline()
+    {
+        auto& device = RHI::get_current_device();
+
+        auto module = execute([&]() {
+            auto desc   = CompileDescriptor{};
+            desc.module = "test";
+            desc.path   = "test.slang";
+            desc.source = pending_bindings_program;
+            return compiler->compile(desc);
+        });
+
+        reflection = compiler->reflect({
+            {*module, "vsmain"},
+            {*module, "fsmain"},
+        });
+
+        pipeline.vstride = sizeof(Vertex);
+        pipeline.attributes.push_back({"position", offsetof(Vertex, position)});
+        pipeline.init_color_state(get_backbuffer_format());
+        pipeline.init_vshader(device, module.get(), "vsmain");
+        pipeline.init_fshader(device, module.get(), "fsmain");
+        pipeline.init_playout(device, reflection.get());
+        pipeline.init_pipeline(device, reflection.get());
+    }
+
+    auto create_pending() -> GPURenderPipeline
+    {
+        auto& device = RHI::get_current_device();
+
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = reflection->get_vertex_attributes(pipeline.attributes);
+        layout.array_stride = pipeline.vstride;
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+
+        auto desc                        = GPURenderPipelineDescriptor{};
+        desc.label                       = "pending_pipeline";
+        desc.async                       = true;
+        desc.layout                      = pipeline.playout;
+        desc.primitive.cull_mode         = GPUCullMode::NONE;
+        desc.primitive.topology          = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.depth_stencil.depth_compare = GPUCompareFunction::ALWAYS;
+        desc.multisample.count           = 1;
+        desc.vertex.module               = pipeline.vshader;
+        desc.vertex.buffers              = layout;
+        desc.fragment.module             = pipeline.fshader;
+        desc.fragment.targets            = pipeline.rstates;
+        return device.create_render_pipeline(desc);
+    }
+
+    void destroy()
+    {
+        vbuffer.destroy();
+        ubuffer.destroy();
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        auto pending = create_pending();
+        CHECK(pending.get_status() == GPUPipelineStatus::PENDING);
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // create bind group
+        auto bind_group = execute([&]() {
+            Array<GPUBindGroupEntry, 1> entries = {};
+
+            auto& entry         = entries.at(0);
+            entry.type          = GPUBindingResourceType::BUFFER;
+            entry.binding       = 0;
+            entry.buffer.buffer = ubuffer;
+            entry.buffer.offset = 0;
+            entry.buffer.size   = 0;
+
+            auto desc    = GPUBindGroupDescriptor{};
+            desc.layout  = pipeline.blayouts.at(0);
+            desc.entries = entries;
+            return device.create_bind_group(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // the bind group is bound with the layout of the pending pipeline,
+        // and stays bound for the ready pipeline sharing that layout.
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.set_viewport(0, 0, float(desc.width), float(desc.height));
+        command.set_scissor_rect(0, 0, desc.width, desc.height);
+        command.set_vertex_buffer(0, vbuffer);
+        command.set_pipeline(pending);
+        command.set_bind_group(0, bind_group);
+        command.draw(3);
+        command.set_pipeline(pipeline.pipeline);
+        command.draw(3);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+
+        pending.destroy();
+    }
+};
+
+TEST_CASE("rhi::vulkan::pipeline_compilation" * doctest::description("Compiling pipeline variants serially and on worker threads, and skipping draws of pending pipelines."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+
+    PipelineCompilationApp app(desc);
+
+    // asynchronous first, so that driver side caches can only favour the serial run
+    double async_ms  = app.compile_variants(true);
+    double serial_ms = app.compile_variants(false);
+    MESSAGE("serial pipeline compilation: ", serial_ms, " ms");
+    MESSAGE("async pipeline compilation: ", async_ms, " ms");
+
+    app.run();
+}
+
+TEST_CASE("rhi::vulkan::pending_pipeline_bindings" * doctest::description("Binding a bind group while a pending pipeline is set, then drawing with a ready pipeline of the same layout."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_pending_bindings";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+
+    PendingBindingsApp app(desc);
+    app.run();
+
+    // the ready pipeline reads the tint from the bind group bound while the pending one was set
+    app.render_target.buffer.map(GPUMapMode::READ);
+    {
+        auto pixels = app.render_target.buffer.get_mapped_range<uint8_t>();
+        auto pixel  = pixels.data + (desc.height / 2 * desc.width + desc.width / 2) * 4;
+        CHECK(pixel[0] == 0);
+        CHECK(pixel[1] == 255);
+        CHECK(pixel[2] == 0);
+        CHECK(pixel[3] == 255);
+    }
+    app.render_target.buffer.unmap();
+
+    app.destroy();
+}
@@ -0,0 +1,215 @@
+#include "helper.h"
+#include <Lyra/Render/RPI/GPUPipelineManifest.h>
+
+CString pipeline_manifest_program = R"""(
+struct VertexInput
+{
+    float3 position : POSITION;
+    float3 color    : COLOR0;
+};
+
+struct VertexOutput
+{
+    float4 position : SV_Position;
+    float4 color    : COLOR0;
+};
+
+[shader("vertex")]
+VertexOutput vsmain(VertexInput input)
+{
+    VertexOutput output;
+    output.position = float4(input.position, 1.0);
+    output.color = float4(input.color, 1.0);
+    return output;
+}
+
+[shader("fragment")]
+float4 fsmain(VertexOutput input) : SV_Target
+{
+    return input.color;
+}
+)""";
+
+struct PipelineManifestApp : public TestApp
+{
+    Geometry              geometry;
+    SimpleRenderPipeline  pipeline;
+    GPUPipelineLayout     other_layout; // same bind group layouts as the pipeline layout, but a different object
+    GPURenderPipeline     manifest_pipeline;
+    Own<ShaderReflection> reflection;
+
+    explicit PipelineManifestApp(const TestAppDescriptor& desc) : TestApp(desc)
+    {
+        setup_buffers();
+        setup_pipeline();
+    }
+
+    void setup_buffers()
+    {
+        geometry = Geometry::create_triangle();
+    }
+
+    void setup_pipeline()
+    {
+        auto& device = RHI::get_current_device();
+
+        auto module = execute([&]() {
+            auto desc   = CompileDescriptor{};
+            desc.module = "test";
+            desc.path   = "test.slang";
+            desc.source = pipeline_manifest_program;
+            return compiler->compile(desc);
+        });
+
+        reflection = compiler->reflect({
+            {*module, "vsmain"},
+            {*module, "fsmain"},
+        });
+
+        pipeline.vstride = sizeof(Vertex);
+        pipeline.attributes.push_back({"position", offsetof(Vertex, position)});
+        pipeline.attributes.push_back({"color", offsetof(Vertex, color)});
+        pipeline.init_color_state(get_backbuffer_format());
+        pipeline.init_vshader(device, module.get(), "vsmain");
+        pipeline.init_fshader(device, module.get(), "fsmain");
+        pipeline.init_playout(device, reflection.get());
+
+        other_layout = execute([&]() {
+            auto desc                 = GPUPipelineLayoutDescriptor{};
+            desc.bind_group_layouts   = pipeline.blayouts;
+            desc.push_constant_ranges = reflection->get_push_constant_ranges();
+            return device.create_pipeline_layout(desc);
+        });
+    }
+
+    auto create_manifest() -> Own<GPUPipelineManifest>
+    {
+        auto desc   = GPUPipelineManifestDescriptor{};
+        desc.shader = [this](GPUSize64 hash) -> GPUShaderModuleHandle {
+            if (pipeline.vshader.get_hash() == hash)
+                return pipeline.vshader;
+            if (pipeline.fshader.get_hash() == hash)
+                return pipeline.fshader;
+            return {};
+        };
+        desc.layout = [this](const Vector<GPUShaderModuleHandle>&) -> GPUPipelineLayoutHandle {
+            return pipeline.playout;
+        };
+        return std::make_unique<GPUPipelineManifest>(desc);
+    }
+
+    auto create_descriptor(GPUPipelineLayoutHandle layout, const GPUVertexBufferLayout& vlayout) -> GPURenderPipelineDescriptor
+    {
+        auto desc                        = GPURenderPipelineDescriptor{};
+        desc.label                       = "manifest_pipeline";
+        desc.layout                      = layout;
+        desc.primitive.cull_mode         = GPUCullMode::NONE;
+        desc.primitive.topology          = GPUPrimitiveTopology::TRIANGLE_LIST;
+        desc.depth_stencil.depth_compare = GPUCompareFunction::ALWAYS;
+        desc.multisample.count           = 1;
+        desc.vertex.module               = pipeline.vshader;
+        desc.vertex.buffers              = vlayout;
+        desc.fragment.module             = pipeline.fshader;
+        desc.fragment.targets            = pipeline.rstates;
+        return desc;
+    }
+
+    auto create_vertex_layout() -> GPUVertexBufferLayout
+    {
+        auto layout         = GPUVertexBufferLayout{};
+        layout.attributes   = reflection->get_vertex_attributes(pipeline.attributes);
+        layout.array_stride = pipeline.vstride;
+        layout.step_mode    = GPUVertexStepMode::VERTEX;
+        return layout;
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // synchronization when window is enabled
+        if (desc.window) {
+            command.wait(backbuffer.available, GPUBarrierSync::PIXEL_SHADING);
+            command.signal(backbuffer.complete, GPUBarrierSync::RENDER_TARGET);
+        }
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.set_viewport(0, 0, float(desc.width), float(desc.height));
+        command.set_scissor_rect(0, 0, desc.width, desc.height);
+        command.set_vertex_buffer(0, geometry.vbuffer);
+        command.set_index_buffer(geometry.ibuffer, GPUIndexFormat::UINT32);
+        command.set_pipeline(manifest_pipeline);
+        command.draw_indexed(3, 1, 0, 0, 0);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+    }
+};
+
+TEST_CASE("rhi::vulkan::pipeline_manifest" * doctest::description("Deduplicating pipelines through a manifest, then prewarming them from the saved manifest."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+
+    PipelineManifestApp app(desc);
+
+    auto& device  = RHI::get_current_device();
+    auto  vlayout = app.create_vertex_layout();
+    auto  path    = fs::temp_directory_path() / "lyra_pipeline_manifest.bin";
+
+    // record: identical descriptors share a pipeline, a different layout gets its own pipeline but no new entry
+    {
+        auto manifest = app.create_manifest();
+        auto first    = manifest->create_render_pipeline(app.create_descriptor(app.pipeline.playout, vlayout));
+        auto second   = manifest->create_render_pipeline(app.create_descriptor(app.pipeline.playout, vlayout));
+        auto other    = manifest->create_render_pipeline(app.create_descriptor(app.other_layout, vlayout));
+        CHECK(first.handle.value == second.handle.value);
+        CHECK(first.handle.value != other.handle.value);
+        CHECK(manifest->size() == 1);
+        CHECK(manifest->save(path));
+    }
+
+    // replay: the saved entry is prewarmed once, and returned for the matching descriptor
+    auto manifest = app.create_manifest();
+    CHECK(manifest->load(path));
+    CHECK(manifest->size() == 1);
+    CHECK(manifest->prewarm() == 1);
+    CHECK(manifest->prewarm() == 0);
+
+    device.wait_pipelines();
+    app.manifest_pipeline = manifest->create_render_pipeline(app.create_descriptor(app.pipeline.playout, vlayout));
+    CHECK(app.manifest_pipeline.get_status() == GPUPipelineStatus::READY);
+    CHECK(manifest->size() == 1);
+    CHECK(manifest->prewarm() == 0);
+
+    app.run();
+    fs::remove(path);
+}
@@ -150,6 +150,54 @@ struct PushConstantsApp : public TestApp
     }
 };
 
+// records every state command twice, the shadowed state drops the repeats
+struct RedundantStateApp : public PushConstantsApp
+{
+    explicit RedundantStateApp(const TestAppDescriptor& desc) : PushConstantsApp(desc) {}
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        for (uint i = 0; i < 2; i++) {
+            command.set_viewport(0, 0, static_cast<float>(desc.width), static_cast<float>(desc.height));
+            command.set_scissor_rect(0, 0, desc.width, desc.height);
+            command.set_pipeline(pipeline.pipeline);
+            command.set_vertex_buffer(0, geometry.vbuffer);
+            command.set_index_buffer(geometry.ibuffer, GPUIndexFormat::UINT32);
+        }
+        for (uint i : {0u, 0u, 1u}) {
+            command.set_push_constants(GPUShaderStage::VERTEX, 0, push_constants.at(i));
+            command.draw_indexed(3, 1, 0, 0, 0);
+        }
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+    }
+};
+
 TEST_CASE("rhi::vulkan::push_constants" * doctest::description("Rendering multiple triangles with the dynamic uniform buffer."))
 {
     TestAppDescriptor desc{};
@@ -164,6 +212,36 @@ TEST_CASE("rhi::vulkan::push_constants" * doctest::description("Rendering multip
     PushConstantsApp(desc).run();
 }
 
+TEST_CASE("rhi::vulkan::command_stats" * doctest::description("Redundant state commands are dropped against the state already recorded in the command buffer."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_command_stats";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = 2;
+
+    RedundantStateApp app(desc);
+    app.run();
+
+    // the state is tracked per command buffer, each frame drops the same commands
+    auto stats = RHI::get_current_device().get_command_stats();
+    CHECK(stats.state_commands == 13 * desc.frames);
+    CHECK(stats.dropped_pipelines == desc.frames);
+    CHECK(stats.dropped_viewports == desc.frames);
+    CHECK(stats.dropped_scissors == desc.frames);
+    CHECK(stats.dropped_vertex_buffers == desc.frames);
+    CHECK(stats.dropped_index_buffers == desc.frames);
+    CHECK(stats.dropped_push_constants == desc.frames);
+    CHECK(stats.dropped_bind_groups == 0);
+    CHECK(stats.merged_vertex_buffers == 0);
+    CHECK(stats.dropped() == 6 * desc.frames);
+}
+
 #ifdef WIN32
 TEST_CASE("rhi::d3d12::push_constants" * doctest::description("Rendering multiple triangles with the dynamic uniform buffer."))
 {
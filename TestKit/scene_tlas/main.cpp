@@ -0,0 +1,226 @@
+#include "helper.h"
+#include <Lyra/Render/RPI/GPUBlasBuilder.h>
+#include <Lyra/Render/RPI/GPUSceneTlas.h>
+
+// a grid of triangles sharing one blas, one of them moves every frame
+constexpr uint NUM_INSTANCES = 64;
+constexpr uint NUM_FRAMES    = 16;
+constexpr uint SPAWN_FRAME   = 8;
+
+struct SceneTlasApp : public TestApp
+{
+    GPUBuffer      vbuffer;
+    GPUBuffer      ibuffer;
+    GPUBlasBuilder builder;
+    GPUProfiler    profiler;
+    GPUSceneTlas   scene;
+    Universe       universe;
+    uint           entry          = 0;
+    uint           frame          = 0;
+    uint           refit_max      = 0;
+    uint           rebuild_min    = ~0u;
+    double         refit_gpu_ms   = 0.0; // GPU time of the latest refit read back
+    double         rebuild_gpu_ms = 0.0; // GPU time of the latest rebuild read back
+
+    explicit SceneTlasApp(const TestAppDescriptor& desc) : TestApp(desc), builder(GPUBlasBuilderDescriptor{}), scene(scene_descriptor(&profiler))
+    {
+        setup_blas();
+    }
+
+    static auto scene_descriptor(GPUProfiler* profiler) -> GPUSceneTlasDescriptor
+    {
+        auto desc     = GPUSceneTlasDescriptor{};
+        desc.profiler = profiler;
+        return desc;
+    }
+
+    void setup_blas()
+    {
+        auto& device = RHI::get_current_device();
+
+        vbuffer = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "tlas_vertex_buffer";
+            desc.size               = sizeof(glm::vec3) * 3;
+            desc.usage              = GPUBufferUsage::BLAS_INPUT | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            desc.virtual_address    = true;
+            return device.create_buffer(desc);
+        });
+
+        ibuffer = execute([&]() {
+            auto desc               = GPUBufferDescriptor{};
+            desc.label              = "tlas_index_buffer";
+            desc.size               = sizeof(uint) * 3;
+            desc.usage              = GPUBufferUsage::BLAS_INPUT | GPUBufferUsage::MAP_WRITE;
+            desc.mapped_at_creation = true;
+            desc.virtual_address    = true;
+            return device.create_buffer(desc);
+        });
+
+        auto vertices = vbuffer.get_mapped_range<glm::vec3>();
+        vertices.at(0) = {0.0f, 0.0f, 0.0f};
+        vertices.at(1) = {1.0f, 0.0f, 0.0f};
+        vertices.at(2) = {0.0f, 1.0f, 0.0f};
+
+        auto indices = ibuffer.get_mapped_range<uint>();
+        indices.at(0) = 0;
+        indices.at(1) = 1;
+        indices.at(2) = 2;
+
+        vbuffer.unmap();
+        ibuffer.unmap();
+
+        auto geometry               = GPUBlasTriangleGeometry{};
+        geometry.size.vertex_format = GPUVertexFormat::FLOAT32x3;
+        geometry.size.index_format  = GPUIndexFormat::UINT32;
+        geometry.size.vertex_count  = 3;
+        geometry.size.index_count   = 3;
+        geometry.size.flags         = GPUBVHGeometryFlag::BVH_OPAQUE;
+        geometry.vertex_buffer      = vbuffer;
+        geometry.index_buffer       = ibuffer;
+        geometry.vertex_stride      = sizeof(glm::vec3);
+
+        auto desc  = GPUBlasDescriptor{};
+        desc.label = "triangle_blas";
+        desc.flags = GPUBVHFlag::PREFER_FAST_TRACE;
+        entry      = builder.add(desc, {geometry});
+    }
+
+    void spawn(uint index)
+    {
+        auto entity = universe.create();
+
+        auto& world = universe.registry.get<WorldTransform>(entity);
+        world.xform = glm::translate(glm::mat4(1.0f), glm::vec3(float(index % 8), float(index / 8), 0.0f));
+        world.dirty = true;
+
+        auto instance        = RayTracingInstance{};
+        instance.blas        = builder.get(entry).handle;
+        instance.custom_data = index;
+        universe.registry.emplace<RayTracingInstance>(entity, instance);
+    }
+
+    void animate()
+    {
+        // move a single instance, the tlas is refit with its record only
+        auto view  = universe.view<RayTracingInstance, WorldTransform>();
+        auto index = frame % NUM_INSTANCES;
+        view.each([&](Entity, RayTracingInstance& instance, WorldTransform& world) {
+            if (instance.custom_data != index)
+                return;
+            world.xform = glm::translate(world.xform, glm::vec3(0.0f, 0.0f, 0.1f));
+            world.dirty = true;
+        });
+    }
+
+    void destroy()
+    {
+        vbuffer.destroy();
+        ibuffer.destroy();
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // build times of the frame last completed in this frame slot
+        profiler.new_frame();
+        for (auto& scope : profiler.get_results()) {
+            if (scope.name == "tlas_refit")
+                refit_gpu_ms = scope.time;
+            if (scope.name == "tlas_rebuild")
+                rebuild_gpu_ms = scope.time;
+        }
+
+        // create command buffer
+        auto command = execute([&]() {
+            auto desc  = GPUCommandBufferDescriptor{};
+            desc.queue = GPUQueueType::DEFAULT;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // the blas is built by the first update, ahead of the tlas
+        builder.update(command);
+
+        if (frame == 0)
+            for (uint i = 0; i < NUM_INSTANCES; i++)
+                spawn(i);
+        else if (frame == SPAWN_FRAME)
+            spawn(NUM_INSTANCES);
+        else
+            animate();
+
+        // tlas builds are recorded outside of render passes
+        auto previous = scene.get_stats();
+        scene.update(command, universe);
+
+        auto stats = scene.get_stats();
+        if (stats.rebuilds != previous.rebuilds)
+            rebuild_min = std::min(rebuild_min, stats.written);
+        if (stats.refits != previous.refits)
+            refit_max = std::max(refit_max, stats.written);
+
+        // the transforms are consumed for this frame
+        universe.view<WorldTransform>().each([](WorldTransform& world) { world.dirty = false; });
+
+        // commands
+        command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
+        command.begin_render_pass(render_pass);
+        command.end_render_pass();
+        profiler.resolve(command);
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+
+        frame++;
+    }
+};
+
+TEST_CASE("rhi::vulkan::scene_tlas" * doctest::description("Refitting the scene TLAS from dirty transforms, rebuilding it when instances are added."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+    desc.frames         = NUM_FRAMES;
+    desc.latency        = 2;
+    desc.features       = {GPUFeatureName::RAYTRACING};
+
+    SceneTlasApp app(desc);
+    app.run();
+
+    // rebuilt on the first frame and when an instance spawns, refit otherwise
+    auto stats = app.scene.get_stats();
+    CHECK(stats.instances == NUM_INSTANCES + 1);
+    CHECK(stats.rebuilds == 2);
+    CHECK(stats.refits == NUM_FRAMES - 2);
+
+    // refits only rewrite the moved instance, rebuilds rewrite every record
+    CHECK(app.refit_max == 1);
+    CHECK(app.rebuild_min >= NUM_INSTANCES);
+    MESSAGE("tlas update recording: ", stats.refit_record_ms, " ms refit, ", stats.rebuild_record_ms, " ms rebuild");
+
+    // both build paths are measured on the GPU as well
+    CHECK(app.refit_gpu_ms > 0.0);
+    CHECK(app.rebuild_gpu_ms > 0.0);
+    MESSAGE("tlas update on GPU: ", app.refit_gpu_ms, " ms refit, ", app.rebuild_gpu_ms, " ms rebuild");
+
+    app.destroy();
+}
@@ -0,0 +1,192 @@
+#include <chrono>
+#include <algorithm>
+#include <Lyra/Common/Slotmap.h>
+#include "helper.h"
+
+struct SlotItem
+{
+    uint value = 0;
+
+    bool valid() const { return value != 0; }
+};
+
+struct SlotItemDeleter
+{
+    void operator()(SlotItem& item) { item.value = 0; }
+};
+
+// previous flat slotmap layout (without the 2048 cap), kept as benchmark baseline
+struct FlatSlotmap
+{
+    Vector<SlotItem> data = {};
+    Vector<uint>     free = {};
+
+    auto add(const SlotItem& value) -> uint
+    {
+        uint index;
+        if (free.empty()) {
+            index = static_cast<uint>(data.size());
+            data.push_back(value);
+        } else {
+            index = free.back();
+            free.pop_back();
+            data.at(index) = value;
+        }
+        return index;
+    }
+
+    void remove(uint index)
+    {
+        SlotItemDeleter()(data.at(index));
+        free.push_back(index);
+    }
+
+    auto at(uint index) -> SlotItem& { return data.at(index); }
+};
+
+using SlotItemManager = Slotmap<SlotItem, SlotItemDeleter>;
+
+constexpr uint NUM_SLOT_ITEMS = 100000;
+constexpr uint NUM_SLOT_ROUND = 10;
+
+template <typename Map>
+double benchmark_slotmap(Map& map, Vector<uint>& handles)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    uint64_t checksum = 0;
+    for (uint round = 0; round < NUM_SLOT_ROUND; round++) {
+        handles.clear();
+        for (uint i = 0; i < NUM_SLOT_ITEMS; i++)
+            handles.push_back(map.add(SlotItem{i + 1}));
+        for (uint handle : handles)
+            checksum += map.at(handle).value;
+        for (uint handle : handles)
+            map.remove(handle);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    CHECK(checksum == uint64_t(NUM_SLOT_ROUND) * NUM_SLOT_ITEMS * (NUM_SLOT_ITEMS + 1) / 2);
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+TEST_CASE("common::slotmap::generation" * doctest::description("stale handles must not alias recycled slots"))
+{
+    SlotItemManager map;
+
+    uint a = map.add(SlotItem{1});
+    CHECK(map.contains(a));
+    CHECK(map.at(a).value == 1);
+
+    map.remove(a);
+    CHECK(!map.contains(a));
+
+    uint b = map.add(SlotItem{2});
+    CHECK(b != a);
+    CHECK(map.contains(b));
+    CHECK(!map.contains(a));
+    CHECK(map.size() == 1);
+}
+
+TEST_CASE("common::slotmap::generation_wrap" * doctest::description("stale handles alias again once their slot is reused 2048 times"))
+{
+    SlotItemManager map;
+
+    // add and remove both bump the generation, only odd generations are handed out
+    constexpr uint REUSES = (SlotItemManager::GENERATION_MASK + 1) / 2;
+    CHECK(REUSES == 2048);
+
+    uint stale = map.add(SlotItem{1});
+    map.remove(stale);
+
+    uint aliased = 0;
+    for (uint i = 1; i < REUSES; i++) {
+        uint handle = map.add(SlotItem{i + 1});
+        aliased += (handle == stale || map.contains(stale)) ? 1 : 0;
+        map.remove(handle);
+    }
+    CHECK(aliased == 0);
+
+    // the generation has wrapped around, the slot hands out the stale handle again
+    uint wrapped = map.add(SlotItem{REUSES + 1});
+    CHECK(wrapped == stale);
+    CHECK(map.contains(stale));
+}
+
+TEST_CASE("common::slotmap::release" * doctest::description("released handles hand the item back exactly once"))
+{
+    SlotItemManager map;
+
+    uint a = map.add(SlotItem{1});
+    uint b = map.add(SlotItem{2});
+
+    auto item = map.release(a);
+    CHECK(item.value == 1);
+    CHECK(!map.contains(a));
+    CHECK(map.size() == 1);
+
+    // the released slot is recycled exactly once
+    uint c = map.add(SlotItem{3});
+    uint d = map.add(SlotItem{4});
+    CHECK(c != d);
+    CHECK(map.at(b).value == 2);
+    CHECK(map.at(c).value == 3);
+    CHECK(map.at(d).value == 4);
+}
+
+TEST_CASE("common::slotmap::growth" * doctest::description("slotmap grows past 2048 entries with stable references"))
+{
+    SlotItemManager map;
+
+    uint      first   = map.add(SlotItem{1});
+    SlotItem* address = &map.at(first);
+
+    Vector<uint> handles;
+    for (uint i = 0; i < 10000; i++)
+        handles.push_back(map.add(SlotItem{i + 2}));
+
+    CHECK(map.size() == 10001);
+    CHECK(&map.at(first) == address);
+    for (uint i = 0; i < handles.size(); i++)
+        CHECK(map.at(handles.at(i)).value == i + 2);
+
+    uint count = 0;
+    for (auto& item : map)
+        count += item.valid() ? 1 : 0;
+    CHECK(count == 10001);
+}
+
+TEST_CASE("common::slotmap::iteration" * doctest::description("iterators hand out the handles of live items"))
+{
+    SlotItemManager map;
+
+    uint a = map.add(SlotItem{1});
+    uint b = map.add(SlotItem{2});
+    map.remove(a);
+    uint c = map.add(SlotItem{3});
+
+    Vector<uint> handles;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        CHECK(map.at(it.handle()).value == (*it).value);
+        handles.push_back(it.handle());
+    }
+
+    CHECK(handles.size() == 2);
+    CHECK(std::find(handles.begin(), handles.end(), b) != handles.end());
+    CHECK(std::find(handles.begin(), handles.end(), c) != handles.end());
+}
+
+TEST_CASE("common::slotmap::benchmark" * doctest::description("add/remove/lookup against the flat slotmap layout"))
+{
+    Vector<uint> handles;
+    handles.reserve(NUM_SLOT_ITEMS);
+
+    FlatSlotmap     flat;
+    SlotItemManager chunked;
+
+    double flat_ms    = benchmark_slotmap(flat, handles);
+    double chunked_ms = benchmark_slotmap(chunked, handles);
+
+    MESSAGE("flat slotmap: ", flat_ms, " ms");
+    MESSAGE("chunked slotmap: ", chunked_ms, " ms");
+}
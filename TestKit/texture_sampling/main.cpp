@@ -48,7 +48,7 @@ struct TextureSamplingApp : public TestApp
 {
     Uniform              uniform;
     Geometry             geometry;
-    GPUBuffer            staging;
+    GPUUploadToken       upload;
     GPUTexture           texture;
     GPUTextureView       texview;
     GPUSampler           sampler;
@@ -100,7 +100,7 @@ struct TextureSamplingApp : public TestApp
         auto tex = SimpleTexture2D::gradient(4, 4);
         tex.upload();
 
-        staging = tex.buffer;
+        upload  = tex.token;
         texture = tex.texture;
         texview = tex.view;
     }
@@ -197,6 +197,9 @@ struct TextureSamplingApp : public TestApp
             command.signal(backbuffer.complete, GPUBarrierSync::RENDER_TARGET);
         }
 
+        // texture is uploaded asynchronously
+        command.wait(upload, GPUBarrierSync::PIXEL_SHADING);
+
         // commands
         command.resource_barrier(state_transition(backbuffer.texture, undefined_state(), color_attachment_state()));
         command.begin_render_pass(render_pass);
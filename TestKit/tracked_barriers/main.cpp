@@ -0,0 +1,185 @@
+#include "helper.h"
+
+CString tracked_barriers_program = R"""(
+struct VertexInput
+{
+    float3 position : POSITION;
+    float3 color    : COLOR0;
+};
+
+struct VertexOutput
+{
+    float4 position : SV_Position;
+    float4 color    : COLOR0;
+};
+
+[shader("vertex")]
+VertexOutput vsmain(VertexInput input)
+{
+    VertexOutput output;
+    output.position = float4(input.position, 1.0);
+    output.color = float4(input.color, 1.0);
+    return output;
+}
+
+[shader("fragment")]
+float4 fsmain(VertexOutput input) : SV_Target
+{
+    return input.color;
+}
+)""";
+
+// vertices are written by one command buffer and read by the next one,
+// which renders into a render target it never transitions explicitly.
+struct TrackedBarriersApp : public TestApp
+{
+    GPUBuffer            vbuffer;
+    SimpleRenderPipeline pipeline;
+
+    explicit TrackedBarriersApp(const TestAppDescriptor& desc) : TestApp(desc)
+    {
+        setup_buffers();
+        setup_pipeline();
+    }
+
+    void setup_buffers()
+    {
+        auto& device = RHI::get_current_device();
+
+        vbuffer = execute([&]() {
+            auto desc  = GPUBufferDescriptor{};
+            desc.label = "tracked_vertex_buffer";
+            desc.size  = sizeof(Vertex) * 3;
+            desc.usage = GPUBufferUsage::VERTEX | GPUBufferUsage::COPY_DST;
+            return device.create_buffer(desc);
+        });
+    }
+
+    void setup_pipeline()
+    {
+        auto& device = RHI::get_current_device();
+
+        auto module = execute([&]() {
+            auto desc   = CompileDescriptor{};
+            desc.module = "test";
+            desc.path   = "test.slang";
+            desc.source = tracked_barriers_program;
+            return compiler->compile(desc);
+        });
+
+        auto reflection = compiler->reflect({
+            {*module, "vsmain"},
+            {*module, "fsmain"},
+        });
+
+        pipeline.vstride = sizeof(Vertex);
+        pipeline.attributes.push_back({"position", offsetof(Vertex, position)});
+        pipeline.attributes.push_back({"color", offsetof(Vertex, color)});
+        pipeline.init_color_state(get_backbuffer_format());
+        pipeline.init_vshader(device, module.get(), "vsmain");
+        pipeline.init_fshader(device, module.get(), "fsmain");
+        pipeline.init_playout(device, reflection.get());
+        pipeline.init_pipeline(device, reflection.get());
+    }
+
+    void destroy()
+    {
+        vbuffer.destroy();
+    }
+
+    void render(const GPUSurfaceTexture& backbuffer) override
+    {
+        auto& device = RHI::get_current_device();
+
+        // a red triangle covering the whole render target
+        Array<Vertex, 3> vertices = {};
+        vertices.at(0).position   = {-1.0f, -1.0f, 0.0f};
+        vertices.at(1).position   = {+3.0f, -1.0f, 0.0f};
+        vertices.at(2).position   = {-1.0f, +3.0f, 0.0f};
+        for (auto& vertex : vertices)
+            vertex.color = {1.0f, 0.0f, 0.0f};
+
+        // the first command buffer writes the vertices
+        auto upload = execute([&]() {
+            auto desc    = GPUCommandBufferDescriptor{};
+            desc.queue   = GPUQueueType::DEFAULT;
+            desc.tracked = true;
+            return device.create_command_buffer(desc);
+        });
+        upload.update_buffer(vbuffer, 0, vertices.data(), sizeof(Vertex) * vertices.size());
+        upload.submit();
+
+        // the second command buffer reads them, its first accesses are synchronized by a prologue
+        auto command = execute([&]() {
+            auto desc    = GPUCommandBufferDescriptor{};
+            desc.queue   = GPUQueueType::DEFAULT;
+            desc.tracked = true;
+            return device.create_command_buffer(desc);
+        });
+
+        // color attachments
+        auto color_attachment        = GPURenderPassColorAttachment{};
+        color_attachment.clear_value = GPUColor{0.0f, 0.0f, 0.0f, 0.0f};
+        color_attachment.load_op     = GPULoadOp::CLEAR;
+        color_attachment.store_op    = GPUStoreOp::STORE;
+        color_attachment.view        = backbuffer.view;
+
+        // render pass info
+        auto render_pass                     = GPURenderPassDescriptor{};
+        render_pass.color_attachments        = color_attachment;
+        render_pass.depth_stencil_attachment = {};
+
+        // commands, the render pass is deferred and its attachment transitioned before it begins
+        command.begin_render_pass(render_pass);
+        command.set_viewport(0, 0, static_cast<float>(desc.width), static_cast<float>(desc.height));
+        command.set_scissor_rect(0, 0, desc.width, desc.height);
+        command.set_pipeline(pipeline.pipeline);
+        command.set_vertex_buffer(0, vbuffer);
+        command.draw(3);
+        command.end_render_pass();
+        postprocessing(command, backbuffer.texture);
+        command.submit();
+    }
+};
+
+TEST_CASE("rhi::vulkan::tracked_barriers" * doctest::description("Tracked command buffers synchronize with previous submissions through prologues, and transition attachments of deferred render passes."))
+{
+    TestAppDescriptor desc{};
+    desc.name           = "vulkan_tracked_barriers";
+    desc.window         = false;
+    desc.backend        = RHIBackend::VULKAN;
+    desc.width          = 640;
+    desc.height         = 480;
+    desc.rhi_flags      = RHIFlag::DEBUG | RHIFlag::VALIDATION;
+    desc.compile_target = CompileTarget::SPIRV;
+    desc.compile_flags  = CompileFlag::DEBUG;
+
+    TrackedBarriersApp app(desc);
+    app.run();
+
+    // vertex buffer written by the previous submission, and render target never used before
+    auto stats = RHI::get_current_device().get_command_stats();
+    MESSAGE("tracked barriers: ", stats.tracked_barriers, " while recording, ", stats.prologue_barriers, " in prologues");
+    CHECK(stats.prologue_barriers >= 2);
+
+    // render target transitioned from the attachment to the copy source for the readback
+    CHECK(stats.tracked_barriers >= 1);
+
+    // the triangle covers the render target, drawn from the uploaded vertices
+    app.render_target.buffer.map(GPUMapMode::READ);
+    {
+        auto pixels = app.render_target.buffer.get_mapped_range<uint8_t>();
+        for (uint y : {0u, desc.height / 2, desc.height - 1}) {
+            for (uint x : {0u, desc.width / 2, desc.width - 1}) {
+                auto pixel = pixels.data + (y * desc.width + x) * 4;
+                CHECK(pixel[0] == 255);
+                CHECK(pixel[1] == 0);
+                CHECK(pixel[2] == 0);
+                CHECK(pixel[3] == 255);
+            }
+        }
+    }
+    app.render_target.buffer.unmap();
+
+    app.destroy();
+}